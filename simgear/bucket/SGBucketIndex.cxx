@@ -0,0 +1,275 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include "SGBucketIndex.hxx"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// 1/8 degree latitude bands from -90 to 90
+const unsigned NumRows = 180*8;
+
+// The radius the geocentric distance functions of SGGeodesy use
+const double EarthRadiusM = SG_RAD_TO_NM*SG_NM_TO_METER;
+
+unsigned
+rowOfBucket(const SGBucket& bucket)
+{
+    return (bucket.get_chunk_lat() + 90)*8 + bucket.get_y();
+}
+
+unsigned
+rowOfLatitude(double latDeg)
+{
+    int row = int(floor((latDeg + 90)/SG_BUCKET_SPAN));
+    return unsigned(SGMisc<int>::clip(row, 0, NumRows - 1));
+}
+
+double
+sphereDistanceRad(double lat1, double lat2, double dLon)
+{
+    return SGGeodesy::distanceRad(SGGeoc::fromRadM(0, lat1, 1),
+                                  SGGeoc::fromRadM(dLon, lat2, 1));
+}
+
+}
+
+SGBucketIndex::SGBucketIndex() :
+    _rows(NumRows)
+{
+}
+
+SGBucketIndex::~SGBucketIndex()
+{
+}
+
+bool
+SGBucketIndex::insert(const SGBucket& bucket)
+{
+    if (!bucket.isValid())
+        return false;
+    long int index = bucket.gen_index();
+    if (!_indices.insert(index).second)
+        return false;
+    _rows[rowOfBucket(bucket)].insert(index);
+    return true;
+}
+
+bool
+SGBucketIndex::erase(const SGBucket& bucket)
+{
+    if (!_indices.erase(bucket.gen_index()))
+        return false;
+    _rows[rowOfBucket(bucket)].erase(bucket.gen_index());
+    return true;
+}
+
+bool
+SGBucketIndex::contains(const SGBucket& bucket) const
+{
+    return _indices.count(bucket.gen_index()) != 0;
+}
+
+void
+SGBucketIndex::clear()
+{
+    _indices.clear();
+    for (unsigned i = 0; i < _rows.size(); ++i)
+        _rows[i].clear();
+}
+
+void
+SGBucketIndex::getBuckets(std::vector<SGBucket>& list) const
+{
+    for (unsigned i = 0; i < _rows.size(); ++i) {
+        for (Row::const_iterator j = _rows[i].begin(); j != _rows[i].end(); ++j)
+            list.push_back(SGBucket(*j));
+    }
+}
+
+void
+SGBucketIndex::getBuckets(const SGGeod& min, const SGGeod& max,
+                          std::vector<SGBucket>& list) const
+{
+    if (max.getLatitudeDeg() < min.getLatitudeDeg())
+        return;
+    double west = min.getLongitudeDeg();
+    double east = max.getLongitudeDeg();
+    if (east < west)
+        east += 360;
+
+    unsigned lastRow = rowOfLatitude(max.getLatitudeDeg());
+    for (unsigned row = rowOfLatitude(min.getLatitudeDeg()); row <= lastRow; ++row)
+        getRowBuckets(row, west, east, list);
+}
+
+void
+SGBucketIndex::getBuckets(const SGGeod& center, double radiusM,
+                          std::vector<SGBucket>& list) const
+{
+    if (_indices.empty() || radiusM < 0)
+        return;
+
+    double radius = radiusM/EarthRadiusM;
+    double lat = center.getLatitudeRad();
+    double south = lat - radius;
+    double north = lat + radius;
+
+    // Longitude extent of the spherical cap, all around if it has a pole
+    double dLon;
+    if (SGMiscd::pi()/2 <= radius || SGMiscd::pi()/2 <= north
+        || south <= -SGMiscd::pi()/2)
+        dLon = SGMiscd::pi();
+    else
+        dLon = asin(sin(radius)/cos(lat));
+
+    double lon = center.getLongitudeDeg();
+    dLon *= SGD_RADIANS_TO_DEGREES;
+
+    std::size_t first = list.size();
+    unsigned lastRow = rowOfLatitude(north*SGD_RADIANS_TO_DEGREES);
+    for (unsigned row = rowOfLatitude(south*SGD_RADIANS_TO_DEGREES);
+         row <= lastRow; ++row)
+        getRowBuckets(row, lon - dLon, lon + dLon, list);
+
+    // The bands cover the bounding box of the cap, drop the corners
+    std::size_t kept = first;
+    for (std::size_t i = first; i < list.size(); ++i) {
+        if (distanceRad(list[i], center) <= radius)
+            list[kept++] = list[i];
+    }
+    list.resize(kept);
+}
+
+void
+SGBucketIndex::getNearestBuckets(const SGGeod& center, unsigned count,
+                                 std::vector<SGBucket>& list) const
+{
+    if (_indices.empty() || !count)
+        return;
+
+    // Grow the search radius until there are enough candidates. All
+    // buckets nearer than the radius are found, so the nearest count of
+    // them are the nearest count of all.
+    double radiusM = 2*SG_BUCKET_SPAN*SGD_DEGREES_TO_RADIANS*EarthRadiusM;
+    std::vector<SGBucket> candidates;
+    for (;;) {
+        candidates.clear();
+        getBuckets(center, radiusM, candidates);
+        if (count <= candidates.size() || SGMiscd::pi()*EarthRadiusM <= radiusM)
+            break;
+        radiusM *= 2;
+    }
+
+    std::vector<std::pair<double, long int> > sorted;
+    sorted.reserve(candidates.size());
+    for (std::size_t i = 0; i < candidates.size(); ++i)
+        sorted.push_back(std::make_pair(distanceRad(candidates[i], center),
+                                        candidates[i].gen_index()));
+    count = unsigned(std::min(std::size_t(count), sorted.size()));
+    std::partial_sort(sorted.begin(), sorted.begin() + count, sorted.end());
+    for (unsigned i = 0; i < count; ++i)
+        list.push_back(SGBucket(sorted[i].second));
+}
+
+double
+SGBucketIndex::distanceRad(const SGBucket& bucket, const SGGeod& geod)
+{
+    double lat = geod.getLatitudeRad();
+    double south = (bucket.get_center_lat() - 0.5*bucket.get_height())*SGD_DEGREES_TO_RADIANS;
+    double north = (bucket.get_center_lat() + 0.5*bucket.get_height())*SGD_DEGREES_TO_RADIANS;
+    double halfWidth = 0.5*bucket.get_width()*SGD_DEGREES_TO_RADIANS;
+    double dLon = geod.getLongitudeRad() - bucket.get_center_lon()*SGD_DEGREES_TO_RADIANS;
+    dLon = fabs(SGMiscd::normalizePeriodic(-SGMiscd::pi(), SGMiscd::pi(), dLon));
+
+    // Within the longitudes of the bucket, straight north or south
+    if (dLon <= halfWidth) {
+        if (lat < south)
+            return south - lat;
+        if (north < lat)
+            return lat - north;
+        return 0;
+    }
+
+    // Otherwise the nearest point is on the nearer bounding meridian,
+    // either the foot of the perpendicular or one of the corners
+    double edgeLon = dLon - halfWidth;
+    double distance = std::min(sphereDistanceRad(lat, south, edgeLon),
+                               sphereDistanceRad(lat, north, edgeLon));
+    if (edgeLon < SGMiscd::pi()/2) {
+        double foot = atan(tan(lat)/cos(edgeLon));
+        if (south < foot && foot < north)
+            distance = std::min(distance, sphereDistanceRad(lat, foot, edgeLon));
+    }
+    return distance;
+}
+
+double
+SGBucketIndex::distanceM(const SGBucket& bucket, const SGGeod& geod)
+{
+    return distanceRad(bucket, geod)*EarthRadiusM;
+}
+
+void
+SGBucketIndex::getRowBuckets(unsigned row, double west, double east,
+                             std::vector<SGBucket>& list) const
+{
+    const Row& buckets = _rows[row];
+    if (buckets.empty())
+        return;
+
+    double rowLat = -90 + (row + 0.5)*SG_BUCKET_SPAN;
+    if (360 <= east - west) {
+        getRowBuckets(buckets, rowLat, -180, 180, list);
+        return;
+    }
+
+    double extent = east - west;
+    west = SGMiscd::normalizePeriodic(-180, 180, west);
+    east = west + extent;
+    if (east <= 180) {
+        getRowBuckets(buckets, rowLat, west, east, list);
+    } else {
+        // Across the antimeridian
+        getRowBuckets(buckets, rowLat, west, 180, list);
+        getRowBuckets(buckets, rowLat, -180, east - 360, list);
+    }
+}
+
+void
+SGBucketIndex::getRowBuckets(const Row& row, double rowLat, double west,
+                             double east, std::vector<SGBucket>& list) const
+{
+    if (180 <= west)
+        return;
+    // Within a band the index grows with the longitude, so start at the
+    // bucket containing the west end and walk east
+    SGBucket first(SGGeod::fromDeg(west, rowLat));
+    for (Row::const_iterator i = row.lower_bound(first.gen_index());
+         i != row.end(); ++i) {
+        SGBucket bucket(*i);
+        if (east < bucket.get_center_lon() - 0.5*bucket.get_width())
+            break;
+        list.push_back(bucket);
+    }
+}
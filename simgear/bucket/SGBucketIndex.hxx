@@ -0,0 +1,117 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+/** \file SGBucketIndex.hxx
+ * A set of buckets with spatial queries.
+ */
+
+#ifndef _SGBUCKETINDEX_HXX
+#define _SGBUCKETINDEX_HXX
+
+#include <set>
+#include <unordered_set>
+#include <vector>
+
+#include <simgear/bucket/newbucket.hxx>
+
+/**
+ * A set of buckets, for example the currently loaded tiles, that answers
+ * which of them lie within a distance of a point, overlap a lat/lon box
+ * or are nearest to a point.
+ *
+ * Membership is a hash on SGBucket::gen_index(). In addition the buckets
+ * are sorted into the 1/8 degree latitude bands of the tiling scheme,
+ * and within a band the bucket index increases with longitude. A query
+ * only visits the bands it covers and in each band only the longitude
+ * range it needs.
+ *
+ * Distances are great circle distances on a sphere to the nearest point
+ * of a bucket, so a bucket counts as within range as soon as any part of
+ * it is. Queries covering a pole take whole latitude bands, queries
+ * crossing the antimeridian wrap around.
+ */
+class SGBucketIndex {
+public:
+    SGBucketIndex();
+    ~SGBucketIndex();
+
+    /**
+     * Add a bucket, returns false for invalid or already contained ones.
+     */
+    bool insert(const SGBucket& bucket);
+
+    /**
+     * Remove a bucket, returns false if it is not contained.
+     */
+    bool erase(const SGBucket& bucket);
+
+    bool contains(const SGBucket& bucket) const;
+
+    void clear();
+
+    bool empty() const
+    { return _indices.empty(); }
+    std::size_t size() const
+    { return _indices.size(); }
+
+    /**
+     * Append all contained buckets to list.
+     */
+    void getBuckets(std::vector<SGBucket>& list) const;
+
+    /**
+     * Append the buckets overlapping the box from min to max to list.
+     * If the longitude of min is larger than the one of max, the box
+     * crosses the antimeridian.
+     */
+    void getBuckets(const SGGeod& min, const SGGeod& max,
+                    std::vector<SGBucket>& list) const;
+
+    /**
+     * Append the buckets that come closer than radiusM to center to list.
+     */
+    void getBuckets(const SGGeod& center, double radiusM,
+                    std::vector<SGBucket>& list) const;
+
+    /**
+     * Append the count buckets nearest to center to list, nearest first.
+     */
+    void getNearestBuckets(const SGGeod& center, unsigned count,
+                           std::vector<SGBucket>& list) const;
+
+    /**
+     * Great circle distance from geod to the nearest point of bucket, in
+     * radians and in meters. Zero if geod is inside the bucket.
+     */
+    static double distanceRad(const SGBucket& bucket, const SGGeod& geod);
+    static double distanceM(const SGBucket& bucket, const SGGeod& geod);
+
+private:
+    typedef std::set<long int> Row;
+
+    // Appends the buckets of one latitude band that overlap the longitude
+    // range from west to east in degrees, wrapping at the antimeridian.
+    void getRowBuckets(unsigned row, double west, double east,
+                       std::vector<SGBucket>& list) const;
+    void getRowBuckets(const Row& row, double rowLat, double west,
+                       double east, std::vector<SGBucket>& list) const;
+
+    std::unordered_set<long int> _indices;
+    std::vector<Row> _rows;
+};
+
+#endif // _SGBUCKETINDEX_HXX
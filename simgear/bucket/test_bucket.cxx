@@ -25,13 +25,17 @@
 #include <iostream>
 #include <cstdlib>
 #include <cstring>
+#include <algorithm>
 
 using std::cout;
 using std::cerr;
 using std::endl;
 
 #include <simgear/bucket/newbucket.hxx>
+#include <simgear/bucket/SGBucketIndex.hxx>
+#include <simgear/math/sg_random.h>
 #include <simgear/misc/test_macros.hxx>
+#include <simgear/timing/timestamp.hxx>
 
 void testBucketSpans()
 {
@@ -345,6 +349,169 @@ void testSiblings()
     siblings.clear();
 }
 
+std::vector<long int> sortedIndices(const std::vector<SGBucket>& buckets)
+{
+    std::vector<long int> indices;
+    for (unsigned i = 0; i < buckets.size(); ++i)
+        indices.push_back(buckets[i].gen_index());
+    std::sort(indices.begin(), indices.end());
+    return indices;
+}
+
+void bruteForceRadius(const std::vector<SGBucket>& buckets, const SGGeod& center,
+                      double radiusM, std::vector<SGBucket>& list)
+{
+    for (unsigned i = 0; i < buckets.size(); ++i) {
+        if (SGBucketIndex::distanceM(buckets[i], center) <= radiusM)
+            list.push_back(buckets[i]);
+    }
+}
+
+void fillIndex(SGBucketIndex& index, std::vector<SGBucket>& buckets, unsigned count)
+{
+    while (buckets.size() < count) {
+        SGBucket b(SGGeod::fromDeg(360*sg_random() - 180, 180*sg_random() - 90));
+        if (index.insert(b))
+            buckets.push_back(b);
+    }
+}
+
+void testIndexBasic()
+{
+    SGBucketIndex index;
+    SG_VERIFY(index.empty());
+
+    SGBucket b1(5.1, 55.05);
+    SGBucket b2(-10.1, -43.8);
+    SG_VERIFY(index.insert(b1));
+    SG_VERIFY(!index.insert(b1));
+    SG_VERIFY(!index.insert(SGBucket()));
+    SG_VERIFY(index.insert(b2));
+    SG_CHECK_EQUAL(index.size(), 2u);
+    SG_VERIFY(index.contains(b1));
+    SG_VERIFY(!index.contains(SGBucket(5.3, 55.05)));
+
+    SG_VERIFY(index.erase(b1));
+    SG_VERIFY(!index.erase(b1));
+    SG_VERIFY(!index.contains(b1));
+
+    std::vector<SGBucket> all;
+    index.getBuckets(all);
+    SG_CHECK_EQUAL(all.size(), 1u);
+    SG_CHECK_EQUAL(all[0], b2);
+
+    SG_CHECK_EQUAL(SGBucketIndex::distanceM(b2, b2.get_center()), 0.0);
+    // one band south of the bucket
+    SGGeod south = SGGeod::fromDeg(b2.get_center_lon(), b2.get_center_lat() - 0.125);
+    SG_CHECK_EQUAL_EP2(SGBucketIndex::distanceRad(b2, south),
+                       0.0625*SGD_DEGREES_TO_RADIANS, 1e-12);
+}
+
+void testIndexPolarAndAntimeridian()
+{
+    SGBucketIndex index;
+
+    // Around the pole all longitudes are near
+    SGBucket polar1(-170, 89.95);
+    SGBucket polar2(10, 89.95);
+    SGBucket polar3(100, 88.5);
+    SG_VERIFY(index.insert(polar1));
+    SG_VERIFY(index.insert(polar2));
+    SG_VERIFY(index.insert(polar3));
+
+    std::vector<SGBucket> list;
+    index.getBuckets(SGGeod::fromDeg(0, 90), 50000, list);
+    SG_CHECK_EQUAL(list.size(), 2u);
+    list.clear();
+    index.getBuckets(SGGeod::fromDeg(-80, 89.99), 200000, list);
+    SG_CHECK_EQUAL(list.size(), 3u);
+    list.clear();
+
+    // Both sides of the antimeridian
+    SGBucket east(179.95, 10.01);
+    SGBucket west(-179.95, 10.01);
+    SG_VERIFY(index.insert(east));
+    SG_VERIFY(index.insert(west));
+    index.getBuckets(SGGeod::fromDeg(179.99, 10.05), 20000, list);
+    SG_CHECK_EQUAL(list.size(), 2u);
+    list.clear();
+    index.getBuckets(SGGeod::fromDeg(-179.99, 10.05), 20000, list);
+    SG_CHECK_EQUAL(list.size(), 2u);
+    list.clear();
+
+    // A box crossing the antimeridian
+    index.getBuckets(SGGeod::fromDeg(179, 9), SGGeod::fromDeg(-179, 11), list);
+    SG_CHECK_EQUAL(list.size(), 2u);
+    list.clear();
+    index.getBuckets(SGGeod::fromDeg(-179, 9), SGGeod::fromDeg(179, 11), list);
+    SG_CHECK_EQUAL(list.size(), 0u);
+    list.clear();
+
+    index.getNearestBuckets(SGGeod::fromDeg(179.99, 10.05), 1, list);
+    SG_CHECK_EQUAL(list.size(), 1u);
+    SG_CHECK_EQUAL(list[0], east);
+    list.clear();
+    index.getNearestBuckets(SGGeod::fromDeg(0, 90), 10, list);
+    SG_CHECK_EQUAL(list.size(), 5u);
+    // The two near the antimeridian are equally far from the pole
+    SG_VERIFY(list[3] == east || list[3] == west);
+    SG_VERIFY(list[4] == east || list[4] == west);
+}
+
+void testIndexQueries()
+{
+    sg_srandom(17);
+
+    SGBucketIndex index;
+    std::vector<SGBucket> buckets;
+    fillIndex(index, buckets, 200000);
+
+    std::vector<SGGeod> centers;
+    std::vector<double> radii;
+    for (unsigned i = 0; i < 1000; ++i) {
+        centers.push_back(SGGeod::fromDeg(360*sg_random() - 180, 180*sg_random() - 90));
+        radii.push_back(10000 + 490000*sg_random());
+    }
+
+    SGTimeStamp timeStamp = SGTimeStamp::now();
+    std::vector<std::vector<SGBucket> > results(centers.size());
+    for (unsigned i = 0; i < centers.size(); ++i)
+        index.getBuckets(centers[i], radii[i], results[i]);
+    int indexUSec = timeStamp.elapsedUSec();
+
+    // The linear scan is slow, check a part of the queries only
+    unsigned numBrute = 100;
+    timeStamp.stamp();
+    std::vector<std::vector<SGBucket> > bruteResults(numBrute);
+    for (unsigned i = 0; i < numBrute; ++i)
+        bruteForceRadius(buckets, centers[i], radii[i], bruteResults[i]);
+    int bruteUSec = timeStamp.elapsedUSec();
+
+    for (unsigned i = 0; i < numBrute; ++i)
+        SG_VERIFY(sortedIndices(results[i]) == sortedIndices(bruteResults[i]));
+
+    // The k nearest are no farther than anything else
+    for (unsigned i = 0; i < 20; ++i) {
+        std::vector<SGBucket> nearest;
+        index.getNearestBuckets(centers[i], 16, nearest);
+        SG_CHECK_EQUAL(nearest.size(), 16u);
+        std::vector<double> distances;
+        for (unsigned j = 0; j < buckets.size(); ++j)
+            distances.push_back(SGBucketIndex::distanceRad(buckets[j], centers[i]));
+        std::nth_element(distances.begin(), distances.begin() + 15, distances.end());
+        SG_CHECK_EQUAL(SGBucketIndex::distanceRad(nearest[15], centers[i]),
+                       distances[15]);
+        for (unsigned j = 1; j < nearest.size(); ++j)
+            SG_VERIFY(SGBucketIndex::distanceRad(nearest[j - 1], centers[i]) <=
+                      SGBucketIndex::distanceRad(nearest[j], centers[i]));
+    }
+
+    cout << centers.size() << " radius queries over " << buckets.size()
+         << " buckets: index " << indexUSec/1000 << "ms, linear scan "
+         << bruteUSec/numBrute*centers.size()/1000 << "ms (extrapolated from "
+         << numBrute << ")" << endl;
+}
+
 int main(int argc, char* argv[])
 {
     testBucketSpans();
@@ -356,6 +523,9 @@ int main(int argc, char* argv[])
     testOffsetWrap();
     testPolarOffset();
     testSiblings();
+    testIndexBasic();
+    testIndexPolarAndAntimeridian();
+    testIndexQueries();
 
     cout << "all tests passed OK" << endl;
     return 0; // passed
@@ -27,6 +27,7 @@
 #include "BVHTransform.hxx"
 #include "BVHMotionTransform.hxx"
 #include "BVHLineGeometry.hxx"
+#include "BVHFlatGeometry.hxx"
 
 #include "BVHStaticData.hxx"
 
@@ -56,6 +57,8 @@ public:
     { expandBy(node.getBoundingSphere()); }
     virtual void apply(BVHStaticGeometry& node)
     { expandBy(node.getBoundingSphere()); }
+    virtual void apply(BVHFlatGeometry& node)
+    { expandBy(node.getBoundingSphere()); }
     
     virtual void apply(const BVHStaticBinary& node, const BVHStaticData& data)
     { expandBy(node.getBoundingBox()); }
@@ -0,0 +1,234 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include "BVHFlatGeometry.hxx"
+
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace simgear {
+
+namespace {
+
+// The traversal stack is never deeper than the tree,
+// the builder guarantees that depth limit.
+enum { MaxStackSize = 64 };
+
+// The line segment in the form needed for the box test below.
+struct SegmentBoxTest {
+    SegmentBoxTest(const SGLineSegmentf& lineSegment)
+    { set(lineSegment); }
+
+    void set(const SGLineSegmentf& lineSegment)
+    {
+        SGVec3f center = lineSegment.getCenter();
+        SGVec3f direction = lineSegment.getDirection();
+        for (unsigned i = 0; i < 3; ++i) {
+            _c[i] = center[i];
+            _w[i] = 0.5f*direction[i];
+            _v[i] = std::fabs(_w[i]);
+        }
+    }
+
+    // Exactly the separating axis test of
+    // intersects(const SGBox<T>&, const SGLineSegment<T>&)
+    // but working on the raw node data.
+    bool intersects(const BVHFlatGeometry::Node& node) const
+    {
+        float c[3], h[3];
+        for (unsigned i = 0; i < 3; ++i) {
+            c[i] = _c[i] - 0.5f*(node._min[i] + node._max[i]);
+            h[i] = 0.5f*(node._max[i] - node._min[i]);
+            if (std::fabs(c[i]) > _v[i] + h[i])
+                return false;
+        }
+
+        if (std::fabs(c[1]*_w[2] - c[2]*_w[1]) > h[1]*_v[2] + h[2]*_v[1])
+            return false;
+        if (std::fabs(c[0]*_w[2] - c[2]*_w[0]) > h[0]*_v[2] + h[2]*_v[0])
+            return false;
+        if (std::fabs(c[0]*_w[1] - c[1]*_w[0]) > h[0]*_v[1] + h[1]*_v[0])
+            return false;
+
+        return true;
+    }
+
+    float _c[3];
+    float _w[3];
+    float _v[3];
+};
+
+}
+
+BVHFlatGeometry::BVHFlatGeometry(const std::vector<Node>& nodes,
+                                 const std::vector<Triangle>& triangles,
+                                 const MaterialList& materials) :
+    _storage(0),
+    _nodes(0),
+    _numNodes(static_cast<unsigned>(nodes.size())),
+    _triangles(0),
+    _numTriangles(static_cast<unsigned>(triangles.size())),
+    _materials(materials)
+{
+    std::size_t nodeBytes = _numNodes*sizeof(Node);
+    // Start the triangles on a fresh cache line too
+    nodeBytes = (nodeBytes + CacheLineSize - 1) & ~std::size_t(CacheLineSize - 1);
+    std::size_t triangleBytes = _numTriangles*sizeof(Triangle);
+
+    _storage = new char[nodeBytes + triangleBytes + CacheLineSize];
+    std::size_t misalignment = reinterpret_cast<std::size_t>(_storage)
+        & std::size_t(CacheLineSize - 1);
+    char* aligned = _storage;
+    if (misalignment)
+        aligned += CacheLineSize - misalignment;
+
+    _nodes = reinterpret_cast<Node*>(aligned);
+    _triangles = reinterpret_cast<Triangle*>(aligned + nodeBytes);
+    if (_numNodes)
+        std::memcpy(_nodes, &nodes.front(), _numNodes*sizeof(Node));
+    if (_numTriangles)
+        std::memcpy(_triangles, &triangles.front(), triangleBytes);
+}
+
+BVHFlatGeometry::~BVHFlatGeometry()
+{
+    delete [] _storage;
+}
+
+void
+BVHFlatGeometry::accept(BVHVisitor& visitor)
+{
+    visitor.apply(*this);
+}
+
+bool
+BVHFlatGeometry::intersect(SGLineSegmentf& lineSegment,
+                           unsigned& triangleIndex) const
+{
+    if (!_numNodes)
+        return false;
+
+    SegmentBoxTest boxTest(lineSegment);
+    const SGVec3f start = lineSegment.getStart();
+    bool haveHit = false;
+
+    unsigned stack[MaxStackSize];
+    unsigned stackSize = 0;
+    unsigned index = 0;
+    for (;;) {
+        const Node& node = _nodes[index];
+        if (boxTest.intersects(node)) {
+            if (!node.isLeaf()) {
+                // Enter the child the start point is in first, same as
+                // BVHStaticBinary::traverse does. Once we hit something
+                // there, the shortened segment may already miss the other.
+                unsigned nearChild = index + 1;
+                unsigned farChild = node._offset;
+                unsigned axis = node._splitAxis;
+                float center = 0.5f*(node._min[axis] + node._max[axis]);
+                if (!(start[axis] < center))
+                    std::swap(nearChild, farChild);
+                stack[stackSize++] = farChild;
+                index = nearChild;
+                continue;
+            }
+
+            unsigned end = node._offset + node._count;
+            for (unsigned i = node._offset; i < end; ++i) {
+                SGTrianglef triangle = _triangles[i].getTriangle();
+                SGVec3f point;
+                if (!intersects(point, triangle, lineSegment, 1e-4f))
+                    continue;
+                lineSegment.set(start, point);
+                boxTest.set(lineSegment);
+                triangleIndex = i;
+                haveHit = true;
+            }
+        }
+        if (!stackSize)
+            break;
+        index = stack[--stackSize];
+    }
+
+    return haveHit;
+}
+
+bool
+BVHFlatGeometry::nearestPoint(SGSphered& sphere, SGVec3d& point,
+                              unsigned& triangleIndex) const
+{
+    if (!_numNodes)
+        return false;
+
+    const SGVec3f center(sphere.getCenter());
+    bool havePoint = false;
+
+    unsigned stack[MaxStackSize];
+    unsigned stackSize = 0;
+    unsigned index = 0;
+    for (;;) {
+        const Node& node = _nodes[index];
+        if (intersects(sphere, node.getBoundingBox())) {
+            if (!node.isLeaf()) {
+                unsigned nearChild = index + 1;
+                unsigned farChild = node._offset;
+                unsigned axis = node._splitAxis;
+                float split = 0.5f*(node._min[axis] + node._max[axis]);
+                if (!(center[axis] < split))
+                    std::swap(nearChild, farChild);
+                stack[stackSize++] = farChild;
+                index = nearChild;
+                continue;
+            }
+
+            unsigned end = node._offset + node._count;
+            for (unsigned i = node._offset; i < end; ++i) {
+                SGTrianglef triangle = _triangles[i].getTriangle();
+                SGVec3d closest(closestPoint(triangle, center));
+                if (!intersects(sphere, closest))
+                    continue;
+                point = closest;
+                // The trick is to decrease the radius of the search sphere.
+                sphere.setRadius(length(closest - sphere.getCenter()));
+                triangleIndex = i;
+                havePoint = true;
+            }
+        }
+        if (!stackSize)
+            break;
+        index = stack[--stackSize];
+    }
+
+    return havePoint;
+}
+
+SGSphered
+BVHFlatGeometry::computeBoundingSphere() const
+{
+    SGSphered sphere;
+    if (!_numNodes)
+        return sphere;
+    sphere.expandBy(SGBoxd(_nodes[0].getBoundingBox()));
+    return sphere;
+}
+
+}
@@ -0,0 +1,133 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifndef BVHFlatGeometry_hxx
+#define BVHFlatGeometry_hxx
+
+#include <cstddef>
+#include <vector>
+
+#include <simgear/math/SGGeometry.hxx>
+#include <simgear/structure/SGSharedPtr.hxx>
+
+#include "BVHVisitor.hxx"
+#include "BVHNode.hxx"
+#include "BVHMaterial.hxx"
+
+namespace simgear {
+
+/// Static triangle geometry stored as one flat array of tree nodes.
+/// In contrast to BVHStaticGeometry, which keeps every inner node and every
+/// triangle as a separately allocated BVHStaticNode reached through virtual
+/// calls, this node keeps the whole tree in a single cache line aligned block
+/// and the triangle data packed in leaf order. Queries walk the tree with an
+/// explicit stack and without any virtual dispatch.
+/// Build instances with the BVHFlatGeometryBuilder.
+class BVHFlatGeometry : public BVHNode {
+public:
+    /// One node of the flattened tree, exactly 32 bytes.
+    /// For inner nodes the left child immediately follows the node in the
+    /// array and _offset is the index of the right child.
+    /// For leaf nodes _offset is the index of the first triangle and
+    /// _count the number of triangles.
+    struct Node {
+        float _min[3];
+        float _max[3];
+        unsigned _offset;
+        unsigned short _count;
+        unsigned short _splitAxis;
+
+        bool isLeaf() const
+        { return 0 < _count; }
+        SGBoxf getBoundingBox() const
+        { return SGBoxf(SGVec3f(_min), SGVec3f(_max)); }
+    };
+
+    /// A triangle in the same base vertex plus edges form that SGTriangle
+    /// uses, but stored as plain floats to keep the array tightly packed.
+    struct Triangle {
+        float _v0[3];
+        float _edge[2][3];
+        unsigned _material;
+
+        SGTrianglef getTriangle() const
+        {
+            SGTrianglef triangle;
+            triangle.setBaseVertex(SGVec3f(_v0));
+            triangle.setEdge(0, SGVec3f(_edge[0]));
+            triangle.setEdge(1, SGVec3f(_edge[1]));
+            return triangle;
+        }
+    };
+
+    typedef std::vector<SGSharedPtr<const BVHMaterial> > MaterialList;
+
+    BVHFlatGeometry(const std::vector<Node>& nodes,
+                    const std::vector<Triangle>& triangles,
+                    const MaterialList& materials);
+    virtual ~BVHFlatGeometry();
+
+    virtual void accept(BVHVisitor& visitor);
+
+    unsigned getNumNodes() const
+    { return _numNodes; }
+    const Node& getNode(unsigned i) const
+    { return _nodes[i]; }
+
+    unsigned getNumTriangles() const
+    { return _numTriangles; }
+    const Triangle& getTriangle(unsigned i) const
+    { return _triangles[i]; }
+
+    const BVHMaterial* getMaterial(unsigned i) const
+    { if (_materials.size() <= i) return 0; return _materials[i]; }
+
+    /// Intersect the line segment with the triangles.
+    /// On a hit the end of the line segment is moved to the closest
+    /// intersection point and the index of that triangle is returned in
+    /// triangleIndex.
+    bool intersect(SGLineSegmentf& lineSegment, unsigned& triangleIndex) const;
+
+    /// Find the closest point within the sphere.
+    /// On success the radius of the sphere is shrunk to the distance of
+    /// the returned point and the index of that triangle is returned in
+    /// triangleIndex.
+    bool nearestPoint(SGSphered& sphere, SGVec3d& point,
+                      unsigned& triangleIndex) const;
+
+    virtual SGSphered computeBoundingSphere() const;
+
+private:
+    BVHFlatGeometry(const BVHFlatGeometry&);
+    BVHFlatGeometry& operator=(const BVHFlatGeometry&);
+
+    // The arrays are placed in one block that is aligned to a cache line.
+    // std::allocator does not honour over aligned types before c++17.
+    enum { CacheLineSize = 64 };
+    char* _storage;
+
+    Node* _nodes;
+    unsigned _numNodes;
+    Triangle* _triangles;
+    unsigned _numTriangles;
+
+    MaterialList _materials;
+};
+
+}
+
+#endif
@@ -0,0 +1,356 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include "BVHFlatGeometryBuilder.hxx"
+
+#include <algorithm>
+
+namespace simgear {
+
+namespace {
+
+// Number of buckets the centers are sorted into along each axis.
+enum { NumBins = 16 };
+// Past this depth splits are done at the object median, which halves the
+// primitive count per level and bounds the depth of the tree to well below
+// the traversal stack size of BVHFlatGeometry.
+enum { MaxSAHDepth = 32 };
+// A leaf must fit the 16 bit count in the node.
+enum { MaxLeafCount = 0xffff };
+
+// Relative cost of one box test compared to one triangle test.
+const float TraversalCost = 1;
+
+float
+surfaceArea(const SGBoxf& box)
+{
+    if (box.empty())
+        return 0;
+    SGVec3f size = box.getSize();
+    return 2*(size[0]*size[1] + size[1]*size[2] + size[2]*size[0]);
+}
+
+struct VertexLess {
+    bool operator()(const SGVec3f& v1, const SGVec3f& v2) const
+    {
+        for (unsigned i = 0; i < 3; ++i) {
+            if (v1[i] < v2[i])
+                return true;
+            if (v2[i] < v1[i])
+                return false;
+        }
+        return false;
+    }
+};
+
+// Triangles with the same three vertices in any order are the same.
+struct TriangleKey {
+    SGVec3f _vertices[3];
+    unsigned _index;
+
+    bool operator<(const TriangleKey& key) const
+    {
+        VertexLess less;
+        for (unsigned i = 0; i < 3; ++i) {
+            if (less(_vertices[i], key._vertices[i]))
+                return true;
+            if (less(key._vertices[i], _vertices[i]))
+                return false;
+        }
+        return false;
+    }
+    bool operator==(const TriangleKey& key) const
+    { return !(*this < key) && !(key < *this); }
+};
+
+struct CenterLess {
+    CenterLess(unsigned axis) : _axis(axis) {}
+    template<typename P>
+    bool operator()(const P& p1, const P& p2) const
+    { return p1._center[_axis] < p2._center[_axis]; }
+    unsigned _axis;
+};
+
+struct Bin {
+    Bin() : _count(0) {}
+    SGBoxf _box;
+    unsigned _count;
+};
+
+template<typename P>
+struct InLeftBins {
+    InLeftBins(unsigned axis, float min, float scale, unsigned splitBin) :
+        _axis(axis), _min(min), _scale(scale), _splitBin(splitBin)
+    {}
+    bool operator()(const P& p) const
+    {
+        unsigned bin = unsigned((p._center[_axis] - _min)*_scale);
+        return std::min(bin, unsigned(NumBins - 1)) <= _splitBin;
+    }
+    unsigned _axis;
+    float _min;
+    float _scale;
+    unsigned _splitBin;
+};
+
+}
+
+BVHFlatGeometryBuilder::BVHFlatGeometryBuilder() :
+    _currentMaterial(0),
+    _currentMaterialIndex(~0u),
+    _maxLeafSize(4)
+{
+}
+
+BVHFlatGeometryBuilder::~BVHFlatGeometryBuilder()
+{
+}
+
+void
+BVHFlatGeometryBuilder::setCurrentMaterial(const BVHMaterial* material)
+{
+    _currentMaterial = material;
+    _currentMaterialIndex = addMaterial(material);
+}
+
+unsigned
+BVHFlatGeometryBuilder::addMaterial(const BVHMaterial* material)
+{
+    MaterialMap::const_iterator i = _materialMap.find(material);
+    if (i != _materialMap.end())
+        return i->second;
+    unsigned index = static_cast<unsigned>(_materials.size());
+    _materials.push_back(material);
+    _materialMap[material] = index;
+    return index;
+}
+
+void
+BVHFlatGeometryBuilder::addTriangle(const SGVec3f& v1, const SGVec3f& v2,
+                                    const SGVec3f& v3)
+{
+    Triangle triangle;
+    triangle._vertices[0] = v1;
+    triangle._vertices[1] = v2;
+    triangle._vertices[2] = v3;
+    triangle._material = _currentMaterialIndex;
+    _triangles.push_back(triangle);
+}
+
+void
+BVHFlatGeometryBuilder::removeDuplicates()
+{
+    std::vector<TriangleKey> keys(_triangles.size());
+    for (unsigned i = 0; i < _triangles.size(); ++i) {
+        TriangleKey& key = keys[i];
+        for (unsigned j = 0; j < 3; ++j)
+            key._vertices[j] = _triangles[i]._vertices[j];
+        std::sort(key._vertices, key._vertices + 3, VertexLess());
+        key._index = i;
+    }
+    // Stable, so the first added triangle of equal ones survives like with
+    // the BVHStaticGeometryBuilder.
+    std::stable_sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    if (keys.size() == _triangles.size())
+        return;
+
+    std::vector<unsigned> indices(keys.size());
+    for (unsigned i = 0; i < keys.size(); ++i)
+        indices[i] = keys[i]._index;
+    std::sort(indices.begin(), indices.end());
+
+    std::vector<Triangle> triangles(indices.size());
+    for (unsigned i = 0; i < indices.size(); ++i)
+        triangles[i] = _triangles[indices[i]];
+    _triangles.swap(triangles);
+}
+
+BVHFlatGeometry*
+BVHFlatGeometryBuilder::buildTree()
+{
+    if (_triangles.empty())
+        return 0;
+
+    removeDuplicates();
+
+    PrimitiveList primitives(_triangles.size());
+    for (unsigned i = 0; i < _triangles.size(); ++i) {
+        Primitive& primitive = primitives[i];
+        const Triangle& triangle = _triangles[i];
+        primitive._box.clear();
+        primitive._box.expandBy(triangle._vertices[0]);
+        primitive._box.expandBy(triangle._vertices[1]);
+        primitive._box.expandBy(triangle._vertices[2]);
+        primitive._center = (1.0f/3)*(triangle._vertices[0]
+                                      + triangle._vertices[1]
+                                      + triangle._vertices[2]);
+        primitive._index = i;
+    }
+
+    _nodes.clear();
+    _nodes.reserve(2*primitives.size());
+    buildRecursive(primitives, 0, static_cast<unsigned>(primitives.size()), 0);
+
+    // Pack the triangles in the order the leafs reference them
+    std::vector<BVHFlatGeometry::Triangle> triangles(primitives.size());
+    for (unsigned i = 0; i < primitives.size(); ++i) {
+        const Triangle& triangle = _triangles[primitives[i]._index];
+        BVHFlatGeometry::Triangle& packed = triangles[i];
+        SGVec3f edge0 = triangle._vertices[1] - triangle._vertices[0];
+        SGVec3f edge1 = triangle._vertices[2] - triangle._vertices[0];
+        for (unsigned j = 0; j < 3; ++j) {
+            packed._v0[j] = triangle._vertices[0][j];
+            packed._edge[0][j] = edge0[j];
+            packed._edge[1][j] = edge1[j];
+        }
+        packed._material = triangle._material;
+    }
+
+    BVHFlatGeometry* geometry;
+    geometry = new BVHFlatGeometry(_nodes, triangles, _materials);
+
+    _nodes.clear();
+    _triangles.clear();
+    return geometry;
+}
+
+unsigned
+BVHFlatGeometryBuilder::buildRecursive(PrimitiveList& primitives,
+                                       unsigned begin, unsigned end,
+                                       unsigned depth)
+{
+    unsigned nodeIndex = static_cast<unsigned>(_nodes.size());
+    _nodes.push_back(BVHFlatGeometry::Node());
+
+    SGBoxf box;
+    SGBoxf centerBox;
+    for (unsigned i = begin; i < end; ++i) {
+        box.expandBy(primitives[i]._box);
+        centerBox.expandBy(primitives[i]._center);
+    }
+    for (unsigned i = 0; i < 3; ++i) {
+        _nodes[nodeIndex]._min[i] = box.getMin()[i];
+        _nodes[nodeIndex]._max[i] = box.getMax()[i];
+    }
+
+    unsigned count = end - begin;
+    unsigned splitAxis = centerBox.getBroadestAxis();
+    float centerExtent = centerBox.getSize()[splitAxis];
+
+    // All centers in one point, nothing to separate by position
+    bool makeLeaf = count <= 1 || (centerExtent <= 0 && count <= MaxLeafCount);
+    bool medianSplit = !makeLeaf && (MaxSAHDepth <= depth || centerExtent <= 0);
+    unsigned middle = begin + count/2;
+
+    if (!makeLeaf && !medianSplit) {
+        // Binned surface area heuristic over all three axis
+        float bestCost = SGLimitsf::max();
+        unsigned bestAxis = 0;
+        unsigned bestBin = 0;
+        for (unsigned axis = 0; axis < 3; ++axis) {
+            float extent = centerBox.getSize()[axis];
+            if (extent <= 0)
+                continue;
+            float min = centerBox.getMin()[axis];
+            float scale = NumBins/extent;
+
+            Bin bins[NumBins];
+            for (unsigned i = begin; i < end; ++i) {
+                unsigned bin = unsigned((primitives[i]._center[axis] - min)*scale);
+                bin = std::min(bin, unsigned(NumBins - 1));
+                bins[bin]._box.expandBy(primitives[i]._box);
+                ++bins[bin]._count;
+            }
+
+            float rightArea[NumBins];
+            unsigned rightCount[NumBins];
+            SGBoxf rightBox;
+            unsigned rightSum = 0;
+            for (unsigned i = NumBins - 1; 0 < i; --i) {
+                rightBox.expandBy(bins[i]._box);
+                rightSum += bins[i]._count;
+                rightArea[i] = surfaceArea(rightBox);
+                rightCount[i] = rightSum;
+            }
+
+            SGBoxf leftBox;
+            unsigned leftSum = 0;
+            for (unsigned i = 0; i < NumBins - 1; ++i) {
+                leftBox.expandBy(bins[i]._box);
+                leftSum += bins[i]._count;
+                if (!leftSum || !rightCount[i + 1])
+                    continue;
+                float cost = leftSum*surfaceArea(leftBox)
+                    + rightCount[i + 1]*rightArea[i + 1];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin = i;
+                }
+            }
+        }
+
+        float area = surfaceArea(box);
+        float leafCost = count*area;
+        float splitCost = TraversalCost*area + bestCost;
+        if (count <= _maxLeafSize && count <= MaxLeafCount
+            && leafCost <= splitCost) {
+            makeLeaf = true;
+        } else if (bestCost == SGLimitsf::max()) {
+            medianSplit = true;
+        } else {
+            float min = centerBox.getMin()[bestAxis];
+            float scale = NumBins/centerBox.getSize()[bestAxis];
+            InLeftBins<Primitive> inLeft(bestAxis, min, scale, bestBin);
+            PrimitiveList::iterator split;
+            split = std::partition(primitives.begin() + begin,
+                                   primitives.begin() + end, inLeft);
+            middle = static_cast<unsigned>(split - primitives.begin());
+            splitAxis = bestAxis;
+            if (middle == begin || middle == end)
+                medianSplit = true;
+        }
+    }
+
+    if (makeLeaf) {
+        _nodes[nodeIndex]._offset = begin;
+        _nodes[nodeIndex]._count = static_cast<unsigned short>(count);
+        _nodes[nodeIndex]._splitAxis = 0;
+        return nodeIndex;
+    }
+
+    if (medianSplit) {
+        middle = begin + count/2;
+        std::nth_element(primitives.begin() + begin,
+                         primitives.begin() + middle,
+                         primitives.begin() + end, CenterLess(splitAxis));
+    }
+
+    _nodes[nodeIndex]._count = 0;
+    _nodes[nodeIndex]._splitAxis = static_cast<unsigned short>(splitAxis);
+    buildRecursive(primitives, begin, middle, depth + 1);
+    unsigned rightChild = buildRecursive(primitives, middle, end, depth + 1);
+    _nodes[nodeIndex]._offset = rightChild;
+    return nodeIndex;
+}
+
+}
@@ -0,0 +1,94 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifndef BVHFlatGeometryBuilder_hxx
+#define BVHFlatGeometryBuilder_hxx
+
+#include <map>
+#include <vector>
+
+#include <simgear/math/SGGeometry.hxx>
+#include <simgear/structure/SGReferenced.hxx>
+#include <simgear/structure/SGSharedPtr.hxx>
+
+#include "BVHFlatGeometry.hxx"
+
+namespace simgear {
+
+/// Builds a BVHFlatGeometry from a triangle soup.
+/// The interface matches BVHStaticGeometryBuilder, so both can be fed by
+/// the same scenegraph walk. The tree is split using a binned surface area
+/// heuristic instead of the center split of the static builder, and
+/// duplicate triangles are removed by sorting at build time instead of
+/// maintaining vertex and triangle maps while adding.
+class BVHFlatGeometryBuilder : public SGReferenced {
+public:
+    BVHFlatGeometryBuilder();
+    virtual ~BVHFlatGeometryBuilder();
+
+    void setCurrentMaterial(const BVHMaterial* material);
+    const BVHMaterial* getCurrentMaterial() const
+    { return _currentMaterial; }
+    unsigned addMaterial(const BVHMaterial* material);
+
+    void addTriangle(const SGVec3f& v1, const SGVec3f& v2, const SGVec3f& v3);
+
+    bool empty() const
+    { return _triangles.empty(); }
+
+    /// Returns zero if there are no triangles.
+    BVHFlatGeometry* buildTree();
+
+    /// Maximum number of triangles that go into a leaf when the surface
+    /// area heuristic would still split. Defaults to 4, leaves never hold
+    /// more than 65535 triangles.
+    void setMaxLeafSize(unsigned maxLeafSize)
+    { _maxLeafSize = maxLeafSize; }
+    unsigned getMaxLeafSize() const
+    { return _maxLeafSize; }
+
+private:
+    struct Triangle {
+        SGVec3f _vertices[3];
+        unsigned _material;
+    };
+    struct Primitive {
+        SGBoxf _box;
+        SGVec3f _center;
+        unsigned _index;
+    };
+    typedef std::vector<Primitive> PrimitiveList;
+
+    void removeDuplicates();
+    unsigned buildRecursive(PrimitiveList& primitives, unsigned begin,
+                            unsigned end, unsigned depth);
+
+    std::vector<Triangle> _triangles;
+
+    typedef std::map<const BVHMaterial*, unsigned> MaterialMap;
+    MaterialMap _materialMap;
+    BVHFlatGeometry::MaterialList _materials;
+    const BVHMaterial* _currentMaterial;
+    unsigned _currentMaterialIndex;
+    unsigned _maxLeafSize;
+
+    std::vector<BVHFlatGeometry::Node> _nodes;
+};
+
+}
+
+#endif
@@ -0,0 +1,465 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include "BVHLineSegmentPacketVisitor.hxx"
+
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+#include <simgear/math/SGGeometry.hxx>
+
+#include "BVHVisitor.hxx"
+
+#include "BVHNode.hxx"
+#include "BVHGroup.hxx"
+#include "BVHPageNode.hxx"
+#include "BVHTransform.hxx"
+#include "BVHMotionTransform.hxx"
+#include "BVHLineGeometry.hxx"
+#include "BVHStaticGeometry.hxx"
+#include "BVHFlatGeometry.hxx"
+
+#include "BVHStaticData.hxx"
+
+#include "BVHStaticNode.hxx"
+#include "BVHStaticTriangle.hxx"
+#include "BVHStaticBinary.hxx"
+
+namespace simgear {
+
+namespace {
+
+// Same limit as the traversal in BVHFlatGeometry
+enum { MaxStackSize = 64 };
+
+// Restores the active mask when leaving a subtree
+class MaskGuard {
+public:
+    MaskGuard(unsigned& mask, unsigned newMask) :
+        _mask(mask),
+        _oldMask(mask)
+    { _mask = newMask; }
+    ~MaskGuard()
+    { _mask = _oldMask; }
+private:
+    unsigned& _mask;
+    unsigned _oldMask;
+};
+
+}
+
+BVHLineSegmentPacketVisitor::BVHLineSegmentPacketVisitor(const SGLineSegmentd* lineSegments,
+                                                         unsigned numSegments,
+                                                         const double& t) :
+    _numSegments(numSegments),
+    _time(t),
+    _mask(0)
+{
+    assert(numSegments <= MaxSegments);
+    for (unsigned i = 0; i < MaxSegments; ++i) {
+        Lane& lane = _lanes[i];
+        lane._material = 0;
+        lane._id = 0;
+        lane._haveHit = false;
+        if (i < numSegments) {
+            setLineSegment(i, lineSegments[i]);
+            _mask |= 1u << i;
+        } else {
+            // Unused lanes are never in the mask, just keep them defined
+            setLineSegment(i, SGLineSegmentd(SGVec3d::zeros(),
+                                             SGVec3d::zeros()));
+        }
+    }
+}
+
+BVHLineSegmentPacketVisitor::~BVHLineSegmentPacketVisitor()
+{
+}
+
+void
+BVHLineSegmentPacketVisitor::apply(BVHGroup& group)
+{
+    unsigned mask = sphereMask(group.getBoundingSphere());
+    if (!mask)
+        return;
+    MaskGuard guard(_mask, mask);
+    group.traverse(*this);
+}
+
+void
+BVHLineSegmentPacketVisitor::apply(BVHPageNode& pageNode)
+{
+    unsigned mask = sphereMask(pageNode.getBoundingSphere());
+    if (!mask)
+        return;
+    MaskGuard guard(_mask, mask);
+    pageNode.traverse(*this);
+}
+
+void
+BVHLineSegmentPacketVisitor::apply(BVHTransform& transform)
+{
+    unsigned mask = sphereMask(transform.getBoundingSphere());
+    if (!mask)
+        return;
+
+    // Push the line segments
+    SGLineSegmentd lineSegments[MaxSegments];
+    bool haveHit[MaxSegments];
+    for (unsigned i = 0; i < _numSegments; ++i) {
+        if (!(mask & (1u << i)))
+            continue;
+        lineSegments[i] = _lanes[i]._lineSegment;
+        haveHit[i] = _lanes[i]._haveHit;
+        _lanes[i]._haveHit = false;
+        setLineSegment(i, transform.lineSegmentToLocal(lineSegments[i]));
+    }
+
+    {
+        MaskGuard guard(_mask, mask);
+        transform.traverse(*this);
+    }
+
+    for (unsigned i = 0; i < _numSegments; ++i) {
+        if (!(mask & (1u << i)))
+            continue;
+        Lane& lane = _lanes[i];
+        if (lane._haveHit) {
+            lane._linearVelocity = transform.vecToWorld(lane._linearVelocity);
+            lane._angularVelocity = transform.vecToWorld(lane._angularVelocity);
+            SGVec3d point(transform.ptToWorld(lane._lineSegment.getEnd()));
+            setLineSegment(i, SGLineSegmentd(lineSegments[i].getStart(), point));
+            lane._normal = transform.vecToWorld(lane._normal);
+        } else {
+            setLineSegment(i, lineSegments[i]);
+            lane._haveHit = haveHit[i];
+        }
+    }
+}
+
+void
+BVHLineSegmentPacketVisitor::apply(BVHMotionTransform& transform)
+{
+    unsigned mask = sphereMask(transform.getBoundingSphere());
+    if (!mask)
+        return;
+
+    // Push the line segments
+    SGMatrixd toLocal = transform.getToLocalTransform(_time);
+    SGLineSegmentd lineSegments[MaxSegments];
+    bool haveHit[MaxSegments];
+    for (unsigned i = 0; i < _numSegments; ++i) {
+        if (!(mask & (1u << i)))
+            continue;
+        lineSegments[i] = _lanes[i]._lineSegment;
+        haveHit[i] = _lanes[i]._haveHit;
+        _lanes[i]._haveHit = false;
+        setLineSegment(i, lineSegments[i].transform(toLocal));
+    }
+
+    {
+        MaskGuard guard(_mask, mask);
+        transform.traverse(*this);
+    }
+
+    SGMatrixd toWorld = transform.getToWorldTransform(_time);
+    for (unsigned i = 0; i < _numSegments; ++i) {
+        if (!(mask & (1u << i)))
+            continue;
+        Lane& lane = _lanes[i];
+        if (lane._haveHit) {
+            SGVec3d localStart = lane._lineSegment.getStart();
+            lane._linearVelocity += transform.getLinearVelocityAt(localStart);
+            lane._angularVelocity += transform.getAngularVelocity();
+            lane._linearVelocity = toWorld.xformVec(lane._linearVelocity);
+            lane._angularVelocity = toWorld.xformVec(lane._angularVelocity);
+            SGVec3d localEnd = lane._lineSegment.getEnd();
+            setLineSegment(i, SGLineSegmentd(lineSegments[i].getStart(),
+                                             toWorld.xformPt(localEnd)));
+            lane._normal = toWorld.xformVec(lane._normal);
+            if (!lane._id)
+                lane._id = transform.getId();
+        } else {
+            setLineSegment(i, lineSegments[i]);
+            lane._haveHit = haveHit[i];
+        }
+    }
+}
+
+void
+BVHLineSegmentPacketVisitor::apply(BVHLineGeometry&)
+{
+}
+
+void
+BVHLineSegmentPacketVisitor::apply(BVHStaticGeometry& node)
+{
+    unsigned mask = sphereMask(node.getBoundingSphere());
+    if (!mask)
+        return;
+    MaskGuard guard(_mask, mask);
+    node.traverse(*this);
+}
+
+void
+BVHLineSegmentPacketVisitor::apply(BVHFlatGeometry& node)
+{
+    unsigned mask = sphereMask(node.getBoundingSphere());
+    if (!mask || !node.getNumNodes())
+        return;
+    MaskGuard guard(_mask, mask);
+
+    // Same walk as BVHFlatGeometry::intersect, but each stack entry carries
+    // the segments that are still interested in that subtree.
+    std::pair<unsigned, unsigned> stack[MaxStackSize];
+    unsigned stackSize = 0;
+    std::pair<unsigned, unsigned> current(0, mask);
+    for (;;) {
+        const BVHFlatGeometry::Node& flatNode = node.getNode(current.first);
+        mask = current.second & _mask;
+        if (mask)
+            mask &= boxMask(flatNode._min, flatNode._max);
+        if (mask) {
+            if (!flatNode.isLeaf()) {
+                unsigned nearChild = current.first + 1;
+                unsigned farChild = flatNode._offset;
+                unsigned axis = flatNode._splitAxis;
+                float center = 0.5f*(flatNode._min[axis] + flatNode._max[axis]);
+                unsigned lane = getFirstLane(mask);
+                if (!(_lanes[lane]._lineSegment.getStart()[axis] < center))
+                    std::swap(nearChild, farChild);
+                stack[stackSize++] = std::make_pair(farChild, mask);
+                current = std::make_pair(nearChild, mask);
+                continue;
+            }
+
+            MaskGuard leafGuard(_mask, mask);
+            unsigned end = flatNode._offset + flatNode._count;
+            for (unsigned i = flatNode._offset; i < end; ++i) {
+                const BVHFlatGeometry::Triangle& triangle = node.getTriangle(i);
+                applyTriangle(triangle.getTriangle(),
+                              node.getMaterial(triangle._material));
+            }
+        }
+        if (!stackSize)
+            break;
+        current = stack[--stackSize];
+    }
+}
+
+void
+BVHLineSegmentPacketVisitor::apply(const BVHStaticBinary& node,
+                                   const BVHStaticData& data)
+{
+    const SGBoxf& box = node.getBoundingBox();
+    unsigned mask = boxMask(box.getMin().data(), box.getMax().data());
+    if (!mask)
+        return;
+    MaskGuard guard(_mask, mask);
+
+    // Like BVHLineSegmentVisitor, enter the box the start point is in
+    // first. Within a packet this is decided by the first segment.
+    unsigned lane = getFirstLane(mask);
+    node.traverse(*this, data, _lanes[lane]._lineSegment.getStart());
+}
+
+void
+BVHLineSegmentPacketVisitor::apply(const BVHStaticTriangle& triangle,
+                                   const BVHStaticData& data)
+{
+    applyTriangle(triangle.getTriangle(data),
+                  data.getMaterial(triangle.getMaterialIndex()));
+}
+
+unsigned
+BVHLineSegmentPacketVisitor::sphereMask(const SGSphered& sphere) const
+{
+    unsigned mask = 0;
+    for (unsigned i = 0; i < _numSegments; ++i) {
+        if (!(_mask & (1u << i)))
+            continue;
+        if (intersects(_lanes[i]._lineSegment, sphere))
+            mask |= 1u << i;
+    }
+    return mask;
+}
+
+unsigned
+BVHLineSegmentPacketVisitor::boxMask(const float min[3],
+                                     const float max[3]) const
+{
+    // The separating axis test of
+    // intersects(const SGBox<T>&, const SGLineSegment<T>&)
+    // for four segments at once.
+    Packet h[3];
+    Packet center[3];
+    for (unsigned i = 0; i < 3; ++i) {
+        h[i] = Packet(0.5f*(max[i] - min[i]));
+        center[i] = Packet(0.5f*(min[i] + max[i]));
+    }
+
+    unsigned mask = 0;
+    for (unsigned b = 0; b < NumBlocks; ++b) {
+        int blockMask = (_mask >> 4*b) & 0xf;
+        if (!blockMask)
+            continue;
+        const Block& block = _blocks[b];
+
+        Packet c[3], w[3], v[3];
+        for (unsigned i = 0; i < 3; ++i) {
+            w[i] = 0.5f*block._direction[i];
+            v[i] = simd4::abs(w[i]);
+            c[i] = block._start[i] + w[i] - center[i];
+            blockMask &= simd4::le_mask(simd4::abs(c[i]), v[i] + h[i]);
+        }
+        if (!blockMask)
+            continue;
+
+        blockMask &= simd4::le_mask(simd4::abs(c[1]*w[2] - c[2]*w[1]),
+                                    h[1]*v[2] + h[2]*v[1]);
+        blockMask &= simd4::le_mask(simd4::abs(c[0]*w[2] - c[2]*w[0]),
+                                    h[0]*v[2] + h[2]*v[0]);
+        blockMask &= simd4::le_mask(simd4::abs(c[0]*w[1] - c[1]*w[0]),
+                                    h[0]*v[1] + h[1]*v[0]);
+        mask |= unsigned(blockMask) << 4*b;
+    }
+    return mask;
+}
+
+unsigned
+BVHLineSegmentPacketVisitor::triangleMask(const SGTrianglef& triangle) const
+{
+    // The rejection tests of
+    // intersects(SGVec3<T>&, const SGTriangle<T>&, const SGLineSegment<T>&, T)
+    // for four segments at once. The exact intersection point is computed
+    // by the scalar code for the survivors.
+    Packet v0[3], e0[3], e1[3];
+    for (unsigned i = 0; i < 3; ++i) {
+        v0[i] = Packet(triangle.getBaseVertex()[i]);
+        e0[i] = Packet(triangle.getEdge(0)[i]);
+        e1[i] = Packet(triangle.getEdge(1)[i]);
+    }
+    const Packet zero(0.0f);
+    const Packet eps(1e-4f);
+    const Packet minDenom(SGLimitsf::min());
+
+    unsigned mask = 0;
+    for (unsigned b = 0; b < NumBlocks; ++b) {
+        int blockMask = (_mask >> 4*b) & 0xf;
+        if (!blockMask)
+            continue;
+        const Block& block = _blocks[b];
+        const Packet* d = block._direction;
+
+        Packet p[3];
+        p[0] = d[1]*e1[2] - d[2]*e1[1];
+        p[1] = d[2]*e1[0] - d[0]*e1[2];
+        p[2] = d[0]*e1[1] - d[1]*e1[0];
+        Packet denom = p[0]*e0[0] + p[1]*e0[1] + p[2]*e0[2];
+
+        Packet s[3];
+        for (unsigned i = 0; i < 3; ++i)
+            s[i] = block._start[i] - v0[i];
+        Packet q[3];
+        q[0] = s[1]*e0[2] - s[2]*e0[1];
+        q[1] = s[2]*e0[0] - s[0]*e0[2];
+        q[2] = s[0]*e0[1] - s[1]*e0[0];
+
+        Packet signDenom;
+        for (unsigned i = 0; i < 4; ++i)
+            signDenom[i] = std::copysign(1.0f, denom[i]);
+
+        Packet tDenom = signDenom*(q[0]*e1[0] + q[1]*e1[1] + q[2]*e1[2]);
+        Packet absDenom = simd4::abs(denom);
+        Packet absDenomEps = absDenom*eps;
+        Packet u = signDenom*(p[0]*s[0] + p[1]*s[1] + p[2]*s[2]);
+        Packet v = signDenom*(q[0]*d[0] + q[1]*d[1] + q[2]*d[2]);
+
+        blockMask &= simd4::le_mask(zero, tDenom);
+        blockMask &= simd4::le_mask(tDenom, absDenom);
+        blockMask &= simd4::le_mask(-absDenomEps, u);
+        blockMask &= simd4::le_mask(-absDenomEps, v);
+        blockMask &= simd4::le_mask(u + v, absDenom + absDenomEps);
+        blockMask &= ~simd4::le_mask(absDenom, minDenom);
+        mask |= unsigned(blockMask & 0xf) << 4*b;
+    }
+    return mask;
+}
+
+void
+BVHLineSegmentPacketVisitor::applyTriangle(const SGTrianglef& triangle,
+                                           const BVHMaterial* material)
+{
+    unsigned mask = triangleMask(triangle);
+    if (!mask)
+        return;
+
+    SGVec3d normal;
+    bool haveNormal = false;
+    for (unsigned i = 0; i < _numSegments; ++i) {
+        if (!(mask & (1u << i)))
+            continue;
+        Lane& lane = _lanes[i];
+        SGVec3f point;
+        if (!intersects(point, triangle, SGLineSegmentf(lane._lineSegment), 1e-4f))
+            continue;
+        if (!haveNormal) {
+            normal = SGVec3d(triangle.getNormal());
+            haveNormal = true;
+        }
+        setLineSegment(i, SGLineSegmentd(lane._lineSegment.getStart(),
+                                         SGVec3d(point)));
+        lane._normal = normal;
+        lane._linearVelocity = SGVec3d::zeros();
+        lane._angularVelocity = SGVec3d::zeros();
+        lane._material = material;
+        lane._id = 0;
+        lane._haveHit = true;
+    }
+}
+
+void
+BVHLineSegmentPacketVisitor::setLineSegment(unsigned i,
+                                            const SGLineSegmentd& lineSegment)
+{
+    _lanes[i]._lineSegment = lineSegment;
+
+    // Use the same float segment the scalar visitor tests with
+    SGLineSegmentf lineSegmentf(lineSegment);
+    Block& block = _blocks[i/4];
+    for (unsigned j = 0; j < 3; ++j) {
+        block._start[j][i % 4] = lineSegmentf.getStart()[j];
+        block._direction[j][i % 4] = lineSegmentf.getDirection()[j];
+    }
+}
+
+unsigned
+BVHLineSegmentPacketVisitor::getFirstLane(unsigned mask) const
+{
+    for (unsigned i = 0; i < _numSegments; ++i) {
+        if (mask & (1u << i))
+            return i;
+    }
+    return 0;
+}
+
+}
@@ -0,0 +1,119 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifndef BVHLineSegmentPacketVisitor_hxx
+#define BVHLineSegmentPacketVisitor_hxx
+
+#include <simgear/math/SGGeometry.hxx>
+#include <simgear/math/simd.hxx>
+
+#include "BVHVisitor.hxx"
+#include "BVHNode.hxx"
+
+namespace simgear {
+
+class BVHMaterial;
+
+/// Intersects up to eight line segments with the tree in one traversal.
+/// Gear contact points of one aircraft or the ground probes of a group of
+/// AI models are close together and mostly walk the same nodes. Testing
+/// them as a packet shares the node fetches and does the box and triangle
+/// tests of four segments at once with simd4_t. Subtrees are left as soon
+/// as no segment of the packet is interested any more.
+/// The per segment results are the same as from BVHLineSegmentVisitor.
+class BVHLineSegmentPacketVisitor : public BVHVisitor {
+public:
+    enum { MaxSegments = 8 };
+
+    BVHLineSegmentPacketVisitor(const SGLineSegmentd* lineSegments,
+                                unsigned numSegments, const double& t = 0);
+    virtual ~BVHLineSegmentPacketVisitor();
+
+    unsigned getNumSegments() const
+    { return _numSegments; }
+
+    bool empty(unsigned i) const
+    { return !_lanes[i]._haveHit; }
+
+    const SGLineSegmentd& getLineSegment(unsigned i) const
+    { return _lanes[i]._lineSegment; }
+
+    SGVec3d getPoint(unsigned i) const
+    { return _lanes[i]._lineSegment.getEnd(); }
+    const SGVec3d& getNormal(unsigned i) const
+    { return _lanes[i]._normal; }
+    const SGVec3d& getLinearVelocity(unsigned i) const
+    { return _lanes[i]._linearVelocity; }
+    const SGVec3d& getAngularVelocity(unsigned i) const
+    { return _lanes[i]._angularVelocity; }
+    const BVHMaterial* getMaterial(unsigned i) const
+    { return _lanes[i]._material; }
+    BVHNode::Id getId(unsigned i) const
+    { return _lanes[i]._id; }
+
+    virtual void apply(BVHGroup& group);
+    virtual void apply(BVHPageNode& node);
+    virtual void apply(BVHTransform& transform);
+    virtual void apply(BVHMotionTransform& transform);
+    virtual void apply(BVHLineGeometry&);
+    virtual void apply(BVHStaticGeometry& node);
+    virtual void apply(BVHFlatGeometry& node);
+
+    virtual void apply(const BVHStaticBinary&, const BVHStaticData&);
+    virtual void apply(const BVHStaticTriangle&, const BVHStaticData&);
+
+private:
+    typedef simd4_t<float,4> Packet;
+    enum { NumBlocks = MaxSegments/4 };
+
+    struct Lane {
+        SGLineSegmentd _lineSegment;
+        SGVec3d _normal;
+        SGVec3d _linearVelocity;
+        SGVec3d _angularVelocity;
+        const BVHMaterial* _material;
+        BVHNode::Id _id;
+        bool _haveHit;
+    };
+
+    // Four segments in structure of arrays layout
+    struct Block {
+        Packet _start[3];
+        Packet _direction[3];
+    };
+
+    unsigned sphereMask(const SGSphered& sphere) const;
+    unsigned boxMask(const float min[3], const float max[3]) const;
+    unsigned triangleMask(const SGTrianglef& triangle) const;
+    void applyTriangle(const SGTrianglef& triangle,
+                       const BVHMaterial* material);
+
+    void setLineSegment(unsigned i, const SGLineSegmentd& lineSegment);
+    unsigned getFirstLane(unsigned mask) const;
+
+    Lane _lanes[MaxSegments];
+    Block _blocks[NumBlocks];
+    unsigned _numSegments;
+    double _time;
+
+    // The segments that are still interested in the current subtree
+    unsigned _mask;
+};
+
+}
+
+#endif
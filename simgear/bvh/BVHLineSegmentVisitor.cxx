@@ -32,6 +32,7 @@
 #include "BVHMotionTransform.hxx"
 #include "BVHLineGeometry.hxx"
 #include "BVHStaticGeometry.hxx"
+#include "BVHFlatGeometry.hxx"
 
 #include "BVHStaticData.hxx"
 
@@ -131,6 +132,28 @@ BVHLineSegmentVisitor::apply(BVHStaticGeometry& node)
     node.traverse(*this);
 }
 
+void
+BVHLineSegmentVisitor::apply(BVHFlatGeometry& node)
+{
+    if (!intersects(_lineSegment, node.getBoundingSphere()))
+        return;
+
+    SGLineSegmentf lineSegment(_lineSegment);
+    unsigned triangleIndex;
+    if (!node.intersect(lineSegment, triangleIndex))
+        return;
+
+    const BVHFlatGeometry::Triangle& triangle
+        = node.getTriangle(triangleIndex);
+    setLineSegmentEnd(SGVec3d(lineSegment.getEnd()));
+    _normal = SGVec3d(triangle.getTriangle().getNormal());
+    _linearVelocity = SGVec3d::zeros();
+    _angularVelocity = SGVec3d::zeros();
+    _material = node.getMaterial(triangle._material);
+    _id = 0;
+    _haveHit = true;
+}
+
 void
 BVHLineSegmentVisitor::apply(const BVHStaticBinary& node,
                              const BVHStaticData& data)
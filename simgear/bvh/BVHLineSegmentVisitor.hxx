@@ -66,6 +66,7 @@ public:
     virtual void apply(BVHMotionTransform& transform);
     virtual void apply(BVHLineGeometry&);
     virtual void apply(BVHStaticGeometry& node);
+    virtual void apply(BVHFlatGeometry& node);
     
     virtual void apply(const BVHStaticBinary&, const BVHStaticData&);
     virtual void apply(const BVHStaticTriangle&, const BVHStaticData&);
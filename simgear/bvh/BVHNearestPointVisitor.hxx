@@ -28,6 +28,7 @@
 #include "BVHTransform.hxx"
 #include "BVHLineGeometry.hxx"
 #include "BVHStaticGeometry.hxx"
+#include "BVHFlatGeometry.hxx"
 
 #include "BVHStaticData.hxx"
 
@@ -113,6 +114,23 @@ public:
             return;
         node.traverse(*this);
     }
+    virtual void apply(BVHFlatGeometry& node)
+    {
+        if (!intersects(_sphere, node.getBoundingSphere()))
+            return;
+        SGVec3d point;
+        unsigned triangleIndex;
+        if (!node.nearestPoint(_sphere, point, triangleIndex))
+            return;
+        const BVHFlatGeometry::Triangle& triangle
+            = node.getTriangle(triangleIndex);
+        _point = point;
+        _linearVelocity = SGVec3d::zeros();
+        _angularVelocity = SGVec3d::zeros();
+        _material = node.getMaterial(triangle._material);
+        _havePoint = true;
+        _id = 0;
+    }
     
     virtual void apply(const BVHStaticBinary& node, const BVHStaticData& data)
     {
@@ -23,12 +23,12 @@
 #include <simgear/structure/SGSharedPtr.hxx>
 
 #include "BVHGroup.hxx"
+#include "BVHPageRequest.hxx"
 #include "BVHVisitor.hxx"
 
 namespace simgear {
 
 class BVHPager;
-class BVHPageRequest;
 
 class BVHPageNode : public BVHGroup {
 public:
@@ -57,6 +57,8 @@ private:
     friend class BVHPager;
 
     std::list<SGSharedPtr<BVHPageNode> >::iterator _iterator;
+    // The request that is not yet inserted, if any
+    SGSharedPtr<BVHPageRequest> _request;
     unsigned _useStamp;
     bool _requested;
 };
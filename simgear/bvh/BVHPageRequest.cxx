@@ -21,6 +21,13 @@
 
 namespace simgear {
 
+BVHPageRequest::BVHPageRequest() :
+    _useStamp(0),
+    _distance(0),
+    _cancelled(false)
+{
+}
+
 BVHPageRequest::~BVHPageRequest()
 {
 }
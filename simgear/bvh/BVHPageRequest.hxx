@@ -19,13 +19,16 @@
 #define BVHPageRequest_hxx
 
 #include <simgear/structure/SGReferenced.hxx>
+#include <simgear/timing/timestamp.hxx>
 
 namespace simgear {
 
 class BVHPageNode;
+class BVHPager;
 
 class BVHPageRequest : public SGReferenced {
 public:
+    BVHPageRequest();
     virtual ~BVHPageRequest();
 
     /// Happens in the pager thread, do not modify the calling bvh tree
@@ -35,6 +38,16 @@ public:
     virtual void insert() = 0;
     /// The page node this request is for
     virtual BVHPageNode* getPageNode() = 0;
+
+private:
+    friend class BVHPager;
+
+    // Scheduling state owned by the pager
+    unsigned _useStamp;
+    double _distance;
+    SGTimeStamp _requestTime;
+    SGTimeStamp _loadTime;
+    bool _cancelled;
 };
 
 }
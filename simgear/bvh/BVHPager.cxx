@@ -19,7 +19,9 @@
 
 #include "BVHPager.hxx"
 
+#include <algorithm>
 #include <list>
+#include <vector>
 
 #include <simgear/threads/SGThread.hxx>
 #include <simgear/threads/SGGuard.hxx>
@@ -29,9 +31,10 @@
 
 namespace simgear {
 
-struct BVHPager::_PrivateData : protected SGThread {
+struct BVHPager::_PrivateData {
     typedef SGSharedPtr<BVHPageRequest> _Request;
     typedef std::list<_Request> _RequestList;
+    typedef std::vector<_Request> _RequestVector;
     typedef std::list<SGSharedPtr<BVHPageNode> > _PageNodeList;
     
     struct _LockedQueue {
@@ -56,62 +59,157 @@ struct BVHPager::_PrivateData : protected SGThread {
     };
     
     struct _WorkQueue {
+        _WorkQueue() :
+            _stopped(false)
+        {
+        }
+        void _start()
+        {
+            SGGuard<SGMutex> scopeLock(_mutex);
+            _stopped = false;
+        }
         void _stop()
         {
-            _push(_Request());
+            SGGuard<SGMutex> scopeLock(_mutex);
+            _stopped = true;
+            _waitCondition.broadcast();
         }
         void _push(const _Request& request)
         {
             SGGuard<SGMutex> scopeLock(_mutex);
-            bool needSignal = _requestList.empty();
-            _requestList.push_back(request);
-            if (needSignal)
-                _waitCondition.signal();
+            _requestVector.push_back(request);
+            _waitCondition.signal();
         }
+        /// Returns the most important request, a zero request means stop
         _Request _pop()
         {
             SGGuard<SGMutex> scopeLock(_mutex);
-            while (_requestList.empty())
+            while (!_stopped && _requestVector.empty())
                 _waitCondition.wait(_mutex);
+            if (_stopped)
+                return _Request();
+            // The queue is short compared to the time a load takes, and the
+            // priorities change while waiting. So just search instead of
+            // maintaining a heap.
+            _RequestVector::iterator best = _requestVector.begin();
+            for (_RequestVector::iterator i = best + 1;
+                 i != _requestVector.end(); ++i) {
+                if (_before(**i, **best))
+                    best = i;
+            }
             _Request request;
-            request.swap(_requestList.front());
-            _requestList.pop_front();
+            request.swap(*best);
+            _requestVector.erase(best);
             return request;
         }
+        /// Update the priority of a still pending request
+        void _use(BVHPageRequest& request, unsigned useStamp, double distance)
+        {
+            SGGuard<SGMutex> scopeLock(_mutex);
+            if (request._useStamp == useStamp) {
+                request._distance = std::min(request._distance, distance);
+            } else {
+                request._useStamp = useStamp;
+                request._distance = distance;
+            }
+        }
+        /// Returns false if the request is already taken by a worker
+        bool _remove(const _Request& request)
+        {
+            SGGuard<SGMutex> scopeLock(_mutex);
+            _RequestVector::iterator i;
+            i = std::find(_requestVector.begin(), _requestVector.end(), request);
+            if (i == _requestVector.end())
+                return false;
+            _requestVector.erase(i);
+            return true;
+        }
+        /// Take out all requests still waiting for a worker
+        void _drain(_RequestVector& requestVector)
+        {
+            SGGuard<SGMutex> scopeLock(_mutex);
+            requestVector.swap(_requestVector);
+            _requestVector.clear();
+        }
+        unsigned _size()
+        {
+            SGGuard<SGMutex> scopeLock(_mutex);
+            return static_cast<unsigned>(_requestVector.size());
+        }
     private:
+        // Recently used before long unused, near before far
+        static bool _before(const BVHPageRequest& request0,
+                            const BVHPageRequest& request1)
+        {
+            if (request0._useStamp != request1._useStamp) {
+                // Wraparound save test for a positive difference
+                unsigned diff = request0._useStamp - request1._useStamp;
+                return !(diff & (~((~0u) >> 1)));
+            }
+            return request0._distance < request1._distance;
+        }
+
         SGMutex _mutex;
         SGWaitCondition _waitCondition;
-        _RequestList _requestList;
+        _RequestVector _requestVector;
+        bool _stopped;
+    };
+
+    struct _Worker : public SGThread {
+        _Worker(_WorkQueue& pendingRequests, _LockedQueue& processedRequests) :
+            _pendingRequests(pendingRequests),
+            _processedRequests(processedRequests)
+        {
+        }
+        virtual void run()
+        {
+            for (;;) {
+                _Request request = _pendingRequests._pop();
+                // This means stop working
+                if (!request.valid())
+                    return;
+                SGTimeStamp timeStamp = SGTimeStamp::now();
+                request->load();
+                request->_loadTime = SGTimeStamp::now() - timeStamp;
+                _processedRequests._push(request);
+            }
+        }
+    private:
+        _WorkQueue& _pendingRequests;
+        _LockedQueue& _processedRequests;
     };
+    typedef std::vector<_Worker*> _WorkerVector;
 
     _PrivateData() :
         _started(false),
-        _useStamp(0)
+        _useStamp(0),
+        _outstandingRequests(0)
     {
+        _resetStatistics();
     }
-    virtual ~_PrivateData()
+    ~_PrivateData()
     {
         _stop();
     }
 
-    virtual void run()
-    {
-        for (;;) {
-            _Request request = _pendingRequests._pop();
-            // This means stop working
-            if (!request.valid())
-                return;
-            request->load();
-            _processedRequests._push(request);
-        }
-    }
-
-    bool _start()
+    bool _start(unsigned numThreads)
     {
         if (_started)
             return true;
-        if (!start())
+        _pendingRequests._start();
+        numThreads = std::max(numThreads, 1u);
+        for (unsigned i = 0; i < numThreads; ++i) {
+            _Worker* worker = new _Worker(_pendingRequests, _processedRequests);
+            if (!worker->start()) {
+                delete worker;
+                break;
+            }
+            _workers.push_back(worker);
+        }
+        if (_workers.size() != numThreads) {
+            _joinWorkers();
             return false;
+        }
         _started = true;
         return true;
     }
@@ -120,19 +218,51 @@ struct BVHPager::_PrivateData : protected SGThread {
     {
         if (!_started)
             return;
-        // send a stop request ...
-        _pendingRequests._stop();
-        // ... and wait for the thread to finish
-        join();
+        _joinWorkers();
+        _dropPendingRequests();
         _started = false;
     }
 
-    void _use(BVHPageNode& pageNode)
+    void _dropPendingRequests()
+    {
+        // The page node and its pending request reference each other, break
+        // that and forget about the page node so it gets requested again
+        _RequestVector requestVector;
+        _pendingRequests._drain(requestVector);
+        for (_RequestVector::iterator i = requestVector.begin();
+             i != requestVector.end(); ++i) {
+            --_outstandingRequests;
+            SGSharedPtr<BVHPageNode> pageNode = (*i)->getPageNode();
+            if (!pageNode.valid() || pageNode->_request != *i)
+                continue;
+            pageNode->_request = 0;
+            pageNode->_requested = false;
+            _pageNodeList.erase(pageNode->_iterator);
+        }
+    }
+
+    void _joinWorkers()
+    {
+        // wake up all workers with a stop request ...
+        _pendingRequests._stop();
+        // ... and wait for the threads to finish
+        for (_WorkerVector::iterator i = _workers.begin();
+             i != _workers.end(); ++i) {
+            (*i)->join();
+            delete *i;
+        }
+        _workers.clear();
+    }
+
+    void _use(BVHPageNode& pageNode, double distance)
     {
         if (pageNode._requested) {
             // move it forward in the lru list
             _pageNodeList.splice(_pageNodeList.end(), _pageNodeList,
                                  pageNode._iterator);
+            // and raise its priority if it is still waiting for a worker
+            if (pageNode._request.valid())
+                _pendingRequests._use(*pageNode._request, _useStamp, distance);
         } else {
             _Request request = pageNode.newRequest();
             if (!request.valid())
@@ -143,6 +273,11 @@ struct BVHPager::_PrivateData : protected SGThread {
             pageNode._requested = true;
 
             if (_started) {
+                request->_useStamp = _useStamp;
+                request->_distance = distance;
+                request->_requestTime = SGTimeStamp::now();
+                pageNode._request = request;
+                ++_outstandingRequests;
                 _pendingRequests._push(request);
             } else {
                 request->load();
@@ -152,6 +287,32 @@ struct BVHPager::_PrivateData : protected SGThread {
         pageNode._useStamp = _useStamp;
     }
 
+    void _cancelRequest(BVHPageNode& pageNode)
+    {
+        _Request request;
+        request.swap(pageNode._request);
+        if (!request.valid())
+            return;
+        if (_pendingRequests._remove(request)) {
+            --_outstandingRequests;
+        } else {
+            // Already loading, drop it when it comes back in update
+            request->_cancelled = true;
+        }
+        ++_cancelledRequests;
+    }
+
+    bool _cancel(BVHPageNode& pageNode)
+    {
+        if (!pageNode._requested || !pageNode._request.valid())
+            return false;
+        _cancelRequest(pageNode);
+        pageNode._requested = false;
+        // May drop the last reference to the page node
+        _pageNodeList.erase(pageNode._iterator);
+        return true;
+    }
+
     void _update(unsigned expiry)
     {
         // Insert all processed requests
@@ -160,7 +321,19 @@ struct BVHPager::_PrivateData : protected SGThread {
             request = _processedRequests._pop();
             if (!request.valid())
                 break;
+            --_outstandingRequests;
+            if (request->_cancelled)
+                continue;
+            BVHPageNode* pageNode = request->getPageNode();
+            if (pageNode)
+                pageNode->_request = 0;
             request->insert();
+
+            double latency = (SGTimeStamp::now() - request->_requestTime).toSecs();
+            ++_insertedRequests;
+            _latencySum += latency;
+            _maxLatency = std::max(_maxLatency, latency);
+            _loadTimeSum += request->_loadTime.toSecs();
         }
 
         // ... and throw away stuff that is not used for a long time
@@ -174,20 +347,66 @@ struct BVHPager::_PrivateData : protected SGThread {
             // test the sign bit of the difference
             if (!(diff & (~((~0u) >> 1))))
                 break;
+            // Not worth loading anymore if it did not make it until now
+            _cancelRequest(**i);
             (*i)->clear();
             (*i)->_requested = false;
             i = _pageNodeList.erase(i);
         }
     }
 
+    Statistics _getStatistics()
+    {
+        Statistics statistics;
+        statistics._pendingRequests = _pendingRequests._size();
+        statistics._loadingRequests = _outstandingRequests - statistics._pendingRequests;
+        statistics._insertedRequests = _insertedRequests;
+        statistics._cancelledRequests = _cancelledRequests;
+        if (_insertedRequests) {
+            statistics._averageLatency = _latencySum/_insertedRequests;
+            statistics._averageLoadTime = _loadTimeSum/_insertedRequests;
+        }
+        statistics._maxLatency = _maxLatency;
+        return statistics;
+    }
+
+    void _resetStatistics()
+    {
+        _insertedRequests = 0;
+        _cancelledRequests = 0;
+        _latencySum = 0;
+        _maxLatency = 0;
+        _loadTimeSum = 0;
+    }
+
     bool _started;
     unsigned _useStamp;
     _WorkQueue _pendingRequests;
     _LockedQueue _processedRequests;
+    _WorkerVector _workers;
     // Store the rcu list of loaded nodes so that they can expire
     _PageNodeList _pageNodeList;
+
+    // Requests handed to the workers and not yet back in update
+    unsigned _outstandingRequests;
+    unsigned _insertedRequests;
+    unsigned _cancelledRequests;
+    double _latencySum;
+    double _maxLatency;
+    double _loadTimeSum;
 };
 
+BVHPager::Statistics::Statistics() :
+    _pendingRequests(0),
+    _loadingRequests(0),
+    _insertedRequests(0),
+    _cancelledRequests(0),
+    _averageLatency(0),
+    _maxLatency(0),
+    _averageLoadTime(0)
+{
+}
+
 BVHPager::BVHPager() :
     _privateData(new _PrivateData)
 {
@@ -200,9 +419,9 @@ BVHPager::~BVHPager()
 }
 
 bool
-BVHPager::start()
+BVHPager::start(unsigned numThreads)
 {
-    return _privateData->_start();
+    return _privateData->_start(numThreads);
 }
 
 void
@@ -212,9 +431,15 @@ BVHPager::stop()
 }
 
 void
-BVHPager::use(BVHPageNode& pageNode)
+BVHPager::use(BVHPageNode& pageNode, double distance)
 {
-    _privateData->_use(pageNode);
+    _privateData->_use(pageNode, distance);
+}
+
+bool
+BVHPager::cancel(BVHPageNode& pageNode)
+{
+    return _privateData->_cancel(pageNode);
 }
 
 void
@@ -235,4 +460,16 @@ BVHPager::getUseStamp() const
     return _privateData->_useStamp;
 }
 
+BVHPager::Statistics
+BVHPager::getStatistics() const
+{
+    return _privateData->_getStatistics();
+}
+
+void
+BVHPager::resetStatistics()
+{
+    _privateData->_resetStatistics();
+}
+
 }
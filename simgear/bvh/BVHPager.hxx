@@ -27,17 +27,43 @@ class BVHPageRequest;
 
 class BVHPager {
 public:
+    /// Counters describing the state of the pager
+    struct Statistics {
+        Statistics();
+
+        /// Requests waiting for a worker
+        unsigned _pendingRequests;
+        /// Requests taken by a worker but not yet inserted into the tree
+        unsigned _loadingRequests;
+        /// Requests inserted into the tree since the last reset
+        unsigned _insertedRequests;
+        /// Requests cancelled since the last reset
+        unsigned _cancelledRequests;
+        /// Time in seconds from scheduling to insertion of the requests
+        double _averageLatency;
+        double _maxLatency;
+        /// Time in seconds spent in BVHPageRequest::load
+        double _averageLoadTime;
+    };
+
     BVHPager();
     ~BVHPager();
 
-    /// Starts the pager thread
-    bool start();
+    /// Starts the pager threads
+    bool start(unsigned numThreads = 1);
 
-    /// Stops the pager thread
+    /// Stops the pager threads
     void stop();
 
-    /// Use this page node, if loaded make it as used, if not loaded schedule
-    void use(BVHPageNode& pageNode);
+    /// Use this page node, if loaded make it as used, if not loaded schedule.
+    /// Requests are served most recently used first and among those with
+    /// the same usage stamp the one nearest to the requester is loaded first.
+    void use(BVHPageNode& pageNode, double distance = 0);
+
+    /// Drop the request of a not yet loaded page node.
+    /// Page nodes that expire in update are cancelled the same way.
+    /// Returns false if there is nothing outstanding for this node.
+    bool cancel(BVHPageNode& pageNode);
 
     /// Call this from the main thread to incorporate the processed page
     /// requests into the bounding volume tree
@@ -47,6 +73,10 @@ public:
     void setUseStamp(unsigned stamp);
     unsigned getUseStamp() const;
 
+    /// Queue depth and latency of the page requests
+    Statistics getStatistics() const;
+    void resetStatistics();
+
 private:
     BVHPager(const BVHPager&);
     BVHPager& operator=(const BVHPager&);
@@ -19,6 +19,7 @@
 #define BVHStaticGeometryBuilder_hxx
 
 #include <algorithm>
+#include <list>
 #include <map>
 #include <set>
 
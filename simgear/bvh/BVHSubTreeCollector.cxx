@@ -30,6 +30,7 @@
 #include "BVHStaticTriangle.hxx"
 #include "BVHStaticBinary.hxx"
 #include "BVHStaticGeometry.hxx"
+#include "BVHFlatGeometry.hxx"
 #include "BVHBoundingBoxVisitor.hxx"
 
 namespace simgear {
@@ -151,6 +152,15 @@ BVHSubTreeCollector::apply(BVHStaticGeometry& node)
     _staticNode = 0;
 }
 
+void
+BVHSubTreeCollector::apply(BVHFlatGeometry& node)
+{
+    // The flat tree cannot share subtrees, so take it as a whole.
+    if (!intersects(_sphere, node.getBoundingSphere()))
+        return;
+    addNode(&node);
+}
+
 void
 BVHSubTreeCollector::apply(const BVHStaticBinary& node,
                            const BVHStaticData& data)
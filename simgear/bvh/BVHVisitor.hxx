@@ -28,6 +28,7 @@ class BVHTransform;
 class BVHMotionTransform;
 class BVHStaticGeometry;
 class BVHLineGeometry;
+class BVHFlatGeometry;
 
 class BVHStaticBinary;
 class BVHStaticTriangle;
@@ -47,6 +48,9 @@ public:
     virtual void apply(BVHMotionTransform&) = 0;
     virtual void apply(BVHLineGeometry&) = 0;
     virtual void apply(BVHStaticGeometry&) = 0;
+    // Not pure, so that visitors outside simgear that do not know
+    // about flat geometry keep compiling. The default ignores the node.
+    virtual void apply(BVHFlatGeometry&) {}
     
     // Static tree nodes to handle
     virtual void apply(const BVHStaticBinary&, const BVHStaticData&) = 0;
@@ -16,12 +16,19 @@
 //
 
 #include <simgear_config.h>
+#include <cmath>
 #include <iostream>
+#include <vector>
+#include <simgear/math/sg_random.h>
 #include <simgear/structure/SGSharedPtr.hxx>
+#include <simgear/threads/SGGuard.hxx>
+#include <simgear/threads/SGThread.hxx>
+#include <simgear/timing/timestamp.hxx>
 
 #include "BVHNode.hxx"
 #include "BVHGroup.hxx"
 #include "BVHTransform.hxx"
+#include "BVHMotionTransform.hxx"
 
 #include "BVHStaticData.hxx"
 
@@ -30,10 +37,17 @@
 #include "BVHStaticTriangle.hxx"
 #include "BVHStaticBinary.hxx"
 #include "BVHStaticGeometry.hxx"
+#include "BVHStaticGeometryBuilder.hxx"
+#include "BVHFlatGeometry.hxx"
+#include "BVHFlatGeometryBuilder.hxx"
+#include "BVHPageNode.hxx"
+#include "BVHPageRequest.hxx"
+#include "BVHPager.hxx"
 
 #include "BVHBoundingBoxVisitor.hxx"
 #include "BVHSubTreeCollector.hxx"
 #include "BVHLineSegmentVisitor.hxx"
+#include "BVHLineSegmentPacketVisitor.hxx"
 #include "BVHNearestPointVisitor.hxx"
 
 using namespace simgear;
@@ -132,6 +146,484 @@ testNearestPoint()
     return true;
 }
 
+// Some hilly terrain patch made of a regular grid, every triangle is added
+// twice to exercise the duplicate removal in the builders.
+template<typename Builder>
+void
+addTerrain(Builder& builder, const std::vector<SGSharedPtr<BVHMaterial> >& materials,
+           unsigned size)
+{
+    std::vector<SGVec3f> vertices((size + 1)*(size + 1));
+    for (unsigned j = 0; j <= size; ++j) {
+        for (unsigned i = 0; i <= size; ++i) {
+            float x = 10.0f*i;
+            float y = 10.0f*j;
+            float z = 20.0f*std::sin(0.013f*x)*std::cos(0.021f*y) + 0.01f*x;
+            vertices[j*(size + 1) + i] = SGVec3f(x, y, z);
+        }
+    }
+    for (unsigned pass = 0; pass < 2; ++pass) {
+        for (unsigned j = 0; j < size; ++j) {
+            builder.setCurrentMaterial(materials[(j/8) % materials.size()]);
+            for (unsigned i = 0; i < size; ++i) {
+                const SGVec3f& v00 = vertices[j*(size + 1) + i];
+                const SGVec3f& v10 = vertices[j*(size + 1) + i + 1];
+                const SGVec3f& v01 = vertices[(j + 1)*(size + 1) + i];
+                const SGVec3f& v11 = vertices[(j + 1)*(size + 1) + i + 1];
+                builder.addTriangle(v00, v10, v11);
+                builder.addTriangle(v00, v11, v01);
+            }
+        }
+    }
+}
+
+bool
+testFlatGeometry()
+{
+    const unsigned size = 128;
+    std::vector<SGSharedPtr<BVHMaterial> > materials;
+    for (unsigned i = 0; i < 3; ++i)
+        materials.push_back(new BVHMaterial);
+
+    SGTimeStamp timeStamp = SGTimeStamp::now();
+    SGSharedPtr<BVHStaticGeometryBuilder> staticBuilder;
+    staticBuilder = new BVHStaticGeometryBuilder;
+    addTerrain(*staticBuilder, materials, size);
+    SGSharedPtr<BVHNode> staticNode = staticBuilder->buildTree();
+    int staticBuildUSec = timeStamp.elapsedUSec();
+
+    timeStamp.stamp();
+    SGSharedPtr<BVHFlatGeometryBuilder> flatBuilder;
+    flatBuilder = new BVHFlatGeometryBuilder;
+    addTerrain(*flatBuilder, materials, size);
+    SGSharedPtr<BVHFlatGeometry> flatNode = flatBuilder->buildTree();
+    int flatBuildUSec = timeStamp.elapsedUSec();
+
+    if (!staticNode || !flatNode)
+        return false;
+    if (flatNode->getNumTriangles() != 2*size*size)
+        return false;
+    if (reinterpret_cast<std::size_t>(&flatNode->getNode(0)) % 32)
+        return false;
+
+    // Mostly vertical probes like the ground queries plus some slanted ones
+    mt random;
+    mt_init(&random, 17);
+    std::vector<SGLineSegmentd> lineSegments;
+    for (unsigned i = 0; i < 20000; ++i) {
+        SGVec3d start(10*size*mt_rand(&random), 10*size*mt_rand(&random), 100);
+        SGVec3d end(start[0], start[1], -100);
+        if (i % 4 == 0) {
+            end[0] += 200*(mt_rand(&random) - 0.5);
+            end[1] += 200*(mt_rand(&random) - 0.5);
+        }
+        lineSegments.push_back(SGLineSegmentd(start, end));
+    }
+
+    std::vector<BVHLineSegmentVisitor> staticResults;
+    timeStamp.stamp();
+    for (unsigned i = 0; i < lineSegments.size(); ++i) {
+        BVHLineSegmentVisitor lineSegmentVisitor(lineSegments[i]);
+        staticNode->accept(lineSegmentVisitor);
+        staticResults.push_back(lineSegmentVisitor);
+    }
+    int staticQueryUSec = timeStamp.elapsedUSec();
+
+    std::vector<BVHLineSegmentVisitor> flatResults;
+    timeStamp.stamp();
+    for (unsigned i = 0; i < lineSegments.size(); ++i) {
+        BVHLineSegmentVisitor lineSegmentVisitor(lineSegments[i]);
+        flatNode->accept(lineSegmentVisitor);
+        flatResults.push_back(lineSegmentVisitor);
+    }
+    int flatQueryUSec = timeStamp.elapsedUSec();
+
+    for (unsigned i = 0; i < lineSegments.size(); ++i) {
+        const BVHLineSegmentVisitor& s = staticResults[i];
+        const BVHLineSegmentVisitor& f = flatResults[i];
+        if (s.empty() != f.empty())
+            return false;
+        if (s.empty())
+            continue;
+        if (1e-3 < dist(s.getPoint(), f.getPoint()))
+            return false;
+        // On shared edges both trees may legally report either triangle
+        if (s.getMaterial() != f.getMaterial()
+            && 1e-3 < dist(s.getNormal(), f.getNormal()))
+            return false;
+    }
+
+    SGSphered sphere(SGVec3d(10*size/2, 10*size/2, 100), 200);
+    BVHNearestPointVisitor staticNearest(sphere, 0);
+    staticNode->accept(staticNearest);
+    BVHNearestPointVisitor flatNearest(sphere, 0);
+    flatNode->accept(flatNearest);
+    if (staticNearest.empty() || flatNearest.empty())
+        return false;
+    if (1e-3 < dist(staticNearest.getPoint(), flatNearest.getPoint()))
+        return false;
+
+    std::cout << "BVH build of " << 4*size*size << " triangles: static "
+              << staticBuildUSec/1000 << "ms, flat SAH "
+              << flatBuildUSec/1000 << "ms" << std::endl;
+    std::cout << lineSegments.size() << " line segment queries: static "
+              << staticQueryUSec/1000 << "ms, flat SAH "
+              << flatQueryUSec/1000 << "ms" << std::endl;
+
+    return true;
+}
+
+bool
+testLargeLeaves()
+{
+    // Overlapping triangles the surface area heuristic prefers to keep in
+    // one leaf, more than fit into one
+    const unsigned count = 70000;
+    SGSharedPtr<BVHFlatGeometryBuilder> flatBuilder;
+    flatBuilder = new BVHFlatGeometryBuilder;
+    flatBuilder->setMaxLeafSize(~0u);
+    for (unsigned i = 0; i < count; ++i) {
+        float z = i*1e-7f;
+        flatBuilder->addTriangle(SGVec3f(-1000, -1000, z),
+                                 SGVec3f(1000, -1000, z),
+                                 SGVec3f(-1000, 1000, z));
+    }
+    SGSharedPtr<BVHFlatGeometry> flatNode = flatBuilder->buildTree();
+    if (!flatNode || flatNode->getNumTriangles() != count)
+        return false;
+
+    // The topmost triangle is the last one added
+    SGLineSegmentd lineSegment(SGVec3d(-500, -500, 10), SGVec3d(-500, -500, -10));
+    BVHLineSegmentVisitor lineSegmentVisitor(lineSegment);
+    flatNode->accept(lineSegmentVisitor);
+    if (lineSegmentVisitor.empty())
+        return false;
+    return 1e-6 > std::fabs(lineSegmentVisitor.getPoint()[2] - (count - 1)*1e-7f);
+}
+
+bool
+equivalentResults(const BVHLineSegmentVisitor& visitor,
+                  const BVHLineSegmentPacketVisitor& packetVisitor, unsigned i)
+{
+    if (visitor.empty() != packetVisitor.empty(i))
+        return false;
+    if (visitor.empty())
+        return true;
+    if (1e-3 < dist(visitor.getPoint(), packetVisitor.getPoint(i)))
+        return false;
+    // On shared edges both may legally report either triangle
+    if (visitor.getMaterial() != packetVisitor.getMaterial(i)
+        && 1e-3 < dist(visitor.getNormal(), packetVisitor.getNormal(i)))
+        return false;
+    if (1e-6 < dist(visitor.getLinearVelocity(),
+                    packetVisitor.getLinearVelocity(i)))
+        return false;
+    if (1e-6 < dist(visitor.getAngularVelocity(),
+                    packetVisitor.getAngularVelocity(i)))
+        return false;
+    return visitor.getId() == packetVisitor.getId(i);
+}
+
+bool
+testPacketLineIntersections()
+{
+    const unsigned size = 64;
+    std::vector<SGSharedPtr<BVHMaterial> > materials;
+    for (unsigned i = 0; i < 3; ++i)
+        materials.push_back(new BVHMaterial);
+
+    SGSharedPtr<BVHStaticGeometryBuilder> staticBuilder;
+    staticBuilder = new BVHStaticGeometryBuilder;
+    addTerrain(*staticBuilder, materials, size);
+    SGSharedPtr<BVHFlatGeometryBuilder> flatBuilder;
+    flatBuilder = new BVHFlatGeometryBuilder;
+    addTerrain(*flatBuilder, materials, size);
+
+    SGSharedPtr<BVHGroup> group = new BVHGroup;
+    group->addChild(staticBuilder->buildTree());
+    SGSharedPtr<BVHMotionTransform> motionTransform = new BVHMotionTransform;
+    motionTransform->setLinearVelocity(SGVec3d(0, 0, 1));
+    motionTransform->setAngularVelocity(SGVec3d(1, 0, 0));
+    motionTransform->setToWorldTransform(SGMatrixd(SGVec3d(10*size, 0, 0)));
+    motionTransform->addChild(flatBuilder->buildTree());
+    group->addChild(motionTransform);
+
+    // Bundles of nearby probes, like the gear of one aircraft
+    mt random;
+    mt_init(&random, 4711);
+    const unsigned numPackets = 2000;
+    std::vector<SGLineSegmentd> lineSegments;
+    for (unsigned i = 0; i < numPackets; ++i) {
+        SGVec3d center(20*size*mt_rand(&random), 10*size*mt_rand(&random), 0);
+        for (unsigned j = 0; j < BVHLineSegmentPacketVisitor::MaxSegments; ++j) {
+            SGVec3d offset(20*mt_rand(&random), 20*mt_rand(&random), 0);
+            SGVec3d start = center + offset + SGVec3d(0, 0, 100);
+            SGVec3d end = center + offset - SGVec3d(0, 0, 100);
+            lineSegments.push_back(SGLineSegmentd(start, end));
+        }
+    }
+
+    std::vector<BVHLineSegmentVisitor> results;
+    SGTimeStamp timeStamp = SGTimeStamp::now();
+    for (unsigned i = 0; i < lineSegments.size(); ++i) {
+        BVHLineSegmentVisitor lineSegmentVisitor(lineSegments[i]);
+        group->accept(lineSegmentVisitor);
+        results.push_back(lineSegmentVisitor);
+    }
+    int scalarUSec = timeStamp.elapsedUSec();
+
+    std::vector<BVHLineSegmentPacketVisitor> packetResults;
+    timeStamp.stamp();
+    for (unsigned i = 0; i < lineSegments.size();
+         i += BVHLineSegmentPacketVisitor::MaxSegments) {
+        BVHLineSegmentPacketVisitor packetVisitor(&lineSegments[i],
+                                                  BVHLineSegmentPacketVisitor::MaxSegments);
+        group->accept(packetVisitor);
+        packetResults.push_back(packetVisitor);
+    }
+    int packetUSec = timeStamp.elapsedUSec();
+
+    for (unsigned i = 0; i < lineSegments.size(); ++i) {
+        unsigned packet = i/BVHLineSegmentPacketVisitor::MaxSegments;
+        unsigned lane = i % BVHLineSegmentPacketVisitor::MaxSegments;
+        if (!equivalentResults(results[i], packetResults[packet], lane))
+            return false;
+    }
+
+    // Partial packets
+    for (unsigned n = 1; n < BVHLineSegmentPacketVisitor::MaxSegments; ++n) {
+        BVHLineSegmentPacketVisitor packetVisitor(&lineSegments[8*n], n);
+        group->accept(packetVisitor);
+        for (unsigned i = 0; i < n; ++i) {
+            if (!equivalentResults(results[8*n + i], packetVisitor, i))
+                return false;
+        }
+    }
+
+    std::cout << lineSegments.size() << " line segment queries: scalar "
+              << scalarUSec/1000 << "ms, packets of "
+              << BVHLineSegmentPacketVisitor::MaxSegments << " "
+              << packetUSec/1000 << "ms" << std::endl;
+
+    return true;
+}
+
+// Records the order page nodes are loaded in. Loading blocks while the
+// gate is closed, so the test can fill the queue behind a busy worker.
+struct PageLog {
+    PageLog() : _open(true) {}
+    void wait()
+    {
+        for (;;) {
+            {
+                SGGuard<SGMutex> scopeLock(_mutex);
+                if (_open)
+                    return;
+            }
+            SGTimeStamp::sleepForMSec(1);
+        }
+    }
+    void setOpen(bool open)
+    {
+        SGGuard<SGMutex> scopeLock(_mutex);
+        _open = open;
+    }
+    void loaded(unsigned id)
+    {
+        SGGuard<SGMutex> scopeLock(_mutex);
+        _order.push_back(id);
+    }
+    std::vector<unsigned> getOrder()
+    {
+        SGGuard<SGMutex> scopeLock(_mutex);
+        return _order;
+    }
+    SGMutex _mutex;
+    std::vector<unsigned> _order;
+    bool _open;
+};
+
+struct GateOpener : public SGThread {
+    GateOpener(PageLog& log) : _log(log) {}
+    virtual void run()
+    {
+        SGTimeStamp::sleepForMSec(100);
+        _log.setOpen(true);
+    }
+    PageLog& _log;
+};
+
+class TestPageNode : public BVHPageNode {
+public:
+    TestPageNode(unsigned id, PageLog& log) : _id(id), _log(log) {}
+    virtual SGSphered computeBoundingSphere() const
+    { return SGSphered(SGVec3d(_id, 0, 0), 1); }
+    virtual BVHPageRequest* newRequest()
+    { return new Request(this); }
+protected:
+    virtual void invalidateBound() {}
+private:
+    struct Request : public BVHPageRequest {
+        Request(TestPageNode* pageNode) : _pageNode(pageNode) {}
+        virtual void load()
+        {
+            _pageNode->_log.wait();
+            _pageNode->_log.loaded(_pageNode->_id);
+            _node = new BVHGroup;
+        }
+        virtual void insert()
+        { _pageNode->addChild(_node); }
+        virtual BVHPageNode* getPageNode()
+        { return _pageNode; }
+        SGSharedPtr<TestPageNode> _pageNode;
+        SGSharedPtr<BVHNode> _node;
+    };
+    unsigned _id;
+    PageLog& _log;
+};
+
+bool
+waitForPager(BVHPager& pager, unsigned loading)
+{
+    for (unsigned i = 0; i < 10000; ++i) {
+        pager.update(1000);
+        BVHPager::Statistics statistics = pager.getStatistics();
+        if (!statistics._pendingRequests
+            && statistics._loadingRequests == loading)
+            return true;
+        SGTimeStamp::sleepForMSec(1);
+    }
+    std::cerr << "Pager does not finish" << std::endl;
+    return false;
+}
+
+bool
+testPager()
+{
+    PageLog log;
+    std::vector<SGSharedPtr<TestPageNode> > nodes;
+    for (unsigned i = 0; i < 8; ++i)
+        nodes.push_back(new TestPageNode(i, log));
+
+    BVHPager pager;
+    if (!pager.start(1))
+        return false;
+
+    // Keep the only worker busy with node 0 ...
+    log.setOpen(false);
+    pager.setUseStamp(1);
+    pager.use(*nodes[0]);
+    if (!waitForPager(pager, 1))
+        return false;
+
+    // ... while the others queue up
+    pager.use(*nodes[1], 30);
+    pager.use(*nodes[2], 10);
+    pager.use(*nodes[3], 20);
+    pager.setUseStamp(2);
+    pager.use(*nodes[4], 50);
+    pager.use(*nodes[3], 5);
+    pager.use(*nodes[5], 40);
+    if (!pager.cancel(*nodes[5]))
+        return false;
+    if (pager.getStatistics()._pendingRequests != 4)
+        return false;
+
+    log.setOpen(true);
+    if (!waitForPager(pager, 0))
+        return false;
+
+    unsigned expectedOrder[] = { 0, 3, 4, 2, 1 };
+    std::vector<unsigned> order = log.getOrder();
+    if (order != std::vector<unsigned>(expectedOrder, expectedOrder + 5)) {
+        std::cerr << "Page requests loaded in wrong order" << std::endl;
+        return false;
+    }
+    for (unsigned i = 0; i < 5; ++i) {
+        if (nodes[i]->getNumChildren() != 1)
+            return false;
+    }
+    if (nodes[5]->getNumChildren() != 0 || pager.cancel(*nodes[5]))
+        return false;
+
+    // Page nodes expiring before their request is done are not loaded ...
+    log.setOpen(false);
+    pager.setUseStamp(3);
+    pager.use(*nodes[6]);
+    if (!waitForPager(pager, 1))
+        return false;
+    pager.use(*nodes[7]);
+    pager.setUseStamp(10);
+    pager.update(2);
+    // ... or at least not inserted if already loading
+    log.setOpen(true);
+    if (!waitForPager(pager, 0))
+        return false;
+    if (nodes[6]->getNumChildren() != 0 || nodes[7]->getNumChildren() != 0)
+        return false;
+    if (log.getOrder().size() != 6)
+        return false;
+
+    BVHPager::Statistics statistics = pager.getStatistics();
+    if (statistics._insertedRequests != 5
+        || statistics._cancelledRequests != 3)
+        return false;
+    pager.stop();
+
+    // Stopping with queued requests releases them, a restart requests again
+    log.setOpen(false);
+    pager.setUseStamp(11);
+    if (!pager.start(1))
+        return false;
+    SGSharedPtr<TestPageNode> loading = new TestPageNode(8, log);
+    SGSharedPtr<TestPageNode> queued = new TestPageNode(9, log);
+    pager.use(*loading);
+    if (!waitForPager(pager, 1))
+        return false;
+    pager.use(*queued);
+    // Open the gate only after stop waits for the busy worker
+    GateOpener gateOpener(log);
+    gateOpener.start();
+    pager.stop();
+    gateOpener.join();
+    if (SGReferenced::count(queued.get()) != 1)
+        return false;
+    if (!pager.start(1))
+        return false;
+    pager.use(*queued);
+    if (!waitForPager(pager, 0))
+        return false;
+    if (loading->getNumChildren() != 1 || queued->getNumChildren() != 1)
+        return false;
+    pager.stop();
+
+    // Many workers, everything gets loaded
+    BVHPager multiPager;
+    if (!multiPager.start(4))
+        return false;
+    std::vector<SGSharedPtr<TestPageNode> > multiNodes;
+    for (unsigned i = 0; i < 256; ++i) {
+        multiNodes.push_back(new TestPageNode(i, log));
+        multiPager.use(*multiNodes.back(), i);
+    }
+    if (!waitForPager(multiPager, 0))
+        return false;
+    for (unsigned i = 0; i < multiNodes.size(); ++i) {
+        if (multiNodes[i]->getNumChildren() != 1)
+            return false;
+    }
+    statistics = multiPager.getStatistics();
+    if (statistics._insertedRequests != multiNodes.size())
+        return false;
+
+    std::cout << statistics._insertedRequests << " page requests on 4 threads: "
+              << "average latency " << statistics._averageLatency*1e3
+              << "ms, max latency " << statistics._maxLatency*1e3 << "ms"
+              << std::endl;
+
+    return true;
+}
+
 int
 main(int argc, char** argv)
 {
@@ -139,5 +631,13 @@ main(int argc, char** argv)
         return EXIT_FAILURE;
     if (!testNearestPoint())
         return EXIT_FAILURE;
+    if (!testFlatGeometry())
+        return EXIT_FAILURE;
+    if (!testLargeLeaves())
+        return EXIT_FAILURE;
+    if (!testPacketLineIntersections())
+        return EXIT_FAILURE;
+    if (!testPager())
+        return EXIT_FAILURE;
     return EXIT_SUCCESS;
 }
@@ -30,7 +30,10 @@
 
 #include "RTIFederate.hxx"
 #include "RTIFederateFactoryRegistry.hxx"
+#ifdef HAVE_RTI13
 #include "RTI13FederateFactory.hxx"
+#endif
+#include "RTILoopbackFederateFactory.hxx"
 #include "RTIInteractionClass.hxx"
 #include "RTIObjectClass.hxx"
 #include "HLADataElement.hxx"
@@ -47,8 +50,11 @@ HLAFederate::HLAFederate() :
     _timeConstrainedByLocalClock(false),
     _done(false)
 {
-    // For now instantiate the current only available factory here explicitly
+    // For now instantiate the available factories here explicitly
+#ifdef HAVE_RTI13
     RTI13FederateFactory::instance();
+#endif
+    RTILoopbackFederateFactory::instance();
 }
 
 HLAFederate::~HLAFederate()
@@ -88,6 +94,8 @@ HLAFederate::setVersion(const std::string& version)
         return setVersion(RTI1516);
     else if (version == "RTI1516E")
         return setVersion(RTI1516E);
+    else if (version == "Loopback")
+        return setVersion(Loopback);
     else {
         /// at some time think about routing these down to the factory
         SG_LOG(SG_NETWORK, SG_ALERT, "HLA: Unknown version string in HLAFederate::setVersion!");
@@ -225,6 +233,9 @@ HLAFederate::connect()
     case RTI1516E:
         _rtiFederate = registry->create("RTI1516E", _connectArguments);
         break;
+    case Loopback:
+        _rtiFederate = registry->create("Loopback", _connectArguments);
+        break;
     default:
         SG_LOG(SG_NETWORK, SG_WARN, "HLA: Unknown rti version in connect!");
     }
@@ -998,6 +1009,12 @@ HLAFederate::readObjectModel()
         if (readRTI1516ObjectModelTemplate(getFederationObjectModel()))
             return true;
         return readRTI13ObjectModelTemplate(getFederationObjectModel());
+    case Loopback:
+        if (readRTI1516ObjectModelTemplate(getFederationObjectModel()))
+            return true;
+        if (readRTI1516EObjectModelTemplate(getFederationObjectModel()))
+            return true;
+        return readRTI13ObjectModelTemplate(getFederationObjectModel());
     default:
         return false;
     }
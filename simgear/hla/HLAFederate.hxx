@@ -38,7 +38,9 @@ public:
     enum Version {
         RTI13,
         RTI1516,
-        RTI1516E
+        RTI1516E,
+        /// In process federation without an rti, mostly for testing
+        Loopback
     };
 
     /// The rti version backend to connect
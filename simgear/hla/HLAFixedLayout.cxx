@@ -0,0 +1,296 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include <simgear/compiler.h>
+
+#include "HLAFixedLayout.hxx"
+
+#include <algorithm>
+#include <sstream>
+
+#include "HLADataTypeVisitor.hxx"
+
+namespace simgear {
+
+static inline bool
+hostIsLittleEndian()
+{
+    union {
+        uint16_t u16;
+        uint8_t u8[2];
+    } u;
+    u.u16 = 1;
+    return u.u8[0] == 1;
+}
+
+template<unsigned size>
+static inline void
+swapBytes(char* data)
+{
+    for (unsigned i = 0; i < size/2; ++i)
+        std::swap(data[i], data[size - 1 - i]);
+}
+
+class HLAFixedLayout::_LayoutVisitor : public HLADataTypeVisitor {
+public:
+    _LayoutVisitor(HLAFixedLayout& layout) :
+        _layout(layout),
+        _offset(0),
+        _depth(0),
+        _success(true)
+    { }
+    virtual ~_LayoutVisitor()
+    { }
+
+    // Everything not listed below has a variable size
+    virtual void apply(const HLADataType& dataType)
+    { _success = false; }
+
+    virtual void apply(const HLAInt8DataType& dataType)
+    { _value(dataType, Int8, 1, false); }
+    virtual void apply(const HLAUInt8DataType& dataType)
+    { _value(dataType, UInt8, 1, false); }
+    virtual void apply(const HLAInt16DataType& dataType)
+    { _value(dataType, Int16, 2, dynamic_cast<const HLAInt16BEDataType*>(&dataType)); }
+    virtual void apply(const HLAUInt16DataType& dataType)
+    { _value(dataType, UInt16, 2, dynamic_cast<const HLAUInt16BEDataType*>(&dataType)); }
+    virtual void apply(const HLAInt32DataType& dataType)
+    { _value(dataType, Int32, 4, dynamic_cast<const HLAInt32BEDataType*>(&dataType)); }
+    virtual void apply(const HLAUInt32DataType& dataType)
+    { _value(dataType, UInt32, 4, dynamic_cast<const HLAUInt32BEDataType*>(&dataType)); }
+    virtual void apply(const HLAInt64DataType& dataType)
+    { _value(dataType, Int64, 8, dynamic_cast<const HLAInt64BEDataType*>(&dataType)); }
+    virtual void apply(const HLAUInt64DataType& dataType)
+    { _value(dataType, UInt64, 8, dynamic_cast<const HLAUInt64BEDataType*>(&dataType)); }
+    virtual void apply(const HLAFloat32DataType& dataType)
+    { _value(dataType, Float32, 4, dynamic_cast<const HLAFloat32BEDataType*>(&dataType)); }
+    virtual void apply(const HLAFloat64DataType& dataType)
+    { _value(dataType, Float64, 8, dynamic_cast<const HLAFloat64BEDataType*>(&dataType)); }
+
+    virtual void apply(const HLAEnumeratedDataType& dataType)
+    {
+        if (!dataType.getRepresentation()) {
+            _success = false;
+            return;
+        }
+        dataType.getRepresentation()->accept(*this);
+    }
+
+    virtual void apply(const HLAFixedArrayDataType& dataType)
+    {
+        const HLADataType* elementDataType = dataType.getElementDataType();
+        if (!elementDataType) {
+            _success = false;
+            return;
+        }
+        _offset = RTIBasicDataStream::getAlignedOffset(_offset, dataType.getAlignment());
+        std::string path = _path;
+        ++_depth;
+        for (unsigned i = 0; _success && i < dataType.getNumElements(); ++i) {
+            std::stringstream stream;
+            stream << path << "[" << i << "]";
+            _path = stream.str();
+            elementDataType->accept(*this);
+        }
+        --_depth;
+        _path = path;
+    }
+
+    virtual void apply(const HLAFixedRecordDataType& dataType)
+    {
+        _offset = RTIBasicDataStream::getAlignedOffset(_offset, dataType.getAlignment());
+        std::string path = _path;
+        unsigned depth = _depth++;
+        for (unsigned i = 0; _success && i < dataType.getNumFields(); ++i) {
+            const HLADataType* fieldDataType = dataType.getFieldDataType(i);
+            if (!fieldDataType) {
+                _success = false;
+                break;
+            }
+            if (path.empty())
+                _path = dataType.getFieldName(i);
+            else
+                _path = path + "." + dataType.getFieldName(i);
+
+            Field field;
+            field._alignment = fieldDataType->getAlignment();
+            field._offset = RTIBasicDataStream::getAlignedOffset(_offset, field._alignment);
+            fieldDataType->accept(*this);
+            field._size = _offset - field._offset;
+            if (depth == 0)
+                _layout._fieldVector.push_back(field);
+        }
+        --_depth;
+        _path = path;
+    }
+
+    HLAFixedLayout& _layout;
+    std::string _path;
+    unsigned _offset;
+    unsigned _depth;
+    bool _success;
+
+private:
+    void _value(const HLADataType& dataType, Type type, unsigned size, bool bigEndian)
+    {
+        _offset = RTIBasicDataStream::getAlignedOffset(_offset, dataType.getAlignment());
+
+        Value value;
+        value._path = _path;
+        value._type = type;
+        value._offset = _offset;
+        _layout._valueVector.push_back(value);
+
+        if (1 < size && bigEndian == hostIsLittleEndian()) {
+            SwapVector& swapVector = _layout._swapVector;
+            if (!swapVector.empty() && swapVector.back()._size == size &&
+                swapVector.back()._offset + swapVector.back()._count*size == _offset) {
+                ++swapVector.back()._count;
+            } else {
+                Swap swap;
+                swap._offset = _offset;
+                swap._size = size;
+                swap._count = 1;
+                swapVector.push_back(swap);
+            }
+        }
+
+        _offset += size;
+    }
+};
+
+HLAFixedLayout::HLAFixedLayout() :
+    _size(0),
+    _alignment(1)
+{
+}
+
+HLAFixedLayout::~HLAFixedLayout()
+{
+}
+
+SGSharedPtr<HLAFixedLayout>
+HLAFixedLayout::create(const HLADataType* dataType)
+{
+    if (!dataType)
+        return 0;
+    SGSharedPtr<HLAFixedLayout> layout = new HLAFixedLayout;
+    _LayoutVisitor visitor(*layout);
+    dataType->accept(visitor);
+    if (!visitor._success)
+        return 0;
+    layout->_size = visitor._offset;
+    layout->_alignment = dataType->getAlignment();
+    return layout;
+}
+
+unsigned
+HLAFixedLayout::getValueIndex(const std::string& path) const
+{
+    for (unsigned i = 0; i < _valueVector.size(); ++i) {
+        if (_valueVector[i]._path == path)
+            return i;
+    }
+    return ~0u;
+}
+
+bool
+HLAFixedLayout::encode(HLAEncodeStream& stream, const char* image) const
+{
+    if (!stream.alignOffsetForSize(_alignment))
+        return false;
+    unsigned offset = stream.getOffset();
+    if (!stream.skip(_size))
+        return false;
+    _copy(stream.getData().data() + offset, image, 0, _size);
+    return true;
+}
+
+bool
+HLAFixedLayout::decode(HLADecodeStream& stream, char* image) const
+{
+    if (!stream.alignOffsetForSize(_alignment))
+        return false;
+    unsigned offset = stream.getOffset();
+    if (!stream.skip(_size))
+        return false;
+    _copy(image, stream.getData().data() + offset, 0, _size);
+    return true;
+}
+
+bool
+HLAFixedLayout::encodeField(HLAEncodeStream& stream, const char* image, unsigned index) const
+{
+    if (_fieldVector.size() <= index)
+        return false;
+    const Field& field = _fieldVector[index];
+    if (!stream.alignOffsetForSize(field._alignment))
+        return false;
+    unsigned offset = stream.getOffset();
+    if (!stream.skip(field._size))
+        return false;
+    _copy(stream.getData().data() + offset, image + field._offset, field._offset, field._offset + field._size);
+    return true;
+}
+
+bool
+HLAFixedLayout::decodeField(HLADecodeStream& stream, char* image, unsigned index) const
+{
+    if (_fieldVector.size() <= index)
+        return false;
+    const Field& field = _fieldVector[index];
+    if (!stream.alignOffsetForSize(field._alignment))
+        return false;
+    unsigned offset = stream.getOffset();
+    if (!stream.skip(field._size))
+        return false;
+    _copy(image + field._offset, stream.getData().data() + offset, field._offset, field._offset + field._size);
+    return true;
+}
+
+void
+HLAFixedLayout::_copy(char* dst, const char* src, unsigned begin, unsigned end) const
+{
+    // dst and src both point to the image offset begin
+    if (begin == end)
+        return;
+    memcpy(dst, src, end - begin);
+    for (SwapVector::const_iterator i = _swapVector.begin(); i != _swapVector.end(); ++i) {
+        unsigned offset = i->_offset;
+        for (unsigned j = 0; j < i->_count; ++j, offset += i->_size) {
+            if (offset < begin || end <= offset)
+                continue;
+            switch (i->_size) {
+            case 2:
+                swapBytes<2>(dst + offset - begin);
+                break;
+            case 4:
+                swapBytes<4>(dst + offset - begin);
+                break;
+            case 8:
+                swapBytes<8>(dst + offset - begin);
+                break;
+            }
+        }
+    }
+}
+
+} // namespace simgear
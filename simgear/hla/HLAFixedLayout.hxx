@@ -0,0 +1,135 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifndef HLAFixedLayout_hxx
+#define HLAFixedLayout_hxx
+
+#include <string>
+#include <vector>
+#include <simgear/structure/SGReferenced.hxx>
+#include <simgear/structure/SGSharedPtr.hxx>
+#include "RTIData.hxx"
+
+namespace simgear {
+
+class HLADataType;
+
+/// The precomputed wire layout of a data type that only consists of
+/// basic types, enumerations, fixed arrays and fixed records.
+/// Such a data type always encodes to the same offsets, so the whole
+/// value can be kept as an image of the encoded data in host byte order.
+/// Encoding and decoding is then a single copy plus byte swapping of the
+/// values that are transmitted in the other byte order.
+class HLAFixedLayout : public SGReferenced {
+public:
+    enum Type {
+        Int8,
+        UInt8,
+        Int16,
+        UInt16,
+        Int32,
+        UInt32,
+        Int64,
+        UInt64,
+        Float32,
+        Float64
+    };
+
+    virtual ~HLAFixedLayout();
+
+    /// Compute the layout for the given data type.
+    /// Returns zero if the data type does not have a fixed layout.
+    static SGSharedPtr<HLAFixedLayout> create(const HLADataType* dataType);
+
+    /// The size of the encoded value, this is also the size of the image
+    unsigned getSize() const
+    { return _size; }
+    unsigned getAlignment() const
+    { return _alignment; }
+
+    /// The basic values in encoding order.
+    /// Paths are built the same way than the HLADataElementIndex paths,
+    /// so a fixed record field x in a field position is "position.x".
+    unsigned getNumValues() const
+    { return _valueVector.size(); }
+    const std::string& getValuePath(unsigned index) const
+    { return _valueVector[index]._path; }
+    Type getValueType(unsigned index) const
+    { return _valueVector[index]._type; }
+    unsigned getValueOffset(unsigned index) const
+    { return _valueVector[index]._offset; }
+    /// Return the value index for the path or ~0u if not found
+    unsigned getValueIndex(const std::string& path) const;
+
+    /// For records, the byte range each top level field occupies
+    unsigned getNumFields() const
+    { return _fieldVector.size(); }
+    unsigned getFieldOffset(unsigned index) const
+    { return _fieldVector[index]._offset; }
+    unsigned getFieldSize(unsigned index) const
+    { return _fieldVector[index]._size; }
+    unsigned getFieldAlignment(unsigned index) const
+    { return _fieldVector[index]._alignment; }
+
+    /// Encode the image of getSize() bytes into the stream
+    bool encode(HLAEncodeStream& stream, const char* image) const;
+    /// Decode from the stream into the image of getSize() bytes
+    bool decode(HLADecodeStream& stream, char* image) const;
+
+    /// Encode or decode the byte range of a single top level field
+    bool encodeField(HLAEncodeStream& stream, const char* image, unsigned index) const;
+    bool decodeField(HLADecodeStream& stream, char* image, unsigned index) const;
+
+private:
+    HLAFixedLayout();
+
+    class _LayoutVisitor;
+
+    void _copy(char* dst, const char* src, unsigned begin, unsigned end) const;
+
+    struct Value {
+        std::string _path;
+        Type _type;
+        unsigned _offset;
+    };
+    typedef std::vector<Value> ValueVector;
+    ValueVector _valueVector;
+
+    struct Field {
+        unsigned _offset;
+        unsigned _size;
+        unsigned _alignment;
+    };
+    typedef std::vector<Field> FieldVector;
+    FieldVector _fieldVector;
+
+    /// Runs of equally sized values that need their bytes swapped
+    struct Swap {
+        unsigned _offset;
+        unsigned _size;
+        unsigned _count;
+    };
+    typedef std::vector<Swap> SwapVector;
+    SwapVector _swapVector;
+
+    unsigned _size;
+    unsigned _alignment;
+};
+
+} // namespace simgear
+
+#endif
@@ -0,0 +1,96 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include <simgear/compiler.h>
+
+#include "HLAFixedLayoutDataElement.hxx"
+
+#include <simgear/debug/logstream.hxx>
+
+namespace simgear {
+
+HLAFixedLayoutDataElement::HLAFixedLayoutDataElement(const HLAFixedRecordDataType* dataType) :
+    HLAAbstractFixedRecordDataElement(dataType)
+{
+    _setLayout(dataType);
+}
+
+HLAFixedLayoutDataElement::~HLAFixedLayoutDataElement()
+{
+}
+
+bool
+HLAFixedLayoutDataElement::decode(HLADecodeStream& stream)
+{
+    if (!_layout.valid())
+        return false;
+    return _layout->decode(stream, getImage());
+}
+
+bool
+HLAFixedLayoutDataElement::encode(HLAEncodeStream& stream) const
+{
+    if (!_layout.valid())
+        return false;
+    return _layout->encode(stream, getImage());
+}
+
+bool
+HLAFixedLayoutDataElement::setDataType(const HLADataType* dataType)
+{
+    if (!HLAAbstractFixedRecordDataElement::setDataType(dataType))
+        return false;
+    _setLayout(getDataType());
+    return _layout.valid();
+}
+
+bool
+HLAFixedLayoutDataElement::decodeField(HLADecodeStream& stream, unsigned i)
+{
+    if (!_layout.valid())
+        return false;
+    return _layout->decodeField(stream, getImage(), i);
+}
+
+bool
+HLAFixedLayoutDataElement::encodeField(HLAEncodeStream& stream, unsigned i) const
+{
+    if (!_layout.valid())
+        return false;
+    return _layout->encodeField(stream, getImage(), i);
+}
+
+void
+HLAFixedLayoutDataElement::_setLayout(const HLAFixedRecordDataType* dataType)
+{
+    _layout = HLAFixedLayout::create(dataType);
+    if (!_layout.valid()) {
+        _image.clear();
+        if (dataType) {
+            SG_LOG(SG_NETWORK, SG_WARN, "HLAFixedLayoutDataElement: data type \""
+                   << dataType->getName() << "\" does not have a fixed layout!");
+        }
+        return;
+    }
+    _image.assign((_layout->getSize() + sizeof(uint64_t) - 1)/sizeof(uint64_t), 0);
+}
+
+}
@@ -0,0 +1,160 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifndef HLAFixedLayoutDataElement_hxx
+#define HLAFixedLayoutDataElement_hxx
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "HLAFixedLayout.hxx"
+#include "HLAFixedRecordDataElement.hxx"
+
+namespace simgear {
+
+/// Fixed record data element for records with a fixed layout.
+/// Instead of a data element per field, the values are kept in one
+/// image of the encoded record, so encoding and decoding does not
+/// need any per field virtual call.
+/// Values are accessed by the index into the layouts value list.
+class HLAFixedLayoutDataElement : public HLAAbstractFixedRecordDataElement {
+public:
+    HLAFixedLayoutDataElement(const HLAFixedRecordDataType* dataType);
+    virtual ~HLAFixedLayoutDataElement();
+
+    virtual bool decode(HLADecodeStream& stream);
+    virtual bool encode(HLAEncodeStream& stream) const;
+
+    virtual bool setDataType(const HLADataType* dataType);
+
+    virtual bool decodeField(HLADecodeStream& stream, unsigned i);
+    virtual bool encodeField(HLAEncodeStream& stream, unsigned i) const;
+
+    /// Returns zero if the data type does not have a fixed layout
+    const HLAFixedLayout* getLayout() const
+    { return _layout.get(); }
+
+    /// Return the value index for the given path or ~0u if not found
+    unsigned getValueIndex(const std::string& path) const
+    {
+        if (!_layout.valid())
+            return ~0u;
+        return _layout->getValueIndex(path);
+    }
+
+    /// Get and set the value with the given index,
+    /// converting from/to the values data type.
+    template<typename T>
+    T getValue(unsigned index) const
+    {
+        if (!_layout.valid() || _layout->getNumValues() <= index)
+            return T(0);
+        unsigned offset = _layout->getValueOffset(index);
+        switch (_layout->getValueType(index)) {
+        case HLAFixedLayout::Int8:
+            return T(_get<int8_t>(offset));
+        case HLAFixedLayout::UInt8:
+            return T(_get<uint8_t>(offset));
+        case HLAFixedLayout::Int16:
+            return T(_get<int16_t>(offset));
+        case HLAFixedLayout::UInt16:
+            return T(_get<uint16_t>(offset));
+        case HLAFixedLayout::Int32:
+            return T(_get<int32_t>(offset));
+        case HLAFixedLayout::UInt32:
+            return T(_get<uint32_t>(offset));
+        case HLAFixedLayout::Int64:
+            return T(_get<int64_t>(offset));
+        case HLAFixedLayout::UInt64:
+            return T(_get<uint64_t>(offset));
+        case HLAFixedLayout::Float32:
+            return T(_get<float>(offset));
+        case HLAFixedLayout::Float64:
+            return T(_get<double>(offset));
+        default:
+            return T(0);
+        }
+    }
+    template<typename T>
+    void setValue(unsigned index, const T& value)
+    {
+        if (!_layout.valid() || _layout->getNumValues() <= index)
+            return;
+        unsigned offset = _layout->getValueOffset(index);
+        switch (_layout->getValueType(index)) {
+        case HLAFixedLayout::Int8:
+            _set(offset, int8_t(value));
+            break;
+        case HLAFixedLayout::UInt8:
+            _set(offset, uint8_t(value));
+            break;
+        case HLAFixedLayout::Int16:
+            _set(offset, int16_t(value));
+            break;
+        case HLAFixedLayout::UInt16:
+            _set(offset, uint16_t(value));
+            break;
+        case HLAFixedLayout::Int32:
+            _set(offset, int32_t(value));
+            break;
+        case HLAFixedLayout::UInt32:
+            _set(offset, uint32_t(value));
+            break;
+        case HLAFixedLayout::Int64:
+            _set(offset, int64_t(value));
+            break;
+        case HLAFixedLayout::UInt64:
+            _set(offset, uint64_t(value));
+            break;
+        case HLAFixedLayout::Float32:
+            _set(offset, float(value));
+            break;
+        case HLAFixedLayout::Float64:
+            _set(offset, double(value));
+            break;
+        }
+        setDirty(true);
+    }
+
+    /// The raw image in host byte order, call setDirty(true) past writing
+    const char* getImage() const
+    { return _image.empty() ? 0 : reinterpret_cast<const char*>(&_image.front()); }
+    char* getImage()
+    { return _image.empty() ? 0 : reinterpret_cast<char*>(&_image.front()); }
+
+private:
+    void _setLayout(const HLAFixedRecordDataType* dataType);
+
+    template<typename T>
+    T _get(unsigned offset) const
+    {
+        T value;
+        std::memcpy(&value, getImage() + offset, sizeof(T));
+        return value;
+    }
+    template<typename T>
+    void _set(unsigned offset, const T& value)
+    { std::memcpy(getImage() + offset, &value, sizeof(T)); }
+
+    SGSharedPtr<const HLAFixedLayout> _layout;
+    // uint64_t to keep the image aligned for all basic types
+    std::vector<uint64_t> _image;
+};
+
+}
+
+#endif
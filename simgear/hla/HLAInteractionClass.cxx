@@ -232,6 +232,36 @@ HLAInteractionClass::unpublish()
     return _rtiInteractionClass->unpublish();
 }
 
+bool
+HLAInteractionClass::send(const RTIIndexDataPairList& parameters, const RTIData& tag)
+{
+    if (!_rtiInteractionClass) {
+        SG_LOG(SG_NETWORK, SG_WARN, "HLAInteractionClass::send(): No RTIInteractionClass!");
+        return false;
+    }
+    return _rtiInteractionClass->send(parameters, tag);
+}
+
+bool
+HLAInteractionClass::send(const RTIIndexDataPairList& parameters, const SGTimeStamp& timeStamp, const RTIData& tag)
+{
+    if (!_rtiInteractionClass) {
+        SG_LOG(SG_NETWORK, SG_WARN, "HLAInteractionClass::send(): No RTIInteractionClass!");
+        return false;
+    }
+    return _rtiInteractionClass->send(parameters, timeStamp, tag);
+}
+
+void
+HLAInteractionClass::receiveInteraction(const RTIIndexDataPairList& parameters, const RTIData& tag)
+{
+}
+
+void
+HLAInteractionClass::receiveInteraction(const RTIIndexDataPairList& parameters, const SGTimeStamp& timeStamp, const RTIData& tag)
+{
+}
+
 void
 HLAInteractionClass::_setRTIInteractionClass(RTIInteractionClass* interactionClass)
 {
@@ -69,6 +69,14 @@ public:
     virtual bool publish();
     virtual bool unpublish();
 
+    /// Send an interaction with the encoded values of the given parameter indices
+    bool send(const RTIIndexDataPairList& parameters, const RTIData& tag = RTIData());
+    bool send(const RTIIndexDataPairList& parameters, const SGTimeStamp& timeStamp, const RTIData& tag = RTIData());
+
+    /// Called for every received interaction of this class
+    virtual void receiveInteraction(const RTIIndexDataPairList& parameters, const RTIData& tag);
+    virtual void receiveInteraction(const RTIIndexDataPairList& parameters, const SGTimeStamp& timeStamp, const RTIData& tag);
+
 private:
     HLAInteractionClass(const HLAInteractionClass&);
     HLAInteractionClass& operator=(const HLAInteractionClass&);
@@ -28,6 +28,54 @@
 
 namespace simgear {
 
+HLAAbstractLocation::HLAAbstractLocation() :
+    _deadReckoningPositionError(0),
+    _deadReckoningOrientationError(0),
+    _deadReckoningMaxTimeInterval(0),
+    _deadReckoningTimeStampValid(false)
+{
+}
+
+void
+HLAAbstractLocation::setDeadReckoningThresholds(double positionError, double orientationError, double maxTimeInterval)
+{
+    _deadReckoningPositionError = positionError;
+    _deadReckoningOrientationError = orientationError;
+    _deadReckoningMaxTimeInterval = maxTimeInterval;
+}
+
+bool
+HLAAbstractLocation::setDeadReckonedLocation(const SGTimeStamp& timeStamp, const SGLocationd& location,
+                                             const SGVec3d& linearBodyVelocity, const SGVec3d& angularBodyVelocity)
+{
+    if (_deadReckoningTimeStampValid) {
+        double dt = (timeStamp - _deadReckoningTimeStamp).toSecs();
+        if (_deadReckoningMaxTimeInterval <= 0 || dt < _deadReckoningMaxTimeInterval) {
+            // What the receivers see when extrapolating the last written state
+            SGLocationd extrapolated = getLocation();
+            extrapolated.eulerStepBodyVelocitiesMidOrientation(dt, getLinearBodyVelocity(), getAngularBodyVelocity());
+
+            double positionError = dist(extrapolated.getPosition(), location.getPosition());
+            double orientationError;
+            SGVec3d axis;
+            (inverse(extrapolated.getOrientation())*location.getOrientation()).getAngleAxis(orientationError, axis);
+            if (SGMiscd::pi() < orientationError)
+                orientationError = 2*SGMiscd::pi() - orientationError;
+
+            if (positionError <= _deadReckoningPositionError &&
+                orientationError <= _deadReckoningOrientationError)
+                return false;
+        }
+    }
+
+    setLocation(location);
+    setLinearBodyVelocity(linearBodyVelocity);
+    setAngularBodyVelocity(angularBodyVelocity);
+    _deadReckoningTimeStamp = timeStamp;
+    _deadReckoningTimeStampValid = true;
+    return true;
+}
+
 HLAAbstractLocationFactory::~HLAAbstractLocationFactory()
 {
 }
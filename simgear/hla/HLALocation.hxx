@@ -28,6 +28,7 @@ class HLAObjectInstance;
 
 class HLAAbstractLocation : public SGReferenced {
 public:
+    HLAAbstractLocation();
     virtual ~HLAAbstractLocation() {}
 
     virtual SGLocationd getLocation() const = 0;
@@ -55,6 +56,35 @@ public:
         location.eulerStepBodyVelocitiesMidOrientation(getTimeDifference(timeStamp), getLinearBodyVelocity(), getAngularBodyVelocity());
         return location;
     }
+
+    // Send side dead reckoning.
+    // Receivers extrapolate the last received location with the last received
+    // velocities. setDeadReckonedLocation only writes a new state if that
+    // extrapolation is off by more than the position error in meters or the
+    // orientation error in radians, or if the last written state is older than
+    // the maximum time interval in seconds. A zero time interval disables that.
+    // Use the same time stamp for the timestamped attribute update.
+    void setDeadReckoningThresholds(double positionError, double orientationError, double maxTimeInterval = 0);
+    double getDeadReckoningPositionError() const
+    { return _deadReckoningPositionError; }
+    double getDeadReckoningOrientationError() const
+    { return _deadReckoningOrientationError; }
+    double getDeadReckoningMaxTimeInterval() const
+    { return _deadReckoningMaxTimeInterval; }
+
+    // Returns true if the state was written
+    bool setDeadReckonedLocation(const SGTimeStamp& timeStamp, const SGLocationd& location,
+                                 const SGVec3d& linearBodyVelocity, const SGVec3d& angularBodyVelocity);
+    // Force the next setDeadReckonedLocation to write
+    void resetDeadReckoning()
+    { _deadReckoningTimeStampValid = false; }
+
+private:
+    double _deadReckoningPositionError;
+    double _deadReckoningOrientationError;
+    double _deadReckoningMaxTimeInterval;
+    SGTimeStamp _deadReckoningTimeStamp;
+    bool _deadReckoningTimeStampValid;
 };
 
 class HLACartesianLocation : public HLAAbstractLocation {
@@ -382,7 +382,7 @@ HLAObjectInstance::encodeAttributeValues()
         } else if (_attributeVector[i]._enabledUpdate) {
             const HLADataElement* dataElement = getAttributeDataElement(i);
             if (dataElement && dataElement->getDirty())
-                encodeAttributeValue(i);
+                encodeChangedAttributeValue(i);
         }
     }
 }
@@ -401,6 +401,20 @@ HLAObjectInstance::encodeAttributeValue(unsigned index)
     dataElement->setDirty(false);
 }
 
+void
+HLAObjectInstance::encodeChangedAttributeValue(unsigned index)
+{
+    if (!_rtiObjectInstance.valid()) {
+        SG_LOG(SG_IO, SG_INFO, "Not updating inactive object!");
+        return;
+    }
+    HLADataElement* dataElement = getAttributeDataElement(index);
+    if (!dataElement)
+        return;
+    _rtiObjectInstance->encodeChangedAttributeData(index, *dataElement);
+    dataElement->setDirty(false);
+}
+
 void
 HLAObjectInstance::sendAttributeValues(const RTIData& tag)
 {
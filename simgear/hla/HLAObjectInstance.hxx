@@ -118,10 +118,13 @@ public:
     // Push the current values into the RTI
     virtual void updateAttributeValues(const RTIData& tag);
     virtual void updateAttributeValues(const SGTimeStamp& timeStamp, const RTIData& tag);
-    // encode periodic and dirty attribute values for the next sendAttributeValues
+    // encode periodic and dirty attribute values for the next sendAttributeValues,
+    // dirty values that still encode to the last sent bytes are not sent again
     void encodeAttributeValues();
     // encode the attribute value at index i for the next sendAttributeValues
     void encodeAttributeValue(unsigned index);
+    // same as above, but skip sending if the encoded bytes did not change since the last send
+    void encodeChangedAttributeValue(unsigned index);
 
     // Really sends the prepared attribute update values into the RTI
     void sendAttributeValues(const RTIData& tag);
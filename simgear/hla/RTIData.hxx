@@ -67,6 +67,16 @@ public:
             memcpy(_data, data.data(), size);
         }
     }
+    /// Takes over the buffer, borrowed buffers stay borrowed
+    RTIData(RTIData&& data) :
+        _data(data._data),
+        _size(data._size),
+        _capacity(data._capacity)
+    {
+        data._data = 0;
+        data._size = 0;
+        data._capacity = 0;
+    }
     ~RTIData()
     {
         if (_capacity)
@@ -130,8 +140,21 @@ public:
         _size = size;
         _capacity = 0;
     }
+    /// Wrap a read only buffer owned by someone else without copying.
+    /// The buffer must outlive this object or the next setData call.
+    /// Do not write through data() into a borrowed buffer, resizing to
+    /// a larger size detaches into an own copy, which is what the
+    /// HLAEncodeStream does.
+    void setBorrowedData(const char* data, unsigned size)
+    { setData(const_cast<char*>(data), size); }
+    /// Returns true if the data is not owned by this object
+    bool getBorrowed() const
+    { return _capacity == 0 && _data != 0; }
     void setData(const char* data, unsigned size)
     {
+        // Never copy into a borrowed buffer
+        if (_capacity == 0)
+            clear();
         resize(size);
         if (!size)
             return;
@@ -149,11 +172,20 @@ public:
 
     RTIData& operator=(const RTIData& data)
     {
+        if (&data == this)
+            return *this;
         unsigned size = data.size();
-        if (size) {
-            resize(size);
+        if (_capacity == 0)
+            clear();
+        resize(size);
+        if (size)
             memcpy(_data, data.data(), size);
-        }
+        return *this;
+    }
+    RTIData& operator=(RTIData&& data)
+    {
+        swap(data);
+        data.clear();
         return *this;
     }
 
@@ -431,6 +463,10 @@ private:
     unsigned _capacity;
 };
 
+/// Values of attributes or parameters, keyed by their index
+typedef std::pair<unsigned, RTIData> RTIIndexDataPair;
+typedef std::list<RTIIndexDataPair> RTIIndexDataPairList;
+
 /// Gets an own header at some time
 
 class RTIBasicDataStream {
@@ -443,6 +479,9 @@ public:
         return ((offset + size - 1)/size) * size;
     }
 
+    unsigned getOffset() const
+    { return _offset; }
+
 protected:
     unsigned _offset;
 };
@@ -452,6 +491,10 @@ public:
     HLADecodeStream(const RTIData& value) :
         _value(value)
     { }
+    /// Decode from a buffer owned by someone else without copying
+    HLADecodeStream(const char* data, unsigned size) :
+        _value(_borrowed)
+    { _borrowed.setBorrowedData(data, size); }
 
     bool alignOffsetForSize(unsigned size)
     {
@@ -504,6 +547,10 @@ public:
 #undef TYPED_READ_IMPLEMENTATION
 
 private:
+    HLADecodeStream(const HLADecodeStream&);
+    HLADecodeStream& operator=(const HLADecodeStream&);
+
+    RTIData _borrowed;
     const RTIData& _value;
 };
 
@@ -533,6 +580,9 @@ public:
     void setData(const RTIData& data)
     { _value = data; }
 
+    RTIData& getData()
+    { return _value; }
+
 #define TYPED_WRITE_IMPLEMENTATION(type, base, suffix)                  \
     bool encode##base##suffix(type value)                               \
     {                                                                   \
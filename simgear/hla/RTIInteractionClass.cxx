@@ -23,6 +23,9 @@
 
 #include "RTIInteractionClass.hxx"
 
+#include "simgear/debug/logstream.hxx"
+#include "HLAInteractionClass.hxx"
+
 namespace simgear {
 
 RTIInteractionClass::RTIInteractionClass(HLAInteractionClass* interactionClass) :
@@ -35,4 +38,39 @@ RTIInteractionClass::~RTIInteractionClass()
     _interactionClass = 0;
 }
 
+bool
+RTIInteractionClass::send(const RTIIndexDataPairList& parameters, const RTIData& tag)
+{
+    SG_LOG(SG_NETWORK, SG_WARN, "RTI: Sending interactions is not supported by this rti backend.");
+    return false;
+}
+
+bool
+RTIInteractionClass::send(const RTIIndexDataPairList& parameters, const SGTimeStamp& timeStamp, const RTIData& tag)
+{
+    SG_LOG(SG_NETWORK, SG_WARN, "RTI: Sending interactions is not supported by this rti backend.");
+    return false;
+}
+
+void
+RTIInteractionClass::receiveInteraction(const RTIIndexDataPairList& parameters, const RTIData& tag) const
+{
+    if (!_interactionClass) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Invalid hla interaction class pointer in RTIInteractionClass::receiveInteraction().");
+        return;
+    }
+    _interactionClass->receiveInteraction(parameters, tag);
+}
+
+void
+RTIInteractionClass::receiveInteraction(const RTIIndexDataPairList& parameters, const SGTimeStamp& timeStamp,
+                                        const RTIData& tag) const
+{
+    if (!_interactionClass) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Invalid hla interaction class pointer in RTIInteractionClass::receiveInteraction().");
+        return;
+    }
+    _interactionClass->receiveInteraction(parameters, timeStamp, tag);
+}
+
 }
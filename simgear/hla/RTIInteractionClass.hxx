@@ -20,6 +20,9 @@
 
 #include <string>
 #include "simgear/structure/SGReferenced.hxx"
+#include "RTIData.hxx"
+
+class SGTimeStamp;
 
 namespace simgear {
 
@@ -38,8 +41,13 @@ public:
     virtual bool subscribe(bool) = 0;
     virtual bool unsubscribe() = 0;
 
-    // virtual void send(const RTIData& tag) = 0;
-    // virtual void send(const SGTimeStamp& timeStamp, const RTIData& tag) = 0;
+    // Not every backend implements these, the default ones fail
+    virtual bool send(const RTIIndexDataPairList& parameters, const RTIData& tag);
+    virtual bool send(const RTIIndexDataPairList& parameters, const SGTimeStamp& timeStamp, const RTIData& tag);
+
+    // Call back into HLAInteractionClass
+    void receiveInteraction(const RTIIndexDataPairList& parameters, const RTIData& tag) const;
+    void receiveInteraction(const RTIIndexDataPairList& parameters, const SGTimeStamp& timeStamp, const RTIData& tag) const;
 
 private:
     HLAInteractionClass* _interactionClass;
@@ -0,0 +1,535 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include <simgear/compiler.h>
+
+#include "RTILoopbackFederate.hxx"
+
+#include <algorithm>
+
+#include "simgear/debug/logstream.hxx"
+
+namespace simgear {
+
+RTILoopbackFederate::RTILoopbackFederate(const std::list<std::string>& stringList) :
+    _federateHandle(RTILoopbackFederation::InvalidHandle),
+    _timeRegulationEnabled(false),
+    _timeConstrainedEnabled(false),
+    _timeAdvancePending(false)
+{
+    if (!stringList.empty()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Ignoring non empty connect arguments while connecting to a loopback federation!");
+    }
+}
+
+RTILoopbackFederate::~RTILoopbackFederate()
+{
+    if (_federation.valid())
+        _federation->resign(_federateHandle);
+}
+
+RTILoopbackFederate::FederationManagementResult
+RTILoopbackFederate::createFederationExecution(const std::string& federationName, const std::string& objectModel)
+{
+    // The object model is only read by HLAFederate, handles are just assigned by name
+    return RTILoopbackFederation::createFederationExecution(federationName);
+}
+
+RTILoopbackFederate::FederationManagementResult
+RTILoopbackFederate::destroyFederationExecution(const std::string& federation)
+{
+    return RTILoopbackFederation::destroyFederationExecution(federation);
+}
+
+RTILoopbackFederate::FederationManagementResult
+RTILoopbackFederate::join(const std::string& federateType, const std::string& federationName)
+{
+    if (_federation.valid()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not join federation execution: Federate already joined.");
+        return FederationManagementFatal;
+    }
+    SGSharedPtr<RTILoopbackFederation> federation;
+    federation = RTILoopbackFederation::getFederationExecution(federationName);
+    if (!federation.valid()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not join federation execution: Federation execution does not exist.");
+        return FederationManagementFail;
+    }
+    _federateHandle = federation->join(federateType);
+    _federation = federation;
+    SG_LOG(SG_NETWORK, SG_INFO, "RTI: Joined federation \""
+           << federationName << "\" as \"" << federateType << "\"");
+    return FederationManagementSuccess;
+}
+
+bool
+RTILoopbackFederate::resign()
+{
+    if (!_federation.valid()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not resign federation execution: Federate not joined.");
+        return false;
+    }
+    _federation->resign(_federateHandle);
+    _federation = 0;
+    _federateHandle = RTILoopbackFederation::InvalidHandle;
+    _objectInstanceMap.clear();
+    _pendingSyncLabels.clear();
+    _syncronizedSyncLabels.clear();
+    _timeRegulationEnabled = false;
+    _timeConstrainedEnabled = false;
+    _timeAdvancePending = false;
+    SG_LOG(SG_NETWORK, SG_INFO, "RTI: Resigned from federation.");
+    return true;
+}
+
+bool
+RTILoopbackFederate::getJoined() const
+{
+    return _federation.valid();
+}
+
+bool
+RTILoopbackFederate::registerFederationSynchronizationPoint(const std::string& label, const RTIData& tag)
+{
+    if (!_federation.valid()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not register federation synchronization point at unconnected federate.");
+        return false;
+    }
+    if (!_federation->registerFederationSynchronizationPoint(_federateHandle, label, tag)) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not register federation synchronization point \"" << label << "\".");
+        return false;
+    }
+    SG_LOG(SG_NETWORK, SG_INFO, "RTI: registerFederationSynchronizationPoint(" << label << ", tag )");
+    return true;
+}
+
+bool
+RTILoopbackFederate::getFederationSynchronizationPointAnnounced(const std::string& label)
+{
+    return _pendingSyncLabels.find(label) != _pendingSyncLabels.end();
+}
+
+bool
+RTILoopbackFederate::synchronizationPointAchieved(const std::string& label)
+{
+    if (!_federation.valid()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not signal synchronization point at unconnected federate.");
+        return false;
+    }
+    if (!_federation->synchronizationPointAchieved(_federateHandle, label)) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not signal synchronization point \"" << label << "\".");
+        return false;
+    }
+    SG_LOG(SG_NETWORK, SG_INFO, "RTI: synchronizationPointAchieved(" << label << ")");
+    return true;
+}
+
+bool
+RTILoopbackFederate::getFederationSynchronized(const std::string& label)
+{
+    std::set<std::string>::iterator i = _syncronizedSyncLabels.find(label);
+    if (i == _syncronizedSyncLabels.end())
+        return false;
+    _syncronizedSyncLabels.erase(i);
+    return true;
+}
+
+bool
+RTILoopbackFederate::enableTimeConstrained()
+{
+    if (!_federation.valid()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not enable time constrained at unconnected federate.");
+        return false;
+    }
+    if (_timeConstrainedEnabled) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Time constrained is already enabled.");
+        return false;
+    }
+    if (!_federation->enableTimeConstrained(_federateHandle)) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not enable time constrained.");
+        return false;
+    }
+    return true;
+}
+
+bool
+RTILoopbackFederate::disableTimeConstrained()
+{
+    if (!_federation.valid()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not disable time constrained at unconnected federate.");
+        return false;
+    }
+    if (!_timeConstrainedEnabled) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Time constrained is not enabled.");
+        return false;
+    }
+    if (!_federation->disableTimeConstrained(_federateHandle)) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not disable time constrained.");
+        return false;
+    }
+    _timeConstrainedEnabled = false;
+    return true;
+}
+
+bool
+RTILoopbackFederate::getTimeConstrainedEnabled()
+{
+    return _timeConstrainedEnabled;
+}
+
+bool
+RTILoopbackFederate::enableTimeRegulation(const SGTimeStamp& lookahead)
+{
+    if (!_federation.valid()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not enable time regulation at unconnected federate.");
+        return false;
+    }
+    if (_timeRegulationEnabled) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Time regulation already enabled.");
+        return false;
+    }
+    if (!_federation->enableTimeRegulation(_federateHandle, lookahead)) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not enable time regulation.");
+        return false;
+    }
+    return true;
+}
+
+bool
+RTILoopbackFederate::disableTimeRegulation()
+{
+    if (!_federation.valid()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not disable time regulation at unconnected federate.");
+        return false;
+    }
+    if (!_timeRegulationEnabled) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Time regulation is not enabled.");
+        return false;
+    }
+    if (!_federation->disableTimeRegulation(_federateHandle)) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not disable time regulation.");
+        return false;
+    }
+    _timeRegulationEnabled = false;
+    return true;
+}
+
+bool
+RTILoopbackFederate::modifyLookahead(const SGTimeStamp& timeStamp)
+{
+    if (!_federation.valid()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not modify lookahead at unconnected federate.");
+        return false;
+    }
+    if (!_federation->modifyLookahead(_federateHandle, timeStamp)) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not modify lookahead.");
+        return false;
+    }
+    return true;
+}
+
+bool
+RTILoopbackFederate::getTimeRegulationEnabled()
+{
+    return _timeRegulationEnabled;
+}
+
+bool
+RTILoopbackFederate::timeAdvanceRequest(const SGTimeStamp& timeStamp)
+{
+    if (!_federation.valid()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not advance time at unconnected federate.");
+        return false;
+    }
+    if (!_federation->timeAdvanceRequest(_federateHandle, timeStamp, false)) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not advance time.");
+        return false;
+    }
+    _timeAdvancePending = true;
+    return true;
+}
+
+bool
+RTILoopbackFederate::timeAdvanceRequestAvailable(const SGTimeStamp& timeStamp)
+{
+    if (!_federation.valid()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not advance time at unconnected federate.");
+        return false;
+    }
+    if (!_federation->timeAdvanceRequest(_federateHandle, timeStamp, true)) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not advance time.");
+        return false;
+    }
+    _timeAdvancePending = true;
+    return true;
+}
+
+bool
+RTILoopbackFederate::flushQueueRequest(const SGTimeStamp& timeStamp)
+{
+    // The loopback federation never grants less than asked for,
+    // so this is just the same than an available time advance
+    return timeAdvanceRequestAvailable(timeStamp);
+}
+
+bool
+RTILoopbackFederate::getTimeAdvancePending()
+{
+    return _timeAdvancePending;
+}
+
+bool
+RTILoopbackFederate::queryFederateTime(SGTimeStamp& timeStamp)
+{
+    if (!_federation.valid()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not query federate time.");
+        return false;
+    }
+    return _federation->queryFederateTime(_federateHandle, timeStamp);
+}
+
+bool
+RTILoopbackFederate::queryLookahead(SGTimeStamp& timeStamp)
+{
+    if (!_federation.valid()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not query lookahead.");
+        return false;
+    }
+    return _federation->queryLookahead(_federateHandle, timeStamp);
+}
+
+bool
+RTILoopbackFederate::queryGALT(SGTimeStamp& timeStamp)
+{
+    if (!_federation.valid()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not query GALT.");
+        return false;
+    }
+    return _federation->queryGALT(_federateHandle, timeStamp);
+}
+
+bool
+RTILoopbackFederate::queryLITS(SGTimeStamp& timeStamp)
+{
+    if (!_federation.valid()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not query LITS.");
+        return false;
+    }
+    return _federation->queryLITS(_federateHandle, timeStamp);
+}
+
+RTILoopbackFederate::ProcessMessageResult
+RTILoopbackFederate::processMessage()
+{
+    // HLAFederate spins on this while waiting for a time advance grant,
+    // so rather sleep until one of the other federates gives us something
+    if (_timeAdvancePending)
+        return _receive(0.01);
+    return _receive(0);
+}
+
+RTILoopbackFederate::ProcessMessageResult
+RTILoopbackFederate::processMessages(const double& minimum, const double& maximum)
+{
+    // Wait up to minimum for the first message, then drain what is
+    // queued until the larger of both limits is reached
+    SGTimeStamp timeStamp = SGTimeStamp::now() + SGTimeStamp::fromSec(std::max(minimum, maximum));
+    ProcessMessageResult result = _receive(minimum);
+    while (result == ProcessMessagePending && SGTimeStamp::now() <= timeStamp)
+        result = _receive(0);
+    return result;
+}
+
+RTILoopbackObjectClass*
+RTILoopbackFederate::createObjectClass(const std::string& objectClassName, HLAObjectClass* hlaObjectClass)
+{
+    if (!_federation.valid()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not create object class at unconnected federate.");
+        return 0;
+    }
+    RTILoopbackFederation::Handle objectClassHandle;
+    objectClassHandle = _federation->getObjectClassHandle(objectClassName);
+    if (_objectClassMap.find(objectClassHandle) != _objectClassMap.end()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not create object class, object class already exists!");
+        return 0;
+    }
+    RTILoopbackObjectClass* rtiObjectClass;
+    rtiObjectClass = new RTILoopbackObjectClass(hlaObjectClass, objectClassHandle, this);
+    _objectClassMap[objectClassHandle] = rtiObjectClass;
+    return rtiObjectClass;
+}
+
+RTILoopbackInteractionClass*
+RTILoopbackFederate::createInteractionClass(const std::string& interactionClassName, HLAInteractionClass* interactionClass)
+{
+    if (!_federation.valid()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not create interaction class at unconnected federate.");
+        return 0;
+    }
+    RTILoopbackFederation::Handle interactionClassHandle;
+    interactionClassHandle = _federation->getInteractionClassHandle(interactionClassName);
+    if (_interactionClassMap.find(interactionClassHandle) != _interactionClassMap.end()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not create interaction class, interaction class already exists!");
+        return 0;
+    }
+    RTILoopbackInteractionClass* rtiInteractionClass;
+    rtiInteractionClass = new RTILoopbackInteractionClass(interactionClass, interactionClassHandle, this);
+    _interactionClassMap[interactionClassHandle] = rtiInteractionClass;
+    return rtiInteractionClass;
+}
+
+RTILoopbackObjectInstance*
+RTILoopbackFederate::getObjectInstance(const std::string& objectInstanceName)
+{
+    if (!_federation.valid()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not get object instance at unconnected federate.");
+        return 0;
+    }
+    RTILoopbackFederation::Handle objectHandle;
+    objectHandle = _federation->getObjectInstanceHandle(objectInstanceName);
+    ObjectInstanceMap::iterator i = _objectInstanceMap.find(objectHandle);
+    if (i == _objectInstanceMap.end()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not get object instance: ObjectInstance not found.");
+        return 0;
+    }
+    return i->second;
+}
+
+void
+RTILoopbackFederate::insertObjectInstance(RTILoopbackObjectInstance* objectInstance)
+{
+    _objectInstanceMap[objectInstance->getHandle()] = objectInstance;
+}
+
+RTILoopbackFederate::ProcessMessageResult
+RTILoopbackFederate::_receive(double timeout)
+{
+    if (!_federation.valid()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Processing messages at unconnected federate.");
+        return ProcessMessageFatal;
+    }
+    // Keep the federation, the user code called from dispatch might resign
+    SGSharedPtr<RTILoopbackFederation> federation = _federation;
+    RTILoopbackFederation::Handle federateHandle = _federateHandle;
+    SGSharedPtr<const RTILoopbackFederation::Message> message;
+    message = federation->receive(federateHandle, timeout);
+    if (!message.valid())
+        return ProcessMessageLast;
+    _dispatch(*message);
+    if (!_federation.valid() || !federation->hasMessages(federateHandle))
+        return ProcessMessageLast;
+    return ProcessMessagePending;
+}
+
+void
+RTILoopbackFederate::_dispatch(const RTILoopbackFederation::Message& message)
+{
+    switch (message._type) {
+    case RTILoopbackFederation::Message::DiscoverObjectInstance: {
+        ObjectClassMap::iterator i = _objectClassMap.find(message._classHandle);
+        if (i == _objectClassMap.end())
+            return;
+        if (!i->second.valid())
+            return;
+        SGSharedPtr<RTILoopbackObjectInstance> objectInstance;
+        objectInstance = new RTILoopbackObjectInstance(message._handle, message._name, 0, i->second, this);
+        _objectInstanceMap[message._handle] = objectInstance;
+        i->second->discoverInstance(objectInstance.get(), message._tag);
+        break;
+    }
+    case RTILoopbackFederation::Message::ReflectAttributeValues: {
+        ObjectInstanceMap::iterator i = _objectInstanceMap.find(message._handle);
+        if (i == _objectInstanceMap.end())
+            return;
+        if (!i->second.valid())
+            return;
+        i->second->reflectAttributeValues(message, _indexPool);
+        break;
+    }
+    case RTILoopbackFederation::Message::RemoveObjectInstance: {
+        ObjectInstanceMap::iterator i = _objectInstanceMap.find(message._handle);
+        if (i == _objectInstanceMap.end())
+            return;
+        if (i->second.valid())
+            i->second->removeInstance(message._tag);
+        _objectInstanceMap.erase(i);
+        break;
+    }
+    case RTILoopbackFederation::Message::ProvideAttributeValueUpdate: {
+        ObjectInstanceMap::iterator i = _objectInstanceMap.find(message._handle);
+        if (i == _objectInstanceMap.end())
+            return;
+        if (!i->second.valid())
+            return;
+        i->second->provideAttributeValueUpdate(message._values);
+        break;
+    }
+    case RTILoopbackFederation::Message::ReceiveInteraction: {
+        InteractionClassMap::iterator i = _interactionClassMap.find(message._handle);
+        if (i == _interactionClassMap.end())
+            return;
+        if (!i->second.valid())
+            return;
+        if (message._timeStamped)
+            i->second->receiveInteraction(message._values, message._timeStamp, message._tag, _parameterPool);
+        else
+            i->second->receiveInteraction(message._values, message._tag, _parameterPool);
+        break;
+    }
+    case RTILoopbackFederation::Message::StartRegistration: {
+        ObjectClassMap::iterator i = _objectClassMap.find(message._handle);
+        if (i == _objectClassMap.end())
+            return;
+        if (!i->second.valid())
+            return;
+        i->second->startRegistration();
+        break;
+    }
+    case RTILoopbackFederation::Message::StopRegistration: {
+        ObjectClassMap::iterator i = _objectClassMap.find(message._handle);
+        if (i == _objectClassMap.end())
+            return;
+        if (!i->second.valid())
+            return;
+        i->second->stopRegistration();
+        break;
+    }
+    case RTILoopbackFederation::Message::AnnounceSynchronizationPoint:
+        _pendingSyncLabels.insert(message._name);
+        break;
+    case RTILoopbackFederation::Message::FederationSynchronized:
+        _pendingSyncLabels.erase(message._name);
+        _syncronizedSyncLabels.insert(message._name);
+        break;
+    case RTILoopbackFederation::Message::TimeRegulationEnabled:
+        _timeRegulationEnabled = true;
+        SG_LOG(SG_NETWORK, SG_INFO, "RTI: timeRegulationEnabled: " << message._timeStamp);
+        break;
+    case RTILoopbackFederation::Message::TimeConstrainedEnabled:
+        _timeConstrainedEnabled = true;
+        SG_LOG(SG_NETWORK, SG_INFO, "RTI: timeConstrainedEnabled: " << message._timeStamp);
+        break;
+    case RTILoopbackFederation::Message::TimeAdvanceGrant:
+        _timeAdvancePending = false;
+        break;
+    }
+}
+
+}
@@ -0,0 +1,130 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifndef RTILoopbackFederate_hxx
+#define RTILoopbackFederate_hxx
+
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+
+#include "RTIFederate.hxx"
+#include "RTILoopbackFederation.hxx"
+#include "RTILoopbackInteractionClass.hxx"
+#include "RTILoopbackObjectClass.hxx"
+#include "RTILoopbackObjectInstance.hxx"
+
+namespace simgear {
+
+/// A federate of a federation execution within this process.
+/// Does not need any rti, the federates may run in the same or in
+/// different threads of one process.
+class RTILoopbackFederate : public RTIFederate {
+public:
+    RTILoopbackFederate(const std::list<std::string>& stringList);
+    virtual ~RTILoopbackFederate();
+
+    /// Create a federation execution
+    /// Semantically this methods should be static,
+    virtual FederationManagementResult createFederationExecution(const std::string& federation, const std::string& objectModel);
+    virtual FederationManagementResult destroyFederationExecution(const std::string& federation);
+
+    /// Join with federateName the federation execution federation
+    virtual FederationManagementResult join(const std::string& federateType, const std::string& federation);
+    virtual bool resign();
+    virtual bool getJoined() const;
+
+    /// Synchronization Point handling
+    virtual bool registerFederationSynchronizationPoint(const std::string& label, const RTIData& tag);
+    virtual bool getFederationSynchronizationPointAnnounced(const std::string& label);
+    virtual bool synchronizationPointAchieved(const std::string& label);
+    virtual bool getFederationSynchronized(const std::string& label);
+
+    /// Time management
+    virtual bool enableTimeConstrained();
+    virtual bool disableTimeConstrained();
+    virtual bool getTimeConstrainedEnabled();
+
+    virtual bool enableTimeRegulation(const SGTimeStamp& lookahead);
+    virtual bool disableTimeRegulation();
+    virtual bool modifyLookahead(const SGTimeStamp& timeStamp);
+    virtual bool getTimeRegulationEnabled();
+
+    virtual bool timeAdvanceRequest(const SGTimeStamp& timeStamp);
+    virtual bool timeAdvanceRequestAvailable(const SGTimeStamp& timeStamp);
+    virtual bool flushQueueRequest(const SGTimeStamp& timeStamp);
+    virtual bool getTimeAdvancePending();
+
+    virtual bool queryFederateTime(SGTimeStamp& timeStamp);
+    virtual bool queryLookahead(SGTimeStamp& timeStamp);
+    virtual bool queryGALT(SGTimeStamp& timeStamp);
+    virtual bool queryLITS(SGTimeStamp& timeStamp);
+
+    /// Process messages
+    virtual ProcessMessageResult processMessage();
+    virtual ProcessMessageResult processMessages(const double& minimum, const double& maximum);
+
+    virtual RTILoopbackObjectClass* createObjectClass(const std::string& name, HLAObjectClass* hlaObjectClass);
+    virtual RTILoopbackInteractionClass* createInteractionClass(const std::string& name, HLAInteractionClass* interactionClass);
+
+    virtual RTILoopbackObjectInstance* getObjectInstance(const std::string& name);
+    void insertObjectInstance(RTILoopbackObjectInstance* objectInstance);
+
+    /// The federation execution and our handle in there, zero if not joined
+    RTILoopbackFederation* getFederation() const
+    { return _federation.get(); }
+    RTILoopbackFederation::Handle getFederateHandle() const
+    { return _federateHandle; }
+
+private:
+    RTILoopbackFederate(const RTILoopbackFederate&);
+    RTILoopbackFederate& operator=(const RTILoopbackFederate&);
+
+    // Take at most one message, wait up to timeout seconds for it
+    ProcessMessageResult _receive(double timeout);
+    void _dispatch(const RTILoopbackFederation::Message& message);
+
+    SGSharedPtr<RTILoopbackFederation> _federation;
+    RTILoopbackFederation::Handle _federateHandle;
+
+    // All the sync labels we got an announcement for
+    std::set<std::string> _pendingSyncLabels;
+    std::set<std::string> _syncronizedSyncLabels;
+
+    // For attribute reflection, pool of indices
+    HLAIndexList _indexPool;
+    // For interaction reception, pool of parameter values
+    RTIIndexDataPairList _parameterPool;
+
+    typedef std::map<RTILoopbackFederation::Handle, SGSharedPtr<RTILoopbackObjectInstance> > ObjectInstanceMap;
+    ObjectInstanceMap _objectInstanceMap;
+
+    typedef std::map<RTILoopbackFederation::Handle, SGSharedPtr<RTILoopbackObjectClass> > ObjectClassMap;
+    ObjectClassMap _objectClassMap;
+
+    typedef std::map<RTILoopbackFederation::Handle, SGSharedPtr<RTILoopbackInteractionClass> > InteractionClassMap;
+    InteractionClassMap _interactionClassMap;
+
+    bool _timeRegulationEnabled;
+    bool _timeConstrainedEnabled;
+    bool _timeAdvancePending;
+};
+
+}
+
+#endif
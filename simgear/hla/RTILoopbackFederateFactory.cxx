@@ -0,0 +1,54 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include <simgear/compiler.h>
+
+#include "RTILoopbackFederateFactory.hxx"
+
+#include "RTILoopbackFederate.hxx"
+
+namespace simgear {
+
+RTILoopbackFederateFactory::RTILoopbackFederateFactory()
+{
+    _registerAtFactory();
+}
+
+RTILoopbackFederateFactory::~RTILoopbackFederateFactory()
+{
+}
+
+RTIFederate*
+RTILoopbackFederateFactory::create(const std::string& name, const std::list<std::string>& stringList) const
+{
+    if (name != "Loopback")
+        return 0;
+    return new RTILoopbackFederate(stringList);
+}
+
+const SGSharedPtr<RTILoopbackFederateFactory>&
+RTILoopbackFederateFactory::instance()
+{
+    static SGSharedPtr<RTILoopbackFederateFactory> federateFactory = new RTILoopbackFederateFactory;
+    return federateFactory;
+}
+
+}
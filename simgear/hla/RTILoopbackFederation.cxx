@@ -0,0 +1,897 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include <simgear/compiler.h>
+
+#include "RTILoopbackFederation.hxx"
+
+#include <sstream>
+
+#include "simgear/debug/logstream.hxx"
+
+namespace simgear {
+
+typedef std::map<std::string, SGSharedPtr<RTILoopbackFederation> > FederationExecutionMap;
+
+static SGMutex&
+federationExecutionMutex()
+{
+    static SGMutex mutex;
+    return mutex;
+}
+
+static FederationExecutionMap&
+federationExecutionMap()
+{
+    static FederationExecutionMap federationExecutionMap;
+    return federationExecutionMap;
+}
+
+RTILoopbackFederation::RTILoopbackFederation(const std::string& name) :
+    _name(name),
+    _nextFederateHandle(0),
+    _nextObjectInstanceHandle(0)
+{
+}
+
+RTILoopbackFederation::~RTILoopbackFederation()
+{
+}
+
+RTIFederate::FederationManagementResult
+RTILoopbackFederation::createFederationExecution(const std::string& name)
+{
+    SGGuard<SGMutex> guard(federationExecutionMutex());
+    FederationExecutionMap& federationExecutions = federationExecutionMap();
+    if (federationExecutions.find(name) != federationExecutions.end())
+        return RTIFederate::FederationManagementFail;
+    federationExecutions[name] = new RTILoopbackFederation(name);
+    return RTIFederate::FederationManagementSuccess;
+}
+
+RTIFederate::FederationManagementResult
+RTILoopbackFederation::destroyFederationExecution(const std::string& name)
+{
+    SGGuard<SGMutex> guard(federationExecutionMutex());
+    FederationExecutionMap& federationExecutions = federationExecutionMap();
+    FederationExecutionMap::iterator i = federationExecutions.find(name);
+    if (i == federationExecutions.end())
+        return RTIFederate::FederationManagementFail;
+    {
+        SGGuard<SGMutex> federationGuard(i->second->_mutex);
+        if (!i->second->_federates.empty())
+            return RTIFederate::FederationManagementFail;
+    }
+    federationExecutions.erase(i);
+    return RTIFederate::FederationManagementSuccess;
+}
+
+SGSharedPtr<RTILoopbackFederation>
+RTILoopbackFederation::getFederationExecution(const std::string& name)
+{
+    SGGuard<SGMutex> guard(federationExecutionMutex());
+    FederationExecutionMap& federationExecutions = federationExecutionMap();
+    FederationExecutionMap::iterator i = federationExecutions.find(name);
+    if (i == federationExecutions.end())
+        return 0;
+    return i->second;
+}
+
+RTILoopbackFederation::Handle
+RTILoopbackFederation::join(const std::string& federateType)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Handle federate = _nextFederateHandle++;
+    _federates[federate].reset(new Federate(federateType));
+    return federate;
+}
+
+void
+RTILoopbackFederation::resign(Handle federate)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f)
+        return;
+
+    // Delete what is left of the owned objects
+    std::list<Handle> ownedObjectInstances;
+    for (std::map<Handle, ObjectInstance>::const_iterator i = _objectInstances.begin();
+         i != _objectInstances.end(); ++i) {
+        if (i->second._owner == federate)
+            ownedObjectInstances.push_back(i->first);
+    }
+    for (std::list<Handle>::const_iterator i = ownedObjectInstances.begin();
+         i != ownedObjectInstances.end(); ++i)
+        _removeObjectInstance(*i, RTIData(), federate, 0);
+
+    std::set<Handle> objectClasses;
+    for (std::map<Handle, std::set<Handle> >::const_iterator i = f->_publishedAttributes.begin();
+         i != f->_publishedAttributes.end(); ++i)
+        objectClasses.insert(i->first);
+    for (std::map<Handle, std::set<Handle> >::const_iterator i = f->_subscribedAttributes.begin();
+         i != f->_subscribedAttributes.end(); ++i)
+        objectClasses.insert(i->first);
+
+    _federates.erase(federate);
+
+    for (std::set<Handle>::const_iterator i = objectClasses.begin(); i != objectClasses.end(); ++i)
+        _updateRegistration(*i);
+
+    // Nobody waits for this federate anymore
+    for (std::map<std::string, SynchronizationPoint>::iterator i = _synchronizationPoints.begin();
+         i != _synchronizationPoints.end(); ++i) {
+        i->second._announced.erase(federate);
+        i->second._pending.erase(federate);
+    }
+    _checkSynchronizationPoints();
+    _checkTimeAdvance();
+}
+
+RTILoopbackFederation::Handle
+RTILoopbackFederation::getObjectClassHandle(const std::string& name)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    NameHandleMap::const_iterator i = _objectClassHandles.find(name);
+    if (i != _objectClassHandles.end())
+        return i->second;
+    Handle objectClass = _objectClasses.size();
+    _objectClasses.push_back(Class());
+    _objectClasses.back()._name = name;
+    _objectClassHandles[name] = objectClass;
+    return objectClass;
+}
+
+RTILoopbackFederation::Handle
+RTILoopbackFederation::getAttributeHandle(Handle objectClass, const std::string& name)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    if (_objectClasses.size() <= objectClass)
+        return InvalidHandle;
+    NameHandleMap& attributes = _objectClasses[objectClass]._members;
+    NameHandleMap::const_iterator i = attributes.find(name);
+    if (i != attributes.end())
+        return i->second;
+    Handle attribute = attributes.size();
+    attributes[name] = attribute;
+    return attribute;
+}
+
+RTILoopbackFederation::Handle
+RTILoopbackFederation::getInteractionClassHandle(const std::string& name)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    NameHandleMap::const_iterator i = _interactionClassHandles.find(name);
+    if (i != _interactionClassHandles.end())
+        return i->second;
+    Handle interactionClass = _interactionClasses.size();
+    _interactionClasses.push_back(Class());
+    _interactionClasses.back()._name = name;
+    _interactionClassHandles[name] = interactionClass;
+    return interactionClass;
+}
+
+RTILoopbackFederation::Handle
+RTILoopbackFederation::getParameterHandle(Handle interactionClass, const std::string& name)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    if (_interactionClasses.size() <= interactionClass)
+        return InvalidHandle;
+    NameHandleMap& parameters = _interactionClasses[interactionClass]._members;
+    NameHandleMap::const_iterator i = parameters.find(name);
+    if (i != parameters.end())
+        return i->second;
+    Handle parameter = parameters.size();
+    parameters[name] = parameter;
+    return parameter;
+}
+
+void
+RTILoopbackFederation::publishObjectClass(Handle federate, Handle objectClass, const std::set<Handle>& attributes)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f)
+        return;
+    f->_publishedAttributes[objectClass] = attributes;
+    _updateRegistration(objectClass);
+}
+
+void
+RTILoopbackFederation::unpublishObjectClass(Handle federate, Handle objectClass)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f)
+        return;
+    f->_publishedAttributes.erase(objectClass);
+    _updateRegistration(objectClass);
+}
+
+void
+RTILoopbackFederation::subscribeObjectClass(Handle federate, Handle objectClass, const std::set<Handle>& attributes)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f)
+        return;
+    f->_subscribedAttributes[objectClass] = attributes;
+
+    // Tell about what is already there
+    for (std::map<Handle, ObjectInstance>::const_iterator i = _objectInstances.begin();
+         i != _objectInstances.end(); ++i) {
+        if (i->second._objectClass != objectClass || i->second._owner == federate)
+            continue;
+        _discoverObjectInstance(federate, i->first);
+    }
+
+    _updateRegistration(objectClass);
+}
+
+void
+RTILoopbackFederation::unsubscribeObjectClass(Handle federate, Handle objectClass)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f)
+        return;
+    f->_subscribedAttributes.erase(objectClass);
+    _updateRegistration(objectClass);
+}
+
+void
+RTILoopbackFederation::publishInteractionClass(Handle federate, Handle interactionClass)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f)
+        return;
+    f->_publishedInteractions.insert(interactionClass);
+}
+
+void
+RTILoopbackFederation::unpublishInteractionClass(Handle federate, Handle interactionClass)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f)
+        return;
+    f->_publishedInteractions.erase(interactionClass);
+}
+
+void
+RTILoopbackFederation::subscribeInteractionClass(Handle federate, Handle interactionClass)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f)
+        return;
+    f->_subscribedInteractions.insert(interactionClass);
+}
+
+void
+RTILoopbackFederation::unsubscribeInteractionClass(Handle federate, Handle interactionClass)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f)
+        return;
+    f->_subscribedInteractions.erase(interactionClass);
+}
+
+RTILoopbackFederation::Handle
+RTILoopbackFederation::registerObjectInstance(Handle federate, Handle objectClass, std::string& name)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f)
+        return InvalidHandle;
+    std::map<Handle, std::set<Handle> >::const_iterator published;
+    published = f->_publishedAttributes.find(objectClass);
+    if (published == f->_publishedAttributes.end()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not register object instance: Object class not published.");
+        return InvalidHandle;
+    }
+
+    Handle objectInstance = _nextObjectInstanceHandle++;
+    if (name.empty()) {
+        std::stringstream stream;
+        stream << "HLAobject_" << objectInstance;
+        name = stream.str();
+    }
+    if (_objectInstanceHandles.find(name) != _objectInstanceHandles.end()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not register object instance: Object instance name \""
+               << name << "\" already in use.");
+        return InvalidHandle;
+    }
+
+    ObjectInstance& o = _objectInstances[objectInstance];
+    o._name = name;
+    o._objectClass = objectClass;
+    o._owner = federate;
+    o._ownedAttributes = published->second;
+    _objectInstanceHandles[name] = objectInstance;
+
+    for (std::map<Handle, std::unique_ptr<Federate> >::const_iterator i = _federates.begin();
+         i != _federates.end(); ++i) {
+        if (i->first == federate)
+            continue;
+        if (i->second->_subscribedAttributes.find(objectClass) == i->second->_subscribedAttributes.end())
+            continue;
+        _discoverObjectInstance(i->first, objectInstance);
+    }
+
+    return objectInstance;
+}
+
+RTILoopbackFederation::Handle
+RTILoopbackFederation::getObjectInstanceHandle(const std::string& name)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    NameHandleMap::const_iterator i = _objectInstanceHandles.find(name);
+    if (i == _objectInstanceHandles.end())
+        return InvalidHandle;
+    return i->second;
+}
+
+bool
+RTILoopbackFederation::isAttributeOwnedByFederate(Handle federate, Handle objectInstance, Handle attribute)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    ObjectInstance* o = _getObjectInstance(objectInstance);
+    if (!o)
+        return false;
+    if (o->_owner != federate)
+        return false;
+    return o->_ownedAttributes.find(attribute) != o->_ownedAttributes.end();
+}
+
+bool
+RTILoopbackFederation::updateAttributeValues(Handle federate, Handle objectInstance, HandleDataPairList& values,
+                                             const RTIData& tag, const SGTimeStamp* timeStamp)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    ObjectInstance* o = _getObjectInstance(objectInstance);
+    if (!o || o->_owner != federate) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not update attribute values: Object instance not owned.");
+        return false;
+    }
+    if (!_checkTimeStamp(federate, timeStamp))
+        return false;
+
+    SGSharedPtr<Message> message = new Message(Message::ReflectAttributeValues, objectInstance);
+    message->_values.swap(values);
+    message->_tag = tag;
+    if (timeStamp) {
+        message->_timeStamped = true;
+        message->_timeStamp = *timeStamp;
+    }
+
+    for (std::map<Handle, std::unique_ptr<Federate> >::const_iterator i = _federates.begin();
+         i != _federates.end(); ++i) {
+        if (i->first == federate)
+            continue;
+        const Federate& f = *i->second;
+        if (f._knownObjectInstances.find(objectInstance) == f._knownObjectInstances.end())
+            continue;
+        std::map<Handle, std::set<Handle> >::const_iterator subscribed;
+        subscribed = f._subscribedAttributes.find(o->_objectClass);
+        if (subscribed == f._subscribedAttributes.end())
+            continue;
+        // Only bother the federate if it is interested in any of the values,
+        // it filters the single values on its own
+        for (HandleDataPairList::const_iterator j = message->_values.begin();
+             j != message->_values.end(); ++j) {
+            if (subscribed->second.find(j->first) == subscribed->second.end())
+                continue;
+            _send(i->first, federate, message);
+            break;
+        }
+    }
+    return true;
+}
+
+bool
+RTILoopbackFederation::deleteObjectInstance(Handle federate, Handle objectInstance, const RTIData& tag,
+                                            const SGTimeStamp* timeStamp)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    ObjectInstance* o = _getObjectInstance(objectInstance);
+    if (!o || o->_owner != federate) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not delete object instance: Delete privilege not held.");
+        return false;
+    }
+    if (!_checkTimeStamp(federate, timeStamp))
+        return false;
+    _removeObjectInstance(objectInstance, tag, federate, timeStamp);
+    return true;
+}
+
+void
+RTILoopbackFederation::localDeleteObjectInstance(Handle federate, Handle objectInstance)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f)
+        return;
+    f->_knownObjectInstances.erase(objectInstance);
+}
+
+void
+RTILoopbackFederation::requestObjectAttributeValueUpdate(Handle federate, Handle objectInstance,
+                                                         const std::set<Handle>& attributes)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    ObjectInstance* o = _getObjectInstance(objectInstance);
+    if (!o || o->_owner == federate)
+        return;
+    SGSharedPtr<Message> message = new Message(Message::ProvideAttributeValueUpdate, objectInstance);
+    for (std::set<Handle>::const_iterator i = attributes.begin(); i != attributes.end(); ++i) {
+        if (o->_ownedAttributes.find(*i) == o->_ownedAttributes.end())
+            continue;
+        message->_values.push_back(HandleDataPair(*i, RTIData()));
+    }
+    if (message->_values.empty())
+        return;
+    _queue(o->_owner, message);
+}
+
+bool
+RTILoopbackFederation::sendInteraction(Handle federate, Handle interactionClass, HandleDataPairList& values,
+                                       const RTIData& tag, const SGTimeStamp* timeStamp)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f)
+        return false;
+    if (f->_publishedInteractions.find(interactionClass) == f->_publishedInteractions.end()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not send interaction: Interaction class not published.");
+        return false;
+    }
+    if (!_checkTimeStamp(federate, timeStamp))
+        return false;
+
+    SGSharedPtr<Message> message = new Message(Message::ReceiveInteraction, interactionClass);
+    message->_values.swap(values);
+    message->_tag = tag;
+    if (timeStamp) {
+        message->_timeStamped = true;
+        message->_timeStamp = *timeStamp;
+    }
+
+    for (std::map<Handle, std::unique_ptr<Federate> >::const_iterator i = _federates.begin();
+         i != _federates.end(); ++i) {
+        if (i->first == federate)
+            continue;
+        const std::set<Handle>& subscribed = i->second->_subscribedInteractions;
+        if (subscribed.find(interactionClass) == subscribed.end())
+            continue;
+        _send(i->first, federate, message);
+    }
+    return true;
+}
+
+bool
+RTILoopbackFederation::registerFederationSynchronizationPoint(Handle federate, const std::string& label,
+                                                              const RTIData& tag)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    if (!_getFederate(federate))
+        return false;
+    if (_synchronizationPoints.find(label) != _synchronizationPoints.end())
+        return false;
+
+    SynchronizationPoint& synchronizationPoint = _synchronizationPoints[label];
+    SGSharedPtr<Message> message = new Message(Message::AnnounceSynchronizationPoint);
+    message->_name = label;
+    message->_tag = tag;
+    for (std::map<Handle, std::unique_ptr<Federate> >::const_iterator i = _federates.begin();
+         i != _federates.end(); ++i) {
+        synchronizationPoint._announced.insert(i->first);
+        synchronizationPoint._pending.insert(i->first);
+        _queue(i->first, message);
+    }
+    return true;
+}
+
+bool
+RTILoopbackFederation::synchronizationPointAchieved(Handle federate, const std::string& label)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    std::map<std::string, SynchronizationPoint>::iterator i = _synchronizationPoints.find(label);
+    if (i == _synchronizationPoints.end())
+        return false;
+    if (i->second._pending.erase(federate) == 0)
+        return false;
+    _checkSynchronizationPoints();
+    return true;
+}
+
+bool
+RTILoopbackFederation::enableTimeConstrained(Handle federate)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f || f->_timeConstrained)
+        return false;
+    f->_timeConstrained = true;
+    SGSharedPtr<Message> message = new Message(Message::TimeConstrainedEnabled);
+    message->_timeStamp = f->_time;
+    _queue(federate, message);
+    return true;
+}
+
+bool
+RTILoopbackFederation::disableTimeConstrained(Handle federate)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f || !f->_timeConstrained)
+        return false;
+    f->_timeConstrained = false;
+    // What is still held back is delivered in receive order now
+    while (!f->_timeStampQueue.empty()) {
+        _queue(federate, f->_timeStampQueue.begin()->second);
+        f->_timeStampQueue.erase(f->_timeStampQueue.begin());
+    }
+    _checkTimeAdvance();
+    return true;
+}
+
+bool
+RTILoopbackFederation::enableTimeRegulation(Handle federate, const SGTimeStamp& lookahead)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f || f->_timeRegulating)
+        return false;
+    // Do not start in the past of any constrained federate
+    for (std::map<Handle, std::unique_ptr<Federate> >::const_iterator i = _federates.begin();
+         i != _federates.end(); ++i) {
+        if (i->first == federate || !i->second->_timeConstrained)
+            continue;
+        if (f->_time < i->second->_time)
+            f->_time = i->second->_time;
+    }
+    f->_timeRegulating = true;
+    f->_lookahead = lookahead;
+    SGSharedPtr<Message> message = new Message(Message::TimeRegulationEnabled);
+    message->_timeStamp = f->_time;
+    _queue(federate, message);
+    return true;
+}
+
+bool
+RTILoopbackFederation::disableTimeRegulation(Handle federate)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f || !f->_timeRegulating)
+        return false;
+    f->_timeRegulating = false;
+    _checkTimeAdvance();
+    return true;
+}
+
+bool
+RTILoopbackFederation::modifyLookahead(Handle federate, const SGTimeStamp& lookahead)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f || !f->_timeRegulating)
+        return false;
+    f->_lookahead = lookahead;
+    _checkTimeAdvance();
+    return true;
+}
+
+bool
+RTILoopbackFederation::timeAdvanceRequest(Handle federate, const SGTimeStamp& timeStamp, bool available)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f || f->_timeAdvancePending)
+        return false;
+    if (timeStamp < f->_time) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not advance time: Requested time is in the past.");
+        return false;
+    }
+    f->_timeAdvancePending = true;
+    f->_timeAdvanceAvailable = available;
+    f->_requestedTime = timeStamp;
+    _checkTimeAdvance();
+    return true;
+}
+
+bool
+RTILoopbackFederation::queryFederateTime(Handle federate, SGTimeStamp& timeStamp)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f)
+        return false;
+    timeStamp = f->_time;
+    return true;
+}
+
+bool
+RTILoopbackFederation::queryLookahead(Handle federate, SGTimeStamp& timeStamp)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f)
+        return false;
+    timeStamp = f->_lookahead;
+    return true;
+}
+
+bool
+RTILoopbackFederation::queryGALT(Handle federate, SGTimeStamp& timeStamp)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    return _getGALT(federate, timeStamp);
+}
+
+bool
+RTILoopbackFederation::queryLITS(Handle federate, SGTimeStamp& timeStamp)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f || f->_timeStampQueue.empty())
+        return false;
+    timeStamp = f->_timeStampQueue.begin()->first;
+    return true;
+}
+
+SGSharedPtr<const RTILoopbackFederation::Message>
+RTILoopbackFederation::receive(Handle federate, double timeout)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f)
+        return 0;
+    if (f->_queue.empty() && 0 < timeout) {
+        SGTimeStamp end = SGTimeStamp::now() + SGTimeStamp::fromSec(timeout);
+        do {
+            SGTimeStamp now = SGTimeStamp::now();
+            if (end <= now)
+                break;
+            f->_condition.wait(_mutex, unsigned((end - now).toMSecs()) + 1);
+        } while (f->_queue.empty());
+    }
+    if (f->_queue.empty())
+        return 0;
+    SGSharedPtr<const Message> message;
+    message.swap(f->_queue.front());
+    f->_queue.pop_front();
+    return message;
+}
+
+bool
+RTILoopbackFederation::hasMessages(Handle federate)
+{
+    SGGuard<SGMutex> guard(_mutex);
+    Federate* f = _getFederate(federate);
+    if (!f)
+        return false;
+    return !f->_queue.empty();
+}
+
+RTILoopbackFederation::Federate*
+RTILoopbackFederation::_getFederate(Handle federate)
+{
+    std::map<Handle, std::unique_ptr<Federate> >::const_iterator i = _federates.find(federate);
+    if (i == _federates.end())
+        return 0;
+    return i->second.get();
+}
+
+RTILoopbackFederation::ObjectInstance*
+RTILoopbackFederation::_getObjectInstance(Handle objectInstance)
+{
+    std::map<Handle, ObjectInstance>::iterator i = _objectInstances.find(objectInstance);
+    if (i == _objectInstances.end())
+        return 0;
+    return &i->second;
+}
+
+void
+RTILoopbackFederation::_queue(Handle federate, const Message* message)
+{
+    Federate* f = _getFederate(federate);
+    if (!f)
+        return;
+    f->_queue.push_back(message);
+    f->_condition.signal();
+}
+
+void
+RTILoopbackFederation::_send(Handle federate, Handle sender, const Message* message)
+{
+    Federate* f = _getFederate(federate);
+    Federate* s = _getFederate(sender);
+    if (!f || !s)
+        return;
+    // Time stamp order only happens between a regulating sender and a
+    // constrained receiver, everything else is receive order
+    if (!message->_timeStamped || !s->_timeRegulating || !f->_timeConstrained
+        || message->_timeStamp <= f->_time) {
+        _queue(federate, message);
+        return;
+    }
+    f->_timeStampQueue.insert(std::make_pair(message->_timeStamp, SGSharedPtr<const Message>(message)));
+}
+
+bool
+RTILoopbackFederation::_checkTimeStamp(Handle federate, const SGTimeStamp* timeStamp)
+{
+    if (!timeStamp)
+        return true;
+    Federate* f = _getFederate(federate);
+    if (!f || !f->_timeRegulating)
+        return true;
+    // While advancing, the other federates were already promised that
+    // nothing earlier than the requested time plus lookahead is sent.
+    const SGTimeStamp& time = f->_timeAdvancePending ? f->_requestedTime : f->_time;
+    if (*timeStamp < time + f->_lookahead) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Invalid federation time: The time stamp is within the lookahead.");
+        return false;
+    }
+    return true;
+}
+
+void
+RTILoopbackFederation::_discoverObjectInstance(Handle federate, Handle objectInstance)
+{
+    Federate* f = _getFederate(federate);
+    ObjectInstance* o = _getObjectInstance(objectInstance);
+    if (!f || !o)
+        return;
+    if (!f->_knownObjectInstances.insert(objectInstance).second)
+        return;
+    SGSharedPtr<Message> message = new Message(Message::DiscoverObjectInstance, objectInstance);
+    message->_classHandle = o->_objectClass;
+    message->_name = o->_name;
+    _queue(federate, message);
+}
+
+void
+RTILoopbackFederation::_removeObjectInstance(Handle objectInstance, const RTIData& tag, Handle sender,
+                                             const SGTimeStamp* timeStamp)
+{
+    std::map<Handle, ObjectInstance>::iterator o = _objectInstances.find(objectInstance);
+    if (o == _objectInstances.end())
+        return;
+
+    SGSharedPtr<Message> message = new Message(Message::RemoveObjectInstance, objectInstance);
+    message->_tag = tag;
+    if (timeStamp) {
+        message->_timeStamped = true;
+        message->_timeStamp = *timeStamp;
+    }
+    for (std::map<Handle, std::unique_ptr<Federate> >::const_iterator i = _federates.begin();
+         i != _federates.end(); ++i) {
+        if (i->second->_knownObjectInstances.erase(objectInstance) == 0)
+            continue;
+        _send(i->first, sender, message);
+    }
+
+    _objectInstanceHandles.erase(o->second._name);
+    _objectInstances.erase(o);
+}
+
+void
+RTILoopbackFederation::_updateRegistration(Handle objectClass)
+{
+    for (std::map<Handle, std::unique_ptr<Federate> >::const_iterator i = _federates.begin();
+         i != _federates.end(); ++i) {
+        Federate& f = *i->second;
+        bool published = f._publishedAttributes.find(objectClass) != f._publishedAttributes.end();
+        bool subscribed = false;
+        for (std::map<Handle, std::unique_ptr<Federate> >::const_iterator j = _federates.begin();
+             published && !subscribed && j != _federates.end(); ++j) {
+            if (i->first == j->first)
+                continue;
+            subscribed = j->second->_subscribedAttributes.find(objectClass) != j->second->_subscribedAttributes.end();
+        }
+        bool started = f._registrationStarted.find(objectClass) != f._registrationStarted.end();
+
+        if (published && subscribed && !started) {
+            f._registrationStarted.insert(objectClass);
+            _queue(i->first, new Message(Message::StartRegistration, objectClass));
+        } else if (started && !(published && subscribed)) {
+            f._registrationStarted.erase(objectClass);
+            if (published)
+                _queue(i->first, new Message(Message::StopRegistration, objectClass));
+        }
+    }
+}
+
+void
+RTILoopbackFederation::_checkSynchronizationPoints()
+{
+    std::map<std::string, SynchronizationPoint>::iterator i = _synchronizationPoints.begin();
+    while (i != _synchronizationPoints.end()) {
+        if (!i->second._pending.empty()) {
+            ++i;
+            continue;
+        }
+        SGSharedPtr<Message> message = new Message(Message::FederationSynchronized);
+        message->_name = i->first;
+        for (std::set<Handle>::const_iterator j = i->second._announced.begin();
+             j != i->second._announced.end(); ++j)
+            _queue(*j, message);
+        _synchronizationPoints.erase(i++);
+    }
+}
+
+bool
+RTILoopbackFederation::_getGALT(Handle federate, SGTimeStamp& timeStamp)
+{
+    // The least time any other regulating federate may still send messages for
+    bool found = false;
+    for (std::map<Handle, std::unique_ptr<Federate> >::const_iterator i = _federates.begin();
+         i != _federates.end(); ++i) {
+        if (i->first == federate)
+            continue;
+        const Federate& f = *i->second;
+        if (!f._timeRegulating)
+            continue;
+        SGTimeStamp time = f._timeAdvancePending ? f._requestedTime : f._time;
+        time += f._lookahead;
+        if (!found || time < timeStamp)
+            timeStamp = time;
+        found = true;
+    }
+    return found;
+}
+
+void
+RTILoopbackFederation::_checkTimeAdvance()
+{
+    for (std::map<Handle, std::unique_ptr<Federate> >::const_iterator i = _federates.begin();
+         i != _federates.end(); ++i) {
+        Federate& f = *i->second;
+        if (!f._timeAdvancePending)
+            continue;
+
+        const SGTimeStamp& time = f._requestedTime;
+        SGTimeStamp galt;
+        if (f._timeConstrained && _getGALT(i->first, galt)) {
+            if (galt < time)
+                continue;
+            if (galt == time && !f._timeAdvanceAvailable)
+                continue;
+        }
+
+        f._time = time;
+        f._timeAdvancePending = false;
+        while (!f._timeStampQueue.empty() && f._timeStampQueue.begin()->first <= time) {
+            _queue(i->first, f._timeStampQueue.begin()->second);
+            f._timeStampQueue.erase(f._timeStampQueue.begin());
+        }
+        SGSharedPtr<Message> message = new Message(Message::TimeAdvanceGrant);
+        message->_timeStamp = time;
+        _queue(i->first, message);
+    }
+}
+
+}
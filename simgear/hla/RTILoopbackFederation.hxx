@@ -0,0 +1,241 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifndef RTILoopbackFederation_hxx
+#define RTILoopbackFederation_hxx
+
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "simgear/structure/SGReferenced.hxx"
+#include "simgear/structure/SGSharedPtr.hxx"
+#include "simgear/threads/SGGuard.hxx"
+#include "simgear/threads/SGThread.hxx"
+#include "simgear/timing/timestamp.hxx"
+#include "RTIData.hxx"
+#include "RTIFederate.hxx"
+
+namespace simgear {
+
+/// The rti side of a federation execution that only exists within this
+/// process. Federates may live in different threads, every method is
+/// thread safe. Messages for a federate are queued until that federate
+/// fetches them with receive() from its own thread.
+class RTILoopbackFederation : public SGReferenced {
+public:
+    typedef unsigned Handle;
+    enum { InvalidHandle = ~0u };
+
+    typedef std::pair<Handle, RTIData> HandleDataPair;
+    typedef std::list<HandleDataPair> HandleDataPairList;
+
+    /// A callback for a federate. The same message is shared by all
+    /// federates receiving it and must not be changed.
+    struct Message : public SGReferenced {
+        enum Type {
+            DiscoverObjectInstance,
+            ReflectAttributeValues,
+            RemoveObjectInstance,
+            ProvideAttributeValueUpdate,
+            ReceiveInteraction,
+            StartRegistration,
+            StopRegistration,
+            AnnounceSynchronizationPoint,
+            FederationSynchronized,
+            TimeRegulationEnabled,
+            TimeConstrainedEnabled,
+            TimeAdvanceGrant
+        };
+        Message(Type type, Handle handle = InvalidHandle) :
+            _type(type), _handle(handle), _classHandle(InvalidHandle), _timeStamped(false)
+        { }
+
+        Type _type;
+        /// The object instance, object class or interaction class
+        Handle _handle;
+        /// The object class of a discovered object instance
+        Handle _classHandle;
+        /// Object instance name or synchronization point label
+        std::string _name;
+        RTIData _tag;
+        bool _timeStamped;
+        SGTimeStamp _timeStamp;
+        /// Attribute or parameter values, or just the attribute handles
+        HandleDataPairList _values;
+    };
+
+    ~RTILoopbackFederation();
+
+    /// Federation executions are kept by name until they are destroyed
+    static RTIFederate::FederationManagementResult createFederationExecution(const std::string& name);
+    static RTIFederate::FederationManagementResult destroyFederationExecution(const std::string& name);
+    static SGSharedPtr<RTILoopbackFederation> getFederationExecution(const std::string& name);
+
+    const std::string& getName() const
+    { return _name; }
+
+    Handle join(const std::string& federateType);
+    void resign(Handle federate);
+
+    /// Handles are assigned on first use, the object model is not checked
+    Handle getObjectClassHandle(const std::string& name);
+    Handle getAttributeHandle(Handle objectClass, const std::string& name);
+    Handle getInteractionClassHandle(const std::string& name);
+    Handle getParameterHandle(Handle interactionClass, const std::string& name);
+
+    void publishObjectClass(Handle federate, Handle objectClass, const std::set<Handle>& attributes);
+    void unpublishObjectClass(Handle federate, Handle objectClass);
+    void subscribeObjectClass(Handle federate, Handle objectClass, const std::set<Handle>& attributes);
+    void unsubscribeObjectClass(Handle federate, Handle objectClass);
+
+    void publishInteractionClass(Handle federate, Handle interactionClass);
+    void unpublishInteractionClass(Handle federate, Handle interactionClass);
+    void subscribeInteractionClass(Handle federate, Handle interactionClass);
+    void unsubscribeInteractionClass(Handle federate, Handle interactionClass);
+
+    Handle registerObjectInstance(Handle federate, Handle objectClass, std::string& name);
+    Handle getObjectInstanceHandle(const std::string& name);
+    bool isAttributeOwnedByFederate(Handle federate, Handle objectInstance, Handle attribute);
+
+    /// The time stamp is 0 for receive order messages
+    bool updateAttributeValues(Handle federate, Handle objectInstance, HandleDataPairList& values,
+                               const RTIData& tag, const SGTimeStamp* timeStamp);
+    bool deleteObjectInstance(Handle federate, Handle objectInstance, const RTIData& tag,
+                              const SGTimeStamp* timeStamp);
+    void localDeleteObjectInstance(Handle federate, Handle objectInstance);
+    void requestObjectAttributeValueUpdate(Handle federate, Handle objectInstance,
+                                           const std::set<Handle>& attributes);
+    bool sendInteraction(Handle federate, Handle interactionClass, HandleDataPairList& values,
+                         const RTIData& tag, const SGTimeStamp* timeStamp);
+
+    bool registerFederationSynchronizationPoint(Handle federate, const std::string& label, const RTIData& tag);
+    bool synchronizationPointAchieved(Handle federate, const std::string& label);
+
+    bool enableTimeConstrained(Handle federate);
+    bool disableTimeConstrained(Handle federate);
+    bool enableTimeRegulation(Handle federate, const SGTimeStamp& lookahead);
+    bool disableTimeRegulation(Handle federate);
+    bool modifyLookahead(Handle federate, const SGTimeStamp& lookahead);
+
+    /// A grant for available also allows messages at the granted time
+    bool timeAdvanceRequest(Handle federate, const SGTimeStamp& timeStamp, bool available);
+    bool queryFederateTime(Handle federate, SGTimeStamp& timeStamp);
+    bool queryLookahead(Handle federate, SGTimeStamp& timeStamp);
+    bool queryGALT(Handle federate, SGTimeStamp& timeStamp);
+    bool queryLITS(Handle federate, SGTimeStamp& timeStamp);
+
+    /// Take the next message for federate, wait at most timeout seconds
+    /// for one if there is none.
+    SGSharedPtr<const Message> receive(Handle federate, double timeout);
+    bool hasMessages(Handle federate);
+
+private:
+    RTILoopbackFederation(const std::string& name);
+
+    RTILoopbackFederation(const RTILoopbackFederation&);
+    RTILoopbackFederation& operator=(const RTILoopbackFederation&);
+
+    struct Federate {
+        Federate(const std::string& type) :
+            _type(type),
+            _timeConstrained(false),
+            _timeRegulating(false),
+            _timeAdvancePending(false),
+            _timeAdvanceAvailable(false)
+        { }
+
+        std::string _type;
+
+        std::list<SGSharedPtr<const Message> > _queue;
+        /// Time stamp order messages not yet granted
+        std::multimap<SGTimeStamp, SGSharedPtr<const Message> > _timeStampQueue;
+        SGWaitCondition _condition;
+
+        std::map<Handle, std::set<Handle> > _publishedAttributes;
+        std::map<Handle, std::set<Handle> > _subscribedAttributes;
+        std::set<Handle> _publishedInteractions;
+        std::set<Handle> _subscribedInteractions;
+        /// Object classes this federate was told to register instances of
+        std::set<Handle> _registrationStarted;
+        std::set<Handle> _knownObjectInstances;
+
+        bool _timeConstrained;
+        bool _timeRegulating;
+        bool _timeAdvancePending;
+        bool _timeAdvanceAvailable;
+        SGTimeStamp _time;
+        SGTimeStamp _lookahead;
+        SGTimeStamp _requestedTime;
+    };
+
+    struct ObjectInstance {
+        std::string _name;
+        Handle _objectClass;
+        Handle _owner;
+        std::set<Handle> _ownedAttributes;
+    };
+
+    struct SynchronizationPoint {
+        std::set<Handle> _announced;
+        std::set<Handle> _pending;
+    };
+
+    typedef std::map<std::string, Handle> NameHandleMap;
+    struct Class {
+        std::string _name;
+        NameHandleMap _members;
+    };
+
+    Federate* _getFederate(Handle federate);
+    ObjectInstance* _getObjectInstance(Handle objectInstance);
+
+    void _queue(Handle federate, const Message* message);
+    void _send(Handle federate, Handle sender, const Message* message);
+    bool _checkTimeStamp(Handle federate, const SGTimeStamp* timeStamp);
+    void _discoverObjectInstance(Handle federate, Handle objectInstance);
+    void _removeObjectInstance(Handle objectInstance, const RTIData& tag, Handle sender, const SGTimeStamp* timeStamp);
+    void _updateRegistration(Handle objectClass);
+    void _checkSynchronizationPoints();
+    bool _getGALT(Handle federate, SGTimeStamp& timeStamp);
+    void _checkTimeAdvance();
+
+    std::string _name;
+
+    SGMutex _mutex;
+
+    Handle _nextFederateHandle;
+    std::map<Handle, std::unique_ptr<Federate> > _federates;
+
+    NameHandleMap _objectClassHandles;
+    std::vector<Class> _objectClasses;
+    NameHandleMap _interactionClassHandles;
+    std::vector<Class> _interactionClasses;
+
+    Handle _nextObjectInstanceHandle;
+    std::map<Handle, ObjectInstance> _objectInstances;
+    NameHandleMap _objectInstanceHandles;
+
+    std::map<std::string, SynchronizationPoint> _synchronizationPoints;
+};
+
+}
+
+#endif
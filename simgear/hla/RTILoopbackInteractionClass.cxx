@@ -0,0 +1,212 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include <simgear/compiler.h>
+
+#include "RTILoopbackInteractionClass.hxx"
+
+#include "simgear/debug/logstream.hxx"
+#include "RTILoopbackFederate.hxx"
+
+namespace simgear {
+
+RTILoopbackInteractionClass::RTILoopbackInteractionClass(HLAInteractionClass* interactionClass,
+                                                         RTILoopbackFederation::Handle handle,
+                                                         RTILoopbackFederate* federate) :
+    RTIInteractionClass(interactionClass),
+    _handle(handle),
+    _federate(federate)
+{
+}
+
+RTILoopbackInteractionClass::~RTILoopbackInteractionClass()
+{
+}
+
+bool
+RTILoopbackInteractionClass::resolveParameterIndex(const std::string& name, unsigned index)
+{
+    SGSharedPtr<RTILoopbackFederate> federate = _federate.lock();
+    if (!federate.valid() || !federate->getJoined()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not get interaction class parameter: Federate not joined.");
+        return false;
+    }
+
+    if (index != _parameterHandleVector.size()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Resolving needs to happen in growing index order!");
+        return false;
+    }
+
+    RTILoopbackFederation::Handle parameterHandle;
+    parameterHandle = federate->getFederation()->getParameterHandle(_handle, name);
+    if (parameterHandle == RTILoopbackFederation::InvalidHandle) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not get interaction class parameter \"" << name << "\".");
+        return false;
+    }
+    if (getParameterIndex(parameterHandle) != ~0u) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Resolving parameterIndex for parameter \"" << name << "\" twice!");
+        return false;
+    }
+
+    if (_parameterIndexVector.size() <= parameterHandle)
+        _parameterIndexVector.resize(parameterHandle + 1, ~0u);
+    _parameterIndexVector[parameterHandle] = index;
+    _parameterHandleVector.push_back(parameterHandle);
+
+    return true;
+}
+
+bool
+RTILoopbackInteractionClass::publish()
+{
+    SGSharedPtr<RTILoopbackFederate> federate = _federate.lock();
+    if (!federate.valid() || !federate->getJoined()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not publish interaction class: Federate not joined.");
+        return false;
+    }
+    federate->getFederation()->publishInteractionClass(federate->getFederateHandle(), _handle);
+    return true;
+}
+
+bool
+RTILoopbackInteractionClass::unpublish()
+{
+    SGSharedPtr<RTILoopbackFederate> federate = _federate.lock();
+    if (!federate.valid() || !federate->getJoined()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not unpublish interaction class: Federate not joined.");
+        return false;
+    }
+    federate->getFederation()->unpublishInteractionClass(federate->getFederateHandle(), _handle);
+    return true;
+}
+
+bool
+RTILoopbackInteractionClass::subscribe(bool)
+{
+    SGSharedPtr<RTILoopbackFederate> federate = _federate.lock();
+    if (!federate.valid() || !federate->getJoined()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not subscribe interaction class: Federate not joined.");
+        return false;
+    }
+    federate->getFederation()->subscribeInteractionClass(federate->getFederateHandle(), _handle);
+    return true;
+}
+
+bool
+RTILoopbackInteractionClass::unsubscribe()
+{
+    SGSharedPtr<RTILoopbackFederate> federate = _federate.lock();
+    if (!federate.valid() || !federate->getJoined()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not unsubscribe interaction class: Federate not joined.");
+        return false;
+    }
+    federate->getFederation()->unsubscribeInteractionClass(federate->getFederateHandle(), _handle);
+    return true;
+}
+
+bool
+RTILoopbackInteractionClass::send(const RTIIndexDataPairList& parameters, const RTIData& tag)
+{
+    return _send(parameters, 0, tag);
+}
+
+bool
+RTILoopbackInteractionClass::send(const RTIIndexDataPairList& parameters, const SGTimeStamp& timeStamp,
+                                  const RTIData& tag)
+{
+    return _send(parameters, &timeStamp, tag);
+}
+
+void
+RTILoopbackInteractionClass::receiveInteraction(const RTILoopbackFederation::HandleDataPairList& values,
+                                                const RTIData& tag, RTIIndexDataPairList& parameterPool)
+{
+    RTIIndexDataPairList parameters;
+    _collectParameters(parameters, values, parameterPool);
+    RTIInteractionClass::receiveInteraction(parameters, tag);
+
+    // Drop the borrowed data and return the parameters to the pool
+    for (RTIIndexDataPairList::iterator i = parameters.begin(); i != parameters.end(); ++i)
+        i->second.clear();
+    parameterPool.splice(parameterPool.end(), parameters);
+}
+
+void
+RTILoopbackInteractionClass::receiveInteraction(const RTILoopbackFederation::HandleDataPairList& values,
+                                                const SGTimeStamp& timeStamp, const RTIData& tag,
+                                                RTIIndexDataPairList& parameterPool)
+{
+    RTIIndexDataPairList parameters;
+    _collectParameters(parameters, values, parameterPool);
+    RTIInteractionClass::receiveInteraction(parameters, timeStamp, tag);
+
+    // Drop the borrowed data and return the parameters to the pool
+    for (RTIIndexDataPairList::iterator i = parameters.begin(); i != parameters.end(); ++i)
+        i->second.clear();
+    parameterPool.splice(parameterPool.end(), parameters);
+}
+
+bool
+RTILoopbackInteractionClass::_send(const RTIIndexDataPairList& parameters, const SGTimeStamp* timeStamp,
+                                   const RTIData& tag)
+{
+    SGSharedPtr<RTILoopbackFederate> federate = _federate.lock();
+    if (!federate.valid() || !federate->getJoined()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not send interaction: Federate not joined.");
+        return false;
+    }
+
+    RTILoopbackFederation::HandleDataPairList values;
+    for (RTIIndexDataPairList::const_iterator i = parameters.begin(); i != parameters.end(); ++i) {
+        RTILoopbackFederation::Handle parameterHandle = getParameterHandle(i->first);
+        if (parameterHandle == RTILoopbackFederation::InvalidHandle) {
+            SG_LOG(SG_NETWORK, SG_WARN, "RTILoopbackInteractionClass::send(): Invalid parameter index!");
+            continue;
+        }
+        values.push_back(RTILoopbackFederation::HandleDataPair(parameterHandle, i->second));
+    }
+
+    return federate->getFederation()->sendInteraction(federate->getFederateHandle(), _handle,
+                                                      values, tag, timeStamp);
+}
+
+void
+RTILoopbackInteractionClass::_collectParameters(RTIIndexDataPairList& parameters,
+                                                const RTILoopbackFederation::HandleDataPairList& values,
+                                                RTIIndexDataPairList& parameterPool)
+{
+    for (RTILoopbackFederation::HandleDataPairList::const_iterator i = values.begin(); i != values.end(); ++i) {
+        unsigned index = getParameterIndex(i->first);
+        // Parameters this federate does not know about
+        if (index == ~0u)
+            continue;
+
+        if (parameterPool.empty())
+            parameters.push_back(RTIIndexDataPair());
+        else
+            parameters.splice(parameters.end(), parameterPool, parameterPool.begin());
+        parameters.back().first = index;
+        // The message is alive during the callback, so borrow instead of copying
+        parameters.back().second.setBorrowedData(i->second.data(), i->second.size());
+    }
+}
+
+}
@@ -0,0 +1,85 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifndef RTILoopbackInteractionClass_hxx
+#define RTILoopbackInteractionClass_hxx
+
+#include <vector>
+
+#include <simgear/structure/SGWeakPtr.hxx>
+
+#include "RTIInteractionClass.hxx"
+#include "RTILoopbackFederation.hxx"
+
+namespace simgear {
+
+class RTILoopbackFederate;
+
+class RTILoopbackInteractionClass : public RTIInteractionClass {
+public:
+    RTILoopbackInteractionClass(HLAInteractionClass* interactionClass, RTILoopbackFederation::Handle handle,
+                                RTILoopbackFederate* federate);
+    virtual ~RTILoopbackInteractionClass();
+
+    RTILoopbackFederation::Handle getHandle() const
+    { return _handle; }
+
+    virtual bool resolveParameterIndex(const std::string& name, unsigned index);
+
+    unsigned getParameterIndex(RTILoopbackFederation::Handle handle) const
+    {
+        if (_parameterIndexVector.size() <= handle)
+            return ~0u;
+        return _parameterIndexVector[handle];
+    }
+    RTILoopbackFederation::Handle getParameterHandle(unsigned index) const
+    {
+        if (_parameterHandleVector.size() <= index)
+            return RTILoopbackFederation::InvalidHandle;
+        return _parameterHandleVector[index];
+    }
+
+    virtual bool publish();
+    virtual bool unpublish();
+
+    virtual bool subscribe(bool);
+    virtual bool unsubscribe();
+
+    virtual bool send(const RTIIndexDataPairList& parameters, const RTIData& tag);
+    virtual bool send(const RTIIndexDataPairList& parameters, const SGTimeStamp& timeStamp, const RTIData& tag);
+
+    // The values are shared with the other receivers, so they are copied
+    void receiveInteraction(const RTILoopbackFederation::HandleDataPairList& values,
+                            const RTIData& tag, RTIIndexDataPairList& parameterPool);
+    void receiveInteraction(const RTILoopbackFederation::HandleDataPairList& values,
+                            const SGTimeStamp& timeStamp, const RTIData& tag, RTIIndexDataPairList& parameterPool);
+
+private:
+    bool _send(const RTIIndexDataPairList& parameters, const SGTimeStamp* timeStamp, const RTIData& tag);
+    void _collectParameters(RTIIndexDataPairList& parameters, const RTILoopbackFederation::HandleDataPairList& values,
+                            RTIIndexDataPairList& parameterPool);
+
+    RTILoopbackFederation::Handle _handle;
+    SGWeakPtr<RTILoopbackFederate> _federate;
+
+    std::vector<unsigned> _parameterIndexVector;
+    std::vector<RTILoopbackFederation::Handle> _parameterHandleVector;
+};
+
+}
+
+#endif
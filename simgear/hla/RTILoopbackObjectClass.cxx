@@ -0,0 +1,176 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include <simgear/compiler.h>
+
+#include "RTILoopbackObjectClass.hxx"
+
+#include "simgear/debug/logstream.hxx"
+#include "RTILoopbackFederate.hxx"
+
+namespace simgear {
+
+RTILoopbackObjectClass::RTILoopbackObjectClass(HLAObjectClass* hlaObjectClass, RTILoopbackFederation::Handle handle,
+                                               RTILoopbackFederate* federate) :
+    RTIObjectClass(hlaObjectClass),
+    _handle(handle),
+    _federate(federate)
+{
+}
+
+RTILoopbackObjectClass::~RTILoopbackObjectClass()
+{
+}
+
+bool
+RTILoopbackObjectClass::resolveAttributeIndex(const std::string& name, unsigned index)
+{
+    SGSharedPtr<RTILoopbackFederate> federate = _federate.lock();
+    if (!federate.valid() || !federate->getJoined()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not get object class attribute: Federate not joined.");
+        return false;
+    }
+
+    if (index != _attributeHandleVector.size()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Resolving needs to happen in growing index order!");
+        return false;
+    }
+
+    RTILoopbackFederation::Handle attributeHandle;
+    attributeHandle = federate->getFederation()->getAttributeHandle(_handle, name);
+    if (attributeHandle == RTILoopbackFederation::InvalidHandle) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not get object class attribute \"" << name << "\".");
+        return false;
+    }
+    if (getAttributeIndex(attributeHandle) != ~0u) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Resolving attributeIndex for attribute \"" << name << "\" twice!");
+        return false;
+    }
+
+    if (_attributeIndexVector.size() <= attributeHandle)
+        _attributeIndexVector.resize(attributeHandle + 1, ~0u);
+    _attributeIndexVector[attributeHandle] = index;
+    _attributeHandleVector.push_back(attributeHandle);
+    _attributeSubscribedVector.push_back(false);
+
+    return true;
+}
+
+unsigned
+RTILoopbackObjectClass::getNumAttributes() const
+{
+    return _attributeHandleVector.size();
+}
+
+bool
+RTILoopbackObjectClass::publish(const HLAIndexList& indexList)
+{
+    SGSharedPtr<RTILoopbackFederate> federate = _federate.lock();
+    if (!federate.valid() || !federate->getJoined()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not publish object class: Federate not joined.");
+        return false;
+    }
+
+    std::set<RTILoopbackFederation::Handle> attributes;
+    for (HLAIndexList::const_iterator i = indexList.begin(); i != indexList.end(); ++i) {
+        if (_attributeHandleVector.size() <= *i) {
+            SG_LOG(SG_NETWORK, SG_WARN, "RTILoopbackObjectClass::publish(): Invalid attribute index!");
+            continue;
+        }
+        attributes.insert(_attributeHandleVector[*i]);
+    }
+
+    federate->getFederation()->publishObjectClass(federate->getFederateHandle(), _handle, attributes);
+    return true;
+}
+
+bool
+RTILoopbackObjectClass::unpublish()
+{
+    SGSharedPtr<RTILoopbackFederate> federate = _federate.lock();
+    if (!federate.valid() || !federate->getJoined()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not unpublish object class: Federate not joined.");
+        return false;
+    }
+
+    federate->getFederation()->unpublishObjectClass(federate->getFederateHandle(), _handle);
+    return true;
+}
+
+bool
+RTILoopbackObjectClass::subscribe(const HLAIndexList& indexList, bool)
+{
+    SGSharedPtr<RTILoopbackFederate> federate = _federate.lock();
+    if (!federate.valid() || !federate->getJoined()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not subscribe object class: Federate not joined.");
+        return false;
+    }
+
+    std::set<RTILoopbackFederation::Handle> attributes;
+    _attributeSubscribedVector.assign(_attributeHandleVector.size(), false);
+    for (HLAIndexList::const_iterator i = indexList.begin(); i != indexList.end(); ++i) {
+        if (_attributeHandleVector.size() <= *i) {
+            SG_LOG(SG_NETWORK, SG_WARN, "RTILoopbackObjectClass::subscribe(): Invalid attribute index!");
+            continue;
+        }
+        attributes.insert(_attributeHandleVector[*i]);
+        _attributeSubscribedVector[*i] = true;
+    }
+
+    federate->getFederation()->subscribeObjectClass(federate->getFederateHandle(), _handle, attributes);
+    return true;
+}
+
+bool
+RTILoopbackObjectClass::unsubscribe()
+{
+    SGSharedPtr<RTILoopbackFederate> federate = _federate.lock();
+    if (!federate.valid() || !federate->getJoined()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not unsubscribe object class: Federate not joined.");
+        return false;
+    }
+
+    _attributeSubscribedVector.assign(_attributeHandleVector.size(), false);
+    federate->getFederation()->unsubscribeObjectClass(federate->getFederateHandle(), _handle);
+    return true;
+}
+
+RTIObjectInstance*
+RTILoopbackObjectClass::registerObjectInstance(HLAObjectInstance* hlaObjectInstance)
+{
+    SGSharedPtr<RTILoopbackFederate> federate = _federate.lock();
+    if (!federate.valid() || !federate->getJoined()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not register object instance: Federate not joined.");
+        return 0;
+    }
+
+    std::string name;
+    RTILoopbackFederation::Handle objectHandle;
+    objectHandle = federate->getFederation()->registerObjectInstance(federate->getFederateHandle(), _handle, name);
+    if (objectHandle == RTILoopbackFederation::InvalidHandle)
+        return 0;
+    RTILoopbackObjectInstance* objectInstance;
+    objectInstance = new RTILoopbackObjectInstance(objectHandle, name, hlaObjectInstance, this, federate.get());
+    federate->insertObjectInstance(objectInstance);
+    return objectInstance;
+}
+
+}
@@ -0,0 +1,83 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifndef RTILoopbackObjectClass_hxx
+#define RTILoopbackObjectClass_hxx
+
+#include <vector>
+
+#include <simgear/structure/SGWeakPtr.hxx>
+
+#include "RTIObjectClass.hxx"
+#include "RTILoopbackFederation.hxx"
+
+namespace simgear {
+
+class RTILoopbackFederate;
+
+class RTILoopbackObjectClass : public RTIObjectClass {
+public:
+    RTILoopbackObjectClass(HLAObjectClass* hlaObjectClass, RTILoopbackFederation::Handle handle, RTILoopbackFederate* federate);
+    virtual ~RTILoopbackObjectClass();
+
+    RTILoopbackFederation::Handle getHandle() const
+    { return _handle; }
+
+    virtual bool resolveAttributeIndex(const std::string& name, unsigned index);
+
+    virtual unsigned getNumAttributes() const;
+
+    // The attribute handles are small numbers, so plain vectors map them
+    unsigned getAttributeIndex(RTILoopbackFederation::Handle handle) const
+    {
+        if (_attributeIndexVector.size() <= handle)
+            return ~0u;
+        return _attributeIndexVector[handle];
+    }
+    RTILoopbackFederation::Handle getAttributeHandle(unsigned index) const
+    {
+        if (_attributeHandleVector.size() <= index)
+            return RTILoopbackFederation::InvalidHandle;
+        return _attributeHandleVector[index];
+    }
+    bool getAttributeSubscribed(unsigned index) const
+    {
+        if (_attributeSubscribedVector.size() <= index)
+            return false;
+        return _attributeSubscribedVector[index];
+    }
+
+    virtual bool publish(const HLAIndexList& indexList);
+    virtual bool unpublish();
+
+    virtual bool subscribe(const HLAIndexList& indexList, bool);
+    virtual bool unsubscribe();
+
+    virtual RTIObjectInstance* registerObjectInstance(HLAObjectInstance* hlaObjectInstance);
+
+private:
+    RTILoopbackFederation::Handle _handle;
+    SGWeakPtr<RTILoopbackFederate> _federate;
+
+    std::vector<unsigned> _attributeIndexVector;
+    std::vector<RTILoopbackFederation::Handle> _attributeHandleVector;
+    std::vector<bool> _attributeSubscribedVector;
+};
+
+}
+
+#endif
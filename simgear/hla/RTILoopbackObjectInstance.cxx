@@ -0,0 +1,233 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include <simgear/compiler.h>
+
+#include "RTILoopbackObjectInstance.hxx"
+
+#include "simgear/debug/logstream.hxx"
+#include "RTILoopbackFederate.hxx"
+
+namespace simgear {
+
+RTILoopbackObjectInstance::RTILoopbackObjectInstance(RTILoopbackFederation::Handle handle, const std::string& name,
+                                                     HLAObjectInstance* hlaObjectInstance,
+                                                     const RTILoopbackObjectClass* objectClass,
+                                                     RTILoopbackFederate* federate) :
+    RTIObjectInstance(hlaObjectInstance),
+    _handle(handle),
+    _name(name),
+    _objectClass(objectClass),
+    _federate(federate)
+{
+    _setNumAttributes(getNumAttributes());
+}
+
+RTILoopbackObjectInstance::~RTILoopbackObjectInstance()
+{
+}
+
+const RTIObjectClass*
+RTILoopbackObjectInstance::getObjectClass() const
+{
+    return _objectClass.get();
+}
+
+const RTILoopbackObjectClass*
+RTILoopbackObjectInstance::getLoopbackObjectClass() const
+{
+    return _objectClass.get();
+}
+
+std::string
+RTILoopbackObjectInstance::getName() const
+{
+    return _name;
+}
+
+void
+RTILoopbackObjectInstance::deleteObjectInstance(const RTIData& tag)
+{
+    SGSharedPtr<RTILoopbackFederate> federate = _federate.lock();
+    if (!federate.valid() || !federate->getJoined()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not delete object instance: Federate not joined.");
+        return;
+    }
+    federate->getFederation()->deleteObjectInstance(federate->getFederateHandle(), _handle, tag, 0);
+}
+
+void
+RTILoopbackObjectInstance::deleteObjectInstance(const SGTimeStamp& timeStamp, const RTIData& tag)
+{
+    SGSharedPtr<RTILoopbackFederate> federate = _federate.lock();
+    if (!federate.valid() || !federate->getJoined()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not delete object instance: Federate not joined.");
+        return;
+    }
+    federate->getFederation()->deleteObjectInstance(federate->getFederateHandle(), _handle, tag, &timeStamp);
+}
+
+void
+RTILoopbackObjectInstance::localDeleteObjectInstance()
+{
+    SGSharedPtr<RTILoopbackFederate> federate = _federate.lock();
+    if (!federate.valid() || !federate->getJoined()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not delete object instance: Federate not joined.");
+        return;
+    }
+    federate->getFederation()->localDeleteObjectInstance(federate->getFederateHandle(), _handle);
+}
+
+void
+RTILoopbackObjectInstance::reflectAttributeValues(const RTILoopbackFederation::Message& message, HLAIndexList& indexPool)
+{
+    HLAIndexList reflectedIndices;
+    if (_collectAttributeValues(reflectedIndices, message, indexPool)) {
+        if (message._timeStamped)
+            RTIObjectInstance::reflectAttributeValues(reflectedIndices, message._timeStamp, message._tag);
+        else
+            RTIObjectInstance::reflectAttributeValues(reflectedIndices, message._tag);
+    }
+
+    // Return the index list to the pool
+    indexPool.splice(indexPool.end(), reflectedIndices);
+}
+
+void
+RTILoopbackObjectInstance::requestObjectAttributeValueUpdate(const HLAIndexList& indexList)
+{
+    SGSharedPtr<RTILoopbackFederate> federate = _federate.lock();
+    if (!federate.valid() || !federate->getJoined()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not request attribute update for object instance: Federate not joined.");
+        return;
+    }
+
+    std::set<RTILoopbackFederation::Handle> attributes;
+    for (HLAIndexList::const_iterator i = indexList.begin(); i != indexList.end(); ++i) {
+        if (getAttributeOwned(*i)) {
+            SG_LOG(SG_NETWORK, SG_WARN, "RTILoopbackObjectInstance::requestObjectAttributeValueUpdate(): "
+                   "Invalid attribute index!");
+            continue;
+        }
+        attributes.insert(getAttributeHandle(*i));
+    }
+    if (attributes.empty())
+        return;
+
+    federate->getFederation()->requestObjectAttributeValueUpdate(federate->getFederateHandle(), _handle, attributes);
+}
+
+void
+RTILoopbackObjectInstance::provideAttributeValueUpdate(const RTILoopbackFederation::HandleDataPairList& attributes)
+{
+    // Just marks some instance attributes dirty so that they are sent with the next update
+    for (RTILoopbackFederation::HandleDataPairList::const_iterator i = attributes.begin();
+         i != attributes.end(); ++i) {
+        unsigned index = getAttributeIndex(i->first);
+        if (_attributeData.size() <= index)
+            continue;
+        _attributeData[index]._dirty = true;
+    }
+}
+
+void
+RTILoopbackObjectInstance::updateAttributeValues(const RTIData& tag)
+{
+    _updateAttributeValues(0, tag);
+}
+
+void
+RTILoopbackObjectInstance::updateAttributeValues(const SGTimeStamp& timeStamp, const RTIData& tag)
+{
+    _updateAttributeValues(&timeStamp, tag);
+}
+
+bool
+RTILoopbackObjectInstance::isAttributeOwnedByFederate(unsigned index) const
+{
+    SGSharedPtr<RTILoopbackFederate> federate = _federate.lock();
+    if (!federate.valid() || !federate->getJoined()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not query attribute ownership: Federate not joined.");
+        return false;
+    }
+    return federate->getFederation()->isAttributeOwnedByFederate(federate->getFederateHandle(), _handle,
+                                                                 getAttributeHandle(index));
+}
+
+bool
+RTILoopbackObjectInstance::_updateAttributeValues(const SGTimeStamp* timeStamp, const RTIData& tag)
+{
+    SGSharedPtr<RTILoopbackFederate> federate = _federate.lock();
+    if (!federate.valid() || !federate->getJoined()) {
+        SG_LOG(SG_NETWORK, SG_WARN, "RTI: Could not update attribute values: Federate not joined.");
+        return false;
+    }
+
+    RTILoopbackFederation::HandleDataPairList values;
+    unsigned numAttributes = _attributeData.size();
+    for (unsigned i = 0; i < numAttributes; ++i) {
+        if (!_attributeData[i]._dirty)
+            continue;
+        values.push_back(RTILoopbackFederation::HandleDataPair(getAttributeHandle(i), _attributeData[i]._data));
+    }
+    if (values.empty())
+        return true;
+
+    if (!federate->getFederation()->updateAttributeValues(federate->getFederateHandle(), _handle,
+                                                          values, tag, timeStamp))
+        return false;
+
+    for (unsigned i = 0; i < numAttributes; ++i) {
+        _attributeData[i]._dirty = false;
+    }
+    return true;
+}
+
+unsigned
+RTILoopbackObjectInstance::_collectAttributeValues(HLAIndexList& indexList,
+                                                   const RTILoopbackFederation::Message& message,
+                                                   HLAIndexList& indexPool)
+{
+    const RTILoopbackFederation::HandleDataPairList& values = message._values;
+    unsigned count = 0;
+    for (RTILoopbackFederation::HandleDataPairList::const_iterator i = values.begin(); i != values.end(); ++i) {
+        unsigned index = getAttributeIndex(i->first);
+        // Values we did not subscribe are just part of the same update of an other federate
+        if (!_objectClass->getAttributeSubscribed(index) || _attributeData.size() <= index)
+            continue;
+        // Messages are not changed once sent, so borrow instead of copying
+        if (_reflectedMessages.size() <= index)
+            _reflectedMessages.resize(_attributeData.size());
+        _reflectedMessages[index] = &message;
+        _attributeData[index]._data.setBorrowedData(i->second.data(), i->second.size());
+
+        if (indexPool.empty())
+            indexList.push_back(index);
+        else {
+            indexList.splice(indexList.end(), indexPool, indexPool.begin());
+            indexList.back() = index;
+        }
+        ++count;
+    }
+    return count;
+}
+
+}
@@ -0,0 +1,83 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifndef RTILoopbackObjectInstance_hxx
+#define RTILoopbackObjectInstance_hxx
+
+#include <vector>
+#include <simgear/structure/SGWeakPtr.hxx>
+
+#include "RTIObjectInstance.hxx"
+#include "RTILoopbackObjectClass.hxx"
+
+namespace simgear {
+
+class RTILoopbackFederate;
+
+class RTILoopbackObjectInstance : public RTIObjectInstance {
+public:
+    RTILoopbackObjectInstance(RTILoopbackFederation::Handle handle, const std::string& name,
+                              HLAObjectInstance* hlaObjectInstance, const RTILoopbackObjectClass* objectClass,
+                              RTILoopbackFederate* federate);
+    virtual ~RTILoopbackObjectInstance();
+
+    RTILoopbackFederation::Handle getHandle() const
+    { return _handle; }
+
+    virtual const RTIObjectClass* getObjectClass() const;
+    const RTILoopbackObjectClass* getLoopbackObjectClass() const;
+
+    unsigned getNumAttributes() const
+    { return _objectClass->getNumAttributes(); }
+    unsigned getAttributeIndex(RTILoopbackFederation::Handle handle) const
+    { return _objectClass->getAttributeIndex(handle); }
+    RTILoopbackFederation::Handle getAttributeHandle(unsigned index) const
+    { return _objectClass->getAttributeHandle(index); }
+
+    virtual std::string getName() const;
+
+    virtual void deleteObjectInstance(const RTIData& tag);
+    virtual void deleteObjectInstance(const SGTimeStamp& timeStamp, const RTIData& tag);
+    virtual void localDeleteObjectInstance();
+
+    // The values are shared with the other receivers, the attribute data
+    // just borrows them and keeps the message alive until the next reflection
+    void reflectAttributeValues(const RTILoopbackFederation::Message& message, HLAIndexList& indexPool);
+    virtual void requestObjectAttributeValueUpdate(const HLAIndexList& indexList);
+    void provideAttributeValueUpdate(const RTILoopbackFederation::HandleDataPairList& attributes);
+
+    virtual void updateAttributeValues(const RTIData& tag);
+    virtual void updateAttributeValues(const SGTimeStamp& timeStamp, const RTIData& tag);
+
+    virtual bool isAttributeOwnedByFederate(unsigned index) const;
+
+private:
+    bool _updateAttributeValues(const SGTimeStamp* timeStamp, const RTIData& tag);
+    unsigned _collectAttributeValues(HLAIndexList& indexList, const RTILoopbackFederation::Message& message,
+                                     HLAIndexList& indexPool);
+
+    RTILoopbackFederation::Handle _handle;
+    std::string _name;
+    SGSharedPtr<const RTILoopbackObjectClass> _objectClass;
+    SGWeakPtr<RTILoopbackFederate> _federate;
+    /// The messages the attribute data is borrowed from
+    std::vector<SGSharedPtr<const RTILoopbackFederation::Message> > _reflectedMessages;
+};
+
+}
+
+#endif
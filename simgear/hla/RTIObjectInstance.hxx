@@ -18,6 +18,7 @@
 #ifndef RTIObjectInstance_hxx
 #define RTIObjectInstance_hxx
 
+#include <cstring>
 #include <string>
 #include <vector>
 #include "simgear/structure/SGReferenced.hxx"
@@ -69,6 +70,14 @@ public:
         return _attributeData[index].encodeAttributeData(dataElement);
     }
 
+    // Same as above, but only mark the attribute for sending if the encoding changed
+    bool encodeChangedAttributeData(unsigned index, const HLADataElement& dataElement)
+    {
+        if (_attributeData.size() <= index)
+            return false;
+        return _attributeData[index].encodeChangedAttributeData(dataElement);
+    }
+
     bool decodeAttributeData(unsigned index, HLADataElement& dataElement) const
     {
         if (_attributeData.size() <= index)
@@ -128,6 +137,22 @@ protected:
             return dataElement.encode(stream);
         }
 
+        bool encodeChangedAttributeData(const HLADataElement& dataElement)
+        {
+            // Encode aside and compare with the last encoding, which is
+            // what the remote side already has unless _dirty is still set.
+            _encodeData.resize(0);
+            HLAEncodeStream stream(_encodeData);
+            if (!dataElement.encode(stream))
+                return false;
+            if (_encodeData.size() == _data.size() &&
+                std::memcmp(_encodeData.data(), _data.data(), _data.size()) == 0)
+                return true;
+            _data.swap(_encodeData);
+            _dirty = true;
+            return true;
+        }
+
         bool decodeAttributeData(HLADataElement& dataElement) const
         {
             HLADecodeStream stream(_data);
@@ -136,6 +161,8 @@ protected:
 
         // The rti level raw data element
         RTIData _data;
+        // Scratch buffer for encodeChangedAttributeData
+        RTIData _encodeData;
 
         // The state of the attribute as tracked from the rti.
         bool _owned;
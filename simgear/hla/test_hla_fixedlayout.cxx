@@ -0,0 +1,286 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include <simgear/compiler.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <simgear/misc/test_macros.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include "HLAArrayDataType.hxx"
+#include "HLABasicDataType.hxx"
+#include "HLADataTypeVisitor.hxx"
+#include "HLAEnumeratedDataType.hxx"
+#include "HLAFixedLayoutDataElement.hxx"
+#include "HLAFixedRecordDataElement.hxx"
+#include "HLAFixedRecordDataType.hxx"
+#include "HLAVariantRecordDataType.hxx"
+
+using namespace simgear;
+
+// Roughly an entity state update: mixed byte orders, an enumeration,
+// a nested record and a fixed array
+static SGSharedPtr<HLAFixedRecordDataType>
+createEntityDataType()
+{
+    SGSharedPtr<HLAEnumeratedDataType> kindDataType = new HLAEnumeratedDataType("Kind");
+    kindDataType->setRepresentation(new HLAInt32BEDataType);
+    kindDataType->addEnumerator("Other", "0");
+    kindDataType->addEnumerator("Aircraft", "1");
+    kindDataType->addEnumerator("Vehicle", "2");
+    kindDataType->addEnumerator("Ship", "3");
+
+    SGSharedPtr<HLAFixedRecordDataType> positionDataType = new HLAFixedRecordDataType("Position");
+    positionDataType->addField("x", new HLAFloat64BEDataType);
+    positionDataType->addField("y", new HLAFloat64BEDataType);
+    positionDataType->addField("z", new HLAFloat64BEDataType);
+
+    SGSharedPtr<HLAFixedArrayDataType> orientationDataType = new HLAFixedArrayDataType("Orientation");
+    orientationDataType->setElementDataType(new HLAFloat32LEDataType);
+    orientationDataType->setNumElements(4);
+
+    SGSharedPtr<HLAFixedRecordDataType> dataType = new HLAFixedRecordDataType("Entity");
+    dataType->addField("flags", new HLAUInt8DataType);
+    dataType->addField("id", new HLAUInt32BEDataType);
+    dataType->addField("kind", kindDataType.get());
+    dataType->addField("count", new HLAInt16LEDataType);
+    dataType->addField("position", positionDataType.get());
+    dataType->addField("orientation", orientationDataType.get());
+    dataType->addField("time", new HLAInt64BEDataType);
+    dataType->addField("rate", new HLAUInt16BEDataType);
+    SG_VERIFY(dataType->recomputeAlignment());
+    return dataType;
+}
+
+static double
+testValue(const HLAFixedLayout& layout, unsigned index, unsigned seed)
+{
+    double value = (index + seed) % 3;
+    if (layout.getValueType(index) == HLAFixedLayout::Float32 ||
+        layout.getValueType(index) == HLAFixedLayout::Float64)
+        value += 0.25;
+    return value;
+}
+
+static void
+testLayout()
+{
+    SGSharedPtr<HLAFixedRecordDataType> dataType = createEntityDataType();
+    SGSharedPtr<const HLAFixedLayout> layout = HLAFixedLayout::create(dataType.get());
+    SG_VERIFY(layout.valid());
+    SG_CHECK_EQUAL(layout->getNumFields(), dataType->getNumFields());
+    SG_CHECK_EQUAL(layout->getNumValues(), 13u);
+    SG_CHECK_EQUAL(layout->getAlignment(), 8u);
+    SG_CHECK_EQUAL(layout->getValueIndex("position.y"), 5u);
+    SG_CHECK_EQUAL(layout->getValueIndex("orientation[3]"), 10u);
+    SG_CHECK_EQUAL(layout->getValueIndex("nonexistent"), ~0u);
+    SG_CHECK_EQUAL(layout->getValueType(layout->getValueIndex("kind")), HLAFixedLayout::Int32);
+
+    // Variable sized types do not have a fixed layout
+    SGSharedPtr<HLAVariableArrayDataType> variableDataType = new HLAVariableArrayDataType;
+    variableDataType->setElementDataType(new HLAUInt8DataType);
+    variableDataType->setSizeDataType(new HLAUInt32BEDataType);
+    SG_VERIFY(!HLAFixedLayout::create(variableDataType.get()).valid());
+    SG_VERIFY(!HLAFixedLayout::create(0).valid());
+}
+
+static void
+testEncodeDecode()
+{
+    SGSharedPtr<HLAFixedRecordDataType> dataType = createEntityDataType();
+
+    HLADataElementFactoryVisitor factory;
+    dataType->accept(factory);
+    SGSharedPtr<HLADataElement> generic = factory.getDataElement();
+    SG_VERIFY(generic.valid());
+
+    SGSharedPtr<HLAFixedLayoutDataElement> fixed = new HLAFixedLayoutDataElement(dataType.get());
+    const HLAFixedLayout* layout = fixed->getLayout();
+    SG_VERIFY(layout);
+    for (unsigned i = 0; i < layout->getNumValues(); ++i)
+        fixed->setValue(i, testValue(*layout, i, 1));
+    unsigned kindIndex = fixed->getValueIndex("kind");
+    SG_CHECK_EQUAL(fixed->getValue<double>(kindIndex), testValue(*layout, kindIndex, 1));
+
+    // Start at an odd offset to exercise the alignment
+    RTIData fixedData;
+    HLAEncodeStream fixedStream(fixedData);
+    SG_VERIFY(fixedStream.skip(1));
+    SG_VERIFY(fixed->encode(fixedStream));
+
+    // The generic elements must decode and reencode the same bytes
+    HLADecodeStream decodeStream(fixedData);
+    SG_VERIFY(decodeStream.skip(1));
+    SG_VERIFY(generic->decode(decodeStream));
+    SG_CHECK_EQUAL(decodeStream.getOffset(), fixedData.size());
+    RTIData genericData;
+    HLAEncodeStream genericStream(genericData);
+    SG_VERIFY(genericStream.skip(1));
+    SG_VERIFY(generic->encode(genericStream));
+    SG_CHECK_EQUAL(genericData.size(), fixedData.size());
+    SG_VERIFY(std::memcmp(genericData.data() + 1, fixedData.data() + 1, fixedData.size() - 1) == 0);
+
+    // Decode from a borrowed buffer into a fresh element
+    SGSharedPtr<HLAFixedLayoutDataElement> decoded = new HLAFixedLayoutDataElement(dataType.get());
+    HLADecodeStream borrowedStream(genericData.data(), genericData.size());
+    SG_VERIFY(borrowedStream.getData().getBorrowed());
+    SG_VERIFY(borrowedStream.getData().data() == genericData.data());
+    SG_VERIFY(borrowedStream.skip(1));
+    SG_VERIFY(decoded->decode(borrowedStream));
+    for (unsigned i = 0; i < layout->getNumValues(); ++i)
+        SG_CHECK_EQUAL(decoded->getValue<double>(i), testValue(*layout, i, 1));
+
+    // Field wise encoding matches the record encoding
+    RTIData fieldData;
+    HLAEncodeStream fieldStream(fieldData);
+    SG_VERIFY(fieldStream.skip(1));
+    SG_VERIFY(fieldStream.alignOffsetForSize(layout->getAlignment()));
+    for (unsigned i = 0; i < decoded->getNumFields(); ++i)
+        SG_VERIFY(decoded->encodeField(fieldStream, i));
+    SG_CHECK_EQUAL(fieldData.size(), fixedData.size());
+    SG_VERIFY(std::memcmp(fieldData.data() + 1, fixedData.data() + 1, fixedData.size() - 1) == 0);
+
+    // Too short input fails
+    HLADecodeStream shortStream(fixedData.data(), fixedData.size() - 1);
+    SG_VERIFY(shortStream.skip(1));
+    SG_VERIFY(!decoded->decode(shortStream));
+}
+
+static void
+testRTIData()
+{
+    const char buffer[] = { 1, 2, 3, 4 };
+
+    RTIData borrowed;
+    borrowed.setBorrowedData(buffer, sizeof(buffer));
+    SG_VERIFY(borrowed.getBorrowed());
+    SG_VERIFY(borrowed.data() == buffer);
+    SG_CHECK_EQUAL(borrowed.size(), 4u);
+
+    // Copies own their data
+    RTIData copy(borrowed);
+    SG_VERIFY(!copy.getBorrowed());
+    SG_VERIFY(copy.data() != buffer);
+    SG_CHECK_EQUAL(copy.size(), borrowed.size());
+    SG_VERIFY(std::memcmp(copy.data(), buffer, sizeof(buffer)) == 0);
+
+    // Moves take over the buffer
+    const char* data = copy.data();
+    RTIData moved(std::move(copy));
+    SG_VERIFY(moved.data() == data);
+    SG_CHECK_EQUAL(copy.size(), 0u);
+    RTIData assigned;
+    assigned = std::move(moved);
+    SG_VERIFY(assigned.data() == data);
+    SG_CHECK_EQUAL(moved.size(), 0u);
+
+    // Setting data of the same size into a borrowed buffer detaches it
+    RTIData sameSize;
+    sameSize.setBorrowedData(buffer, sizeof(buffer));
+    const char other[] = { 5, 6, 7, 8 };
+    sameSize.setData(other, sizeof(other));
+    SG_VERIFY(!sameSize.getBorrowed());
+    SG_VERIFY(sameSize.data() != buffer);
+    SG_CHECK_EQUAL(sameSize.data()[0], 5);
+    SG_CHECK_EQUAL(buffer[0], 1);
+
+    // Growing a borrowed buffer detaches it
+    borrowed.resize(8);
+    SG_VERIFY(!borrowed.getBorrowed());
+    SG_VERIFY(borrowed.data() != buffer);
+    SG_CHECK_EQUAL(borrowed.data()[3], 4);
+
+    // Shrinking assignment
+    RTIData small("ab", 2);
+    assigned = small;
+    SG_CHECK_EQUAL(assigned.size(), 2u);
+    assigned = RTIData();
+    SG_CHECK_EQUAL(assigned.size(), 0u);
+}
+
+static void
+testBenchmark(unsigned numIterations)
+{
+    SGSharedPtr<HLAFixedRecordDataType> dataType = createEntityDataType();
+
+    HLADataElementFactoryVisitor factory;
+    dataType->accept(factory);
+    SGSharedPtr<HLADataElement> generic = factory.getDataElement();
+    SGSharedPtr<HLAFixedLayoutDataElement> fixed = new HLAFixedLayoutDataElement(dataType.get());
+
+    RTIData data;
+    data.reserve(1024);
+
+    SGTimeStamp genericEncodeTime;
+    SGTimeStamp genericDecodeTime;
+    SGTimeStamp fixedEncodeTime;
+    SGTimeStamp fixedDecodeTime;
+
+    SGTimeStamp start = SGTimeStamp::now();
+    for (unsigned i = 0; i < numIterations; ++i) {
+        data.resize(0);
+        HLAEncodeStream stream(data);
+        generic->encode(stream);
+    }
+    genericEncodeTime = SGTimeStamp::now() - start;
+
+    start = SGTimeStamp::now();
+    for (unsigned i = 0; i < numIterations; ++i) {
+        HLADecodeStream stream(data.data(), data.size());
+        generic->decode(stream);
+    }
+    genericDecodeTime = SGTimeStamp::now() - start;
+
+    start = SGTimeStamp::now();
+    for (unsigned i = 0; i < numIterations; ++i) {
+        data.resize(0);
+        HLAEncodeStream stream(data);
+        fixed->encode(stream);
+    }
+    fixedEncodeTime = SGTimeStamp::now() - start;
+
+    start = SGTimeStamp::now();
+    for (unsigned i = 0; i < numIterations; ++i) {
+        HLADecodeStream stream(data.data(), data.size());
+        fixed->decode(stream);
+    }
+    fixedDecodeTime = SGTimeStamp::now() - start;
+
+    std::cout << "entity record of " << data.size() << " bytes, " << numIterations << " iterations:" << std::endl
+              << "  generic: " << 1e9*genericEncodeTime.toSecs()/numIterations << " ns encode, "
+              << 1e9*genericDecodeTime.toSecs()/numIterations << " ns decode" << std::endl
+              << "  fixed layout: " << 1e9*fixedEncodeTime.toSecs()/numIterations << " ns encode, "
+              << 1e9*fixedDecodeTime.toSecs()/numIterations << " ns decode" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    testLayout();
+    testEncodeDecode();
+    testRTIData();
+    testBenchmark(100000);
+
+    std::cout << "all tests passed successfully!" << std::endl;
+    return EXIT_SUCCESS;
+}
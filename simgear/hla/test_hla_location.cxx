@@ -0,0 +1,118 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include <simgear/compiler.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include <simgear/misc/test_macros.hxx>
+
+#include "HLALocation.hxx"
+
+using namespace simgear;
+
+// A vehicle at constant speed with a slowly varying turn rate,
+// so constant velocity extrapolation drifts off over time
+static SGVec3d
+angularVelocity(double t)
+{
+    return SGVec3d(0, 0.05*std::sin(0.3*t), 0.2*std::sin(0.5*t));
+}
+
+static const SGVec3d linearVelocity(50, 0, 0);
+
+static void
+step(SGLocationd& location, double t, double dt)
+{
+    const unsigned numSubSteps = 10;
+    for (unsigned i = 0; i < numSubSteps; ++i) {
+        double subDt = dt/numSubSteps;
+        location.eulerStepBodyVelocitiesMidOrientation(subDt, linearVelocity, angularVelocity(t + i*subDt));
+    }
+}
+
+// Returns the number of states written out of numSteps
+static unsigned
+simulate(HLACartesianLocation& location, unsigned numSteps, double dt)
+{
+    SGLocationd truth(SGVec3d(1000, 2000, 3000), SGQuatd::unit());
+    SGTimeStamp written;
+    unsigned numWritten = 0;
+    for (unsigned n = 0; n < numSteps; ++n) {
+        double t = n*dt;
+        SGTimeStamp timeStamp = SGTimeStamp::fromSec(t);
+        if (location.setDeadReckonedLocation(timeStamp, truth, linearVelocity, angularVelocity(t))) {
+            written = timeStamp;
+            ++numWritten;
+        }
+
+        // What a receiver extrapolates from the last written state
+        SGLocationd extrapolated = location.getLocation();
+        extrapolated.eulerStepBodyVelocitiesMidOrientation((timeStamp - written).toSecs(),
+                                                           location.getLinearBodyVelocity(),
+                                                           location.getAngularBodyVelocity());
+        SG_VERIFY(dist(extrapolated.getPosition(), truth.getPosition()) <=
+                  location.getDeadReckoningPositionError() + 1e-6);
+
+        step(truth, t, dt);
+    }
+    return numWritten;
+}
+
+static void
+testDeadReckoning()
+{
+    const unsigned numSteps = 3600;
+    const double dt = 1.0/60;
+
+    // Without thresholds every change is written
+    SGSharedPtr<HLACartesianLocation> location = new HLACartesianLocation;
+    SG_CHECK_EQUAL(simulate(*location, numSteps, dt), numSteps);
+
+    location = new HLACartesianLocation;
+    location->setDeadReckoningThresholds(1, SGMiscd::deg2rad(1));
+    unsigned numWritten = simulate(*location, numSteps, dt);
+    SG_VERIFY(1 < numWritten);
+    SG_VERIFY(numWritten < numSteps/10);
+    std::cout << "dead reckoning 1m/1deg: " << numWritten << " of " << numSteps << " states written" << std::endl;
+
+    // The maximum time interval forces a write at least every 5 seconds
+    location = new HLACartesianLocation;
+    location->setDeadReckoningThresholds(1e6, SGMiscd::pi(), 5);
+    SG_CHECK_EQUAL(simulate(*location, numSteps, dt), 12u);
+
+    // A reset forces the next write
+    SG_VERIFY(!location->setDeadReckonedLocation(SGTimeStamp::fromSec(56.0), location->getLocation(),
+                                                  linearVelocity, SGVec3d::zeros()));
+    location->resetDeadReckoning();
+    SG_VERIFY(location->setDeadReckonedLocation(SGTimeStamp::fromSec(56.0), location->getLocation(),
+                                                 linearVelocity, SGVec3d::zeros()));
+}
+
+int main(int argc, char* argv[])
+{
+    testDeadReckoning();
+
+    std::cout << "all tests passed successfully!" << std::endl;
+    return EXIT_SUCCESS;
+}
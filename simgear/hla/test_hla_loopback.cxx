@@ -0,0 +1,455 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include <simgear/compiler.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include <simgear/misc/test_macros.hxx>
+#include <simgear/threads/SGThread.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include "HLABasicDataElement.hxx"
+#include "HLABasicDataType.hxx"
+#include "HLAFederate.hxx"
+#include "HLAInteractionClass.hxx"
+#include "HLAObjectClass.hxx"
+#include "HLAObjectInstance.hxx"
+#include "RTILoopbackFederation.hxx"
+
+using namespace simgear;
+
+class TestObjectInstance : public HLAObjectInstance {
+public:
+    TestObjectInstance(HLAObjectClass* objectClass) :
+        HLAObjectInstance(objectClass),
+        _numReflections(0),
+        _numReflectedAttributes(0),
+        _numTimeStampedReflections(0),
+        _timeOrdered(true)
+    { }
+
+    virtual void reflectAttributeValues(const HLAIndexList& indexList, const RTIData& tag)
+    {
+        HLAObjectInstance::reflectAttributeValues(indexList, tag);
+        ++_numReflections;
+        _numReflectedAttributes += indexList.size();
+    }
+    virtual void reflectAttributeValues(const HLAIndexList& indexList, const SGTimeStamp& timeStamp, const RTIData& tag)
+    {
+        HLAObjectInstance::reflectAttributeValues(indexList, timeStamp, tag);
+        if (timeStamp < _lastTimeStamp)
+            _timeOrdered = false;
+        _lastTimeStamp = timeStamp;
+        ++_numTimeStampedReflections;
+    }
+
+    // Attribute 0 is privilegeToDelete, the values start past that
+    double getValue(unsigned index) const
+    {
+        const HLADoubleDataElement* dataElement;
+        dataElement = dynamic_cast<const HLADoubleDataElement*>(getAttributeDataElement(index + 1));
+        if (!dataElement)
+            return -1;
+        return dataElement->getValue();
+    }
+    void setValue(unsigned index, double value)
+    {
+        HLADoubleDataElement* dataElement;
+        dataElement = dynamic_cast<HLADoubleDataElement*>(getAttributeDataElement(index + 1));
+        if (dataElement)
+            dataElement->setValue(value);
+    }
+
+    unsigned _numReflections;
+    unsigned _numReflectedAttributes;
+    unsigned _numTimeStampedReflections;
+    SGTimeStamp _lastTimeStamp;
+    bool _timeOrdered;
+};
+
+class TestObjectClass : public HLAObjectClass {
+public:
+    TestObjectClass(const std::string& name, HLAFederate* federate) :
+        HLAObjectClass(name, federate)
+    { }
+
+    virtual HLAObjectInstance* createObjectInstance(const std::string& name)
+    { return new TestObjectInstance(this); }
+};
+
+class TestInteractionClass : public HLAInteractionClass {
+public:
+    TestInteractionClass(const std::string& name, HLAFederate* federate) :
+        HLAInteractionClass(name, federate),
+        _numInteractions(0),
+        _lastSize(0)
+    { }
+
+    virtual void receiveInteraction(const RTIIndexDataPairList& parameters, const RTIData& tag)
+    {
+        ++_numInteractions;
+        if (!parameters.empty())
+            _lastSize = parameters.front().second.size();
+        _lastTag = tag;
+    }
+
+    unsigned _numInteractions;
+    unsigned _lastSize;
+    RTIData _lastTag;
+};
+
+class TestFederate : public HLAFederate {
+public:
+    TestFederate(const std::string& federationName, const std::string& federateType,
+                 bool publisher, bool subscriber, unsigned numAttributes,
+                 HLAUpdateType updateType = HLAPeriodicUpdate) :
+        _publisher(publisher),
+        _subscriber(subscriber),
+        _numAttributes(numAttributes),
+        _updateType(updateType),
+        _doubleDataType(new HLAFloat64LEDataType)
+    {
+        setVersion(HLAFederate::Loopback);
+        setFederationExecutionName(federationName);
+        setFederateType(federateType);
+    }
+
+    virtual bool readObjectModel()
+    {
+        _objectClass = new TestObjectClass("Vehicle", this);
+        _objectClass->addAttribute("privilegeToDelete");
+        for (unsigned i = 0; i < _numAttributes; ++i) {
+            std::stringstream name;
+            name << "value" << i;
+            unsigned index = _objectClass->addAttribute(name.str());
+            _objectClass->setAttributeDataType(index, _doubleDataType.get());
+            _objectClass->setAttributeUpdateType(index, _updateType);
+            if (_publisher)
+                _objectClass->setAttributePublicationType(index, HLAPublished);
+            if (_subscriber)
+                _objectClass->setAttributeSubscriptionType(index, HLASubscribedActive);
+        }
+
+        _interactionClass = new TestInteractionClass("Ping", this);
+        unsigned index = _interactionClass->addParameter("payload");
+        _interactionClass->setParameterDataType(index, _doubleDataType.get());
+        if (_publisher)
+            _interactionClass->setPublicationType(HLAPublished);
+        if (_subscriber)
+            _interactionClass->setSubscriptionType(HLASubscribedActive);
+
+        return resolveObjectModel();
+    }
+
+    bool _publisher;
+    bool _subscriber;
+    unsigned _numAttributes;
+    HLAUpdateType _updateType;
+    SGSharedPtr<HLAFloat64LEDataType> _doubleDataType;
+    SGSharedPtr<TestObjectClass> _objectClass;
+    SGSharedPtr<TestInteractionClass> _interactionClass;
+};
+
+static TestObjectInstance*
+findDiscoveredInstance(TestFederate& federate, const std::string& name)
+{
+    return dynamic_cast<TestObjectInstance*>(federate.getObjectInstance(name));
+}
+
+static void
+testReceiveOrder()
+{
+    SGSharedPtr<TestFederate> publisher = new TestFederate("ReceiveOrder", "publisher", true, false, 4);
+    SGSharedPtr<TestFederate> subscriber = new TestFederate("ReceiveOrder", "subscriber", false, true, 4);
+    SG_VERIFY(publisher->init());
+    SG_VERIFY(subscriber->init());
+
+    SGSharedPtr<TestObjectInstance> objectInstance = new TestObjectInstance(publisher->_objectClass.get());
+    objectInstance->registerInstance();
+    SG_VERIFY(!objectInstance->getName().empty());
+    for (unsigned i = 0; i < 4; ++i)
+        objectInstance->setValue(i, 10 + i);
+    objectInstance->updateAttributeValues(RTIData("update"));
+
+    SG_VERIFY(subscriber->processMessage(SGTimeStamp::fromSec(1)));
+    TestObjectInstance* discovered = findDiscoveredInstance(*subscriber, objectInstance->getName());
+    SG_VERIFY(discovered);
+    SG_CHECK_EQUAL(discovered->_numReflections, 1u);
+    for (unsigned i = 0; i < 4; ++i)
+        SG_CHECK_EQUAL(discovered->getValue(i), 10 + i);
+
+    RTIIndexDataPairList parameters;
+    parameters.push_back(RTIIndexDataPair(0, RTIData("12345678", 8)));
+    SG_VERIFY(publisher->_interactionClass->send(parameters, RTIData("ping", 4)));
+    SG_VERIFY(subscriber->processMessage(SGTimeStamp::fromSec(1)));
+    SG_CHECK_EQUAL(subscriber->_interactionClass->_numInteractions, 1u);
+    SG_CHECK_EQUAL(subscriber->_interactionClass->_lastSize, 8u);
+    SG_VERIFY(subscriber->_interactionClass->_lastTag.size() == 4);
+
+    // The publisher does not subscribe, so nothing comes back
+    SG_CHECK_EQUAL(publisher->_interactionClass->_numInteractions, 0u);
+
+    objectInstance->deleteInstance(RTIData());
+    SG_VERIFY(subscriber->processMessage(SGTimeStamp::fromSec(1)));
+    SG_VERIFY(!subscriber->getObjectInstance(objectInstance->getName()));
+
+    SG_VERIFY(subscriber->shutdown());
+    SG_VERIFY(publisher->shutdown());
+}
+
+class TimeSteppingThread : public SGThread {
+public:
+    TimeSteppingThread(TestFederate* federate, unsigned numSteps) :
+        _federate(federate),
+        _numSteps(numSteps),
+        _success(false)
+    { }
+
+    virtual void run()
+    {
+        SGSharedPtr<TestObjectInstance> objectInstance = new TestObjectInstance(_federate->_objectClass.get());
+        objectInstance->registerInstance();
+        _name = objectInstance->getName();
+        for (unsigned step = 0; step < _numSteps; ++step) {
+            objectInstance->setValue(0, step);
+            objectInstance->updateAttributeValues(SGTimeStamp::fromSec(double(step + 1)), RTIData());
+            if (!_federate->timeAdvanceBy(SGTimeStamp::fromSec(1)))
+                return;
+        }
+        _success = true;
+    }
+
+    SGSharedPtr<TestFederate> _federate;
+    unsigned _numSteps;
+    std::string _name;
+    bool _success;
+};
+
+static void
+testTimeStampOrder()
+{
+    const unsigned numSteps = 50;
+
+    // Two regulating and constrained federates that reflect each other
+    SGSharedPtr<TestFederate> federates[2];
+    for (unsigned i = 0; i < 2; ++i) {
+        std::stringstream federateType;
+        federateType << "stepper" << i;
+        federates[i] = new TestFederate("TimeStampOrder", federateType.str(), true, true, 1);
+        federates[i]->setTimeRegulating(true);
+        federates[i]->setTimeConstrained(true);
+        federates[i]->setTimeIncrement(SGTimeStamp::fromSec(1));
+    }
+    for (unsigned i = 0; i < 2; ++i)
+        SG_VERIFY(federates[i]->init());
+
+    TimeSteppingThread thread0(federates[0].get(), numSteps);
+    TimeSteppingThread thread1(federates[1].get(), numSteps);
+    thread0.start();
+    thread1.start();
+    thread0.join();
+    thread1.join();
+    SG_VERIFY(thread0._success);
+    SG_VERIFY(thread1._success);
+
+    const std::string names[2] = { thread1._name, thread0._name };
+
+    for (unsigned i = 0; i < 2; ++i) {
+        SGTimeStamp federateTime;
+        SG_VERIFY(federates[i]->queryFederateTime(federateTime));
+        SG_CHECK_EQUAL(federateTime.toSecs(), double(numSteps));
+
+        // The instance registered by the other federate
+        const TestObjectInstance* discovered = findDiscoveredInstance(*federates[i], names[i]);
+        SG_VERIFY(discovered);
+        SG_VERIFY(!discovered->getAttributeOwned(1));
+        // All updates stamped up to the granted time are delivered in order
+        SG_CHECK_EQUAL(discovered->_numTimeStampedReflections, numSteps);
+        SG_CHECK_EQUAL(discovered->_numReflections, 0u);
+        SG_VERIFY(discovered->_timeOrdered);
+        SG_CHECK_EQUAL(discovered->getValue(0), numSteps - 1);
+    }
+
+    for (unsigned i = 0; i < 2; ++i)
+        SG_VERIFY(federates[i]->shutdown());
+
+    // While a time advance is pending, the sender already promised
+    // not to send anything below the requested time plus lookahead.
+    typedef RTILoopbackFederation::Handle Handle;
+    SG_CHECK_EQUAL(RTILoopbackFederation::createFederationExecution("PendingAdvance"), RTIFederate::FederationManagementSuccess);
+    SGSharedPtr<RTILoopbackFederation> federation = RTILoopbackFederation::getFederationExecution("PendingAdvance");
+    SG_VERIFY(federation.valid());
+    Handle sender = federation->join("sender");
+    Handle receiver = federation->join("receiver");
+    Handle objectClass = federation->getObjectClassHandle("Vehicle");
+    std::set<Handle> attributes;
+    attributes.insert(federation->getAttributeHandle(objectClass, "value"));
+    federation->publishObjectClass(sender, objectClass, attributes);
+    federation->subscribeObjectClass(receiver, objectClass, attributes);
+    std::string name;
+    Handle objectInstance = federation->registerObjectInstance(sender, objectClass, name);
+    const Handle federateHandles[2] = { sender, receiver };
+    for (unsigned i = 0; i < 2; ++i) {
+        SG_VERIFY(federation->enableTimeRegulation(federateHandles[i], SGTimeStamp::fromSec(1)));
+        SG_VERIFY(federation->enableTimeConstrained(federateHandles[i]));
+    }
+
+    // The sender waits for the receiver, the receiver is granted past 2
+    SG_VERIFY(federation->timeAdvanceRequest(sender, SGTimeStamp::fromSec(10), false));
+    SG_VERIFY(federation->timeAdvanceRequest(receiver, SGTimeStamp::fromSec(5), false));
+    SGTimeStamp time;
+    SG_VERIFY(federation->queryFederateTime(receiver, time));
+    SG_CHECK_EQUAL(time.toSecs(), 5.0);
+    SG_VERIFY(federation->queryFederateTime(sender, time));
+    SG_CHECK_EQUAL(time.toSecs(), 0.0);
+
+    RTILoopbackFederation::HandleDataPairList values;
+    values.push_back(RTILoopbackFederation::HandleDataPair(*attributes.begin(), RTIData("1", 1)));
+    SGTimeStamp early = SGTimeStamp::fromSec(2);
+    SG_VERIFY(!federation->updateAttributeValues(sender, objectInstance, values, RTIData(), &early));
+    SGTimeStamp valid = SGTimeStamp::fromSec(11);
+    SG_VERIFY(federation->updateAttributeValues(sender, objectInstance, values, RTIData(), &valid));
+    SG_VERIFY(federation->queryLITS(receiver, time));
+    SG_CHECK_EQUAL(time.toSecs(), 11.0);
+
+    federation->resign(receiver);
+    federation->resign(sender);
+    federation = 0;
+    SG_CHECK_EQUAL(RTILoopbackFederation::destroyFederationExecution("PendingAdvance"), RTIFederate::FederationManagementSuccess);
+}
+
+static void
+testThroughput(unsigned numSubscribers, unsigned numAttributes, unsigned numUpdates)
+{
+    SGSharedPtr<TestFederate> publisher = new TestFederate("Throughput", "publisher", true, false, numAttributes);
+    SG_VERIFY(publisher->init());
+    std::vector<SGSharedPtr<TestFederate> > subscribers;
+    for (unsigned i = 0; i < numSubscribers; ++i) {
+        subscribers.push_back(new TestFederate("Throughput", "subscriber", false, true, numAttributes));
+        SG_VERIFY(subscribers.back()->init());
+    }
+
+    SGSharedPtr<TestObjectInstance> objectInstance = new TestObjectInstance(publisher->_objectClass.get());
+    objectInstance->registerInstance();
+
+    SGTimeStamp encodeTime;
+    SGTimeStamp sendTime;
+    SGTimeStamp reflectTime;
+    for (unsigned n = 0; n < numUpdates; ++n) {
+        for (unsigned i = 0; i < numAttributes; ++i)
+            objectInstance->setValue(i, n + i);
+
+        SGTimeStamp start = SGTimeStamp::now();
+        objectInstance->encodeAttributeValues();
+        SGTimeStamp encoded = SGTimeStamp::now();
+        objectInstance->sendAttributeValues(RTIData());
+        SGTimeStamp sent = SGTimeStamp::now();
+        for (unsigned i = 0; i < numSubscribers; ++i)
+            SG_VERIFY(subscribers[i]->processMessage(SGTimeStamp::fromSec(1)));
+        SGTimeStamp reflected = SGTimeStamp::now();
+
+        encodeTime += encoded - start;
+        sendTime += sent - encoded;
+        reflectTime += reflected - sent;
+    }
+
+    for (unsigned i = 0; i < numSubscribers; ++i) {
+        TestObjectInstance* discovered = findDiscoveredInstance(*subscribers[i], objectInstance->getName());
+        SG_VERIFY(discovered);
+        SG_CHECK_EQUAL(discovered->_numReflections, numUpdates);
+        SG_CHECK_EQUAL(discovered->getValue(numAttributes - 1), numUpdates - 1 + numAttributes - 1);
+    }
+
+    double total = (encodeTime + sendTime + reflectTime).toSecs();
+    std::cout << "loopback " << numSubscribers << " subscribers, " << numAttributes << " attributes: "
+              << 1e6*encodeTime.toSecs()/numUpdates << " us encode, "
+              << 1e6*sendTime.toSecs()/numUpdates << " us send, "
+              << 1e6*reflectTime.toSecs()/(numUpdates*numSubscribers) << " us reflect per subscriber, "
+              << numUpdates/total << " updates/s" << std::endl;
+
+    for (unsigned i = 0; i < numSubscribers; ++i)
+        SG_VERIFY(subscribers[i]->shutdown());
+    SG_VERIFY(publisher->shutdown());
+}
+
+static void
+testDeltaCompression(unsigned numAttributes, unsigned numUpdates)
+{
+    SGSharedPtr<TestFederate> publisher = new TestFederate("DeltaCompression", "publisher", true, false,
+                                                           numAttributes, HLAConditionalUpdate);
+    SGSharedPtr<TestFederate> subscriber = new TestFederate("DeltaCompression", "subscriber", false, true,
+                                                            numAttributes, HLAConditionalUpdate);
+    SG_VERIFY(publisher->init());
+    SG_VERIFY(subscriber->init());
+
+    SGSharedPtr<TestObjectInstance> objectInstance = new TestObjectInstance(publisher->_objectClass.get());
+    objectInstance->registerInstance();
+
+    // Every value is set and thus dirty, but only the first one changes
+    for (unsigned n = 0; n < numUpdates; ++n) {
+        objectInstance->setValue(0, n + 1);
+        for (unsigned i = 1; i < numAttributes; ++i)
+            objectInstance->setValue(i, 1);
+        objectInstance->updateAttributeValues(RTIData());
+        SG_VERIFY(subscriber->processMessage(SGTimeStamp::fromSec(1)));
+    }
+
+    TestObjectInstance* discovered = findDiscoveredInstance(*subscriber, objectInstance->getName());
+    SG_VERIFY(discovered);
+    SG_CHECK_EQUAL(discovered->_numReflections, numUpdates);
+    SG_CHECK_EQUAL(discovered->_numReflectedAttributes, numAttributes + numUpdates - 1);
+    SG_CHECK_EQUAL(discovered->getValue(0), numUpdates);
+    for (unsigned i = 1; i < numAttributes; ++i)
+        SG_CHECK_EQUAL(discovered->getValue(i), 1);
+
+    // A value set back to what was sent last is not sent again either
+    objectInstance->setValue(0, numUpdates);
+    objectInstance->setValue(1, 2);
+    objectInstance->updateAttributeValues(RTIData());
+    SG_VERIFY(subscriber->processMessage(SGTimeStamp::fromSec(1)));
+    SG_CHECK_EQUAL(discovered->_numReflectedAttributes, numAttributes + numUpdates);
+    SG_CHECK_EQUAL(discovered->getValue(1), 2);
+
+    std::cout << "delta compression " << numAttributes << " attributes: "
+              << discovered->_numReflectedAttributes << " of " << numAttributes*(numUpdates + 1)
+              << " attribute values sent" << std::endl;
+
+    SG_VERIFY(subscriber->shutdown());
+    SG_VERIFY(publisher->shutdown());
+}
+
+int main(int argc, char* argv[])
+{
+    testReceiveOrder();
+    testTimeStampOrder();
+    testThroughput(1, 8, 10000);
+    testThroughput(8, 8, 2000);
+    testThroughput(8, 64, 1000);
+    testDeltaCompression(8, 100);
+
+    std::cout << "all tests passed successfully!" << std::endl;
+    return EXIT_SUCCESS;
+}
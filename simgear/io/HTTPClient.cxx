@@ -27,6 +27,7 @@
 #include "HTTPFileRequest.hxx"
 
 #include <sstream>
+#include <algorithm>
 #include <cassert>
 #include <cstdlib> // rand()
 #include <list>
@@ -81,8 +82,14 @@ public:
     {
         curlMulti = curl_multi_init();
         // see https://curl.haxx.se/libcurl/c/CURLMOPT_PIPELINING.html
+#if LIBCURL_VERSION_NUM >= 0x072b00
+        // libCurl dropped HTTP/1.1 pipelining, share connections
+        // by HTTP/2 multiplexing instead
+        curl_multi_setopt(curlMulti, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#else
         // we request HTTP 1.1 pipelining
         curl_multi_setopt(curlMulti, CURLMOPT_PIPELINING, 1 /* aka CURLPIPE_HTTP1 */);
+#endif
 #if (LIBCURL_VERSION_MINOR >= 30)
         curl_multi_setopt(curlMulti, CURLMOPT_MAX_TOTAL_CONNECTIONS, (long) maxConnections);
         curl_multi_setopt(curlMulti, CURLMOPT_MAX_PIPELINE_LENGTH,
@@ -95,6 +102,22 @@ public:
     typedef std::map<Request_ptr, CURL*> RequestCurlMap;
     RequestCurlMap requests;
 
+    typedef std::map<std::string, HostPolicy> HostPolicyMap;
+    HostPolicyMap hostPolicies;
+    // requests handed to libCurl, by Request::hostAndPort()
+    std::map<std::string, unsigned int> activeHostRequests;
+    Statistics stats;
+
+    void requestEnded(const Request_ptr& r)
+    {
+        std::string host = r->hostAndPort();
+        if (--activeHostRequests[host] == 0) {
+            activeHostRequests.erase(host);
+        }
+    }
+
+    void recordTiming(Request* req, CURL* e, CURLcode result);
+
     std::string userAgent;
     std::string proxy;
     int proxyPort;
@@ -103,6 +126,7 @@ public:
     unsigned int maxHostConnections;
     unsigned int maxPipelineDepth;
 
+    // requests held back by their HostPolicy, by descending priority
     RequestList pendingRequests;
 
     SGTimeStamp timeTransferSample;
@@ -111,6 +135,73 @@ public:
     uint64_t totalBytesDownloaded;
 };
 
+#if LIBCURL_VERSION_NUM >= 0x073d00
+#  define SG_CURL_PHASE_TIME(phase) CURLINFO_##phase##_TIME_T
+#else
+#  define SG_CURL_PHASE_TIME(phase) CURLINFO_##phase##_TIME
+#endif
+
+// seconds from the start of the transfer to the end of a phase
+static double phaseTime(CURL* e, CURLINFO info)
+{
+#if LIBCURL_VERSION_NUM >= 0x073d00
+    curl_off_t usec = 0;
+    curl_easy_getinfo(e, info, &usec);
+    return usec * 1e-6;
+#else
+    double sec = 0.0;
+    curl_easy_getinfo(e, info, &sec);
+    return sec;
+#endif
+}
+
+void Client::ClientPrivate::recordTiming(Request* req, CURL* e, CURLcode result)
+{
+    Request::Timing& t = req->_timing;
+    t.lookup = phaseTime(e, SG_CURL_PHASE_TIME(NAMELOOKUP));
+    t.connect = phaseTime(e, SG_CURL_PHASE_TIME(CONNECT));
+    t.tls = phaseTime(e, SG_CURL_PHASE_TIME(APPCONNECT));
+    t.firstByte = phaseTime(e, SG_CURL_PHASE_TIME(STARTTRANSFER));
+    t.total = phaseTime(e, SG_CURL_PHASE_TIME(TOTAL));
+
+    long connects = 0;
+    curl_easy_getinfo(e, CURLINFO_NUM_CONNECTS, &connects);
+    // a failed connect makes no connection either
+    t.reusedConnection = (connects == 0) && (result == CURLE_OK);
+
+    stats.requests++;
+    stats.newConnections += connects;
+    stats.reusedConnections += t.reusedConnection;
+    stats.multiplexedRequests += (req->responseVersion() == Request::HTTP_2);
+    stats.queued += t.queued;
+    stats.lookup += t.lookup;
+    stats.connect += t.connect;
+    stats.tls += t.tls;
+    stats.firstByte += t.firstByte;
+    stats.total += t.total;
+}
+
+Client::HostPolicy::HostPolicy() :
+    maxActiveRequests(0),
+    reuseConnections(true),
+    multiplex(true)
+{
+}
+
+Client::Statistics::Statistics() :
+    requests(0),
+    newConnections(0),
+    reusedConnections(0),
+    multiplexedRequests(0),
+    queued(0.0),
+    lookup(0.0),
+    connect(0.0),
+    tls(0.0),
+    firstByte(0.0),
+    total(0.0)
+{
+}
+
 Client::Client() :
     d(new ClientPrivate)
 {
@@ -122,6 +213,7 @@ Client::Client() :
     d->timeTransferSample.stamp();
     d->totalBytesDownloaded = 0;
     d->maxPipelineDepth = 5;
+    d->hostPolicies[std::string()] = HostPolicy();
     setUserAgent("SimGear-" SG_STRINGIZE(SIMGEAR_VERSION));
 
     static bool didInitCurlGlobal = false;
@@ -165,8 +257,30 @@ void Client::setMaxPipelineDepth(unsigned int depth)
 #endif
 }
 
+void Client::setHostPolicy(const std::string& host, const HostPolicy& policy)
+{
+    d->hostPolicies[host] = policy;
+    // a raised limit frees slots right away
+    dispatchRequests();
+}
+
+const Client::HostPolicy& Client::hostPolicy(const std::string& host) const
+{
+    ClientPrivate::HostPolicyMap::const_iterator it = d->hostPolicies.find(host);
+    if (it == d->hostPolicies.end()) {
+        it = d->hostPolicies.find(std::string());
+    }
+    return it->second;
+}
+
+const Client::Statistics& Client::statistics() const
+{
+    return d->stats;
+}
+
 void Client::update(int waitTimeout)
 {
+    dispatchRequests();
     if (d->requests.empty()) {
         // curl_multi_wait returns immediately if there's no requests active,
         // but that can cause high CPU usage for us.
@@ -224,6 +338,8 @@ void Client::update(int waitTimeout)
           assert(it != d->requests.end());
           assert(it->second == e);
           d->requests.erase(it);
+          d->requestEnded(req);
+          d->recordTiming(req, e, msg->data.result);
 
         if (msg->data.result == 0) {
           req->responseComplete();
@@ -240,6 +356,9 @@ void Client::update(int waitTimeout)
           SG_LOG(SG_IO, SG_ALERT, "unknown CurlMSG:" << msg->msg);
       }
     } // of curl message processing loop
+
+    // start requests waiting for the ones just completed
+    dispatchRequests();
 }
 
 void Client::makeRequest(const Request_ptr& r)
@@ -261,6 +380,41 @@ void Client::makeRequest(const Request_ptr& r)
 
     assert(d->requests.find(r) == d->requests.end());
 
+    // queue behind the requests of the same or higher priority
+    RequestList::iterator pos = d->pendingRequests.begin();
+    while ((pos != d->pendingRequests.end()) &&
+           ((*pos)->priority() >= r->priority())) {
+        ++pos;
+    }
+    d->pendingRequests.insert(pos, r);
+    r->_queueStart.stamp();
+
+    dispatchRequests();
+}
+
+void Client::dispatchRequests()
+{
+    RequestList::iterator it = d->pendingRequests.begin();
+    while (it != d->pendingRequests.end()) {
+        std::string host = (*it)->hostAndPort();
+        unsigned int limit = hostPolicy(host).maxActiveRequests;
+        if ((limit > 0) && (d->activeHostRequests[host] >= limit)) {
+            ++it; // other hosts may still have room
+            continue;
+        }
+
+        Request_ptr r = *it;
+        it = d->pendingRequests.erase(it);
+        startRequest(r);
+    }
+}
+
+void Client::startRequest(const Request_ptr& r)
+{
+    const HostPolicy& policy = hostPolicy(r->hostAndPort());
+    d->activeHostRequests[r->hostAndPort()]++;
+    r->_timing.queued = r->_queueStart.elapsedUSec() * 1e-6;
+
     CURL* curlRequest = curl_easy_init();
     curl_easy_setopt(curlRequest, CURLOPT_URL, r->url().c_str());
 
@@ -276,7 +430,24 @@ void Client::makeRequest(const Request_ptr& r)
     curl_easy_setopt(curlRequest, CURLOPT_HEADERDATA, r.get());
 
     curl_easy_setopt(curlRequest, CURLOPT_USERAGENT, d->userAgent.c_str());
-    curl_easy_setopt(curlRequest, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+#if LIBCURL_VERSION_NUM >= 0x072f00
+    if (policy.multiplex) {
+      // HTTP/2 where TLS negotiates it, plain connections stay HTTP/1.1
+      curl_easy_setopt(curlRequest, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+      curl_easy_setopt(curlRequest, CURLOPT_PIPEWAIT, 1L);
+      // stream weights range from 1 to 256, defaulting to 16
+      long weight = std::max(1, std::min(256, 16 + r->priority()));
+      curl_easy_setopt(curlRequest, CURLOPT_STREAM_WEIGHT, weight);
+    } else
+#endif
+    {
+      curl_easy_setopt(curlRequest, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+    }
+
+    if (!policy.reuseConnections) {
+      curl_easy_setopt(curlRequest, CURLOPT_FRESH_CONNECT, 1L);
+      curl_easy_setopt(curlRequest, CURLOPT_FORBID_REUSE, 1L);
+    }
 
     if (sglog().would_log(SG_TERRASYNC, SG_DEBUG)) {
         curl_easy_setopt(curlRequest, CURLOPT_VERBOSE, 1);
@@ -345,6 +516,14 @@ void Client::makeRequest(const Request_ptr& r)
 
 void Client::cancelRequest(const Request_ptr &r, std::string reason)
 {
+    RequestList::iterator pending = std::find(d->pendingRequests.begin(),
+                                              d->pendingRequests.end(), r);
+    if (pending != d->pendingRequests.end()) {
+        d->pendingRequests.erase(pending);
+        r->setFailure(-1, reason);
+        return;
+    }
+
     ClientPrivate::RequestCurlMap::iterator it = d->requests.find(r);
     if(it == d->requests.end()) {
         // already being removed, presumably inside ::update()
@@ -362,6 +541,7 @@ void Client::cancelRequest(const Request_ptr &r, std::string reason)
 
     curl_easy_cleanup(it->second);
     d->requests.erase(it);
+    d->requestEnded(r);
 
     r->setFailure(-1, reason);
 }
@@ -419,7 +599,7 @@ void Client::setProxy( const std::string& proxy,
 
 bool Client::hasActiveRequests() const
 {
-    return !d->requests.empty();
+    return !d->requests.empty() || !d->pendingRequests.empty();
 }
 
 void Client::receivedBytes(unsigned int count)
@@ -542,6 +722,10 @@ void Client::debugDumpRequests()
     for (; it != d->requests.end(); ++it) {
         SG_LOG(SG_IO, SG_INFO, "\t" << it->first->url());
     }
+    RequestList::iterator pending = d->pendingRequests.begin();
+    for (; pending != d->pendingRequests.end(); ++pending) {
+        SG_LOG(SG_IO, SG_INFO, "\t" << (*pending)->url() << " (queued)");
+    }
     SG_LOG(SG_IO, SG_INFO, "==");
 }
 
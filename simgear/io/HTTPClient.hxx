@@ -81,9 +81,60 @@ public:
 
     /**
      * maximum depth to pipeline requests - set to 0 to disable pipelining
+     *
+     * @note libCurl dropped HTTP/1.1 pipelining, requests to a host share
+     *       connections by HTTP/2 multiplexing instead, see HostPolicy.
      */
     void setMaxPipelineDepth(unsigned int depth);
 
+    /**
+     * How requests to a host use connections.
+     */
+    struct HostPolicy
+    {
+        HostPolicy();
+
+        /// Requests to the host transferring at once, 0 for no limit.
+        /// Further requests wait in the order of their priority.
+        unsigned int maxActiveRequests;
+        /// Keep connections open for later requests to the host
+        bool reuseConnections;
+        /// Negotiate HTTP/2 on TLS connections, and wait for a connection
+        /// being set up to multiplex on instead of opening another one
+        bool multiplex;
+    };
+
+    /**
+     * Set the policy for requests to host, given with the port as in
+     * Request::hostAndPort(). The policy of the empty host applies to
+     * all hosts without their own.
+     */
+    void setHostPolicy(const std::string& host, const HostPolicy& policy);
+    const HostPolicy& hostPolicy(const std::string& host) const;
+
+    /**
+     * Totals over the requests completed or failed since construction.
+     * The times are sums of their Request::timing(), to see where the
+     * transfer time goes.
+     */
+    struct Statistics
+    {
+        Statistics();
+
+        unsigned int requests;
+        unsigned int newConnections;
+        unsigned int reusedConnections;
+        unsigned int multiplexedRequests; ///< received over HTTP/2
+        double queued;
+        double lookup;
+        double connect;
+        double tls;
+        double firstByte;
+        double total;
+    };
+
+    const Statistics& statistics() const;
+
     const std::string& userAgent() const;
 
     const std::string& proxyHost() const;
@@ -119,6 +170,9 @@ private:
 
     void requestFinished(Connection* con);
 
+    void dispatchRequests();
+    void startRequest(const Request_ptr& r);
+
     void receivedBytes(unsigned int count);
 
     friend class Connection;
@@ -41,12 +41,26 @@ Request::Request(const std::string& url, const std::string method):
   _responseLength(0),
   _receivedBodyBytes(0),
   _ready_state(UNSENT),
+  _priority(0),
   _willClose(false),
   _connectionCloseHeader(false)
 {
 
 }
 
+//------------------------------------------------------------------------------
+Request::Timing::Timing():
+  queued(0.0),
+  lookup(0.0),
+  connect(0.0),
+  tls(0.0),
+  firstByte(0.0),
+  total(0.0),
+  reusedConnection(false)
+{
+
+}
+
 //------------------------------------------------------------------------------
 Request::~Request()
 {
@@ -126,6 +140,7 @@ Request::HTTPVersion decodeHTTPVersion(const std::string& v)
 {
   if( v == "HTTP/1.1" ) return Request::HTTP_1_1;
   if( v == "HTTP/1.0" ) return Request::HTTP_1_0;
+  if( v == "HTTP/2" || v == "HTTP/2.0" ) return Request::HTTP_2;
   if( strutils::starts_with(v, "HTTP/0.") ) return Request::HTTP_0_x;
   return Request::HTTP_VERSION_UNKNOWN;
 }
@@ -379,8 +394,8 @@ void Request::setReadyState(ReadyState state)
 //------------------------------------------------------------------------------
 bool Request::closeAfterComplete() const
 {
-  // for non HTTP/1.1 connections, assume server closes
-  return _willClose || (_responseVersion != HTTP_1_1);
+  // for connections older than HTTP/1.1, assume server closes
+  return _willClose || (_responseVersion < HTTP_1_1);
 }
 
 //------------------------------------------------------------------------------
@@ -393,7 +408,7 @@ void Request::setCloseAfterComplete()
 //------------------------------------------------------------------------------
 bool Request::serverSupportsPipelining() const
 {
-    return (_responseVersion == HTTP_1_1) && !_connectionCloseHeader;
+    return (_responseVersion >= HTTP_1_1) && !_connectionCloseHeader;
 }
 
 //------------------------------------------------------------------------------
@@ -27,6 +27,7 @@
 #include <simgear/structure/SGReferenced.hxx>
 #include <simgear/structure/SGSharedPtr.hxx>
 #include <simgear/math/sg_types.hxx>
+#include <simgear/timing/timestamp.hxx>
 
 #include <boost/bind.hpp>
 
@@ -191,7 +192,8 @@ public:
         HTTP_VERSION_UNKNOWN = 0,
         HTTP_0_x, // 0.9 or similar
         HTTP_1_0,
-        HTTP_1_1
+        HTTP_1_1,
+        HTTP_2
     };
 
     HTTPVersion responseVersion() const
@@ -199,6 +201,42 @@ public:
 
     ReadyState readyState() const { return _ready_state; }
 
+    /**
+     * Requests with a higher priority are started first when the client
+     * holds requests back, see Client::HostPolicy. The default is 0.
+     * Set it before passing the request to the client.
+     */
+    void setPriority(int priority)
+        { _priority = priority; }
+    int priority() const
+        { return _priority; }
+
+    /**
+     * Where the time of a request went. All times are in seconds, and
+     * except for queued they count from when the transfer started until
+     * the end of each phase. Phases which were skipped, like the lookup
+     * and connect on a reused connection, end right at the start.
+     */
+    struct Timing
+    {
+        Timing();
+
+        double queued;    ///< held back by the client before the transfer
+        double lookup;    ///< DNS lookup done
+        double connect;   ///< TCP connection established
+        double tls;       ///< TLS handshake done
+        double firstByte; ///< first response byte received
+        double total;     ///< response complete
+        bool   reusedConnection;
+    };
+
+    /**
+     * The timing of the transfer, valid once the request completed or
+     * failed.
+     */
+    const Timing& timing() const
+        { return _timing; }
+
     bool closeAfterComplete() const;
     bool isComplete() const;
 
@@ -258,6 +296,9 @@ private:
                             _cb_always;
 
     ReadyState    _ready_state;
+    int           _priority;
+    Timing        _timing;
+    SGTimeStamp   _queueStart;
     bool          _willClose;
     bool          _connectionCloseHeader;
 };
@@ -22,6 +22,7 @@
 
 
 #include "iochannel.hxx"
+#include "raw_socket.hxx"
 
 
 // constructor
@@ -66,6 +67,34 @@ int SGIOChannel::writestring( const char *str ) {
 }
 
 
+// read one message into the ring
+int SGIOChannel::readBatch( simgear::DatagramRing& ring ) {
+    if ( ring.full() ) {
+        return 0;
+    }
+    int result = read( ring.back(), ring.slotSize() );
+    if ( result <= 0 ) {
+        return 0;
+    }
+    ring.commit( result );
+    return 1;
+}
+
+
+// write the messages of the ring one by one
+int SGIOChannel::writeBatch( simgear::DatagramRing& ring ) {
+    int count = 0;
+    while ( !ring.empty() ) {
+        if ( write( ring.front(), ring.frontLength() ) <= 0 ) {
+            break;
+        }
+        ring.pop();
+        count++;
+    }
+    return count;
+}
+
+
 // dummy close routine
 bool SGIOChannel::close() {
     return false;
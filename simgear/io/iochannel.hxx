@@ -32,6 +32,8 @@
 
 #define SG_IO_MAX_MSG_SIZE 16384
 
+namespace simgear { class DatagramRing; }
+
 /**
  * Specify if this is a read (IN), write (OUT), or r/w (BI) directional
  * channel
@@ -135,6 +137,26 @@ public:
      */
     virtual int writestring( const char *str );
 
+    /**
+     * The readBatch() method reads as many messages as are waiting and
+     * fit into the free slots of ring, one per slot, for protocols that
+     * handle many small messages. The default reads one with read().
+     * Channels that keep message boundaries, like UDP sockets, read
+     * them with fewer system calls.
+     * @param ring the ring to append the messages to
+     * @return number of messages read
+     */
+    virtual int readBatch( simgear::DatagramRing& ring );
+
+    /**
+     * The writeBatch() method writes the messages queued in ring and
+     * removes them from it. The default writes them one by one with
+     * write().
+     * @param ring the messages to write
+     * @return number of messages written
+     */
+    virtual int writeBatch( simgear::DatagramRing& ring );
+
     /**
      * The close() method is modeled after the close() Unix system
      * call and will close an open device. You should call this method
@@ -57,7 +57,9 @@
 #define socklen_t int
 #endif
 
+#include <algorithm>
 #include <map>
+#include <vector>
 
 #include <simgear/debug/logstream.hxx>
 #include <simgear/structure/exception.hxx>
@@ -626,6 +628,37 @@ int Socket::sendto ( const void * buffer, int size,
 }
 
 
+int Socket::sendv ( const void* const* buffers, const int* sizes, int count,
+                     int flags )
+{
+  assert ( handle != -1 ) ;
+#if defined(WINSOCK)
+  std::vector<WSABUF> bufs ( count ) ;
+  for ( int i = 0; i < count; i++ )
+  {
+    bufs[i].buf = (char*)buffers[i] ;
+    bufs[i].len = sizes[i] ;
+  }
+  DWORD sent = 0 ;
+  if ( WSASend(handle, bufs.data(), count, &sent, flags, NULL, NULL) != 0 )
+    return -1 ;
+  return (int)sent ;
+#else
+  std::vector<struct iovec> iovs ( count ) ;
+  for ( int i = 0; i < count; i++ )
+  {
+    iovs[i].iov_base = (void*)buffers[i] ;
+    iovs[i].iov_len = sizes[i] ;
+  }
+  struct msghdr msg ;
+  memset(&msg, 0, sizeof(msg)) ;
+  msg.msg_iov = iovs.data() ;
+  msg.msg_iovlen = count ;
+  return ::sendmsg(handle, &msg, flags | MSG_NOSIGNAL) ;
+#endif
+}
+
+
 int Socket::recv (void * buffer, int size, int flags)
 {
   assert ( handle != -1 ) ;
@@ -642,6 +675,195 @@ int Socket::recvfrom ( void * buffer, int size,
 }
 
 
+DatagramRing::DatagramRing ( unsigned int s, unsigned int size ) :
+  slots ( s ? s : 1 ),
+  slot_size ( size ),
+  head ( 0 ),
+  count ( 0 ),
+  data ( slots * slot_size ),
+  lengths ( slots, 0 ),
+  addresses ( slots ),
+  has_address ( slots, 0 )
+{
+  // allocate the addresses up front, recvBatch() receives into them
+  for ( unsigned int i = 0; i < slots; i++ )
+    addresses[i].getAddr() ;
+}
+
+
+const IPAddress* DatagramRing::frontAddress () const
+{
+  return has_address[head] ? &addresses[head] : 0 ;
+}
+
+
+void DatagramRing::pop ()
+{
+  assert ( count > 0 ) ;
+  head = (head + 1) % slots ;
+  count-- ;
+}
+
+
+void DatagramRing::commit ( unsigned int length, const IPAddress* address )
+{
+  assert ( count < slots ) ;
+  unsigned int i = index(count) ;
+  lengths[i] = std::min(length, slot_size) ;
+  has_address[i] = address != 0 ;
+  if ( address )
+    memcpy(addresses[i].getAddr(), address->getAddr(), address->getAddrLen()) ;
+  count++ ;
+}
+
+
+bool DatagramRing::push ( const void* buffer, unsigned int length,
+                          const IPAddress* to )
+{
+  if ( full() || length > slot_size )
+    return false ;
+  memcpy(back(), buffer, length) ;
+  commit(length, to) ;
+  return true ;
+}
+
+
+// Without MSG_DONTWAIT the fallbacks below only move one datagram per
+// call, as the next could block
+#if defined(MSG_DONTWAIT)
+#  define SG_MSG_DONTWAIT MSG_DONTWAIT
+#else
+#  define SG_MSG_DONTWAIT 0
+#endif
+
+// The datagrams moved per system call
+enum { MAX_BATCH = 64 } ;
+
+int Socket::recvBatch ( DatagramRing& ring, int flags )
+{
+  assert ( handle != -1 ) ;
+  int received = 0 ;
+  while ( !ring.full() )
+  {
+    // the free slots up to the end of the ring are contiguous
+    unsigned int first = ring.index(ring.count) ;
+    unsigned int n = std::min(ring.slots - ring.count, ring.slots - first) ;
+    n = std::min(n, (unsigned int)MAX_BATCH) ;
+    int result = 0 ;
+#if defined(HAVE_RECVMMSG)
+    struct mmsghdr msgs[MAX_BATCH] ;
+    struct iovec iovs[MAX_BATCH] ;
+    memset(msgs, 0, n * sizeof(struct mmsghdr)) ;
+    for ( unsigned int i = 0; i < n; i++ )
+    {
+      iovs[i].iov_base = &ring.data[(first + i) * ring.slot_size] ;
+      iovs[i].iov_len = ring.slot_size ;
+      msgs[i].msg_hdr.msg_iov = &iovs[i] ;
+      msgs[i].msg_hdr.msg_iovlen = 1 ;
+      msgs[i].msg_hdr.msg_name = ring.addresses[first + i].getAddr() ;
+      msgs[i].msg_hdr.msg_namelen = ring.addresses[first + i].getAddrLen() ;
+    }
+    result = ::recvmmsg(handle, msgs, n,
+                        flags | (received ? MSG_DONTWAIT : MSG_WAITFORONE),
+                        NULL) ;
+    for ( int i = 0; i < result; i++ )
+      ring.lengths[first + i] = std::min((unsigned int)msgs[i].msg_len,
+                                         ring.slot_size) ;
+#else
+    while ( result < (int)n )
+    {
+      if ( (received || result) && !SG_MSG_DONTWAIT )
+        break ;
+      IPAddress& from = ring.addresses[first + result] ;
+      socklen_t fromlen = (socklen_t) from.getAddrLen() ;
+      int length = ::recvfrom(handle,
+                              &ring.data[(first + result) * ring.slot_size],
+                              ring.slot_size,
+                              (received || result) ? flags | SG_MSG_DONTWAIT
+                                                   : flags,
+                              from.getAddr(), &fromlen) ;
+      if ( length < 0 )
+      {
+        if ( !result )
+          result = -1 ;
+        break ;
+      }
+      ring.lengths[first + result] = std::min((unsigned int)length,
+                                              ring.slot_size) ;
+      result++ ;
+    }
+#endif
+    if ( result <= 0 )
+      return received ? received : result ;
+    for ( int i = 0; i < result; i++ )
+      ring.has_address[first + i] = 1 ;
+    ring.count += result ;
+    received += result ;
+    if ( result < (int)n )
+      break ;
+  }
+  return received ;
+}
+
+
+int Socket::sendBatch ( DatagramRing& ring, int flags )
+{
+  assert ( handle != -1 ) ;
+  int sent = 0 ;
+  while ( !ring.empty() )
+  {
+    // the queued slots up to the end of the ring are contiguous
+    unsigned int first = ring.head ;
+    unsigned int n = std::min(ring.count, ring.slots - first) ;
+    n = std::min(n, (unsigned int)MAX_BATCH) ;
+    int result = 0 ;
+#if defined(HAVE_SENDMMSG)
+    struct mmsghdr msgs[MAX_BATCH] ;
+    struct iovec iovs[MAX_BATCH] ;
+    memset(msgs, 0, n * sizeof(struct mmsghdr)) ;
+    for ( unsigned int i = 0; i < n; i++ )
+    {
+      iovs[i].iov_base = &ring.data[(first + i) * ring.slot_size] ;
+      iovs[i].iov_len = ring.lengths[first + i] ;
+      msgs[i].msg_hdr.msg_iov = &iovs[i] ;
+      msgs[i].msg_hdr.msg_iovlen = 1 ;
+      if ( ring.has_address[first + i] )
+      {
+        msgs[i].msg_hdr.msg_name = ring.addresses[first + i].getAddr() ;
+        msgs[i].msg_hdr.msg_namelen = ring.addresses[first + i].getAddrLen() ;
+      }
+    }
+    result = ::sendmmsg(handle, msgs, n, flags | MSG_NOSIGNAL) ;
+#else
+    for ( ; result < (int)n; result++ )
+    {
+      const char* buffer = &ring.data[(first + result) * ring.slot_size] ;
+      int length = ring.lengths[first + result] ;
+      int r ;
+      if ( ring.has_address[first + result] )
+        r = sendto(buffer, length, flags, &ring.addresses[first + result]) ;
+      else
+        r = send(buffer, length, flags) ;
+      if ( r < 0 )
+      {
+        if ( !result )
+          result = -1 ;
+        break ;
+      }
+    }
+#endif
+    if ( result <= 0 )
+      return sent ? sent : result ;
+    ring.head = (first + result) % ring.slots ;
+    ring.count -= result ;
+    sent += result ;
+    if ( result < (int)n )
+      break ;
+  }
+  return sent ;
+}
+
+
 void Socket::close (void)
 {
   if ( handle != -1 )
@@ -29,6 +29,8 @@
 //#  include <netinet/in.h>
 //#endif
 
+#include <vector>
+
 struct sockaddr_in;
 struct sockaddr;
      
@@ -68,6 +70,54 @@ public:
 };
 
 
+/*
+ * A ring of fixed size datagram slots, filled by Socket::recvBatch() and
+ * drained by Socket::sendBatch(). Datagrams are added at the back and
+ * taken from the front.
+ */
+class DatagramRing
+{
+  unsigned int slots ;
+  unsigned int slot_size ;
+  unsigned int head ;
+  unsigned int count ;
+  std::vector<char> data ;
+  std::vector<unsigned int> lengths ;
+  std::vector<IPAddress> addresses ;
+  std::vector<char> has_address ;
+
+  friend class Socket ;
+public:
+
+  DatagramRing ( unsigned int slots, unsigned int slot_size ) ;
+
+  unsigned int capacity () const { return slots ; }
+  unsigned int slotSize () const { return slot_size ; }
+  unsigned int size () const { return count ; }
+  bool empty () const { return count == 0 ; }
+  bool full () const { return count == slots ; }
+
+  // The oldest datagram, and where it came from or goes to
+  const char* front () const { return &data[head * slot_size] ; }
+  unsigned int frontLength () const { return lengths[head] ; }
+  const IPAddress* frontAddress () const ;
+  void pop () ;
+
+  // The free slot at the back, to fill in and then commit()
+  char* back () { return &data[index(count) * slot_size] ; }
+  void commit ( unsigned int length, const IPAddress* address = 0 ) ;
+
+  // Queue a copy of a datagram, for "to" or the connected peer. Returns
+  // false if the ring is full or the datagram longer than a slot.
+  bool push ( const void* buffer, unsigned int length,
+              const IPAddress* to = 0 ) ;
+  void clear () { head = count = 0 ; }
+
+private:
+  unsigned int index ( unsigned int i ) const { return (head + i) % slots ; }
+} ;
+
+
 /*
  * Socket type
  */
@@ -94,9 +144,28 @@ public:
   int   connect     ( IPAddress* addr ) ;
   int   send	    ( const void * buffer, int size, int flags = 0 ) ;
   int   sendto      ( const void * buffer, int size, int flags, const IPAddress* to ) ;
+  // send count buffers as one, with a single system call
+  int   sendv       ( const void* const* buffers, const int* sizes, int count,
+                      int flags = 0 ) ;
   int   recv	    ( void * buffer, int size, int flags = 0 ) ;
   int   recvfrom    ( void * buffer, int size, int flags, IPAddress* from ) ;
 
+  /**
+   * Receive the waiting datagrams into the free slots of ring, with as
+   * few system calls as possible (recvmmsg() where available). Only
+   * waits for the first one on a blocking socket. Datagrams longer than
+   * a slot are truncated.
+   * @return the number of datagrams received, or -1 on error
+   */
+  int   recvBatch   ( DatagramRing& ring, int flags = 0 ) ;
+
+  /**
+   * Send the datagrams queued in ring and remove them from it, with as
+   * few system calls as possible (sendmmsg() where available).
+   * @return the number of datagrams sent, or -1 on error
+   */
+  int   sendBatch   ( DatagramRing& ring, int flags = 0 ) ;
+
   void setBlocking ( bool blocking ) ;
   void setBroadcast ( bool broadcast ) ;
 
@@ -26,8 +26,10 @@
 #include <simgear_config.h>
 #include "sg_netBuffer.hxx"
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <utility>
 
 #include <simgear/debug/logstream.hxx>
 
@@ -81,6 +83,182 @@ bool NetBuffer::append (int n)
   return false ;
 }
 
+NetBufferChain::Segment::Segment ( int _capacity ) :
+  capacity ( _capacity )
+{
+  data.reserve ( capacity ) ;
+}
+
+NetBufferChain::Segment::Segment ( std::string&& s ) :
+  data ( std::move(s) )
+{
+  capacity = (int)data.size() ;
+}
+
+NetBufferChain::NetBufferChain ( int _segment_size ) :
+  length ( 0 ),
+  segment_size ( _segment_size > 0 ? _segment_size : 16384 )
+{
+}
+
+void NetBufferChain::append (const char* s, int n)
+{
+  while (n > 0)
+  {
+    // extend the last slice if it ends its segment, which has room left;
+    // a shared segment only grows for the chain that appends first
+    Slice* last = slices.empty() ? NULL : &slices.back() ;
+    if (!last || last->pos + last->length != last->segment->getLength()
+        || last->segment->getLength() == last->segment->capacity)
+    {
+      Slice slice ;
+      slice.segment = new Segment ( segment_size ) ;
+      slice.pos = 0 ;
+      slice.length = 0 ;
+      slices.push_back ( slice ) ;
+      last = &slices.back() ;
+    }
+    Segment* segment = last->segment ;
+    int count = std::min(n, segment->capacity - segment->getLength()) ;
+    segment->data.append(s, count) ;
+    last->length += count ;
+    length += count ;
+    s += count ;
+    n -= count ;
+  }
+}
+
+void NetBufferChain::append (std::string&& s)
+{
+  if (s.empty())
+    return ;
+  Segment* segment = new Segment ( std::move(s) ) ;
+  append ( segment, 0, segment->getLength() ) ;
+}
+
+void NetBufferChain::append (Segment* segment, int pos, int n)
+{
+  SGSharedPtr<Segment> ref ( segment ) ;
+  assert (pos>=0 && n>=0 && (pos+n)<=segment->getLength()) ;
+  if (n == 0)
+    return ;
+  Slice slice ;
+  slice.segment = ref ;
+  slice.pos = pos ;
+  slice.length = n ;
+  slices.push_back ( slice ) ;
+  length += n ;
+}
+
+void NetBufferChain::append (const NetBufferChain& chain)
+{
+  // also works for chain == this
+  size_t count = chain.slices.size() ;
+  for (size_t i = 0; i < count; i++)
+  {
+    slices.push_back ( chain.slices[i] ) ;
+    length += chain.slices[i].length ;
+  }
+}
+
+void NetBufferChain::remove (int n)
+{
+  assert (n>=0 && n<=length) ;
+  length -= n ;
+  while (n > 0)
+  {
+    Slice& first = slices.front() ;
+    if (n < first.length)
+    {
+      first.pos += n ;
+      first.length -= n ;
+      break ;
+    }
+    n -= first.length ;
+    slices.pop_front() ;
+  }
+}
+
+void NetBufferChain::remove ()
+{
+  slices.clear() ;
+  length = 0 ;
+}
+
+bool NetBufferChain::matches (size_t slice, int pos, const char* needle,
+                              int n) const
+{
+  while (n > 0)
+  {
+    const Slice& s = slices[slice++] ;
+    int count = std::min(n, s.length - pos) ;
+    if (memcmp(s.getData() + pos, needle, count))
+      return false ;
+    needle += count ;
+    n -= count ;
+    pos = 0 ;
+  }
+  return true ;
+}
+
+int NetBufferChain::find (const char* needle, int n, int pos) const
+{
+  if (n <= 0)
+    return pos <= length ? pos : -1 ;
+  int base = 0 ;
+  for (size_t i = 0; i < slices.size(); i++)
+  {
+    const Slice& slice = slices[i] ;
+    const char* data = slice.getData() ;
+    int start = std::max(pos - base, 0) ;
+    while (start < slice.length)
+    {
+      const char* hit = (const char*)memchr(data + start, needle[0],
+                                            slice.length - start) ;
+      if (!hit)
+        break ;
+      int offset = hit - data ;
+      if (base + offset + n > length)
+        return -1 ;
+      if (matches(i, offset, needle, n))
+        return base + offset ;
+      start = offset + 1 ;
+    }
+    base += slice.length ;
+  }
+  return -1 ;
+}
+
+void NetBufferChain::copy (int pos, int n, char* out) const
+{
+  assert (pos>=0 && n>=0 && (pos+n)<=length) ;
+  for (size_t i = 0; n > 0; i++)
+  {
+    const Slice& slice = slices[i] ;
+    if (pos >= slice.length)
+    {
+      pos -= slice.length ;
+      continue ;
+    }
+    int count = std::min(n, slice.length - pos) ;
+    memcpy(out, slice.getData() + pos, count) ;
+    out += count ;
+    n -= count ;
+    pos = 0 ;
+  }
+}
+
+int NetBufferChain::getSlices (const void** buffers, int* sizes, int max) const
+{
+  int count = std::min((int)slices.size(), max) ;
+  for (int i = 0; i < count; i++)
+  {
+    buffers[i] = slices[i].getData() ;
+    sizes[i] = slices[i].length ;
+  }
+  return count ;
+}
+
 NetBufferChannel::NetBufferChannel (int in_buffer_size, int out_buffer_size) :
     in_buffer (in_buffer_size),
     out_buffer (out_buffer_size),
@@ -99,11 +277,15 @@ void NetBufferChannel::handleClose ( void )
 
 bool NetBufferChannel::bufferSend (const char* msg, int msg_len)
 {
-  if ( out_buffer.append(msg,msg_len) )
-    return true ;
-    
-  SG_LOG(SG_IO, SG_WARN, "NetBufferChannel: output buffer overflow!" ) ;
-  return false ;
+  out_buffer.append(msg,msg_len) ;
+  interestChanged () ;
+  return true ;
+}
+
+void NetBufferChannel::bufferSendOwned (std::string&& msg)
+{
+  out_buffer.append(std::move(msg)) ;
+  interestChanged () ;
 }
 
 void NetBufferChannel::handleBufferRead (NetBuffer& buffer)
@@ -135,18 +317,18 @@ NetBufferChannel::handleRead (void)
 void
 NetBufferChannel::handleWrite (void)
 {
-  if (out_buffer.getLength())
+  if (!out_buffer.isEmpty())
   {
     if (isConnected())
     {
-      int length = out_buffer.getLength() ;
-      if (length>512)
-        length=512;
-      int num_sent = NetChannel::send (
-        out_buffer.getData(), length);
+      enum { MAX_SLICES = 64 } ;
+      const void* buffers [ MAX_SLICES ] ;
+      int sizes [ MAX_SLICES ] ;
+      int count = out_buffer.getSlices (buffers, sizes, MAX_SLICES) ;
+      int num_sent = NetChannel::sendv (buffers, sizes, count) ;
       if (num_sent > 0)
       {
-        out_buffer.remove (0, num_sent);
+        out_buffer.remove (num_sent);
         //ulSetError ( UL_DEBUG, "netBufferChannel: %d sent", num_sent ) ;
       }
     }
@@ -79,6 +79,10 @@
 #define SG_NET_BUFFER_H
 
 #include <simgear/io/sg_netChannel.hxx>
+#include <simgear/structure/SGSharedPtr.hxx>
+
+#include <deque>
+#include <string>
 
 namespace simgear
 {
@@ -114,6 +118,76 @@ public:
   bool append (int n);
 };
 
+// ===========================================================================
+// NetBufferChain
+// ===========================================================================
+
+/*
+**  A byte queue without a size limit, made of slices of reference counted
+**  segments. Appending copies into the last segment while it has room,
+**  but strings can be handed over and segments shared between chains
+**  without copying. The slices are sent with one gathering send, see
+**  NetChannel::sendv().
+*/
+class NetBufferChain
+{
+public:
+  class Segment : public SGReferenced
+  {
+  public:
+    explicit Segment ( int capacity ) ;
+    explicit Segment ( std::string&& data ) ;
+
+    const char* getData() const { return data.data() ; }
+    int getLength() const { return (int)data.size() ; }
+
+  private:
+    friend class NetBufferChain ;
+    // never grows beyond its capacity, so the slices stay valid
+    std::string data ;
+    int capacity ;
+  } ;
+
+  NetBufferChain ( int segment_size = 16384 ) ;
+
+  int getLength() const { return length ; }
+  bool isEmpty() const { return length == 0 ; }
+
+  void append (const char* s, int n) ;
+  void append (std::string&& s) ;
+  // share the n bytes from pos of segment
+  void append (Segment* segment, int pos, int n) ;
+  // share the contents of another chain
+  void append (const NetBufferChain& chain) ;
+
+  // drop the first n bytes, or everything
+  void remove (int n) ;
+  void remove () ;
+
+  // position of the first needle at or after pos, or -1
+  int find (const char* needle, int n, int pos = 0) const ;
+  // copy the n bytes from pos to out
+  void copy (int pos, int n, char* out) const ;
+
+  // the first slices, up to max of them; returns how many
+  int getSlices (const void** buffers, int* sizes, int max) const ;
+
+private:
+  struct Slice
+  {
+    SGSharedPtr<Segment> segment ;
+    int pos ;
+    int length ;
+    const char* getData() const { return segment->getData() + pos ; }
+  } ;
+
+  bool matches (size_t slice, int pos, const char* needle, int n) const ;
+
+  std::deque<Slice> slices ;
+  int length ;
+  int segment_size ;
+} ;
+
 // ===========================================================================
 // NetBufferChannel
 // ===========================================================================
@@ -121,7 +195,7 @@ public:
 class NetBufferChannel : public NetChannel
 {
   NetBuffer in_buffer;
-  NetBuffer out_buffer;
+  NetBufferChain out_buffer;
   int should_close ;
   
   virtual bool readable (void)
@@ -134,19 +208,23 @@ class NetBufferChannel : public NetChannel
 
   virtual bool writable (void)
   {
-    return (out_buffer.getLength() || should_close);
+    return (!out_buffer.isEmpty() || should_close);
   }
 
   virtual void handleWrite (void) ;
 
 public:
 
+  // out_buffer_size is the size of the output segments, the output is not
+  // limited
   NetBufferChannel (int in_buffer_size = 4096, int out_buffer_size = 16384);
   virtual void handleClose ( void );
   
-  void closeWhenDone (void) { should_close = 1 ; }
+  void closeWhenDone (void) { should_close = 1 ; interestChanged () ; }
 
   virtual bool bufferSend (const char* msg, int msg_len);
+  // queue msg without copying it
+  void bufferSendOwned (std::string&& msg);
   virtual void handleBufferRead (NetBuffer& buffer);
 };
 
@@ -41,6 +41,11 @@
 
 #include <simgear/debug/logstream.hxx>
 
+#if defined(HAVE_SYS_EPOLL_H)
+#  include <sys/epoll.h>
+#  include <unistd.h>
+#endif
+
 
 namespace simgear  {
 
@@ -53,6 +58,11 @@ NetChannel::NetChannel ()
   write_blocked = false ;
   should_delete = false ;
   poller = NULL;
+  poll_handle = -1;
+  poll_events = 0;
+  poll_open = false;
+  poll_dirty = false;
+  poll_notifies = false;
 }
   
 NetChannel::~NetChannel ()
@@ -68,8 +78,12 @@ NetChannel::setHandle (int handle, bool is_connected)
 {
   close () ;
   Socket::setHandle ( handle ) ;
+  // accepted sockets only inherit non-blocking mode on BSD, and a
+  // gathering send of a long output queue must not block the poller
+  setBlocking ( false ) ;
   connected = is_connected ;
   closed = false ;
+  interestChanged () ;
 }
 
 bool
@@ -79,6 +93,7 @@ NetChannel::open (void)
   if (Socket::open(true)) {
     closed = false ;
     setBlocking ( false ) ;
+    interestChanged () ;
     return true ;
   }
   return false ;
@@ -88,6 +103,7 @@ int
 NetChannel::listen ( int backlog )
 {
   accepting = true ;
+  interestChanged () ;
   return Socket::listen ( backlog ) ;
 }
 
@@ -97,14 +113,32 @@ NetChannel::connect ( const char* h, int p )
   host = h;
   port = p;
   resolving_host = true;
+  interestChanged () ;
   return handleResolve();
 }
 
 int
 NetChannel::send (const void * buffer, int size, int flags)
 {
-  int result = Socket::send (buffer, size, flags);
-  
+  return sendResult (Socket::send (buffer, size, flags), size);
+}
+
+int
+NetChannel::sendv (const void* const* buffers, const int* sizes, int count,
+                   int flags)
+{
+  int size = 0;
+  for (int i = 0; i < count; i++) {
+    size += sizes[i];
+  }
+  return sendResult (Socket::sendv (buffers, sizes, count, flags), size);
+}
+
+int
+NetChannel::sendResult (int result, int size)
+{
+  // write_blocked decides writable()
+  interestChanged () ;
   if (result == (int)size) {
     // everything was sent
     write_blocked = false ;
@@ -154,11 +188,36 @@ NetChannel::close (void)
     connected = false ;
     accepting = false ;
     write_blocked = false ;
+    interestChanged () ;
   }
 
   Socket::close () ;
 }
 
+void
+NetChannel::interestChanged (void)
+{
+  if (poller) {
+    poller->markDirty(this);
+  }
+}
+
+void
+NetChannel::setNotifiesInterest (bool notifies)
+{
+  if (notifies == poll_notifies) {
+    return;
+  }
+  poll_notifies = notifies;
+  if (poller) {
+    if (notifies) {
+      poller->forget(this);
+    } else {
+      poller->polled.push_back(this);
+    }
+  }
+}
+
 void
 NetChannel::handleReadEvent (void)
 {
@@ -244,6 +303,53 @@ void NetChannel::handleError (int error)
     }
 }
 
+NetChannelPoller::NetChannelPoller() :
+    epoll_handle(-1),
+    num_open(0),
+    num_interested(0)
+{
+    setUseSelect(false);
+}
+
+NetChannelPoller::~NetChannelPoller()
+{
+    setUseSelect(true);
+}
+
+void
+NetChannelPoller::setUseSelect(bool useSelect)
+{
+#if defined(HAVE_SYS_EPOLL_H)
+    if (useSelect == usesSelect()) {
+        return;
+    }
+
+    for (NetChannel* ch : channels) {
+        ch->poll_handle = -1;
+        ch->poll_events = 0;
+        ch->poll_open = false;
+        ch->poll_dirty = false;
+    }
+    dirty.clear();
+    num_open = 0;
+    num_interested = 0;
+
+    if (useSelect) {
+        ::close(epoll_handle);
+        epoll_handle = -1;
+    } else {
+        epoll_handle = ::epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_handle < 0) {
+            SG_LOG(SG_IO, SG_WARN, "NetChannelPoller: epoll unavailable, "
+                   "using select: " << strerror(errno));
+        }
+        for (NetChannel* ch : channels) {
+            markDirty(ch);
+        }
+    }
+#endif
+}
+
 void
 NetChannelPoller::addChannel(NetChannel* channel)
 {
@@ -251,7 +357,15 @@ NetChannelPoller::addChannel(NetChannel* channel)
     assert(channel->poller == NULL);
         
     channel->poller = this;
+    channel->poll_handle = -1;
+    channel->poll_events = 0;
+    channel->poll_open = false;
+    channel->poll_dirty = false;
     channels.push_back(channel);
+    if (!channel->poll_notifies) {
+        polled.push_back(channel);
+    }
+    markDirty(channel);
 }
 
 void
@@ -261,26 +375,115 @@ NetChannelPoller::removeChannel(NetChannel* channel)
     assert(channel->poller == this);
     channel->poller = NULL;
 
+    uncount(channel);
+    // Closing the handle dropped its registration already, and the handle
+    // may belong to another channel by now
+    if (!channel->closed) {
+        updateInterest(channel, false, false);
+    }
+    // Only clear the entry, updateDirtyChannels() may be walking the list
+    if (channel->poll_dirty) {
+        *std::find(dirty.begin(), dirty.end(), channel) = NULL;
+        channel->poll_dirty = false;
+    }
+    forget(channel);
+
     auto it = std::find(channels.begin(), channels.end(), channel);
     if (it != channels.end()) {
         channels.erase(it);
     }
 }
 
-bool
-NetChannelPoller::poll(unsigned int timeout)
+void
+NetChannelPoller::markDirty(NetChannel* ch)
 {
-    if (channels.empty()) {
-        return false;
+    if (usesSelect() || ch->poll_dirty) {
+        return;
     }
-    
-    enum { MAX_SOCKETS = 256 } ;
-    Socket* reads [ MAX_SOCKETS+1 ] ;
-    Socket* writes [ MAX_SOCKETS+1 ] ;
-    int nreads = 0 ;
-    int nwrites = 0 ;
-    int nopen = 0 ;
-    
+    ch->poll_dirty = true;
+    dirty.push_back(ch);
+}
+
+void
+NetChannelPoller::uncount(NetChannel* ch)
+{
+    if (ch->poll_open) {
+        --num_open;
+    }
+    if (ch->poll_events) {
+        --num_interested;
+    }
+    ch->poll_open = false;
+}
+
+void
+NetChannelPoller::forget(NetChannel* ch)
+{
+    auto it = std::find(polled.begin(), polled.end(), ch);
+    if (it != polled.end()) {
+        polled.erase(it);
+    }
+}
+
+void
+NetChannelPoller::updateDirtyChannels()
+{
+    for (NetChannel* ch : polled) {
+        markDirty(ch);
+    }
+
+    // Channels marked while we are at it are appended and seen on the
+    // next poll
+    std::size_t count = dirty.size();
+    for (std::size_t i = 0; i < count; ++i) {
+        NetChannel* ch = dirty[i];
+        if (!ch) {
+            continue;
+        }
+        dirty[i] = NULL;
+        ch->poll_dirty = false;
+        uncount(ch);
+
+        if (ch->should_delete) {
+            // avoid the channel trying to remove itself from us, or we get
+            // bug http://code.google.com/p/flightgear-bugs/issues/detail?id=1144
+            ch->poller = NULL;
+            channels.erase(std::find(channels.begin(), channels.end(), ch));
+            forget(ch);
+            delete ch;
+            continue;
+        }
+
+        if (ch->closed) {
+            // Closing the handle dropped its registration
+            ch->poll_handle = -1;
+            ch->poll_events = 0;
+            continue;
+        }
+
+        if (ch->resolving_host) {
+            updateInterest(ch, false, false);
+            ch->handleResolve();
+            markDirty(ch);
+            continue;
+        }
+
+        updateInterest(ch, ch->readable(), ch->writable());
+        ch->poll_open = true;
+        ++num_open;
+        if (ch->poll_events) {
+            ++num_interested;
+        }
+    }
+    dirty.erase(dirty.begin(), dirty.begin() + count);
+}
+
+void
+NetChannelPoller::scanChannels(int& nopen, int& ninterested)
+{
+    nopen = 0;
+    ninterested = 0;
+
     ChannelList::iterator it = channels.begin();
     while( it != channels.end() )
     {
@@ -296,7 +499,7 @@ NetChannelPoller::poll(unsigned int timeout)
         }
 
         ++it; // we've copied the pointer into ch
-        if ( ch->closed ) { 
+        if ( ch->closed ) {
             continue;
         }
 
@@ -305,33 +508,141 @@ NetChannelPoller::poll(unsigned int timeout)
             ch -> handleResolve();
             continue;
         }
-      
+
         nopen++ ;
-        if (ch -> readable()) {
-          assert(nreads<MAX_SOCKETS);
-          reads[nreads++] = ch ;
+        bool readable = ch -> readable();
+        bool writable = ch -> writable();
+        if (readable) {
+          reads.push_back(ch);
+        }
+        if (writable) {
+          writes.push_back(ch);
         }
-        if (ch -> writable()) {
-          assert(nwrites<MAX_SOCKETS);
-          writes[nwrites++] = ch ;
+        if (readable || writable) {
+          ninterested++;
         }
     } // of array-filling pass
+}
+
+void
+NetChannelPoller::updateInterest(NetChannel* ch, bool readable, bool writable)
+{
+#if defined(HAVE_SYS_EPOLL_H)
+    if (usesSelect()) {
+        return;
+    }
+
+    int handle = ch->getHandle();
+    bool registered = ch->poll_handle == handle && handle >= 0;
+    unsigned int events = (readable ? EPOLLIN : 0) | (writable ? EPOLLOUT : 0);
+    if (registered && ch->poll_events == events) {
+        return;
+    }
+
+    // Not watching a handle at all, rather than for no events, keeps
+    // errors and hangups of channels that are not interested from waking
+    // us up
+    if (!events) {
+        if (registered) {
+            ::epoll_ctl(epoll_handle, EPOLL_CTL_DEL, handle, NULL);
+        }
+        ch->poll_handle = -1;
+        ch->poll_events = 0;
+        return;
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.ptr = ch;
+    int result = ::epoll_ctl(epoll_handle,
+                             registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
+                             handle, &event);
+    // The handle was closed and reopened with the same number, or the
+    // registration of its earlier owner has not been removed yet
+    if (result < 0 && registered && errno == ENOENT) {
+        result = ::epoll_ctl(epoll_handle, EPOLL_CTL_ADD, handle, &event);
+    } else if (result < 0 && !registered && errno == EEXIST) {
+        result = ::epoll_ctl(epoll_handle, EPOLL_CTL_MOD, handle, &event);
+    }
+    if (result < 0) {
+        SG_LOG(SG_IO, SG_WARN, "Network:" << handle << ": epoll_ctl failed: "
+               << strerror(errno));
+        ch->poll_handle = -1;
+        ch->poll_events = 0;
+        return;
+    }
+    ch->poll_handle = handle;
+    ch->poll_events = events;
+#endif
+}
+
+void
+NetChannelPoller::waitEvents(unsigned int timeout)
+{
+#if defined(HAVE_SYS_EPOLL_H)
+    enum { MAX_EVENTS = 256 } ;
+    struct epoll_event events[MAX_EVENTS];
+    int count = ::epoll_wait(epoll_handle, events, MAX_EVENTS, (int)timeout);
+    for (int i = 0; i < count; i++) {
+        NetChannel* ch = static_cast<NetChannel*>(events[i].data.ptr);
+        unsigned int ready = events[i].events;
+        // select() reports errors and hangups as readable and writable
+        if (ready & (EPOLLERR | EPOLLHUP)) {
+            ready |= EPOLLIN | EPOLLOUT;
+        }
+        if ((ready & EPOLLIN) && (ch->poll_events & EPOLLIN)) {
+            reads.push_back(ch);
+        }
+        if ((ready & EPOLLOUT) && (ch->poll_events & EPOLLOUT)) {
+            writes.push_back(ch);
+        }
+    }
+#endif
+}
+
+bool
+NetChannelPoller::poll(unsigned int timeout)
+{
+    if (channels.empty()) {
+        return false;
+    }
     
-    reads[nreads] = NULL ;
-    writes[nwrites] = NULL ;
+    int nopen = 0 ;
+    int ninterested = 0 ;
+    reads.clear();
+    writes.clear();
+
+    if (usesSelect()) {
+      scanChannels(nopen, ninterested);
+    } else {
+      updateDirtyChannels();
+      nopen = num_open;
+      ninterested = num_interested;
+    }
 
     if (!nopen)
       return false ;
-    if (!nreads && !nwrites)
+    if (!ninterested)
       return true ; //hmmm- should we shutdown?
 
-    Socket::select (reads, writes, timeout) ;
+    if (usesSelect()) {
+      reads.push_back(NULL);
+      writes.push_back(NULL);
+      Socket::select (&reads[0], &writes[0], timeout) ;
+    } else {
+      waitEvents(timeout);
+      reads.push_back(NULL);
+      writes.push_back(NULL);
+    }
 
+    // The handlers change what the channels wait for
     for ( int i=0; reads[i]; i++ )
     {
       NetChannel* ch = (NetChannel*)reads[i];
       if ( ! ch -> closed )
         ch -> handleReadEvent();
+      ch -> interestChanged();
     }
 
     for ( int i=0; writes[i]; i++ )
@@ -339,6 +650,7 @@ NetChannelPoller::poll(unsigned int timeout)
       NetChannel* ch = (NetChannel*)writes[i];
       if ( ! ch -> closed )
         ch -> handleWriteEvent();
+      ch -> interestChanged();
     }
 
     return true ;
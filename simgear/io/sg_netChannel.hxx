@@ -66,11 +66,22 @@ class NetChannelPoller;
 class NetChannel : public Socket
 {
   bool closed, connected, accepting, write_blocked, should_delete, resolving_host ;
+  int sendResult (int result, int size) ;
   std::string host;
   int port;
   
     friend class NetChannelPoller;
     NetChannelPoller* poller;
+    // The handle and events registered with the poller's epoll instance
+    int poll_handle;
+    unsigned int poll_events;
+    // Whether the poller counts the channel as open, and whether it is
+    // queued for asking readable() and writable() again
+    bool poll_open;
+    bool poll_dirty;
+    // Whether the channel calls interestChanged() on every change of
+    // readable() and writable(), see setNotifiesInterest()
+    bool poll_notifies;
 public:
 
   NetChannel () ;
@@ -79,7 +90,7 @@ public:
   void setHandle (int s, bool is_connected = true);
   bool isConnected () const { return connected; }
   bool isClosed () const { return closed; }
-  void shouldDelete () { should_delete = true ; }
+  void shouldDelete () { should_delete = true ; interestChanged () ; }
 
   // --------------------------------------------------
   // socket methods
@@ -90,11 +101,28 @@ public:
   int   listen  ( int backlog ) ;
   int   connect ( const char* host, int port ) ;
   int   send    ( const void * buf, int size, int flags = 0 ) ;
+  int   sendv   ( const void* const* bufs, const int* sizes, int count,
+                  int flags = 0 ) ;
   int   recv    ( void * buf, int size, int flags = 0 ) ;
 
   // poll() eligibility predicates
   virtual bool readable (void) { return (connected || accepting); }
   virtual bool writable (void) { return (!connected || write_blocked); }
+
+  /**
+   * Tells the poller that readable() or writable() may have changed.
+   * NetChannel and NetBufferChannel call it on their own state changes.
+   */
+  void interestChanged (void) ;
+
+  /**
+   * Promise that readable() and writable() only change in the event
+   * handlers or with a call of interestChanged(). With epoll, the poller
+   * then asks them only after such changes instead of on every poll, so
+   * the channel costs nothing while idle. Off by default.
+   */
+  void setNotifiesInterest (bool notifies) ;
+  bool notifiesInterest () const { return poll_notifies; }
   
   // --------------------------------------------------
   // event handlers
@@ -115,15 +143,57 @@ public:
 
 };
 
+/**
+ * Dispatches the read and write events of a set of channels.
+ *
+ * Where epoll is available, each channel is registered once, and the
+ * number of channels is not limited by FD_SETSIZE. Channels are asked
+ * for readable() and writable() on every poll, except for those that
+ * called NetChannel::setNotifiesInterest(true): they are only asked
+ * after they had events or called NetChannel::interestChanged().
+ * Elsewhere, or after setUseSelect(true), all channels are asked on
+ * every poll and select() is used.
+ */
 class NetChannelPoller
 {
+    friend class NetChannel;
+
     typedef std::vector<NetChannel*> ChannelList;
     ChannelList channels;
+    int epoll_handle;
+    // The channels to dispatch, NULL terminated for Socket::select
+    std::vector<Socket*> reads;
+    std::vector<Socket*> writes;
+    // The channels to ask for their interest on the next epoll poll, and
+    // how many channels are open and interested in any event
+    ChannelList dirty;
+    int num_open;
+    int num_interested;
+    // The channels not notifying their interest, marked on every poll
+    ChannelList polled;
+
+    void markDirty(NetChannel* channel);
+    void updateDirtyChannels();
+    void scanChannels(int& nopen, int& ninterested);
+    void uncount(NetChannel* channel);
+    void forget(NetChannel* channel);
+    void updateInterest(NetChannel* channel, bool readable, bool writable);
+    void waitEvents(unsigned int timeout);
 public:
+    NetChannelPoller();
+    ~NetChannelPoller();
+
     void addChannel(NetChannel* channel);
     void removeChannel(NetChannel* channel);
     
     bool hasChannels() const { return !channels.empty(); }
+
+    /**
+     * Use select() even where epoll is available, for instance to
+     * compare them.
+     */
+    void setUseSelect(bool useSelect);
+    bool usesSelect() const { return epoll_handle < 0; }
     
     bool poll(unsigned int timeout = 0);
     void loop(unsigned int timeout = 0);
@@ -28,6 +28,7 @@
 #include <cstring>
 #include <cstdlib>
 #include <algorithm>
+#include <utility>
 
 namespace  simgear {
 
@@ -79,8 +80,9 @@ find_terminator(const NetBuffer& haystack, const std::string& needle)
   if( !needle.empty() )
   {
     const char* data = haystack.getData();
-    const char* ptr = strstr(data,needle.c_str());
-    if (ptr != NULL)
+    const char* end = data + haystack.getLength();
+    const char* ptr = std::search(data, end, needle.begin(), needle.end());
+    if (ptr != end)
       return(ptr-data);
   }
   return -1;
@@ -91,6 +93,12 @@ bool NetChat::push (const char* s)
   return bufferSend ( s, strlen(s) ) ;
 }
 
+bool NetChat::push (std::string&& s)
+{
+  bufferSendOwned ( std::move(s) ) ;
+  return true ;
+}
+
 void
 NetChat::handleBufferRead (NetBuffer& in_buffer)
 {
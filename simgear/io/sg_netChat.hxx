@@ -90,6 +90,8 @@ public:
   void setByteCount(int bytes);
 
   bool push (const char* s);
+  // queue s without copying it
+  bool push (std::string&& s);
   
   virtual void collectIncomingData	(const char* s, int n) {}
   virtual void foundTerminator (void) {}
@@ -185,6 +185,32 @@ int SGSocketUDP::write( const char *buf, const int length ) {
 }
 
 
+// read the waiting datagrams into ring (server)
+int SGSocketUDP::readBatch( simgear::DatagramRing& ring ) {
+    if ( ! isvalid() ) {
+	return 0;
+    }
+
+    return std::max( sock.recvBatch( ring ), 0 );
+}
+
+
+// write the datagrams queued in ring (client)
+int SGSocketUDP::writeBatch( simgear::DatagramRing& ring ) {
+    if ( ! isvalid() ) {
+	return 0;
+    }
+
+    int result = sock.sendBatch( ring );
+    if ( result < 0 ) {
+	SG_LOG( SG_IO, SG_WARN, "Error writing to socket: " << port );
+	return 0;
+    }
+
+    return result;
+}
+
+
 // write null terminated string to socket (server)
 int SGSocketUDP::writestring( const char *str ) {
     if ( !isvalid() ) {
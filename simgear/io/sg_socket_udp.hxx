@@ -108,6 +108,12 @@ public:
     // write data to a socket
     int write( const char *buf, const int length );
 
+    // read the waiting datagrams, one per slot and not null terminated
+    int readBatch( simgear::DatagramRing& ring );
+
+    // write the queued datagrams
+    int writeBatch( simgear::DatagramRing& ring );
+
     // write null terminated string to a socket
     int writestring( const char *str );
 
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <map>
 #include <sstream>
+#include <vector>
 #include <cerrno>
 
 #include <boost/algorithm/string/case_conv.hpp>
@@ -760,6 +761,91 @@ cout << "testing proxy close" << endl;
         SG_CHECK_EQUAL(tr3->bodyData, string(BODY1));
     }
 
+    {
+        cout << "timing and connection reuse" << endl;
+        cl.clearAllConnections();
+        HTTP::Client::Statistics before = cl.statistics();
+
+        TestRequest* tr = new TestRequest("http://localhost:2000/test1");
+        HTTP::Request_ptr own(tr);
+        cl.makeRequest(tr);
+        waitForComplete(&cl, tr);
+
+        TestRequest* tr2 = new TestRequest("http://localhost:2000/test1");
+        HTTP::Request_ptr own2(tr2);
+        cl.makeRequest(tr2);
+        waitForComplete(&cl, tr2);
+
+        SG_CHECK_EQUAL(tr->bodyData, string(BODY1));
+        const HTTP::Request::Timing& t = tr->timing();
+        SG_VERIFY(!t.reusedConnection);
+        SG_VERIFY(t.lookup <= t.connect);
+        SG_VERIFY(t.connect <= t.firstByte);
+        SG_VERIFY(t.firstByte <= t.total);
+        SG_VERIFY(t.total > 0.0);
+        SG_VERIFY(tr2->timing().reusedConnection);
+
+        const HTTP::Client::Statistics& stats = cl.statistics();
+        SG_CHECK_EQUAL(stats.requests, before.requests + 2);
+        SG_CHECK_EQUAL(stats.newConnections, before.newConnections + 1);
+        SG_CHECK_EQUAL(stats.reusedConnections, before.reusedConnections + 1);
+        SG_VERIFY(stats.total >= before.total + t.total);
+
+        // every request on its own connection
+        HTTP::Client::HostPolicy policy;
+        policy.reuseConnections = false;
+        cl.setHostPolicy("localhost:2000", policy);
+        SG_VERIFY(!cl.hostPolicy("localhost:2000").reuseConnections);
+        SG_VERIFY(cl.hostPolicy("localhost:2001").reuseConnections);
+
+        TestRequest* tr3 = new TestRequest("http://localhost:2000/test1");
+        HTTP::Request_ptr own3(tr3);
+        cl.makeRequest(tr3);
+        waitForComplete(&cl, tr3);
+        SG_CHECK_EQUAL(tr3->bodyData, string(BODY1));
+        SG_VERIFY(!tr3->timing().reusedConnection);
+
+        cl.setHostPolicy("localhost:2000", HTTP::Client::HostPolicy());
+    }
+
+    {
+        cout << "request priorities" << endl;
+        HTTP::Client::HostPolicy policy;
+        policy.maxActiveRequests = 1;
+        cl.setHostPolicy("localhost:2000", policy);
+
+        std::vector<int> order;
+        std::vector<HTTP::Request_ptr> requests;
+        const int priorities[] = { 0, 0, 5, 10, -1, 5 };
+        for (int i = 0; i < 6; ++i) {
+            TestRequest* tr = new TestRequest("http://localhost:2000/test1");
+            tr->setPriority(priorities[i]);
+            tr->done([&order, i](HTTP::Request*) { order.push_back(i); });
+            requests.push_back(tr);
+            cl.makeRequest(tr);
+        }
+
+        // the first one got the free slot, the others wait
+        SG_VERIFY(cl.hasActiveRequests());
+        SG_CHECK_EQUAL(requests[0]->readyState(), HTTP::Request::OPENED);
+        SG_CHECK_EQUAL(requests[1]->readyState(), HTTP::Request::UNSENT);
+
+        // cancelling a waiting request just drops it
+        cl.cancelRequest(requests[4], "low priority");
+        SG_CHECK_EQUAL(requests[4]->readyState(), HTTP::Request::FAILED);
+
+        waitForComplete(&cl, static_cast<TestRequest*>(requests[1].get()));
+        const int expected[] = { 0, 3, 2, 5, 1 };
+        SG_CHECK_EQUAL(order.size(), 5u);
+        for (unsigned int i = 0; i < order.size(); ++i) {
+            SG_CHECK_EQUAL(order[i], expected[i]);
+        }
+        SG_VERIFY(requests[1]->timing().queued > requests[0]->timing().queued);
+        SG_VERIFY(!cl.hasActiveRequests());
+
+        cl.setHostPolicy("localhost:2000", HTTP::Client::HostPolicy());
+    }
+
     {
         cout << "get-during-response-send" << endl;
         cl.clearAllConnections();
@@ -0,0 +1,222 @@
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include <simgear/compiler.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <simgear/misc/test_macros.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include "sg_netChat.hxx"
+
+using std::cout;
+using std::endl;
+using std::string;
+
+using namespace simgear;
+
+string contents(const NetBufferChain& chain)
+{
+    string result(chain.getLength(), '\0');
+    if (!result.empty())
+        chain.copy(0, result.size(), &result[0]);
+    return result;
+}
+
+void testChain()
+{
+    // small segments, so that everything crosses segment boundaries
+    NetBufferChain chain(4);
+    SG_VERIFY(chain.isEmpty());
+    chain.append("GET /props", 10);
+    chain.append(string(" HTTP/1.1\r"));
+    chain.append("\nHost: x\r\n\r\n", 12);
+    SG_CHECK_EQUAL(chain.getLength(), 32);
+    SG_CHECK_EQUAL(contents(chain), string("GET /props HTTP/1.1\r\nHost: x\r\n\r\n"));
+
+    SG_CHECK_EQUAL(chain.find("\r\n", 2), 19);
+    SG_CHECK_EQUAL(chain.find("\r\n", 2, 20), 28);
+    SG_CHECK_EQUAL(chain.find("\r\n\r\n", 4), 28);
+    SG_CHECK_EQUAL(chain.find("props HTTP", 10), 5);
+    SG_CHECK_EQUAL(chain.find("\n\n", 2), -1);
+    SG_CHECK_EQUAL(chain.find("\r\n\r\n\r", 5), -1);
+
+    chain.remove(5);
+    SG_CHECK_EQUAL(chain.find("\r\n", 2), 14);
+    SG_CHECK_EQUAL(contents(chain).substr(0, 5), string("props"));
+
+    const void* buffers[16];
+    int sizes[16];
+    int count = chain.getSlices(buffers, sizes, 16);
+    int total = 0;
+    for (int i = 0; i < count; ++i)
+        total += sizes[i];
+    SG_CHECK_EQUAL(total, chain.getLength());
+    SG_CHECK_EQUAL(chain.getSlices(buffers, sizes, 1), 1);
+
+    chain.remove();
+    SG_VERIFY(chain.isEmpty());
+}
+
+void testSharing()
+{
+    NetBufferChain a(16);
+    a.append("abc", 3);
+    NetBufferChain b(16);
+    b.append(a);
+
+    // both end in the shared segment, only the first to append extends it
+    a.append("def", 3);
+    b.append("xyz", 3);
+    SG_CHECK_EQUAL(contents(a), string("abcdef"));
+    SG_CHECK_EQUAL(contents(b), string("abcxyz"));
+
+    // the shared bytes outlive the chain they came from
+    a.remove();
+    SG_CHECK_EQUAL(contents(b), string("abcxyz"));
+
+    SGSharedPtr<NetBufferChain::Segment> segment
+        = new NetBufferChain::Segment(string("0123456789"));
+    b.append(segment, 2, 5);
+    SG_CHECK_EQUAL(contents(b), string("abcxyz23456"));
+}
+
+// Answers a request with a response much larger than its segments
+class Sender : public NetChat
+{
+public:
+    Sender(const string& response) : _response(response)
+    {
+        setTerminator("\r\n");
+    }
+
+    virtual void collectIncomingData (const char* s, int n)
+    {
+        request.append(s, n);
+    }
+
+    virtual void foundTerminator (void)
+    {
+        push("HEADER\r\n");
+        // one copied, one handed over
+        bufferSend(_response.data(), _response.size() / 2);
+        push(_response.substr(_response.size() / 2));
+        closeWhenDone();
+    }
+
+    string request;
+
+private:
+    const string& _response;
+};
+
+class Listener : public NetChannel
+{
+public:
+    Listener(NetChannelPoller& poller, const string& response) :
+        sender(nullptr),
+        _poller(poller),
+        _response(response)
+    {
+        open();
+        bind("127.0.0.1", 2014);
+        listen(4);
+        _poller.addChannel(this);
+    }
+
+    virtual bool writable (void) { return false ; }
+
+    virtual void handleAccept (void)
+    {
+        IPAddress addr;
+        int handle = accept(&addr);
+        if (handle < 0)
+            return;
+        sender = new Sender(_response);
+        sender->setHandle(handle);
+        _poller.addChannel(sender);
+    }
+
+    Sender* sender;
+
+private:
+    NetChannelPoller& _poller;
+    const string& _response;
+};
+
+class Receiver : public NetChat
+{
+public:
+    Receiver() : done(false) { setTerminator("\r\n"); }
+
+    virtual void collectIncomingData (const char* s, int n)
+    {
+        received.append(s, n);
+    }
+
+    virtual void foundTerminator (void)
+    {
+        header = received;
+        received.clear();
+        setByteCount(-1);
+    }
+
+    virtual void handleClose (void)
+    {
+        done = true;
+        NetChat::handleClose();
+    }
+
+    string header;
+    string received;
+    bool done;
+};
+
+void testStreaming()
+{
+    string response(8 * 1024 * 1024, '\0');
+    for (size_t i = 0; i < response.size(); ++i)
+        response[i] = char('a' + (i * 7) % 26);
+
+    NetChannelPoller poller;
+    Listener listener(poller, response);
+    Receiver* receiver = new Receiver;
+    receiver->open();
+    receiver->connect("127.0.0.1", 2014);
+    poller.addChannel(receiver);
+    receiver->push("GET /\r\n");
+
+    SGTimeStamp start = SGTimeStamp::now();
+    while (!receiver->done && start.elapsedMSec() < 20000)
+        poller.poll(10);
+
+    SG_VERIFY(receiver->done);
+    SG_VERIFY(listener.sender);
+    SG_CHECK_EQUAL(listener.sender->request, string("GET /"));
+    SG_CHECK_EQUAL(receiver->header, string("HEADER"));
+    SG_CHECK_EQUAL(receiver->received.size(), response.size());
+    SG_VERIFY(receiver->received == response);
+
+    poller.removeChannel(receiver);
+    delete receiver;
+    poller.removeChannel(listener.sender);
+    delete listener.sender;
+    poller.removeChannel(&listener);
+}
+
+int main(int argc, char* argv[])
+{
+    Socket::initSockets();
+
+    testChain();
+    testSharing();
+    testStreaming();
+
+    cout << "all tests passed" << endl;
+    return EXIT_SUCCESS;
+}
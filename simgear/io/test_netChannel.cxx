@@ -0,0 +1,298 @@
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include <simgear/compiler.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#ifndef _WIN32
+#  include <sys/select.h>
+#endif
+
+#include <simgear/misc/test_macros.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include "sg_netChannel.hxx"
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+using namespace simgear;
+
+// Counts what its connection receives
+class Peer : public NetChannel
+{
+public:
+    Peer() : received(0), asked(0) {}
+
+    virtual bool readable (void)
+    {
+        ++asked;
+        return NetChannel::readable();
+    }
+
+    virtual bool writable (void) { return false ; }
+
+    virtual void handleRead (void)
+    {
+        char buffer[512];
+        int count = recv(buffer, sizeof(buffer));
+        if (count > 0)
+            received += count;
+    }
+
+    int received;
+    int asked;
+};
+
+class Server : public NetChannel
+{
+public:
+    Server(NetChannelPoller& poller, int port) :
+        _poller(poller)
+    {
+        open();
+        bind("127.0.0.1", port);
+        listen(1024);
+        setNotifiesInterest(true);
+        _poller.addChannel(this);
+    }
+
+    ~Server()
+    {
+        for (Peer* peer : peers) {
+            _poller.removeChannel(peer);
+            delete peer;
+        }
+        _poller.removeChannel(this);
+    }
+
+    virtual bool writable (void) { return false ; }
+
+    virtual void handleAccept (void)
+    {
+        IPAddress addr;
+        int handle;
+        while ((handle = accept(&addr)) >= 0) {
+            Peer* peer = new Peer;
+            peer->setNotifiesInterest(true);
+            peer->setHandle(handle);
+            peers.push_back(peer);
+            _poller.addChannel(peer);
+        }
+    }
+
+    std::vector<Peer*> peers;
+
+private:
+    NetChannelPoller& _poller;
+};
+
+class Client : public NetChannel
+{
+public:
+    Client() : wantsWrite(false), written(0) {}
+
+    virtual bool readable (void) { return false ; }
+    virtual bool writable (void)
+    {
+        return NetChannel::writable() || wantsWrite;
+    }
+    virtual void handleWrite (void)
+    {
+        if (wantsWrite) {
+            wantsWrite = false;
+            ++written;
+        }
+    }
+
+    bool wantsWrite;
+    int written;
+};
+
+class Connections
+{
+public:
+    Connections(NetChannelPoller& poller, int port, int count) :
+        server(poller, port),
+        _poller(poller)
+    {
+        for (int i = 0; i < count; ++i) {
+            Client* client = new Client;
+            client->setNotifiesInterest(true);
+            client->open();
+            client->connect("127.0.0.1", port);
+            _poller.addChannel(client);
+            clients.push_back(client);
+        }
+    }
+
+    ~Connections()
+    {
+        for (Client* client : clients) {
+            _poller.removeChannel(client);
+            delete client;
+        }
+    }
+
+    // Polls until pred() holds, or gives up after a few seconds
+    template<typename Pred>
+    bool pollUntil(Pred pred)
+    {
+        SGTimeStamp start = SGTimeStamp::now();
+        while (!pred()) {
+            if (start.elapsedMSec() > 10000)
+                return false;
+            _poller.poll(10);
+        }
+        return true;
+    }
+
+    bool allConnected()
+    {
+        return pollUntil([this]() {
+            if (server.peers.size() != clients.size())
+                return false;
+            for (Client* client : clients)
+                if (!client->isConnected())
+                    return false;
+            return true;
+        });
+    }
+
+    int totalReceived()
+    {
+        int total = 0;
+        for (Peer* peer : server.peers)
+            total += peer->received;
+        return total;
+    }
+
+    Server server;
+    std::vector<Client*> clients;
+
+private:
+    NetChannelPoller& _poller;
+};
+
+void testPoller(bool useSelect, int port, int count)
+{
+    NetChannelPoller poller;
+    poller.setUseSelect(useSelect);
+    {
+        Connections connections(poller, port, count);
+        SG_VERIFY(connections.allConnected());
+
+        // A few active connections among the idle ones
+        const char message[] = "ping";
+        for (int i = 0; i < 3; ++i)
+            connections.clients[i * count / 3]->send(message, 4);
+        SG_VERIFY(connections.pollUntil([&connections]() {
+            return connections.totalReceived() == 12;
+        }));
+        int active = 0;
+        for (Peer* peer : connections.server.peers) {
+            if (peer->received) {
+                SG_CHECK_EQUAL(peer->received, 4);
+                ++active;
+            }
+        }
+        SG_CHECK_EQUAL(active, 3);
+
+        // With epoll, idle channels notifying their interest are not
+        // asked for it, the others are asked on every poll
+        if (!poller.usesSelect()) {
+            Peer* asking = connections.server.peers[0];
+            asking->setNotifiesInterest(false);
+            poller.poll(0);
+            for (Peer* peer : connections.server.peers)
+                peer->asked = 0;
+            for (int i = 0; i < 3; ++i)
+                poller.poll(0);
+            SG_CHECK_EQUAL(asking->asked, 3);
+            for (Peer* peer : connections.server.peers)
+                if (peer != asking)
+                    SG_CHECK_EQUAL(peer->asked, 0);
+        }
+
+        // Interest changing outside of the handlers, announced
+        Client* client = connections.clients[1];
+        client->wantsWrite = true;
+        client->interestChanged();
+        SG_VERIFY(connections.pollUntil([client]() {
+            return client->written == 1;
+        }));
+
+        // or not
+        client = connections.clients[2];
+        client->setNotifiesInterest(false);
+        client->wantsWrite = true;
+        SG_VERIFY(connections.pollUntil([client]() {
+            return client->written == 1;
+        }));
+
+        // Hangups are seen as reads of nothing
+        connections.clients[0]->close();
+        SG_VERIFY(connections.pollUntil([&connections]() {
+            int closed = 0;
+            for (Peer* peer : connections.server.peers)
+                closed += peer->isClosed();
+            return closed == 1;
+        }));
+    }
+    SG_VERIFY(!poller.hasChannels());
+}
+
+// Times polls with many idle and a few active connections
+void benchmark(bool useSelect, int port, int count, int rounds)
+{
+    NetChannelPoller poller;
+    poller.setUseSelect(useSelect);
+    if (useSelect != poller.usesSelect()) {
+        cout << "epoll unavailable" << endl;
+        return;
+    }
+    Connections connections(poller, port, count);
+    if (!connections.allConnected()) {
+        cerr << "failed to connect " << count << " channels" << endl;
+        return;
+    }
+
+    const char message[] = "ping";
+    SGTimeStamp start = SGTimeStamp::now();
+    for (int i = 0; i < rounds; ++i) {
+        for (int j = 0; j < 4; ++j)
+            connections.clients[(i + j * count / 4) % count]->send(message, 4);
+        poller.poll(0);
+    }
+    cout << (useSelect ? "select" : "epoll") << ": " << count
+         << " connections, "
+         << double(start.elapsedUSec()) / rounds << " usec per poll" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    Socket::initSockets();
+
+    if (argc > 1 && !strcmp(argv[1], "--bench")) {
+        int count = argc > 2 ? atoi(argv[2]) : 10000;
+        int rounds = argc > 3 ? atoi(argv[3]) : 1000;
+        // select() can't watch handles beyond FD_SETSIZE
+        if (2 * count + 16 < FD_SETSIZE)
+            benchmark(true, 2011, count, rounds);
+        benchmark(false, 2012, count, rounds);
+        return EXIT_SUCCESS;
+    }
+
+    // More channels than the select() poller used to allow
+    testPoller(false, 2011, 300);
+    testPoller(true, 2012, 300);
+
+    cout << "all tests passed" << endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,188 @@
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include <simgear/compiler.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <simgear/misc/test_macros.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include "raw_socket.hxx"
+#include "sg_socket_udp.hxx"
+
+using std::cout;
+using std::endl;
+
+using simgear::DatagramRing;
+
+void testRing()
+{
+    DatagramRing ring(4, 8);
+    SG_VERIFY(ring.empty());
+    SG_VERIFY(!ring.push("too long!", 9));
+    SG_VERIFY(ring.push("a", 1));
+    SG_VERIFY(ring.push("bb", 2));
+    SG_VERIFY(ring.push("ccc", 3));
+    ring.pop();
+    SG_VERIFY(ring.push("dddd", 4));
+    // wraps around
+    SG_VERIFY(ring.push("eeeee", 5));
+    SG_VERIFY(ring.full());
+    SG_VERIFY(!ring.push("f", 1));
+
+    const char* expected[] = { "bb", "ccc", "dddd", "eeeee" };
+    for (int i = 0; i < 4; ++i) {
+        SG_CHECK_EQUAL(ring.frontLength(), strlen(expected[i]));
+        SG_VERIFY(!memcmp(ring.front(), expected[i], ring.frontLength()));
+        SG_VERIFY(!ring.frontAddress());
+        ring.pop();
+    }
+    SG_VERIFY(ring.empty());
+}
+
+// Polls reader until it received count datagrams, or gives up
+int readAll(SGIOChannel& reader, DatagramRing& ring, int count,
+            std::vector<std::string>& received)
+{
+    SGTimeStamp start = SGTimeStamp::now();
+    while ((int)received.size() < count && start.elapsedMSec() < 5000) {
+        reader.readBatch(ring);
+        for (; !ring.empty(); ring.pop())
+            received.push_back(std::string(ring.front(), ring.frontLength()));
+    }
+    return received.size();
+}
+
+void testChannels()
+{
+    SGSocketUDP server("127.0.0.1", "5510");
+    SG_VERIFY(server.open(SG_IO_IN));
+    server.setBlocking(false);
+    SGSocketUDP client("127.0.0.1", "5510");
+    SG_VERIFY(client.open(SG_IO_OUT));
+
+    // start off the middle of the ring, so that both calls wrap around
+    DatagramRing out(64, 32);
+    for (int i = 0; i < 40; ++i) {
+        out.push("x", 1);
+        out.pop();
+    }
+    char message[32];
+    for (int i = 0; i < 50; ++i) {
+        int length = snprintf(message, sizeof(message), "message %d", i);
+        SG_VERIFY(out.push(message, length));
+    }
+    SG_CHECK_EQUAL(client.writeBatch(out), 50);
+    SG_VERIFY(out.empty());
+
+    DatagramRing in(16, 32);
+    in.push("x", 1);
+    in.pop();
+    std::vector<std::string> received;
+    SG_CHECK_EQUAL(readAll(server, in, 50, received), 50);
+    for (int i = 0; i < 50; ++i) {
+        snprintf(message, sizeof(message), "message %d", i);
+        SG_CHECK_EQUAL(received[i], std::string(message));
+    }
+
+    // nothing left
+    SG_CHECK_EQUAL(server.readBatch(in), 0);
+}
+
+void testAddresses()
+{
+    simgear::Socket receiver;
+    SG_VERIFY(receiver.open(false));
+    SG_CHECK_EQUAL(receiver.bind("127.0.0.1", 5511), 0);
+    receiver.setBlocking(false);
+    simgear::Socket sender;
+    SG_VERIFY(sender.open(false));
+    SG_CHECK_EQUAL(sender.bind("127.0.0.1", 5512), 0);
+
+    // unconnected, every datagram carries its destination
+    simgear::IPAddress to("127.0.0.1", 5511);
+    DatagramRing out(8, 16);
+    out.push("one", 3, &to);
+    out.push("two", 3, &to);
+    SG_CHECK_EQUAL(sender.sendBatch(out), 2);
+
+    DatagramRing in(8, 16);
+    SGTimeStamp start = SGTimeStamp::now();
+    while (in.size() < 2 && start.elapsedMSec() < 5000)
+        receiver.recvBatch(in);
+    SG_CHECK_EQUAL(in.size(), 2u);
+    SG_VERIFY(in.frontAddress());
+    SG_CHECK_EQUAL(in.frontAddress()->getPort(), 5512u);
+    SG_VERIFY(!memcmp(in.front(), "one", 3));
+}
+
+// Moves count datagrams of size bytes, per datagram or in batches
+void benchmark(bool batched, int count, int size)
+{
+    SGSocketUDP server("127.0.0.1", "5513");
+    server.open(SG_IO_IN);
+    server.setBlocking(false);
+    SGSocketUDP client("127.0.0.1", "5513");
+    client.open(SG_IO_OUT);
+
+    enum { Burst = 64 };
+    std::vector<char> message(size, 'x');
+    std::vector<char> buffer(SG_IO_MAX_MSG_SIZE);
+    DatagramRing out(Burst, size);
+    DatagramRing in(Burst, size);
+    int sent = 0;
+    int received = 0;
+    SGTimeStamp start = SGTimeStamp::now();
+    while (sent < count) {
+        // send a burst the socket buffer can hold, then drain it
+        int burst = std::min(int(Burst), count - sent);
+        int got = 0;
+        if (batched) {
+            for (int i = 0; i < burst; ++i)
+                out.push(&message[0], size);
+            sent += client.writeBatch(out);
+            for (int n; got < burst && (n = server.readBatch(in)) > 0;) {
+                got += n;
+                in.clear();
+            }
+        } else {
+            for (int i = 0; i < burst; ++i)
+                sent += client.write(&message[0], size) > 0;
+            while (got < burst && server.read(&buffer[0], buffer.size()) > 0)
+                ++got;
+        }
+        received += got;
+    }
+    double seconds = start.elapsedUSec() * 1e-6;
+    cout << (batched ? "batched:    " : "per packet: ") << received
+         << " of " << count << " datagrams, " << int(received / seconds)
+         << " per second" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    simgear::Socket::initSockets();
+
+    if (argc > 1 && !strcmp(argv[1], "--bench")) {
+        int count = argc > 2 ? atoi(argv[2]) : 1000000;
+        int size = argc > 3 ? atoi(argv[3]) : 200;
+        benchmark(false, count, size);
+        benchmark(true, count, size);
+        return EXIT_SUCCESS;
+    }
+
+    testRing();
+    testChannels();
+    testAddresses();
+
+    cout << "all tests passed" << endl;
+    return EXIT_SUCCESS;
+}
@@ -26,6 +26,7 @@
 #include <simgear/debug/logstream.hxx>
 
 #include "SGMath.hxx"
+#include "simd.hxx"
 
 // These are hard numbers from the WGS84 standard.  DON'T MODIFY
 // unless you want to change the datum.
@@ -138,6 +139,101 @@ SGGeodesy::SGGeodToCart(const SGGeod& geod, SGVec3<double>& cart)
   cart(2) = (h+n-e2*n)*sphi;
 }
 
+// The array versions evaluate the algebraic part of the above for
+// four points at once in simd4_t. With ENABLE_SIMD_CODE this maps to
+// SSE2, otherwise the fixed size loops are left to the autovectorizer.
+// Only cbrt, atan2, sin and cos remain per point.
+typedef simd4_t<double,4> GeodesyBlock;
+
+void
+SGGeodesy::SGCartToGeod(const SGVec3<double>* cart, SGGeod* geod,
+                        unsigned count)
+{
+  typedef GeodesyBlock B;
+  unsigned i = 0;
+  for (; i + 4 <= count; i += 4) {
+    B X, Y, Z;
+    bool center[4];
+    for (unsigned j = 0; j < 4; ++j) {
+      const SGVec3<double>& c = cart[i + j];
+      // Points in the geocenter region get a harmless stand in, so no
+      // lane divides by zero. They are fixed up below.
+      center[j] = c(0)*c(0) + c(1)*c(1) + c(2)*c(2) < 25;
+      X[j] = center[j] ? a : c(0);
+      Y[j] = center[j] ? 0 : c(1);
+      Z[j] = center[j] ? 0 : c(2);
+    }
+
+    B XXpYY = X*X + Y*Y;
+    B sqrtXXpYY = simd4::sqrt(XXpYY);
+    B p = ra2*XXpYY;
+    B q = ((1 - e2)*ra2)*(Z*Z);
+    B r = (1/6.0)*(p + q - B(e4));
+    B s = e4*p*q/(4.0*r*r*r);
+    for (unsigned j = 0; j < 4; ++j) {
+      if( s[j] >= -2.0 && s[j] <= 0.0 )
+        s[j] = 0.0;
+    }
+    B t = B(1) + s + simd4::sqrt(s*(B(2) + s));
+    for (unsigned j = 0; j < 4; ++j)
+      t[j] = cbrt(t[j]);
+    B u = r*(B(1) + t + B(1)/t);
+    B v = simd4::sqrt(u*u + e4*q);
+    B w = e2*(u + v - q)/(2.0*v);
+    B k = simd4::sqrt(u + v + w*w) - w;
+    B D = k*sqrtXXpYY/(k + B(e2));
+    B sqrtDDpZZ = simd4::sqrt(D*D + Z*Z);
+    B h = (k + B(e2 - 1))*sqrtDDpZZ/k;
+
+    for (unsigned j = 0; j < 4; ++j) {
+      SGGeod& g = geod[i + j];
+      if (center[j]) {
+        g.setLongitudeRad( 0.0 );
+        g.setLatitudeRad( 0.0 );
+        g.setElevationM( -EQURAD );
+        continue;
+      }
+      g.setLongitudeRad(2*atan2(Y[j], X[j] + sqrtXXpYY[j]));
+      g.setLatitudeRad(2*atan2(Z[j], D[j] + sqrtDDpZZ[j]));
+      g.setElevationM(h[j]);
+    }
+  }
+  for (; i < count; ++i)
+    SGCartToGeod(cart[i], geod[i]);
+}
+
+void
+SGGeodesy::SGGeodToCart(const SGGeod* geod, SGVec3<double>* cart,
+                        unsigned count)
+{
+  typedef GeodesyBlock B;
+  unsigned i = 0;
+  for (; i + 4 <= count; i += 4) {
+    B h, sphi, cphi, slambda, clambda;
+    for (unsigned j = 0; j < 4; ++j) {
+      const SGGeod& g = geod[i + j];
+      double phi = g.getLatitudeRad();
+      double lambda = g.getLongitudeRad();
+      h[j] = g.getElevationM();
+      sphi[j] = sin(phi);
+      cphi[j] = cos(phi);
+      slambda[j] = sin(lambda);
+      clambda[j] = cos(lambda);
+    }
+
+    B n = B(a)/simd4::sqrt(B(1) - e2*sphi*sphi);
+    B hncphi = (h + n)*cphi;
+    B x = hncphi*clambda;
+    B y = hncphi*slambda;
+    B z = (h + n - e2*n)*sphi;
+
+    for (unsigned j = 0; j < 4; ++j)
+      cart[i + j] = SGVec3<double>(x[j], y[j], z[j]);
+  }
+  for (; i < count; ++i)
+    SGGeodToCart(geod[i], cart[i]);
+}
+
 double
 SGGeodesy::SGGeodToSeaLevelRadius(const SGGeod& geod)
 {
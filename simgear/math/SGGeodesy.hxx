@@ -34,6 +34,13 @@ public:
   /// Takes a geodetic coordinate data and returns the cartesian
   /// coordinates.
   static void SGGeodToCart(const SGGeod& geod, SGVec3<double>& cart);
+
+  /// Array versions of the above, converting count points at once.
+  /// Results match the single point versions up to rounding.
+  static void SGCartToGeod(const SGVec3<double>* cart, SGGeod* geod,
+                           unsigned count);
+  static void SGGeodToCart(const SGGeod* geod, SGVec3<double>* cart,
+                           unsigned count);
   
   /// Takes a geodetic coordinate data and returns the sea level radius.
   static double SGGeodToSeaLevelRadius(const SGGeod& geod);
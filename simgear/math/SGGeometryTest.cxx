@@ -21,6 +21,9 @@
 
 #include <cstdlib>
 #include <iostream>
+#include <vector>
+
+#include <simgear/timing/timestamp.hxx>
 
 #include "SGGeometry.hxx"
 #include "sg_random.h"
@@ -513,6 +516,78 @@ BoxLineIntersectionTest(void)
   return true;
 }
 
+bool
+GeodesyArrayTest(void)
+{
+  // Same tolerances as the single point conversion tests
+  double epsRad = 10*SGMiscd::twopi()*SGLimits<double>::epsilon();
+  double epsM = 10*6e6*SGLimits<double>::epsilon();
+
+  // Not a multiple of the block size to cover the remainder
+  unsigned nPoints = 100003;
+  std::vector<SGGeod> geods(nPoints);
+  for (unsigned i = 0; i < nPoints; ++i) {
+    geods[i] = SGGeod::fromDegM(360*sg_random() - 180, 180*sg_random() - 90,
+                                20000*sg_random() - 1000);
+  }
+  // Poles, the antimeridian and orbit
+  geods[0] = SGGeod::fromDegM(0, 90, 0);
+  geods[1] = SGGeod::fromDegM(0, -90, 10);
+  geods[2] = SGGeod::fromDegM(180, 0, 0);
+  geods[3] = SGGeod::fromDegM(-180, 45, 4e5);
+
+  std::vector<SGVec3d> carts(nPoints);
+  SGTimeStamp timeStamp = SGTimeStamp::now();
+  for (unsigned i = 0; i < nPoints; ++i)
+    SGGeodesy::SGGeodToCart(geods[i], carts[i]);
+  int scalarToCartUSec = timeStamp.elapsedUSec();
+
+  std::vector<SGVec3d> arrayCarts(nPoints);
+  timeStamp.stamp();
+  SGGeodesy::SGGeodToCart(&geods[0], &arrayCarts[0], nPoints);
+  int arrayToCartUSec = timeStamp.elapsedUSec();
+
+  // The geocenter region is special cased
+  carts[4] = SGVec3d(1, 2, 3);
+  carts[5] = SGVec3d::zeros();
+
+  std::vector<SGGeod> scalarGeods(nPoints);
+  timeStamp.stamp();
+  for (unsigned i = 0; i < nPoints; ++i)
+    SGGeodesy::SGCartToGeod(carts[i], scalarGeods[i]);
+  int scalarToGeodUSec = timeStamp.elapsedUSec();
+
+  std::vector<SGGeod> arrayGeods(nPoints);
+  timeStamp.stamp();
+  SGGeodesy::SGCartToGeod(&carts[0], &arrayGeods[0], nPoints);
+  int arrayToGeodUSec = timeStamp.elapsedUSec();
+
+  for (unsigned i = 0; i < nPoints; ++i) {
+    if (i != 4 && i != 5 && epsM < dist(carts[i], arrayCarts[i])) {
+      std::cout << "Failed geodetic to cartesian array conversion #" << i
+                << ": " << arrayCarts[i] << " != " << carts[i] << std::endl;
+      return false;
+    }
+    const SGGeod& geod0 = scalarGeods[i];
+    const SGGeod& geod1 = arrayGeods[i];
+    if (epsRad < fabs(geod0.getLongitudeRad() - geod1.getLongitudeRad()) ||
+        epsRad < fabs(geod0.getLatitudeRad() - geod1.getLatitudeRad()) ||
+        epsM < fabs(geod0.getElevationM() - geod1.getElevationM())) {
+      std::cout << "Failed cartesian to geodetic array conversion #" << i
+                << ": " << geod1 << " != " << geod0 << std::endl;
+      return false;
+    }
+  }
+
+  std::cout << nPoints << " geodetic to cartesian conversions: single "
+            << scalarToCartUSec << "us, array " << arrayToCartUSec << "us\n"
+            << nPoints << " cartesian to geodetic conversions: single "
+            << scalarToGeodUSec << "us, array " << arrayToGeodUSec << "us"
+            << std::endl;
+
+  return true;
+}
+
 int
 main(void)
 {
@@ -541,6 +616,9 @@ main(void)
     return EXIT_FAILURE;
   if (!BoxLineIntersectionTest<double>())
     return EXIT_FAILURE;
+
+  if (!GeodesyArrayTest())
+    return EXIT_FAILURE;
   
   std::cout << "Successfully passed all tests!" << std::endl;
   return EXIT_SUCCESS;
@@ -69,6 +69,14 @@ inline simd4_t<T,N> abs(simd4_t<T,N> v) {
     return v;
 }
 
+template<typename T, int N>
+inline simd4_t<T,N> sqrt(simd4_t<T,N> v) {
+    for (int i=0; i<N; ++i) {
+        v[i] = std::sqrt(v[i]);
+    }
+    return v;
+}
+
 template<typename T, int N>
 inline T magnitude2(const simd4_t<T,N>& vi) {
     simd4_t<T,N> v(vi);
@@ -121,6 +129,16 @@ inline simd4_t<T,3> cross(const simd4_t<T,3>& v1, const simd4_t<T,3>& v2)
     return d;
 }
 
+// Lane wise v1 <= v2, bit i of the result is set if it holds for lane i.
+template<typename T, int N>
+inline int le_mask(const simd4_t<T,N>& v1, const simd4_t<T,N>& v2) {
+    int mask = 0;
+    for (int i=0; i<N; ++i) {
+        if (v1[i] <= v2[i]) mask |= 1 << i;
+    }
+    return mask;
+}
+
 } /* namespace simd4 */
 
 
@@ -563,6 +581,17 @@ inline simd4_t<float,N>abs(simd4_t<float,N> v) {
     return v;
 }
 
+template<int N>
+inline simd4_t<float,N> sqrt(simd4_t<float,N> v) {
+    v = _mm_sqrt_ps(v.v4());
+    return v;
+}
+
+template<int N>
+inline int le_mask(const simd4_t<float,N>& v1, const simd4_t<float,N>& v2) {
+    return _mm_movemask_ps(_mm_cmple_ps(v1.v4(), v2.v4())) & ((1 << N) - 1);
+}
+
 } /* namsepace simd4 */
 
 # endif
@@ -800,6 +829,12 @@ inline simd4_t<double,N>abs(simd4_t<double,N> v) {
     return v;
 }
 
+template<int N>
+inline simd4_t<double,N> sqrt(simd4_t<double,N> v) {
+    v = _mm256_sqrt_pd(v.v4());
+    return v;
+}
+
 } /* namespace simd4 */
 
 # elif defined __SSE2__
@@ -1090,6 +1125,13 @@ inline simd4_t<double,N>abs(simd4_t<double,N> v) {
     return v;
 }
 
+template<int N>
+inline simd4_t<double,N> sqrt(simd4_t<double,N> v) {
+    v.v4()[0] = _mm_sqrt_pd(v.v4()[0]);
+    v.v4()[1] = _mm_sqrt_pd(v.v4()[1]);
+    return v;
+}
+
 } /* namespace simd4 */
 
 # endif
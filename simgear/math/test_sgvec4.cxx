@@ -60,6 +60,12 @@ int main()
   qq = simd4::abs(rr);
   TESTV(qq, T(2.31), T(3.43), T(4.69), T(1.00));
 
+  qq = simd4::sqrt(simd4_t<T,N>(T(4.0), T(9.0), T(2.25), T(1.0)));
+  TESTV(qq, T(2.0), T(3.0), T(1.5), T(1.0));
+
+  if (simd4::le_mask(rr, simd4_t<T,N>(T(0))) != 0xd)
+    printf("line: %i, le_mask\n", __LINE__);
+
   for (i=0; i<MAX; i++)
   {
     VEC(N)<T> v(p);
@@ -0,0 +1,162 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include "PropertyBindings.hxx"
+
+namespace simgear
+{
+
+class PropertyBindings::Listener : public SGPropertyChangeListener
+{
+public:
+    Listener(PropertyBindings* owner, unsigned property) :
+        _owner(owner),
+        _property(property)
+    {
+    }
+
+    virtual void valueChanged(SGPropertyNode* node)
+    {
+        _owner->changed(_property);
+    }
+
+private:
+    PropertyBindings* _owner;
+    unsigned _property;
+};
+
+PropertyBindings::Statistics::Statistics() :
+    _bindings(0),
+    _properties(0),
+    _notifications(0),
+    _updates(0),
+    _targetUpdates(0)
+{
+}
+
+PropertyBindings::PropertyBindings() :
+    _numUpdates(0)
+{
+}
+
+PropertyBindings::~PropertyBindings()
+{
+    clear();
+}
+
+void PropertyBindings::bind(Target* target, SGPropertyNode* const* nodes,
+                            unsigned numNodes)
+{
+    if (!target || !numNodes)
+        return;
+
+    Binding binding;
+    binding._target = target;
+    binding._firstNode = _nodes.size();
+    binding._numNodes = numNodes;
+    binding._lastUpdate = _numUpdates;
+    unsigned index = _bindings.size();
+    for (unsigned i = 0; i < numNodes; ++i) {
+        SGPropertyNode* node = nodes[i];
+        _nodes.push_back(node);
+        std::map<SGPropertyNode*, unsigned>::iterator j;
+        j = _propertyIndex.find(node);
+        if (j == _propertyIndex.end()) {
+            unsigned property = _properties.size();
+            j = _propertyIndex.insert(std::make_pair(node, property)).first;
+            _properties.push_back(Property());
+            _properties.back()._node = node;
+            _properties.back()._listener = new Listener(this, property);
+            _isChanged.push_back(false);
+            node->addChangeListener(_properties.back()._listener);
+        }
+        std::vector<unsigned>& bindings = _properties[j->second]._bindings;
+        if (bindings.empty() || bindings.back() != index)
+            bindings.push_back(index);
+    }
+    _bindings.push_back(binding);
+
+    target->update(&_nodes[binding._firstNode], numNodes);
+    ++_stats._targetUpdates;
+}
+
+void PropertyBindings::changed(unsigned property)
+{
+    ++_stats._notifications;
+    if (_isChanged[property])
+        return;
+    _isChanged[property] = true;
+    _changed.push_back(property);
+}
+
+void PropertyBindings::update()
+{
+    ++_stats._updates;
+    if (_changed.empty())
+        return;
+    // Bindings updated in this round have _lastUpdate == _numUpdates.
+    // Writes from the targets count for the next round.
+    ++_numUpdates;
+    std::vector<unsigned> changed;
+    changed.swap(_changed);
+    for (std::size_t i = 0; i < changed.size(); ++i) {
+        unsigned property = changed[i];
+        _isChanged[property] = false;
+        const std::vector<unsigned>& bindings = _properties[property]._bindings;
+        for (std::size_t j = 0; j < bindings.size(); ++j) {
+            Binding& binding = _bindings[bindings[j]];
+            if (binding._lastUpdate == _numUpdates)
+                continue;
+            binding._lastUpdate = _numUpdates;
+            binding._target->update(&_nodes[binding._firstNode],
+                                    binding._numNodes);
+            ++_stats._targetUpdates;
+        }
+    }
+}
+
+void PropertyBindings::clear()
+{
+    for (std::size_t i = 0; i < _properties.size(); ++i) {
+        _properties[i]._node->removeChangeListener(_properties[i]._listener);
+        delete _properties[i]._listener;
+    }
+    _properties.clear();
+    _propertyIndex.clear();
+    _bindings.clear();
+    _nodes.clear();
+    _changed.clear();
+    _isChanged.clear();
+}
+
+PropertyBindings::Statistics PropertyBindings::getStatistics() const
+{
+    Statistics stats = _stats;
+    stats._bindings = _bindings.size();
+    stats._properties = _properties.size();
+    return stats;
+}
+
+void PropertyBindings::resetStatistics()
+{
+    _stats = Statistics();
+}
+
+}
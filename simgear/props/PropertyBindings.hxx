@@ -0,0 +1,109 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA
+
+#ifndef SIMGEAR_PROPERTYBINDINGS_HXX
+#define SIMGEAR_PROPERTYBINDINGS_HXX 1
+
+#include <map>
+#include <vector>
+
+#include "props.hxx"
+
+namespace simgear
+{
+/**
+ * Copies property values to their consumers once per update() instead of
+ * from a change listener per consumer on every write.
+ *
+ * Each bound property gets one listener, however many bindings use it,
+ * and the listener only marks the property changed. update() then calls
+ * each binding with a changed property exactly once. The tables are flat
+ * vectors indexed by the listeners, so no lookup happens per write.
+ *
+ * Bindings are added and updated on the thread writing the properties.
+ */
+class PropertyBindings
+{
+public:
+    /** The consumer of the values of one or more properties. */
+    class Target : public SGReferenced
+    {
+    public:
+        virtual ~Target() {}
+        virtual void update(SGPropertyNode* const* nodes, unsigned numNodes) = 0;
+    };
+
+    struct Statistics {
+        Statistics();
+
+        /// Bindings and the distinct properties they listen to
+        unsigned _bindings;
+        unsigned _properties;
+        /// Change notifications received, update() calls and the
+        /// Target::update calls they made, since the last reset
+        unsigned long _notifications;
+        unsigned long _updates;
+        unsigned long _targetUpdates;
+    };
+
+    PropertyBindings();
+    ~PropertyBindings();
+
+    /**
+     * Binds target to the numNodes nodes, and updates it right away so
+     * it starts with the current values.
+     */
+    void bind(Target* target, SGPropertyNode* const* nodes, unsigned numNodes);
+
+    /** Updates the targets of all properties changed since the last call. */
+    void update();
+
+    /** Removes all bindings and their listeners. */
+    void clear();
+
+    Statistics getStatistics() const;
+    void resetStatistics();
+
+private:
+    class Listener;
+
+    struct Property {
+        SGPropertyNode_ptr _node;
+        Listener* _listener;
+        std::vector<unsigned> _bindings;
+    };
+
+    struct Binding {
+        SGSharedPtr<Target> _target;
+        unsigned _firstNode;
+        unsigned _numNodes;
+        unsigned long _lastUpdate;
+    };
+
+    void changed(unsigned property);
+
+    std::vector<Property> _properties;
+    std::map<SGPropertyNode*, unsigned> _propertyIndex;
+    std::vector<Binding> _bindings;
+    std::vector<SGPropertyNode*> _nodes;
+    std::vector<unsigned> _changed;
+    std::vector<char> _isChanged;
+    unsigned long _numUpdates;
+    Statistics _stats;
+};
+}
+
+#endif
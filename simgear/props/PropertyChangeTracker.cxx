@@ -0,0 +1,90 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include "PropertyChangeTracker.hxx"
+
+#include <algorithm>
+
+namespace simgear
+{
+
+PropertyChangeTracker::PropertyChangeTracker() :
+    _dirty(true),
+    _volatile(false)
+{
+}
+
+PropertyChangeTracker::~PropertyChangeTracker()
+{
+}
+
+void PropertyChangeTracker::addProperty(const SGPropertyNode* node)
+{
+    if (!node)
+        return;
+    if (std::find(_watched.begin(), _watched.end(), node) != _watched.end())
+        return;
+    // Listening does not change the node, but the listener lists are
+    // only reachable through non const nodes.
+    SGPropertyNode* watched = const_cast<SGPropertyNode*>(node);
+    _watched.push_back(watched);
+    watched->addChangeListener(this);
+    if (watched->isTied() || watched->isAlias())
+        _volatile = true;
+    setDirty();
+}
+
+void PropertyChangeTracker::setDirty()
+{
+    if (_dirty)
+        return;
+    _dirty = true;
+    dirtied();
+}
+
+bool PropertyChangeTracker::checkTied()
+{
+    std::vector<SGPropertyNode*>::const_iterator i;
+    for (i = _watched.begin(); !_volatile && i != _watched.end(); ++i) {
+        if ((*i)->isTied() || (*i)->isAlias())
+            _volatile = true;
+    }
+    return _volatile;
+}
+
+void PropertyChangeTracker::dirtied()
+{
+}
+
+void PropertyChangeTracker::unregister_property(SGPropertyNode* node)
+{
+    std::vector<SGPropertyNode*>::iterator i;
+    i = std::find(_watched.begin(), _watched.end(), node);
+    if (i != _watched.end())
+        _watched.erase(i);
+    MultiChangeListener::unregister_property(node);
+}
+
+void PropertyChangeTracker::valueChangedImplementation()
+{
+    setDirty();
+}
+
+}
@@ -0,0 +1,96 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA
+
+#ifndef SIMGEAR_PROPERTYCHANGETRACKER_HXX
+#define SIMGEAR_PROPERTYCHANGETRACKER_HXX 1
+
+#include <set>
+#include <vector>
+
+#include "props.hxx"
+#include "AtomicChangeListener.hxx"
+
+namespace simgear
+{
+/**
+ * Remembers whether any of a set of properties was written since the
+ * last clearDirty(), so code deriving values from properties can skip
+ * the work while the inputs stay the same.
+ *
+ * Tied properties and aliases do not fire change listeners. A tracker
+ * depending on one of them is volatile and always dirty. The same goes
+ * for inputs that are not properties at all, see setVolatile().
+ */
+class PropertyChangeTracker : public MultiChangeListener
+{
+public:
+    PropertyChangeTracker();
+    virtual ~PropertyChangeTracker();
+
+    /**
+     * Listen to the properties an expression or a condition reads, as
+     * reported by its collectDependentProperties().
+     * A dependent that also reads some other state, as reported by its
+     * hasExternalDependencies(), makes the tracker volatile.
+     */
+    template<typename T>
+    void addDependencies(const T* dependent)
+    {
+        if (!dependent)
+            return;
+        std::set<const SGPropertyNode*> props;
+        dependent->collectDependentProperties(props);
+        if (dependent->hasExternalDependencies())
+            setVolatile(true);
+        std::set<const SGPropertyNode*>::const_iterator i;
+        for (i = props.begin(); i != props.end(); ++i)
+            addProperty(*i);
+    }
+
+    void addProperty(const SGPropertyNode* node);
+
+    std::size_t getNumProperties() const { return _watched.size(); }
+
+    bool isDirty() const { return _dirty || _volatile; }
+    void setDirty();
+    void clearDirty() { _dirty = false; }
+
+    bool isVolatile() const { return _volatile; }
+    void setVolatile(bool isVolatile) { _volatile = isVolatile; }
+
+    /**
+     * Properties can be tied after the tracker started listening. This
+     * makes the tracker volatile if one of them is tied or an alias by
+     * now, and returns isVolatile().
+     */
+    bool checkTied();
+
+protected:
+    /** Called when the tracker goes from clean to dirty. */
+    virtual void dirtied();
+
+    virtual void unregister_property(SGPropertyNode* node) override;
+
+private:
+    virtual void valueChangedImplementation() override;
+
+    std::vector<SGPropertyNode*> _watched;
+    bool _dirty;
+    bool _volatile;
+};
+}
+
+#endif
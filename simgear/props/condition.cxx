@@ -39,6 +39,9 @@ public:
   virtual bool test () const { return _node->getBoolValue(); }
   virtual void collectDependentProperties(std::set<const SGPropertyNode*>& props) const
     { props.insert(_node.get()); }
+  virtual bool hasExternalDependencies() const { return false; }
+  virtual int compile(simgear::expression::Compiler& compiler) const
+    { return compiler.property(_node, simgear::expression::BOOL); }
 private:
   SGConstPropertyNode_ptr _node;
 };
@@ -52,6 +55,9 @@ class SGConstantCondition : public SGCondition
 public:
   SGConstantCondition (bool v) : _value(v) { ; }
   virtual bool test () const { return _value; }
+  virtual bool isConst() const { return true; }
+  virtual int compile(simgear::expression::Compiler& compiler) const
+    { return compiler.constant(_value, simgear::expression::BOOL); }
 private:
   bool _value;
 };
@@ -68,31 +74,15 @@ public:
   virtual ~SGNotCondition ();
   virtual bool test () const;
   virtual void collectDependentProperties(std::set<const SGPropertyNode*>& props) const;
+  virtual bool isConst() const { return _condition->isConst(); }
+  virtual bool hasExternalDependencies() const
+    { return _condition->hasExternalDependencies(); }
+  virtual int compile(simgear::expression::Compiler& compiler) const;
 private:
   SGConditionRef _condition;
 };
 
 
-/**
- * Condition for an 'and' group.
- *
- * This condition is true only if all of the conditions
- * in the group are true.
- */
-class SGAndCondition : public SGCondition
-{
-public:
-  SGAndCondition ();
-  virtual ~SGAndCondition ();
-  virtual bool test () const;
-				// transfer pointer ownership
-  virtual void addCondition (SGCondition * condition);
-  virtual void collectDependentProperties(std::set<const SGPropertyNode*>& props) const;
-private:
-  std::vector<SGConditionRef> _conditions;
-};
-
-
 /**
  * Condition for an 'or' group.
  *
@@ -108,6 +98,9 @@ public:
 				// transfer pointer ownership
   virtual void addCondition (SGCondition * condition);
   virtual void collectDependentProperties(std::set<const SGPropertyNode*>& props) const;
+  virtual bool isConst() const;
+  virtual bool hasExternalDependencies() const;
+  virtual int compile(simgear::expression::Compiler& compiler) const;
 private:
   std::vector<SGConditionRef> _conditions;
 };
@@ -143,6 +136,7 @@ public:
   void setPrecisionDExpression(SGExpressiond* dexp);
   
   virtual void collectDependentProperties(std::set<const SGPropertyNode*>& props) const;
+  virtual bool hasExternalDependencies() const;
 private:
   Type _type;
   bool _reverse;
@@ -168,6 +162,12 @@ SGCondition::~SGCondition ()
 {
 }
 
+int
+SGCondition::compile(simgear::expression::Compiler& compiler) const
+{
+  return compiler.test(this);
+}
+
 
 ////////////////////////////////////////////////////////////////////////
 // Implementation of SGPropertyCondition.
@@ -209,6 +209,13 @@ SGNotCondition::collectDependentProperties(std::set<const SGPropertyNode*>& prop
     _condition->collectDependentProperties(props);
 }
 
+int
+SGNotCondition::compile(simgear::expression::Compiler& compiler) const
+{
+  return compiler.unary(compiler.NOT, simgear::expression::BOOL,
+                        compiler.compile(_condition.get()));
+}
+
 ////////////////////////////////////////////////////////////////////////
 // Implementation of SGAndCondition.
 ////////////////////////////////////////////////////////////////////////
@@ -245,6 +252,34 @@ SGAndCondition::collectDependentProperties(std::set<const SGPropertyNode*>& prop
     _conditions[i]->collectDependentProperties(props);
 }
 
+bool
+SGAndCondition::isConst() const
+{
+  for( size_t i = 0; i < _conditions.size(); i++ )
+    if (!_conditions[i]->isConst())
+      return false;
+  return true;
+}
+
+bool
+SGAndCondition::hasExternalDependencies() const
+{
+  for( size_t i = 0; i < _conditions.size(); i++ )
+    if (_conditions[i]->hasExternalDependencies())
+      return true;
+  return false;
+}
+
+int
+SGAndCondition::compile(simgear::expression::Compiler& compiler) const
+{
+  int value = compiler.constant(true, simgear::expression::BOOL);
+  for( size_t i = 0; i < _conditions.size(); i++ )
+    value = compiler.binary(compiler.AND, simgear::expression::BOOL, value,
+                            compiler.compile(_conditions[i].get()));
+  return value;
+}
+
 
 ////////////////////////////////////////////////////////////////////////
 // Implementation of SGOrCondition.
@@ -282,6 +317,34 @@ SGOrCondition::collectDependentProperties(std::set<const SGPropertyNode*>& props
     _conditions[i]->collectDependentProperties(props);
 }
 
+bool
+SGOrCondition::isConst() const
+{
+  for( size_t i = 0; i < _conditions.size(); i++ )
+    if (!_conditions[i]->isConst())
+      return false;
+  return true;
+}
+
+bool
+SGOrCondition::hasExternalDependencies() const
+{
+  for( size_t i = 0; i < _conditions.size(); i++ )
+    if (_conditions[i]->hasExternalDependencies())
+      return true;
+  return false;
+}
+
+int
+SGOrCondition::compile(simgear::expression::Compiler& compiler) const
+{
+  int value = compiler.constant(false, simgear::expression::BOOL);
+  for( size_t i = 0; i < _conditions.size(); i++ )
+    value = compiler.binary(compiler.OR, simgear::expression::BOOL, value,
+                            compiler.compile(_conditions[i].get()));
+  return value;
+}
+
 
 ////////////////////////////////////////////////////////////////////////
 // Implementation of SGComparisonCondition.
@@ -470,6 +533,14 @@ SGComparisonCondition::collectDependentProperties(std::set<const SGPropertyNode*
   
 }
 
+bool
+SGComparisonCondition::hasExternalDependencies() const
+{
+  return (_left_dexp && _left_dexp->hasExternalDependencies())
+    || (_right_dexp && _right_dexp->hasExternalDependencies())
+    || (_precision_dexp && _precision_dexp->hasExternalDependencies());
+}
+
 ////////////////////////////////////////////////////////////////////////
 // Read a condition and use it if necessary.
 ////////////////////////////////////////////////////////////////////////
@@ -11,11 +11,14 @@
 #define __SG_CONDITION_HXX
 
 #include <set>
+#include <vector>
 #include <simgear/structure/SGReferenced.hxx>
 #include <simgear/structure/SGSharedPtr.hxx>
 
 class SGPropertyNode;
 
+namespace simgear { namespace expression { class Compiler; } }
+
 ////////////////////////////////////////////////////////////////////////
 // Conditions.
 ////////////////////////////////////////////////////////////////////////
@@ -36,11 +39,49 @@ public:
   virtual ~SGCondition ();
   virtual bool test () const = 0;
   virtual void collectDependentProperties(std::set<const SGPropertyNode*>& props) const { }
+  /**
+   * True if test() always returns the same value.
+   */
+  virtual bool isConst() const { return false; }
+  /**
+   * True if test() depends on more than the properties reported by
+   * collectDependentProperties(). Unknown conditions that are not
+   * constant are assumed to read some other state.
+   */
+  virtual bool hasExternalDependencies() const { return !isConst(); }
+  /**
+   * Emit the instructions computing this condition, see
+   * simgear::expression::Compiler. By default test() is called.
+   */
+  virtual int compile(simgear::expression::Compiler& compiler) const;
 };
 
 typedef SGSharedPtr<SGCondition> SGConditionRef;
 
 
+/**
+ * Condition for an 'and' group.
+ *
+ * This condition is true only if all of the conditions
+ * in the group are true.
+ */
+class SGAndCondition : public SGCondition
+{
+public:
+  SGAndCondition ();
+  virtual ~SGAndCondition ();
+  virtual bool test () const;
+				// transfer pointer ownership
+  virtual void addCondition (SGCondition * condition);
+  virtual void collectDependentProperties(std::set<const SGPropertyNode*>& props) const;
+  virtual bool isConst() const;
+  virtual bool hasExternalDependencies() const;
+  virtual int compile(simgear::expression::Compiler& compiler) const;
+private:
+  std::vector<SGConditionRef> _conditions;
+};
+
+
 /**
  * Base class for a conditional components.
  *
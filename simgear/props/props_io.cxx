@@ -30,6 +30,7 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <cstdint>
 #include <cstring>      // strcmp()
 #include <vector>
 #include <map>
@@ -713,6 +714,228 @@ writeProperties (const char* file, const SGPropertyNode * start_node)
 }
 
 
+////////////////////////////////////////////////////////////////////////
+// Property list binary format.
+//
+// "SGPB", a format version, then the start node and its descendants
+// depth first: name, index, attributes, type, value and the number of
+// children. Numbers are in host byte order.
+////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+const char binaryMagic[4] = { 'S', 'G', 'P', 'B' };
+const uint32_t binaryVersion = 1;
+const uint32_t maxBinaryString = 1 << 24;
+
+template<typename T>
+void
+writeBinary (ostream &output, const T &value)
+{
+  output.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void
+writeBinaryString (ostream &output, const std::string &value)
+{
+  writeBinary(output, uint32_t(value.size()));
+  output.write(value.data(), value.size());
+}
+
+template<typename T>
+bool
+readBinary (istream &input, T &value)
+{
+  return (bool)input.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+bool
+readBinaryString (istream &input, std::string &value)
+{
+  uint32_t size;
+  if (!readBinary(input, size) || size > maxBinaryString)
+    return false;
+  value.resize(size);
+  return size == 0 || input.read(&value[0], size);
+}
+
+void
+writeBinaryNode (ostream &output, const SGPropertyNode *node)
+{
+  using namespace simgear;
+  props::Type type = node->hasValue() ? node->getType() : props::NONE;
+  writeBinary(output, int32_t(node->getAttributes()));
+  switch (type) {
+  case props::BOOL:
+    writeBinary(output, uint8_t(type));
+    writeBinary(output, uint8_t(node->getBoolValue()));
+    break;
+  case props::INT:
+    writeBinary(output, uint8_t(type));
+    writeBinary(output, int32_t(node->getIntValue()));
+    break;
+  case props::LONG:
+    writeBinary(output, uint8_t(type));
+    writeBinary(output, int64_t(node->getLongValue()));
+    break;
+  case props::FLOAT:
+    writeBinary(output, uint8_t(type));
+    writeBinary(output, node->getFloatValue());
+    break;
+  case props::DOUBLE:
+    writeBinary(output, uint8_t(type));
+    writeBinary(output, node->getDoubleValue());
+    break;
+  case props::STRING:
+  case props::UNSPECIFIED:
+    writeBinary(output, uint8_t(type));
+    writeBinaryString(output, node->getStringValue());
+    break;
+  case props::VEC3D: {
+    SGVec3d v = node->getValue<SGVec3d>();
+    writeBinary(output, uint8_t(type));
+    for (int i = 0; i < 3; ++i)
+      writeBinary(output, v[i]);
+    break;
+  }
+  case props::VEC4D: {
+    SGVec4d v = node->getValue<SGVec4d>();
+    writeBinary(output, uint8_t(type));
+    for (int i = 0; i < 4; ++i)
+      writeBinary(output, v[i]);
+    break;
+  }
+  default:
+    writeBinary(output, uint8_t(props::NONE));
+    break;
+  }
+
+  int nChildren = node->nChildren();
+  writeBinary(output, uint32_t(nChildren));
+  for (int i = 0; i < nChildren; i++) {
+    const SGPropertyNode *child = node->getChild(i);
+    writeBinaryString(output, child->getNameString());
+    writeBinary(output, int32_t(child->getIndex()));
+    writeBinaryNode(output, child);
+  }
+}
+
+bool
+readBinaryNode (istream &input, SGPropertyNode *node)
+{
+  using namespace simgear;
+  int32_t attributes;
+  uint8_t type;
+  if (!readBinary(input, attributes) || !readBinary(input, type))
+    return false;
+  switch (type) {
+  case props::NONE:
+    break;
+  case props::BOOL: {
+    uint8_t value;
+    if (!readBinary(input, value))
+      return false;
+    node->setBoolValue(value != 0);
+    break;
+  }
+  case props::INT: {
+    int32_t value;
+    if (!readBinary(input, value))
+      return false;
+    node->setIntValue(value);
+    break;
+  }
+  case props::LONG: {
+    int64_t value;
+    if (!readBinary(input, value))
+      return false;
+    node->setLongValue(value);
+    break;
+  }
+  case props::FLOAT: {
+    float value;
+    if (!readBinary(input, value))
+      return false;
+    node->setFloatValue(value);
+    break;
+  }
+  case props::DOUBLE: {
+    double value;
+    if (!readBinary(input, value))
+      return false;
+    node->setDoubleValue(value);
+    break;
+  }
+  case props::STRING:
+  case props::UNSPECIFIED: {
+    std::string value;
+    if (!readBinaryString(input, value))
+      return false;
+    if (type == props::STRING)
+      node->setStringValue(value);
+    else
+      node->setUnspecifiedValue(value.c_str());
+    break;
+  }
+  case props::VEC3D: {
+    SGVec3d value;
+    for (int i = 0; i < 3; ++i)
+      if (!readBinary(input, value[i]))
+        return false;
+    node->setValue(value);
+    break;
+  }
+  case props::VEC4D: {
+    SGVec4d value;
+    for (int i = 0; i < 4; ++i)
+      if (!readBinary(input, value[i]))
+        return false;
+    node->setValue(value);
+    break;
+  }
+  default:
+    return false;
+  }
+  node->setAttributes(attributes);
+
+  uint32_t nChildren;
+  if (!readBinary(input, nChildren))
+    return false;
+  std::string name;
+  for (uint32_t i = 0; i < nChildren; i++) {
+    int32_t index;
+    if (!readBinaryString(input, name) || !readBinary(input, index)
+        || name.empty() || index < 0)
+      return false;
+    SGPropertyNode *child = node->getChild(name, index, true);
+    if (!readBinaryNode(input, child))
+      return false;
+  }
+  return true;
+}
+}
+
+void
+writeBinaryProperties (ostream &output, const SGPropertyNode *start_node)
+{
+  output.write(binaryMagic, sizeof(binaryMagic));
+  writeBinary(output, binaryVersion);
+  writeBinaryNode(output, start_node);
+}
+
+bool
+readBinaryProperties (istream &input, SGPropertyNode *start_node)
+{
+  char magic[sizeof(binaryMagic)];
+  uint32_t version;
+  if (!input.read(magic, sizeof(magic))
+      || memcmp(magic, binaryMagic, sizeof(magic))
+      || !readBinary(input, version) || version != binaryVersion)
+    return false;
+  return readBinaryNode(input, start_node);
+}
+
+
 ////////////////////////////////////////////////////////////////////////
 // Copy properties from one tree to another.
 ////////////////////////////////////////////////////////////////////////
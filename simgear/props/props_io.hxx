@@ -58,6 +58,24 @@ void writeProperties (const SGPath &file,
 		      SGPropertyNode::Attribute archive_flag = SGPropertyNode::ARCHIVE);
 
 
+/**
+ * Write properties to a stream in a compact binary form, for caches
+ * read back on the same machine. Values keep their types, attributes are
+ * kept, aliases are skipped like in copyProperties().
+ */
+void writeBinaryProperties (std::ostream &output,
+                            const SGPropertyNode * start_node);
+
+
+/**
+ * Read properties written by writeBinaryProperties().
+ *
+ * @return false if the data is not a property tree of this format, or
+ *  is truncated.
+ */
+bool readBinaryProperties (std::istream &input, SGPropertyNode * start_node);
+
+
 /**
  * Copy properties from one node to another.
  */
@@ -13,12 +13,18 @@
 #include <memory>               // std::unique_ptr
 #include <iostream>
 #include <map>
+#include <sstream>
 
 #include "props.hxx"
 #include "props_io.hxx"
+#include "condition.hxx"
+#include "PropertyBindings.hxx"
+#include "PropertyChangeTracker.hxx"
+#include "vectorPropTemplates.hxx"
 
 #include <simgear/misc/test_macros.hxx>
 #include <simgear/misc/sg_path.hxx>
+#include <simgear/structure/SGExpression.hxx>
 #include <simgear/misc/test_macros.hxx>
 
 using std::cout;
@@ -944,6 +950,278 @@ void testDeleterListener()
 
 }
 
+class CountingTracker : public simgear::PropertyChangeTracker
+{
+public:
+    CountingTracker() : dirtiedCount(0) {}
+    int dirtiedCount;
+protected:
+    void dirtied() override { ++dirtiedCount; }
+};
+
+// Reads state that is not a property and reports no dependencies
+class ExternalExpression : public SGExpression<double>
+{
+public:
+    ExternalExpression(const double* value) : _value(value) {}
+    void eval(double& value, const simgear::expression::Binding*) const override
+    { value = *_value; }
+private:
+    const double* _value;
+};
+
+// Tests state that is not a property and reports no dependencies
+class ExternalCondition : public SGCondition
+{
+public:
+    ExternalCondition(const bool* value) : _value(value) {}
+    bool test() const override { return *_value; }
+private:
+    const bool* _value;
+};
+
+void testChangeTracker()
+{
+    SGPropertyNode_ptr tree = new SGPropertyNode;
+    defineSamplePropertyTree(tree);
+    SGPropertyNode* a = tree->getNode("position/body/a");
+    SGPropertyNode* c = tree->getNode("position/body/c", true);
+    SGPropertyNode* season = tree->getNode("sim/season", true);
+    season->setStringValue("summer");
+
+    SGSharedPtr<SGExpressiond> expr
+        = new SGSumExpression<double>(new SGPropertyExpression<double>(a),
+                                      new SGPropertyExpression<double>(c));
+    SGPropertyNode_ptr conditionConfig = new SGPropertyNode;
+    SGPropertyNode* equals = conditionConfig->addChild("equals");
+    equals->setStringValue("property", "sim/season");
+    equals->setStringValue("value", "summer");
+    SGSharedPtr<SGCondition> condition = sgReadCondition(tree, conditionConfig);
+
+    {
+        CountingTracker tracker;
+        tracker.addDependencies(expr.get());
+        tracker.addDependencies(condition.get());
+        tracker.addDependencies((const SGCondition*)0);
+        // a, c, sim/season and the node holding the compared value
+        SG_CHECK_EQUAL(tracker.getNumProperties(), 4u);
+
+        // New trackers are dirty so the first update happens
+        SG_VERIFY(tracker.isDirty());
+        tracker.clearDirty();
+        SG_VERIFY(!tracker.isDirty());
+
+        tree->setIntValue("position/body/b", 5);
+        SG_VERIFY(!tracker.isDirty());
+        a->setIntValue(7);
+        SG_VERIFY(tracker.isDirty());
+        c->setDoubleValue(1);
+        SG_CHECK_EQUAL(tracker.dirtiedCount, 1);
+
+        tracker.clearDirty();
+        season->setStringValue("winter");
+        SG_VERIFY(tracker.isDirty());
+        SG_CHECK_EQUAL(tracker.dirtiedCount, 2);
+
+        // Tying a property later is caught by checkTied()
+        tracker.clearDirty();
+        SG_VERIFY(!tracker.checkTied());
+        int value = 3;
+        c->tie(SGRawValuePointer<int>(&value));
+        SG_VERIFY(tracker.checkTied());
+        value = 4;
+        tracker.clearDirty();
+        SG_VERIFY(tracker.isDirty());
+        c->untie();
+
+        // Aliases do not forward changes of their target
+        CountingTracker aliasTracker;
+        SGPropertyNode* alias = tree->getNode("position/alias", true);
+        alias->alias(a);
+        aliasTracker.addProperty(alias);
+        SG_VERIFY(aliasTracker.isVolatile());
+
+        // Constants need no updates at all
+        CountingTracker constTracker;
+        SGSharedPtr<SGExpressiond> constExpr = new SGConstExpression<double>(2);
+        SGPropertyNode_ptr emptyConfig = new SGPropertyNode;
+        SGSharedPtr<SGCondition> emptyCondition = sgReadCondition(tree, emptyConfig);
+        constTracker.addDependencies(constExpr.get());
+        constTracker.addDependencies(emptyCondition.get());
+        SG_CHECK_EQUAL(constTracker.getNumProperties(), 0u);
+        SG_VERIFY(!constTracker.isVolatile());
+        constTracker.clearDirty();
+        SG_VERIFY(!constTracker.isDirty());
+
+        // Expressions without dependencies read something else
+        double external = 1;
+        CountingTracker externalTracker;
+        SGSharedPtr<SGExpressiond> externalExpr = new ExternalExpression(&external);
+        externalTracker.addDependencies(externalExpr.get());
+        SG_CHECK_EQUAL(externalTracker.getNumProperties(), 0u);
+        SG_VERIFY(externalTracker.isVolatile());
+        externalTracker.clearDirty();
+        external = 2;
+        SG_VERIFY(externalTracker.isDirty());
+
+        // Mixing properties with other state still needs every update
+        CountingTracker mixedTracker;
+        SGSharedPtr<SGExpressiond> mixedExpr
+            = new SGSumExpression<double>(new SGPropertyExpression<double>(a),
+                                          new ExternalExpression(&external));
+        mixedTracker.addDependencies(mixedExpr.get());
+        SG_CHECK_EQUAL(mixedTracker.getNumProperties(), 1u);
+        SG_VERIFY(mixedTracker.isVolatile());
+
+        bool externalFlag = true;
+        CountingTracker andTracker;
+        SGSharedPtr<SGAndCondition> mixedCondition = new SGAndCondition;
+        mixedCondition->addCondition(sgReadCondition(tree, conditionConfig));
+        mixedCondition->addCondition(new ExternalCondition(&externalFlag));
+        andTracker.addDependencies(mixedCondition.get());
+        SG_CHECK_EQUAL(andTracker.getNumProperties(), 2u);
+        SG_VERIFY(andTracker.isVolatile());
+        andTracker.clearDirty();
+        externalFlag = false;
+        SG_VERIFY(andTracker.isDirty());
+
+        // while the properties alone do not
+        CountingTracker propertyTracker;
+        propertyTracker.addDependencies(expr.get());
+        propertyTracker.addDependencies(condition.get());
+        SG_VERIFY(!propertyTracker.isVolatile());
+    }
+
+    // The trackers stopped listening when they were destroyed
+    SG_VERIFY(ensureNListeners(tree, 0));
+}
+
+class RecordingTarget : public simgear::PropertyBindings::Target
+{
+public:
+    RecordingTarget() : updates(0), sum(0) {}
+    void update(SGPropertyNode* const* nodes, unsigned numNodes) override
+    {
+        ++updates;
+        sum = 0;
+        for (unsigned i = 0; i < numNodes; ++i)
+            sum += nodes[i]->getDoubleValue();
+    }
+    int updates;
+    double sum;
+};
+
+void testBindings()
+{
+    SGPropertyNode_ptr tree = new SGPropertyNode;
+    SGPropertyNode* x = tree->getNode("light/x", true);
+    SGPropertyNode* y = tree->getNode("light/y", true);
+    SGPropertyNode* z = tree->getNode("light/z", true);
+    SGPropertyNode* unbound = tree->getNode("light/w", true);
+    x->setDoubleValue(1);
+
+    {
+        simgear::PropertyBindings bindings;
+        std::vector<SGSharedPtr<RecordingTarget> > scalars;
+        std::vector<SGSharedPtr<RecordingTarget> > vectors;
+        SGPropertyNode* vector[3] = { x, y, z };
+        for (int i = 0; i < 100; ++i) {
+            scalars.push_back(new RecordingTarget);
+            bindings.bind(scalars.back().get(), &x, 1);
+            vectors.push_back(new RecordingTarget);
+            bindings.bind(vectors.back().get(), vector, 3);
+        }
+
+        // Bound targets start with the current values, and share one
+        // listener per property
+        SG_CHECK_EQUAL(scalars[0]->updates, 1);
+        SG_CHECK_EQUAL(scalars[0]->sum, 1.0);
+        simgear::PropertyBindings::Statistics stats = bindings.getStatistics();
+        SG_CHECK_EQUAL(stats._bindings, 200u);
+        SG_CHECK_EQUAL(stats._properties, 3u);
+        SG_CHECK_EQUAL(x->nListeners(), 1);
+        bindings.resetStatistics();
+
+        // Nothing happens until update(), and then every target is
+        // updated once, however often and however many of its properties
+        // were written
+        for (int i = 0; i < 10; ++i) {
+            x->setDoubleValue(2 + i);
+            y->setDoubleValue(i);
+        }
+        unbound->setDoubleValue(5);
+        SG_CHECK_EQUAL(scalars[0]->updates, 1);
+        bindings.update();
+        SG_CHECK_EQUAL(scalars[0]->updates, 2);
+        SG_CHECK_EQUAL(scalars[0]->sum, 11.0);
+        SG_CHECK_EQUAL(vectors[0]->updates, 2);
+        SG_CHECK_EQUAL(vectors[0]->sum, 20.0);
+        stats = bindings.getStatistics();
+        SG_CHECK_EQUAL(stats._notifications, 20ul);
+        SG_CHECK_EQUAL(stats._targetUpdates, 200ul);
+
+        // Only the targets of the changed property
+        z->setDoubleValue(1);
+        bindings.update();
+        bindings.update();
+        SG_CHECK_EQUAL(scalars[0]->updates, 2);
+        SG_CHECK_EQUAL(vectors[99]->updates, 3);
+        stats = bindings.getStatistics();
+        SG_CHECK_EQUAL(stats._updates, 3ul);
+        SG_CHECK_EQUAL(stats._targetUpdates, 300ul);
+    }
+
+    // The listeners went away with the bindings
+    SG_VERIFY(ensureNListeners(tree, 0));
+}
+
+void testBinaryIO()
+{
+    SGPropertyNode_ptr tree = new SGPropertyNode;
+    tree->setBoolValue("a/bool", true);
+    tree->setIntValue("a/int[3]", -7);
+    tree->setLongValue("a/long", 1L << 40);
+    tree->setFloatValue("a/float", 0.25f);
+    tree->setDoubleValue("a/double", 1.0 / 3.0);
+    tree->setStringValue("b/string", "some text");
+    tree->getNode("b/unspecified", true)->setUnspecifiedValue("12");
+    tree->getNode("b/vec3", true)->setValue(SGVec3d(1, 2, 3));
+    tree->getNode("b/vec4", true)->setValue(SGVec4d(1, 2, 3, 4));
+    tree->getNode("c/empty", true);
+    tree->getNode("a/double")->setAttribute(SGPropertyNode::ARCHIVE, true);
+
+    std::stringstream stream;
+    writeBinaryProperties(stream, tree);
+    SGPropertyNode_ptr copy = new SGPropertyNode;
+    SG_VERIFY(readBinaryProperties(stream, copy));
+
+    SG_CHECK_EQUAL(copy->nChildren(), 3);
+    SG_CHECK_EQUAL(copy->getNode("a/bool")->getType(), simgear::props::BOOL);
+    SG_VERIFY(copy->getBoolValue("a/bool"));
+    SG_CHECK_EQUAL(copy->getNode("a/int[3]")->getType(), simgear::props::INT);
+    SG_CHECK_EQUAL(copy->getIntValue("a/int[3]"), -7);
+    SG_CHECK_EQUAL(copy->getLongValue("a/long"), 1L << 40);
+    SG_CHECK_EQUAL(copy->getFloatValue("a/float"), 0.25f);
+    SG_CHECK_EQUAL(copy->getDoubleValue("a/double"), 1.0 / 3.0);
+    SG_VERIFY(copy->getNode("a/double")->getAttribute(SGPropertyNode::ARCHIVE));
+    SG_CHECK_EQUAL(copy->getStringValue("b/string"), std::string("some text"));
+    SG_CHECK_EQUAL(copy->getNode("b/unspecified")->getType(),
+                   simgear::props::UNSPECIFIED);
+    SG_CHECK_EQUAL(copy->getNode("b/vec3")->getType(), simgear::props::VEC3D);
+    SG_VERIFY(copy->getNode("b/vec3")->getValue<SGVec3d>() == SGVec3d(1, 2, 3));
+    SG_VERIFY(copy->getNode("b/vec4")->getValue<SGVec4d>()
+              == SGVec4d(1, 2, 3, 4));
+    SG_VERIFY(!copy->getNode("c/empty")->hasValue());
+
+    // Truncated or foreign data is refused
+    std::string data = stream.str();
+    std::stringstream truncated(data.substr(0, data.size() - 3));
+    SGPropertyNode_ptr partial = new SGPropertyNode;
+    SG_VERIFY(!readBinaryProperties(truncated, partial));
+    std::stringstream xml("<PropertyList/>");
+    SG_VERIFY(!readBinaryProperties(xml, partial));
+}
+
 int main (int ac, char ** av)
 {
   test_value();
@@ -967,6 +1245,9 @@ int main (int ac, char ** av)
     tiedPropertiesTest();
     tiedPropertiesListeners();
     testDeleterListener();
+    testChangeTracker();
+    testBindings();
+    testBinaryIO();
 
     // disable test for the moment
    // testAliasedListeners();
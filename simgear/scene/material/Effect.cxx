@@ -90,12 +90,82 @@ using namespace osgUtil;
 
 using namespace effect;
 
+namespace
+{
+// A uniform fed from global properties, bound once the effect is in the
+// scene graph. The binding then updates it with the rest once per frame.
+class UniformBinding : public DeferredPropertyListener,
+                       public PropertyBindings::Target
+{
+public:
+    UniformBinding(PropertyBindings* bindings, Uniform* uniform,
+                   const std::vector<std::string>& propNames) :
+        _bindings(bindings),
+        _uniform(uniform),
+        _propNames(propNames)
+    {
+    }
+
+    void activate(SGPropertyNode* propRoot)
+    {
+        SGSharedPtr<UniformBinding> self(this);
+        std::vector<SGPropertyNode*> nodes;
+        for (std::size_t i = 0; i < _propNames.size(); ++i) {
+            SGPropertyNode* node = _propNames.size() == 1
+                ? makeNode(propRoot, _propNames[i])
+                : propRoot->getNode(_propNames[i], true);
+            if (!node)
+                return;
+            nodes.push_back(node);
+        }
+        _propNames.clear();
+        _bindings->bind(this, &nodes[0], nodes.size());
+    }
+
+    void update(SGPropertyNode* const* nodes, unsigned numNodes)
+    {
+        switch (_uniform->getType()) {
+        case Uniform::BOOL:
+            _uniform->set(nodes[0]->getBoolValue());
+            break;
+        case Uniform::FLOAT:
+            _uniform->set(nodes[0]->getFloatValue());
+            break;
+        case Uniform::FLOAT_VEC3:
+            if (numNodes == 3)
+                _uniform->set(Vec3(nodes[0]->getDoubleValue(),
+                                   nodes[1]->getDoubleValue(),
+                                   nodes[2]->getDoubleValue()));
+            break;
+        case Uniform::FLOAT_VEC4:
+            if (numNodes == 4)
+                _uniform->set(Vec4(nodes[0]->getDoubleValue(),
+                                   nodes[1]->getDoubleValue(),
+                                   nodes[2]->getDoubleValue(),
+                                   nodes[3]->getDoubleValue()));
+            break;
+        default:
+            _uniform->set(nodes[0]->getIntValue());
+            break;
+        }
+    }
+
+private:
+    PropertyBindings* _bindings;
+    ref_ptr<Uniform> _uniform;
+    std::vector<std::string> _propNames;
+};
+}
+
 const char* UniformFactoryImpl::vec3Names[] = {"x", "y", "z"};
 const char* UniformFactoryImpl::vec4Names[] = {"x", "y", "z", "w"};
 
 void UniformFactoryImpl::reset()
 {
+  SGGuard<SGMutex> scopeLock(_mutex);
   uniformCache.clear();
+  // the bindings hold the uniforms of the effects thrown away
+  _bindings.clear();
 }
 
 ref_ptr<Uniform> UniformFactoryImpl::getUniform( Effect * effect,
@@ -140,6 +210,32 @@ ref_ptr<Uniform> UniformFactoryImpl::getUniform( Effect * effect,
 
     uniform->setName(name);
     uniform->setType(uniformType);
+
+    // Uniforms following global properties are updated in batches, see
+    // updateUniforms()
+    const SGPropertyNode* paramProp = getEffectPropertyNode(effect, valProp);
+    if (paramProp && paramProp->nChildren() > 0) {
+        std::vector<std::string> propNames;
+        switch (uniformType) {
+        case Uniform::FLOAT_VEC3:
+            propNames = getVectorProperties(paramProp, options, 3, vec3Names);
+            break;
+        case Uniform::FLOAT_VEC4:
+            propNames = getVectorProperties(paramProp, options, 4, vec4Names);
+            break;
+        default:
+            propNames.push_back(getGlobalProperty(paramProp, options));
+            break;
+        }
+        if (propNames.empty())
+            throw BuilderException();
+        uniform->setDataVariance(Object::DYNAMIC);
+        effect->addDeferredPropertyListener(new UniformBinding(&_bindings,
+                                                               uniform.get(),
+                                                               propNames));
+        return uniform;
+    }
+
     switch (uniformType) {
     case Uniform::BOOL:
     	initFromParameters(effect, valProp, uniform.get(),
@@ -189,6 +285,18 @@ void UniformFactoryImpl::addListener(DeferredPropertyListener* listener)
     }
 }
 
+void UniformFactoryImpl::updateUniforms()
+{
+    SGGuard<SGMutex> scopeLock(_mutex);
+    _bindings.update();
+}
+
+PropertyBindings::Statistics UniformFactoryImpl::getBindingStatistics()
+{
+    SGGuard<SGMutex> scopeLock(_mutex);
+    return _bindings.getStatistics();
+}
+
 void UniformFactoryImpl::updateListeners( SGPropertyNode* propRoot )
 {
 	SGGuard<SGMutex> scopeLock(_mutex);
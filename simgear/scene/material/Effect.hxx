@@ -30,6 +30,7 @@
 #include <osgDB/ReaderWriter>
 
 #include <simgear/props/props.hxx>
+#include <simgear/props/PropertyBindings.hxx>
 #include <simgear/scene/util/UpdateOnceCallback.hxx>
 #include <simgear/threads/SGThread.hxx>
 #include <simgear/threads/SGGuard.hxx>
@@ -186,6 +187,12 @@ public:
                                  const SGReaderWriterOptions* options );
     void updateListeners( SGPropertyNode* propRoot );
     void addListener(DeferredPropertyListener* listener);
+    /**
+     * Write the uniforms whose properties changed since the last call,
+     * each once. Called once per frame from the update phase.
+     */
+    void updateUniforms();
+    PropertyBindings::Statistics getBindingStatistics();
     void reset();
 private:
     // Default names for vector property components
@@ -200,6 +207,9 @@ private:
 
     typedef std::queue<DeferredPropertyListener*> DeferredListenerList;
     DeferredListenerList deferredListenerList;
+
+    // Uniforms fed from the global property tree
+    PropertyBindings _bindings;
 };
 
 typedef Singleton<UniformFactoryImpl> UniformFactory;
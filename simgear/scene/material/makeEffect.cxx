@@ -13,6 +13,12 @@
 #include <map>
 #include <sstream>
 
+#ifdef _WIN32
+#  include <process.h>
+#else
+#  include <unistd.h>
+#endif
+
 #include <boost/lexical_cast.hpp>
 #include <boost/tuple/tuple.hpp>
 #include <boost/tuple/tuple_comparison.hpp>
@@ -31,6 +37,9 @@
 #include <osgDB/Registry>
 
 #include <simgear/debug/logstream.hxx>
+#include <simgear/io/iostreams/sgstream.hxx>
+#include <simgear/misc/sg_hash.hxx>
+#include <simgear/misc/strutils.hxx>
 #include <simgear/scene/util/SGReaderWriterOptions.hxx>
 #include <simgear/props/props_io.hxx>
 #include <simgear/scene/tgdb/userdata.hxx>
@@ -51,6 +60,9 @@ namespace
 {
 EffectMap effectMap;
 OpenThreads::ReentrantMutex effectMutex;
+// Keys of the named effects in the persistent effect cache, empty for
+// effects without a valid entry
+map<string, string> effectKeys;
 }
 
 /** Merge two property trees, producing a new tree.
@@ -116,17 +128,25 @@ void mergePropertyTrees(SGPropertyNode* resultNode,
 }
 }
 
-Effect* makeEffect(const string& name,
-                   bool realizeTechniques,
-                   const SGReaderWriterOptions* options)
+namespace
 {
-    {
-        OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(effectMutex);
-        EffectMap::iterator itr = effectMap.find(name);
-        if ((itr != effectMap.end())&&
-            itr->second.valid())
-            return itr->second.get();
+bool realizeEffect(Effect* effect, const SGReaderWriterOptions* options)
+{
+    try {
+        OpenThreads::ScopedLock<OpenThreads::ReentrantMutex>
+            lock(effectMutex);
+        effect->realizeTechniques(options);
+    }
+    catch (BuilderException& e) {
+        SG_LOG(SG_INPUT, SG_ALERT, "Error building technique: "
+               << e.getFormattedMessage());
+        return false;
     }
+    return true;
+}
+
+string findEffectFile(const string& name, const SGReaderWriterOptions* options)
+{
     string effectFileName;
     // Use getPropertyRoot() because the SGReaderWriterOptions might not have a
     // valid property tree
@@ -136,21 +156,227 @@ Effect* makeEffect(const string& name,
     effectFileName += ".eff";
     string absFileName
         = SGModelLib::findDataFile(effectFileName, options);
-    if (absFileName.empty()) {
+    if (absFileName.empty())
         SG_LOG(SG_INPUT, SG_ALERT, "can't find \"" << effectFileName << "\"");
-        return 0;
+    return absFileName;
+}
+
+/* The persistent effect cache
+ *
+ * Named effects are also stored merged with the effects they inherit
+ * from, in SGSceneFeatures::getEffectCachePath(). An entry is found by
+ * the SHA-1 of its effect file and holds the key of its parent, the
+ * SHA-1 of the parent's file and of the key of the parent's parent. It
+ * is used only while that whole chain is unchanged, and then saves
+ * parsing and merging the XML of the chain.
+ *
+ * An entry is a header tree (parent, parent-key and the generators)
+ * followed by the merged effect tree, in writeBinaryProperties() form.
+ * Effect files with includes are not stored, as the digest of their
+ * contents would not cover the included files.
+ */
+const char* const effectCacheVersion = "1";
+
+string sha1Hex(const string& data)
+{
+    sha1nfo info;
+    sha1_init(&info);
+    sha1_write(&info, data.data(), data.size());
+    return strutils::encodeHex(sha1_result(&info), HASH_LENGTH);
+}
+
+// The digest of an effect file, or empty if it can't be cached
+string effectFileDigest(const string& absFileName)
+{
+    sg_ifstream stream(SGPath::fromUtf8(absFileName));
+    if (!stream.is_open())
+        return string();
+    ostringstream contents;
+    contents << effectCacheVersion << '\n' << stream.rdbuf();
+    string data = contents.str();
+    if (data.find("include=") != string::npos)
+        return string();
+    return sha1Hex(data);
+}
+
+SGPath effectCacheFile(const string& digest)
+{
+    return SGSceneFeatures::instance()->getEffectCachePath()
+        / (digest + ".effect");
+}
+
+string cachedEffectKey(const string& name,
+                       const SGReaderWriterOptions* options);
+
+// Reads the entry of the effect file with the digest and returns its
+// key, or an empty string if there is no entry or it is out of date.
+// Called with effectMutex locked.
+string loadCachedEffect(const string& digest, SGPropertyNode* header,
+                        SGPropertyNode* effectProps,
+                        const SGReaderWriterOptions* options)
+{
+    sg_ifstream stream(effectCacheFile(digest));
+    if (!stream.is_open())
+        return string();
+    if (!readBinaryProperties(stream, header)
+        || !readBinaryProperties(stream, effectProps)) {
+        SG_LOG(SG_INPUT, SG_WARN, "ignoring corrupt effect cache entry "
+               << effectCacheFile(digest));
+        return string();
     }
-    SGPropertyNode_ptr effectProps = new SGPropertyNode();
-    try {
-        readProperties(absFileName, effectProps.ptr(), 0, true);
+    string parent = header->getStringValue("parent");
+    string parentKey;
+    if (!parent.empty()) {
+        parentKey = cachedEffectKey(parent, options);
+        if (parentKey.empty() || parentKey != header->getStringValue("parent-key"))
+            return string();
     }
-    catch (sg_io_exception& e) {
-        SG_LOG(SG_INPUT, SG_ALERT, "error reading \"" << absFileName << "\": "
-               << e.getFormattedMessage());
+    return sha1Hex(digest + parentKey);
+}
+
+string cachedEffectKey(const string& name,
+                       const SGReaderWriterOptions* options)
+{
+    OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(effectMutex);
+    map<string, string>::iterator itr = effectKeys.find(name);
+    if (itr != effectKeys.end())
+        return itr->second;
+    string key;
+    string absFileName = findEffectFile(name, options);
+    string digest;
+    if (!absFileName.empty())
+        digest = effectFileDigest(absFileName);
+    if (!digest.empty()) {
+        SGPropertyNode_ptr header = new SGPropertyNode;
+        SGPropertyNode_ptr effectProps = new SGPropertyNode;
+        key = loadCachedEffect(digest, header, effectProps, options);
+    }
+    effectKeys[name] = key;
+    return key;
+}
+
+void storeCachedEffect(const string& name, const string& digest,
+                       const SGPropertyNode* props, const Effect* effect,
+                       const SGReaderWriterOptions* options)
+{
+    OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(effectMutex);
+    string parent = props->getStringValue("inherits-from");
+    string parentKey;
+    if (!parent.empty()) {
+        parentKey = cachedEffectKey(parent, options);
+        if (parentKey.empty())
+            return;
+    }
+    SGPropertyNode_ptr header = new SGPropertyNode;
+    header->setStringValue("parent", parent);
+    header->setStringValue("parent-key", parentKey);
+    int i = 0;
+    for (map<Effect::Generator, int>::const_iterator itr
+             = effect->generator.begin(), e = effect->generator.end();
+         itr != e;
+         ++itr, ++i) {
+        SGPropertyNode* generator = header->getChild("generator", i, true);
+        generator->setIntValue("type", itr->first);
+        generator->setIntValue("location", itr->second);
+    }
+
+    // Write the entry under a temporary name so that no other process
+    // finds it half written. The name carries the process id, as
+    // several processes can share the cache directory.
+    SGPath path = effectCacheFile(digest);
+    SGPath tempPath = path;
+#ifdef _WIN32
+    tempPath.concat(".tmp" + boost::lexical_cast<string>(_getpid()));
+#else
+    tempPath.concat(".tmp" + boost::lexical_cast<string>(getpid()));
+#endif
+    tempPath.create_dir();
+    {
+        sg_ofstream stream(tempPath, std::ios::out | std::ios::binary
+                                     | std::ios::trunc);
+        if (!stream.is_open())
+            return;
+        writeBinaryProperties(stream, header);
+        writeBinaryProperties(stream, effect->root);
+        if (!stream)
+            return;
+    }
+    if (!tempPath.rename(path)) {
+        tempPath.remove();
+        return;
+    }
+    effectKeys[name] = sha1Hex(digest + parentKey);
+}
+
+Effect* makeCachedEffect(const SGPropertyNode* header,
+                         SGPropertyNode* effectProps,
+                         bool realizeTechniques,
+                         const SGReaderWriterOptions* options)
+{
+    ref_ptr<Effect> effect = new Effect;
+    effect->setName(effectProps->getStringValue("name"));
+    effect->root = effectProps;
+    effect->parametersProp = effect->root->getChild("parameters");
+    for (int i = 0; i < header->nChildren(); ++i) {
+        const SGPropertyNode* generator = header->getChild(i);
+        if (strcmp(generator->getName(), "generator"))
+            continue;
+        effect->setGenerator(Effect::Generator(generator->getIntValue("type")),
+                             generator->getIntValue("location"));
+    }
+    if (realizeTechniques && !realizeEffect(effect, options))
         return 0;
+    return effect.release();
+}
+}
+
+Effect* makeEffect(const string& name,
+                   bool realizeTechniques,
+                   const SGReaderWriterOptions* options)
+{
+    {
+        OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(effectMutex);
+        EffectMap::iterator itr = effectMap.find(name);
+        if ((itr != effectMap.end())&&
+            itr->second.valid())
+            return itr->second.get();
+    }
+    string absFileName = findEffectFile(name, options);
+    if (absFileName.empty())
+        return 0;
+
+    // Try the persistent cache first
+    string digest;
+    if (!SGSceneFeatures::instance()->getEffectCachePath().isNull())
+        digest = effectFileDigest(absFileName);
+    SGPropertyNode_ptr header = new SGPropertyNode;
+    SGPropertyNode_ptr effectProps = new SGPropertyNode;
+    string key;
+    if (!digest.empty()) {
+        OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(effectMutex);
+        key = loadCachedEffect(digest, header, effectProps, options);
+        effectKeys[name] = key;
+    }
+
+    ref_ptr<Effect> result;
+    if (!key.empty()) {
+        SG_LOG(SG_INPUT, SG_DEBUG, "using cached effect \"" << name << "\"");
+        result = makeCachedEffect(header, effectProps, realizeTechniques,
+                                  options);
+    } else {
+        effectProps = new SGPropertyNode;
+        try {
+            readProperties(absFileName, effectProps.ptr(), 0, true);
+        }
+        catch (sg_io_exception& e) {
+            SG_LOG(SG_INPUT, SG_ALERT, "error reading \"" << absFileName << "\": "
+                   << e.getFormattedMessage());
+            return 0;
+        }
+        result = makeEffect(effectProps.ptr(), realizeTechniques, options);
+        if (result.valid() && !digest.empty())
+            storeCachedEffect(name, digest, effectProps, result, options);
     }
-    ref_ptr<Effect> result = makeEffect(effectProps.ptr(), realizeTechniques,
-                                        options);
     if (result.valid()) {
         OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(effectMutex);
         pair<EffectMap::iterator, bool> irslt
@@ -267,18 +493,8 @@ Effect* makeEffect(SGPropertyNode* prop,
         parameter = generateProp->getChild("binormal");
         if(parameter) effect->setGenerator(Effect::BINORMAL, parameter->getIntValue());
     }
-    if (realizeTechniques) {
-        try {
-            OpenThreads::ScopedLock<OpenThreads::ReentrantMutex>
-                lock(effectMutex);
-            effect->realizeTechniques(options);
-        }
-        catch (BuilderException& e) {
-            SG_LOG(SG_INPUT, SG_ALERT, "Error building technique: "
-                   << e.getFormattedMessage());
-            return 0;
-        }
-    }
+    if (realizeTechniques && !realizeEffect(effect, options))
+        return 0;
     return effect.release();
 }
 
@@ -287,6 +503,7 @@ void clearEffectCache()
     SG_LOG(SG_INPUT, SG_DEBUG, "clearEffectCache called");
     OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(effectMutex);
     effectMap.clear();
+    effectKeys.clear();
     UniformFactory::instance()->reset();
 }
 
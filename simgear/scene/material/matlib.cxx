@@ -29,6 +29,7 @@
 #include <simgear/constants.h>
 #include <simgear/structure/exception.hxx>
 
+#include <cmath>
 #include <string.h>
 #include <string>
 
@@ -53,16 +54,152 @@
 using std::string;
 
 
+// The material areas are indexed on a grid of one degree cells. Every cell
+// refers to a signature, the set of regions with an area touching the
+// cell, and for every signature the materials that can be valid anywhere
+// in those cells are listed per name. Regions without areas are part of
+// every signature. Most of the globe shares a few signatures, so lookups
+// only test the handful of regional variants that can match.
 class SGMaterialLib::MatLibPrivate
 {
 public:
+    enum { GridWidth = 360, GridHeight = 180, MaxCachedStates = 1024 };
+
+    struct Region {
+        const AreaList* areas;
+        SGSharedPtr<const SGCondition> condition;
+    };
+
+    // Indices into the material_list of a name, last one first
+    typedef std::vector<unsigned> candidate_list;
+
+    struct Signature {
+        std::vector<unsigned> regions;
+        // By position of the name in the material map
+        std::vector<candidate_list> candidates;
+    };
+
+    // Regions a cell or a point is in, set bits mean the area test and
+    // the condition passed
+    typedef std::vector<bool> region_state;
+
+    static int cellIndex(float lon, float lat)
+    {
+        int x = SGMisc<int>::clip(int(std::floor(lon + 180)), 0, GridWidth - 1);
+        int y = SGMisc<int>::clip(int(std::floor(lat + 90)), 0, GridHeight - 1);
+        return y*GridWidth + x;
+    }
+
+    const Signature& getSignature(SGVec2f center) const
+    {
+        return signatures[cells[cellIndex(center.x(), center.y())]];
+    }
+
+    bool inArea(unsigned region, SGVec2f center) const
+    {
+        const AreaList* areas = regions[region].areas;
+        for (AreaList::const_iterator i = areas->begin(); i != areas->end(); ++i) {
+            if (i->contains(center.x(), center.y()))
+                return true;
+        }
+        return false;
+    }
+
+    bool testCondition(unsigned region) const
+    {
+        const SGCondition* condition = regions[region].condition;
+        return !condition || condition->test();
+    }
+
+    void buildIndex(const material_map& matlib);
+
     SGMutex mutex;
+
+    std::vector<Region> regions;
+    // For every material name the region of each entry in its list
+    std::map<std::string, std::vector<unsigned> > materialRegions;
+    std::map<std::string, unsigned> nameIds;
+    std::vector<unsigned> globalRegions;
+
+    std::vector<unsigned short> cells;
+    std::vector<Signature> signatures;
+
+    // Material caches are a function of the region state, tiles with the
+    // same materials share theirs
+    std::map<region_state, osg::ref_ptr<SGMaterialCache> > cacheByState;
 };
 
+void SGMaterialLib::MatLibPrivate::buildIndex(const material_map& matlib)
+{
+    std::vector<std::vector<unsigned> > cellRegions(GridWidth*GridHeight);
+    globalRegions.clear();
+    for (unsigned r = 0; r < regions.size(); ++r) {
+        const AreaList* areas = regions[r].areas;
+        if (areas->empty()) {
+            globalRegions.push_back(r);
+            continue;
+        }
+        std::vector<bool> touched(cellRegions.size());
+        for (AreaList::const_iterator i = areas->begin(); i != areas->end(); ++i) {
+            int first = cellIndex(i->x(), i->y());
+            int last = cellIndex(i->x() + i->width(), i->y() + i->height());
+            for (int y = first/GridWidth; y <= last/GridWidth; ++y) {
+                for (int x = first%GridWidth; x <= last%GridWidth; ++x)
+                    touched[y*GridWidth + x] = true;
+            }
+        }
+        for (unsigned c = 0; c < touched.size(); ++c) {
+            if (touched[c])
+                cellRegions[c].push_back(r);
+        }
+    }
+
+    std::map<std::vector<unsigned>, unsigned short> signatureIds;
+    signatures.clear();
+    cells.resize(cellRegions.size());
+    for (unsigned c = 0; c < cellRegions.size(); ++c) {
+        std::pair<std::map<std::vector<unsigned>, unsigned short>::iterator, bool> ins
+            = signatureIds.insert(std::make_pair(cellRegions[c],
+                                                 (unsigned short)signatures.size()));
+        if (ins.second) {
+            signatures.push_back(Signature());
+            signatures.back().regions = cellRegions[c];
+        }
+        cells[c] = ins.first->second;
+    }
+
+    nameIds.clear();
+    for (const_material_map_iterator it = matlib.begin(); it != matlib.end(); ++it)
+        nameIds.insert(std::make_pair(it->first, unsigned(nameIds.size())));
+
+    for (unsigned s = 0; s < signatures.size(); ++s) {
+        Signature& signature = signatures[s];
+        std::vector<bool> inSignature(regions.size());
+        for (unsigned i = 0; i < globalRegions.size(); ++i)
+            inSignature[globalRegions[i]] = true;
+        for (unsigned i = 0; i < signature.regions.size(); ++i)
+            inSignature[signature.regions[i]] = true;
+
+        signature.candidates.resize(matlib.size());
+        for (const_material_map_iterator it = matlib.begin(); it != matlib.end(); ++it) {
+            const std::vector<unsigned>& listRegions = materialRegions[it->first];
+            candidate_list& candidates = signature.candidates[nameIds[it->first]];
+            for (unsigned i = listRegions.size(); i-- > 0;) {
+                if (inSignature[listRegions[i]])
+                    candidates.push_back(i);
+            }
+        }
+    }
+
+    SGGuard<SGMutex> lock(mutex);
+    cacheByState.clear();
+}
+
 // Constructor
 SGMaterialLib::SGMaterialLib ( void ) :
     d(new MatLibPrivate)
 {
+    d->buildIndex(matlib);
 }
 
 // Load a library of material properties
@@ -127,6 +264,10 @@ bool SGMaterialLib::load( const string &fg_root, const string& mpath,
 			condition = sgReadCondition(prop_root, conditionNode);
 		}
 
+		unsigned region = d->regions.size();
+		MatLibPrivate::Region regionEntry = { arealist, condition };
+		d->regions.push_back(regionEntry);
+
 		// Now build all the materials for this set of areas and conditions
 
 		const simgear::PropertyList materials = node->getChildren("material");
@@ -141,6 +282,7 @@ bool SGMaterialLib::load( const string &fg_root, const string& mpath,
 				string name = names[j]->getStringValue();
 				// cerr << "Material " << name << endl;
 				matlib[name].push_back(m);
+				d->materialRegions[name].push_back(region);
 				m->add_name(name);
 				SG_LOG( SG_TERRAIN, SG_DEBUG, "  Loading material "
 						<< names[j]->getStringValue() );
@@ -148,26 +290,28 @@ bool SGMaterialLib::load( const string &fg_root, const string& mpath,
 		}
     }
 
+    d->buildIndex(matlib);
     return true;
 }
 
 // find a material record by material name and tile center
 SGMaterial *SGMaterialLib::find( const string& material, const SGVec2f center ) const
 {
-    SGMaterial *result = NULL;
     const_material_map_iterator it = matlib.find( material );
-    if ( it != end() ) {            
-        // We now have a list of materials that match this
-        // name. Find the first one that matches.
-    	// We start at the end of the list, as the materials
-    	// list is ordered with the smallest regions at the end.
-        material_list::const_reverse_iterator iter = it->second.rbegin();
-        while (iter != it->second.rend()) {
-            result = *iter;
-            if (result->valid(center)) {
-                return result;
-            }
-            iter++;
+    if ( it == end() )
+        return NULL;
+
+    // We now have a list of materials that match this name. Find the
+    // first one that matches, starting at the end of the list as the
+    // materials list is ordered with the smallest regions at the end.
+    // The index only leaves the entries whose areas are near the center.
+    const MatLibPrivate::Signature& signature = d->getSignature(center);
+    const MatLibPrivate::candidate_list& list
+        = signature.candidates[d->nameIds.find(material)->second];
+    for (unsigned i = 0; i < list.size(); ++i) {
+        SGMaterial* result = it->second[list[i]];
+        if (result->valid(center)) {
+            return result;
         }
     }
 
@@ -181,18 +325,54 @@ SGMaterial *SGMaterialLib::find( const string& material, const SGGeod& center )
 	return find(material, c);
 }
 
-SGMaterialCache *SGMaterialLib::generateMatCache(SGVec2f center)
+osg::ref_ptr<SGMaterialCache> SGMaterialLib::generateMatCache(SGVec2f center)
 {
-	SGMaterialCache* newCache = new SGMaterialCache();
-    material_map::const_reverse_iterator it = matlib.rbegin();
-    for (; it != matlib.rend(); ++it) {
-        newCache->insert(it->first, find(it->first, center));
+    // Every material is valid exactly when its region is, so the cache
+    // only depends on which regions are valid at the center.
+    const MatLibPrivate::Signature& signature = d->getSignature(center);
+    MatLibPrivate::region_state state(d->regions.size());
+    for (unsigned i = 0; i < d->globalRegions.size(); ++i) {
+        unsigned r = d->globalRegions[i];
+        state[r] = d->testCondition(r);
+    }
+    for (unsigned i = 0; i < signature.regions.size(); ++i) {
+        unsigned r = signature.regions[i];
+        state[r] = d->inArea(r, center) && d->testCondition(r);
+    }
+
+    SGGuard<SGMutex> lock(d->mutex);
+    osg::ref_ptr<SGMaterialCache>& cached = d->cacheByState[state];
+    // Take the reference while locked, other threads may clear the map
+    if (cached.valid())
+        return cached;
+
+    osg::ref_ptr<SGMaterialCache> newCache = new SGMaterialCache();
+    const_material_map_iterator it = matlib.begin();
+    for (unsigned id = 0; it != matlib.end(); ++it, ++id) {
+        const MatLibPrivate::candidate_list& list = signature.candidates[id];
+        const std::vector<unsigned>& listRegions
+            = d->materialRegions.find(it->first)->second;
+        SGMaterial* result = NULL;
+        for (unsigned i = 0; i < list.size(); ++i) {
+            if (state[listRegions[list[i]]]) {
+                result = it->second[list[i]];
+                break;
+            }
+        }
+        newCache->insert(it->first, result);
+    }
+
+    // Conditions on continuous properties could produce many states
+    if (d->cacheByState.size() > MatLibPrivate::MaxCachedStates) {
+        d->cacheByState.clear();
+        d->cacheByState[state] = newCache;
+    } else {
+        cached = newCache;
     }
-    
     return newCache;
 }
 
-SGMaterialCache *SGMaterialLib::generateMatCache(SGGeod center)
+osg::ref_ptr<SGMaterialCache> SGMaterialLib::generateMatCache(SGGeod center)
 {
 	SGVec2f c = SGVec2f(center.getLongitudeDeg(), center.getLatitudeDeg());
 	return SGMaterialLib::generateMatCache(c);
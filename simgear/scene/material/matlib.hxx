@@ -36,6 +36,8 @@
 #include <map>			// STL associative "array"
 #include <vector>		// STL "array"
 
+#include <osg/ref_ptr>
+
 class SGMaterial;
 class SGPropertyNode;
 
@@ -59,7 +61,8 @@ public:
     // Lookup
     SGMaterial *find( const std::string& material ) const;
 
-    // Destructor
+protected:
+    // Caches are shared between tiles, hold them in an osg::ref_ptr
     ~SGMaterialCache ( void );
 };
 
@@ -103,10 +106,15 @@ public:
      * To fix this, and also avoid repeated re-evaluation of the material
      * conditions, we provide factory method to generate a material library
      * cache of the valid materials based on the current state and a given position.
+     *
+     * Positions where the same regions are valid, like neighbouring tiles,
+     * get the same cache, which must not be modified. The library
+     * drops its own references at any time, so keep the returned ref_ptr
+     * as long as the cache is in use.
      */
 
-    SGMaterialCache *generateMatCache( SGVec2f center);
-    SGMaterialCache *generateMatCache( SGGeod center);
+    osg::ref_ptr<SGMaterialCache> generateMatCache( SGVec2f center);
+    osg::ref_ptr<SGMaterialCache> generateMatCache( SGGeod center);
 
     material_map_iterator begin() { return matlib.begin(); }
     const_material_map_iterator begin() const { return matlib.begin(); }
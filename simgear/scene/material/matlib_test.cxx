@@ -0,0 +1,145 @@
+#include <simgear_config.h>
+#include <simgear/compiler.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <osg/ref_ptr>
+
+#include <simgear/math/sg_random.h>
+#include <simgear/misc/sg_dir.hxx>
+#include <simgear/misc/test_macros.hxx>
+#include <simgear/props/props.hxx>
+#include <simgear/props/props_io.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include "mat.hxx"
+#include "matlib.hxx"
+
+const char* names[] = { "Grass", "Forest", "Town", "Ocean", "Sand", "Rock" };
+const int nameCount = sizeof(names)/sizeof(names[0]);
+
+void addMaterials(SGPropertyNode* region, bool all)
+{
+    for (int i = 0; i < nameCount; ++i) {
+        if (!all && sg_random() < 0.5)
+            continue;
+        SGPropertyNode* material = region->addChild("material");
+        material->addChild("name")->setStringValue(names[i]);
+        if (sg_random() < 0.3)
+            material->addChild("name")->setStringValue(names[(i + 1)%nameCount]);
+    }
+}
+
+// A global region, a few more without areas and regions with random areas
+// in the western hemisphere. The first and some others are only valid in
+// summer.
+void writeMaterials(const SGPath& path)
+{
+    SGPropertyNode_ptr root = new SGPropertyNode;
+    SGPropertyNode* global = root->addChild("region");
+    for (int i = 0; i < nameCount; ++i)
+        global->addChild("material")->addChild("name")->setStringValue(names[i]);
+
+    for (int r = 0; r < 40; ++r) {
+        SGPropertyNode* region = root->addChild("region");
+        int areas = r < 5 ? 0 : 1 + int(3*sg_random());
+        for (int a = 0; a < areas; ++a) {
+            SGPropertyNode* area = region->addChild("area");
+            double lon = 120*sg_random() - 180, lat = 180*sg_random() - 90;
+            // Whole degrees like the real material files, and odd ones
+            if (sg_random() < 0.5) {
+                lon = int(lon);
+                lat = int(lat);
+            }
+            area->setDoubleValue("lon1", lon);
+            area->setDoubleValue("lon2", lon + 60*sg_random());
+            area->setDoubleValue("lat1", lat);
+            area->setDoubleValue("lat2", lat - 30*sg_random());
+        }
+        if (r == 0 || sg_random() < 0.3) {
+            SGPropertyNode* equals = region->addChild("condition")->addChild("equals");
+            equals->setStringValue("property", "/sim/startup/season");
+            equals->setStringValue("value", "summer");
+        }
+        addMaterials(region, r == 0);
+    }
+    writeProperties(path, root);
+}
+
+// The lookup before the index
+SGMaterial* bruteForceFind(SGMaterialLib* matlib, const std::string& name,
+                           SGVec2f center)
+{
+    auto it = matlib->begin();
+    for (; it != matlib->end(); ++it) {
+        if (it->first != name)
+            continue;
+        for (auto m = it->second.rbegin(); m != it->second.rend(); ++m) {
+            if ((*m)->valid(center))
+                return *m;
+        }
+    }
+    return 0;
+}
+
+SGVec2f randomCenter()
+{
+    return SGVec2f(float(360*sg_random() - 180), float(180*sg_random() - 90));
+}
+
+void testLookups(SGMaterialLib* matlib)
+{
+    for (int i = 0; i < 2000; ++i) {
+        SGVec2f center = randomCenter();
+        osg::ref_ptr<SGMaterialCache> cache = matlib->generateMatCache(center);
+        for (int n = 0; n < nameCount; ++n) {
+            SGMaterial* expected = bruteForceFind(matlib, names[n], center);
+            SG_VERIFY(matlib->find(names[n], center) == expected);
+            SG_VERIFY(cache->find(names[n]) == expected);
+        }
+        SG_VERIFY(!matlib->find("Unknown", center));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    sg_srandom(11);
+
+    simgear::Dir dir = simgear::Dir::tempDir("matlib_test");
+    dir.setRemoveOnDestroy();
+    SGPath path = dir.file("materials.xml");
+    writeMaterials(path);
+
+    SGPropertyNode_ptr propRoot = new SGPropertyNode;
+    propRoot->setStringValue("/sim/startup/season", "summer");
+    SGMaterialLibPtr matlib = new SGMaterialLib;
+    SG_VERIFY(matlib->load(dir.path().utf8Str(), path.utf8Str(), propRoot));
+
+    testLookups(matlib);
+    propRoot->setStringValue("/sim/startup/season", "winter");
+    testLookups(matlib);
+
+    // Away from the regions the tiles share one cache, which follows the
+    // conditions
+    SGVec2f east(90, 0);
+    osg::ref_ptr<SGMaterialCache> first = matlib->generateMatCache(east);
+    osg::ref_ptr<SGMaterialCache> second = matlib->generateMatCache(SGVec2f(120.5f, 40));
+    SG_VERIFY(first == second);
+    propRoot->setStringValue("/sim/startup/season", "summer");
+    osg::ref_ptr<SGMaterialCache> summer = matlib->generateMatCache(east);
+    SG_VERIFY(summer != first);
+    for (int n = 0; n < nameCount; ++n)
+        SG_VERIFY(summer->find(names[n]) == bruteForceFind(matlib, names[n], east));
+
+    SGTimeStamp timeStamp = SGTimeStamp::now();
+    for (int i = 0; i < 10000; ++i)
+        matlib->generateMatCache(randomCenter());
+    std::cout << "10000 material caches in " << timeStamp.elapsedMSec()
+              << " ms" << std::endl;
+
+    std::cout << "all tests passed OK" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -27,6 +27,8 @@
 #include <osg/Image>
 #include <osg/Vec4>
 
+#include <simgear/scene/util/SGImageUtils.hxx>
+
 #include <boost/lexical_cast.hpp>
 #include <boost/tuple/tuple_comparison.hpp>
 
@@ -306,6 +308,14 @@ osg::Image* computeMipmap( osg::Image* image, MipMapTuple attrs )
         s = image->s();
         t = image->t();
         r = image->r();
+
+        // 2D images in the common formats go through the row kernels,
+        // MipMapFunction has the values of ImageKernels::Reduction
+        ImageKernels::PixelLayout layout = ImageKernels::GENERIC;
+        if ( r == 1 )
+            layout = ImageUtils::getPixelLayout( image );
+        int functions[4] = { attrs.get<0>(), attrs.get<1>(), attrs.get<2>(), attrs.get<3>() };
+
         for ( int m = 0; m < nb-1; ++m )
         {
             unsigned char *src = data;
@@ -318,6 +328,24 @@ osg::Image* computeMipmap( osg::Image* image, MipMapTuple attrs )
             int nt = t >> 1; if ( nt == 0 ) nt = 1;
             int nr = r >> 1; if ( nr == 0 ) nr = 1;
 
+            if ( layout != ImageKernels::GENERIC )
+            {
+                unsigned int srcRowWidth = osg::Image::computeRowWidthInBytes( s, image->getPixelFormat(), image->getDataType(), image->getPacking() );
+                unsigned int destRowWidth = osg::Image::computeRowWidthInBytes( ns, image->getPixelFormat(), image->getDataType(), image->getPacking() );
+                ImageKernels::forEachBand( nt, 2 * srcRowWidth, [&]( unsigned begin, unsigned end ) {
+                    for ( unsigned j = begin; j < end; ++j )
+                    {
+                        const unsigned char *row0 = src + 2 * j * srcRowWidth;
+                        const unsigned char *row1 = 2 * j + 1 < unsigned( t ) ? row0 + srcRowWidth : 0L;
+                        ImageKernels::mipmapRow( layout, dest + j * destRowWidth, row0, row1, s, functions );
+                    }
+                } );
+                s = ns;
+                t = nt;
+                r = nr;
+                continue;
+            }
+
             for ( int k = 0; k < r; k += 2 )
             {
                 for ( int j = 0; j < t; j += 2 )
@@ -40,6 +40,7 @@
 #include <simgear/bvh/BVHTransform.hxx>
 #include <simgear/bvh/BVHMotionTransform.hxx>
 #include <simgear/bvh/BVHStaticGeometry.hxx>
+#include <simgear/bvh/BVHFlatGeometry.hxx>
 
 #include <simgear/bvh/BVHStaticData.hxx>
 
@@ -127,6 +128,21 @@ public:
         --_currentLevel;
     }
 
+    virtual void apply(BVHFlatGeometry& node)
+    {
+        addNodeSphere(node);
+        for (unsigned i = 0; i < node.getNumNodes(); ++i) {
+            const BVHFlatGeometry::Node& flatNode = node.getNode(i);
+            if (!flatNode.isLeaf())
+                continue;
+            addBox(flatNode.getBoundingBox());
+            unsigned end = flatNode._offset + flatNode._count;
+            for (unsigned j = flatNode._offset; j < end; ++j)
+                addTriangle(node.getTriangle(j).getTriangle(),
+                            osg::Vec4(0.5, 0, 0.5, 0.2));
+        }
+    }
+
     virtual void apply(const BVHStaticBinary& node, const BVHStaticData& data)
     {
         addNodeBox(node, data);
@@ -189,9 +205,16 @@ private:
             return;
         BVHBoundingBoxVisitor bbv;
         node.accept(bbv, data);
+        addBox(bbv.getBox());
+    }
+
+    void addBox(const SGBoxf& box)
+    {
+        if (_level != ~0u && _level != _currentLevel)
+            return;
         osg::Box* shape = new osg::Box;
-        shape->setCenter(toOsg(bbv.getBox().getCenter()));
-        shape->setHalfLengths(toOsg((0.5*bbv.getBox().getSize())));
+        shape->setCenter(toOsg(box.getCenter()));
+        shape->setHalfLengths(toOsg((0.5*box.getSize())));
         addShape(shape, osg::Vec4(0.5f, 0, 0, 0.1f));
     }
     
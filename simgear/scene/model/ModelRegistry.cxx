@@ -496,9 +496,16 @@ ModelRegistry::readImage(const string& fileName,
                                         //processor->generateMipMap(*srcImage, true, osgDB::ImageProcessor::USE_CPU);
                                     }
                                     else {
+                                        // without the osg_nvtt plugin compress the mipmaps ourselves
                                         simgear::effect::MipMapTuple mipmapFunctions(simgear::effect::AVERAGE, simgear::effect::AVERAGE, simgear::effect::AVERAGE, simgear::effect::AVERAGE);
-                                        SG_LOG(SG_IO, SG_INFO, "Texture compression plugin (osg_nvtt) not available; storing uncompressed image: " << absFileName);
                                         srcImage = simgear::effect::computeMipmap(srcImage, mipmapFunctions);
+                                        osg::ref_ptr<osg::Image> compressedImage = ImageUtils::compressImage(srcImage, targetFormat);
+                                        if (compressedImage.valid()) {
+                                            SG_LOG(SG_IO, SG_INFO, "Created " << targetFormat << " on the CPU for " << absFileName);
+                                            srcImage = compressedImage;
+                                        }
+                                        else
+                                            SG_LOG(SG_IO, SG_INFO, "Cannot compress " << absFileName << "; storing uncompressed image");
                                     }
                                     }
                                 else {
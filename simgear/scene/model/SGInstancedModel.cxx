@@ -0,0 +1,352 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include "SGInstancedModel.hxx"
+
+#include <atomic>
+#include <typeinfo>
+
+#include <osg/BoundingBox>
+#include <osg/Drawable>
+#include <osg/Geode>
+#include <osg/Geometry>
+#include <osg/RenderInfo>
+#include <osg/State>
+#include <osg/Version>
+
+#include <simgear/scene/material/EffectGeode.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+namespace simgear
+{
+
+namespace
+{
+std::atomic<unsigned> numModels(0);
+std::atomic<unsigned> numInstances(0);
+std::atomic<unsigned> numDrawables(0);
+std::atomic<std::size_t> numInstanceBytes(0);
+std::atomic<unsigned> numSavedRenderLeaves(0);
+std::atomic<unsigned> numCulls(0);
+std::atomic<unsigned long long> cullTimeUSec(0);
+
+bool hasCallbacks(const osg::Node* node)
+{
+    return node->getUpdateCallback() || node->getCullCallback()
+        || node->getEventCallback() || node->getUserData();
+}
+}
+
+/// The placement matrices shared by all drawables of one model
+class SGInstancedModel::InstanceList : public osg::Referenced
+{
+public:
+    std::vector<osg::Matrix> _matrices;
+};
+
+/**
+ * Draws one drawable of the model once for each placement, just
+ * changing the model view matrix in between.
+ */
+class SGInstancedModel::InstancedDrawable : public osg::Drawable
+{
+public:
+    InstancedDrawable()
+    {
+        setSupportsDisplayList(false);
+    }
+
+    InstancedDrawable(osg::Drawable* drawable, const osg::Matrix& local,
+                      const InstanceList* instances) :
+        _drawable(drawable),
+        _local(local),
+        _instances(instances)
+    {
+        setSupportsDisplayList(false);
+        setStateSet(drawable->getStateSet());
+#if !OSG_VERSION_LESS_THAN(3,3,2)
+        setNodeMask(drawable->getNodeMask());
+#endif
+    }
+
+    InstancedDrawable(const InstancedDrawable& rhs,
+                      const osg::CopyOp& copyop = osg::CopyOp::SHALLOW_COPY) :
+        osg::Drawable(rhs, copyop),
+        _drawable(rhs._drawable),
+        _local(rhs._local),
+        _instances(rhs._instances)
+    {
+    }
+
+    META_Object(simgear, InstancedDrawable);
+
+    virtual void drawImplementation(osg::RenderInfo& renderInfo) const
+    {
+        if (!_drawable.valid() || !_instances.valid())
+            return;
+        osg::State& state = *renderInfo.getState();
+        const osg::Matrix modelView = state.getModelViewMatrix();
+        std::vector<osg::Matrix>::const_iterator i;
+        for (i = _instances->_matrices.begin();
+             i != _instances->_matrices.end(); ++i) {
+            state.applyModelViewMatrix(_local * *i * modelView);
+            _drawable->draw(renderInfo);
+        }
+        state.applyModelViewMatrix(modelView);
+    }
+
+    virtual osg::BoundingBox
+#if OSG_VERSION_LESS_THAN(3,3,2)
+    computeBound()
+#else
+    computeBoundingBox()
+#endif
+    const
+    {
+        osg::BoundingBox bb;
+        if (!_drawable.valid() || !_instances.valid())
+            return bb;
+        const osg::BoundingBox& box =
+#if OSG_VERSION_LESS_THAN(3,3,2)
+            _drawable->getBound();
+#else
+            _drawable->getBoundingBox();
+#endif
+        if (!box.valid())
+            return bb;
+        std::vector<osg::Matrix>::const_iterator i;
+        for (i = _instances->_matrices.begin();
+             i != _instances->_matrices.end(); ++i) {
+            osg::Matrix matrix = _local * *i;
+            for (unsigned j = 0; j < 8; ++j)
+                bb.expandBy(box.corner(j) * matrix);
+        }
+        return bb;
+    }
+
+    virtual void compileGLObjects(osg::RenderInfo& renderInfo) const
+    {
+        _drawable->compileGLObjects(renderInfo);
+    }
+
+    virtual void resizeGLObjectBuffers(unsigned int maxSize)
+    {
+        osg::Drawable::resizeGLObjectBuffers(maxSize);
+        _drawable->resizeGLObjectBuffers(maxSize);
+    }
+
+    virtual void releaseGLObjects(osg::State* state = 0) const
+    {
+        osg::Drawable::releaseGLObjects(state);
+        _drawable->releaseGLObjects(state);
+    }
+
+private:
+    osg::ref_ptr<osg::Drawable> _drawable;
+    osg::Matrix _local;
+    osg::ref_ptr<const InstanceList> _instances;
+};
+
+SGInstancedModel::Statistics::Statistics() :
+    _models(0),
+    _instances(0),
+    _drawables(0),
+    _instanceBytes(0),
+    _savedRenderLeaves(0),
+    _culls(0),
+    _cullTime(0)
+{
+}
+
+SGInstancedModel::SGInstancedModel() :
+    _instances(new InstanceList),
+    _numDrawables(0),
+    _instanceBytes(0)
+{
+    ++numModels;
+}
+
+SGInstancedModel::SGInstancedModel(const SGInstancedModel& rhs,
+                                   const osg::CopyOp& copyop) :
+    osg::Group(rhs, copyop),
+    _instances(rhs._instances),
+    _instanced(rhs._instanced),
+    _numDrawables(rhs._numDrawables),
+    _instanceBytes(rhs._instanceBytes)
+{
+    ++numModels;
+    numInstances += getNumInstances();
+    numDrawables += _numDrawables;
+    numInstanceBytes += _instanceBytes;
+    if (getNumInstances() > 0)
+        numSavedRenderLeaves += _numDrawables * (getNumInstances() - 1);
+}
+
+SGInstancedModel::SGInstancedModel(osg::Node* model,
+                                   const PlacementList& placements) :
+    _instances(new InstanceList),
+    _numDrawables(0),
+    _instanceBytes(0)
+{
+    _instances->_matrices.reserve(placements.size());
+    PlacementList::const_iterator i;
+    for (i = placements.begin(); i != placements.end(); ++i) {
+        _instances->_matrices.push_back((*i)->getMatrix());
+        addChild(i->get());
+    }
+    if (!placements.empty())
+        _instanced = instance(model, osg::Matrix::identity());
+
+    _instanceBytes = _instances->_matrices.capacity() * sizeof(osg::Matrix)
+        + _numDrawables * sizeof(InstancedDrawable);
+    ++numModels;
+    numInstances += getNumInstances();
+    numDrawables += _numDrawables;
+    numInstanceBytes += _instanceBytes;
+    if (!placements.empty())
+        numSavedRenderLeaves += _numDrawables * (getNumInstances() - 1);
+}
+
+SGInstancedModel::~SGInstancedModel()
+{
+    --numModels;
+    numInstances -= getNumInstances();
+    numDrawables -= _numDrawables;
+    numInstanceBytes -= _instanceBytes;
+    if (getNumInstances() > 0)
+        numSavedRenderLeaves -= _numDrawables * (getNumInstances() - 1);
+}
+
+unsigned SGInstancedModel::getNumInstances() const
+{
+    return _instances->_matrices.size();
+}
+
+void SGInstancedModel::traverse(osg::NodeVisitor& nv)
+{
+    if (nv.getVisitorType() != osg::NodeVisitor::CULL_VISITOR
+        || !_instanced.valid()) {
+        osg::Group::traverse(nv);
+        return;
+    }
+    SGTimeStamp start = SGTimeStamp::now();
+    _instanced->accept(nv);
+    cullTimeUSec += start.elapsedUSec();
+    ++numCulls;
+}
+
+// Copies the model down to the geodes, replacing their drawables with
+// instanced ones. Transforms are folded into the local matrix of the
+// drawables below them.
+osg::Node* SGInstancedModel::instance(osg::Node* node,
+                                      const osg::Matrix& local)
+{
+    if (osg::Geode* geode = node->asGeode()) {
+        osg::ref_ptr<osg::Geode> copy;
+        if (EffectGeode* effectGeode = dynamic_cast<EffectGeode*>(geode))
+            copy = new EffectGeode(*effectGeode);
+        else
+            copy = new osg::Geode(*geode);
+        copy->removeDrawables(0, copy->getNumDrawables());
+        for (unsigned i = 0; i < geode->getNumDrawables(); ++i) {
+            copy->addDrawable(new InstancedDrawable(geode->getDrawable(i),
+                                                    local,
+                                                    _instances.get()));
+            ++_numDrawables;
+        }
+        return copy.release();
+    }
+
+    osg::Group* group = node->asGroup();
+    if (!group)
+        return 0;
+    osg::Matrix childLocal = local;
+    if (osg::MatrixTransform* transform = dynamic_cast<osg::MatrixTransform*>(group))
+        childLocal = transform->getMatrix() * local;
+
+    osg::ref_ptr<osg::Group> copy = new osg::Group;
+    copy->setName(group->getName());
+    copy->setNodeMask(group->getNodeMask());
+    copy->setStateSet(group->getStateSet());
+    copy->setDataVariance(osg::Object::STATIC);
+    for (unsigned i = 0; i < group->getNumChildren(); ++i) {
+        if (osg::Node* child = instance(group->getChild(i), childLocal))
+            copy->addChild(child);
+    }
+    return copy.release();
+}
+
+bool SGInstancedModel::isInstanceable(const osg::Node* model)
+{
+    if (!model || hasCallbacks(model))
+        return false;
+
+    if (const osg::Geode* geode = model->asGeode()) {
+        if (typeid(*geode) != typeid(osg::Geode)
+            && typeid(*geode) != typeid(EffectGeode))
+            return false;
+        for (unsigned i = 0; i < geode->getNumDrawables(); ++i) {
+            const osg::Drawable* drawable = geode->getDrawable(i);
+            if (!drawable || !drawable->asGeometry())
+                return false;
+            if (drawable->getUpdateCallback() || drawable->getCullCallback()
+                || drawable->getDrawCallback() || drawable->getUserData())
+                return false;
+        }
+        return true;
+    }
+
+    const osg::Group* group = model->asGroup();
+    if (!group)
+        return false;
+    if (typeid(*group) == typeid(osg::MatrixTransform)) {
+        const osg::Transform* transform = group->asTransform();
+        if (transform->getReferenceFrame() != osg::Transform::RELATIVE_RF)
+            return false;
+    } else if (typeid(*group) != typeid(osg::Group)) {
+        return false;
+    }
+    for (unsigned i = 0; i < group->getNumChildren(); ++i) {
+        if (!isInstanceable(group->getChild(i)))
+            return false;
+    }
+    return true;
+}
+
+SGInstancedModel::Statistics SGInstancedModel::getStatistics()
+{
+    Statistics stats;
+    stats._models = numModels;
+    stats._instances = numInstances;
+    stats._drawables = numDrawables;
+    stats._instanceBytes = numInstanceBytes;
+    stats._savedRenderLeaves = numSavedRenderLeaves;
+    stats._culls = numCulls;
+    stats._cullTime = cullTimeUSec * 1e-6;
+    return stats;
+}
+
+void SGInstancedModel::resetStatistics()
+{
+    numCulls = 0;
+    cullTimeUSec = 0;
+}
+
+}
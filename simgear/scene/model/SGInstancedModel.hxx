@@ -0,0 +1,107 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA
+
+#ifndef SIMGEAR_SGINSTANCEDMODEL_HXX
+#define SIMGEAR_SGINSTANCEDMODEL_HXX 1
+
+#include <vector>
+
+#include <osg/Group>
+#include <osg/Matrix>
+#include <osg/MatrixTransform>
+#include <osg/ref_ptr>
+
+namespace simgear
+{
+
+/**
+ * Many placements of one shared, non animated model.
+ *
+ * The children are the placement transforms as they were created, so
+ * intersection, bounding volume and other visitors see the usual scene
+ * graph. Culling instead walks a single copy of the model whose
+ * drawables draw the geometry once for each placement, with the
+ * placement matrices kept in one buffer shared by all drawables. The
+ * cull traversal thus touches one subtree and creates one render leaf
+ * per drawable instead of one per drawable and placement.
+ */
+class SGInstancedModel : public osg::Group
+{
+public:
+    struct Statistics {
+        Statistics();
+
+        /// Instanced models alive and the placements they draw
+        unsigned _models;
+        unsigned _instances;
+        /// Instanced drawables, one per drawable of each model
+        unsigned _drawables;
+        /// Bytes of the instance buffers and the instanced drawables
+        std::size_t _instanceBytes;
+        /// Render leaves per frame saved if all models are in view
+        unsigned _savedRenderLeaves;
+        /// Cull traversals of instanced models since the last reset, and
+        /// the time in seconds spent in them
+        unsigned _culls;
+        double _cullTime;
+    };
+
+    typedef std::vector<osg::ref_ptr<osg::MatrixTransform> > PlacementList;
+
+    SGInstancedModel();
+    SGInstancedModel(const SGInstancedModel& rhs,
+                     const osg::CopyOp& copyop = osg::CopyOp::SHALLOW_COPY);
+    /**
+     * Instances model once for each placement. The placements must each
+     * have model as their only child.
+     */
+    SGInstancedModel(osg::Node* model, const PlacementList& placements);
+
+    META_Node(simgear, SGInstancedModel);
+
+    virtual void traverse(osg::NodeVisitor& nv);
+
+    unsigned getNumInstances() const;
+
+    /**
+     * Whether model can be drawn through an SGInstancedModel: only
+     * plain groups, relative matrix transforms and geodes holding
+     * geometry, without any callbacks that could make the model
+     * different between placements or frames.
+     */
+    static bool isInstanceable(const osg::Node* model);
+
+    static Statistics getStatistics();
+    static void resetStatistics();
+
+protected:
+    virtual ~SGInstancedModel();
+
+private:
+    class InstancedDrawable;
+    class InstanceList;
+
+    osg::Node* instance(osg::Node* node, const osg::Matrix& local);
+
+    osg::ref_ptr<InstanceList> _instances;
+    osg::ref_ptr<osg::Node> _instanced;
+    unsigned _numDrawables;
+    std::size_t _instanceBytes;
+};
+
+}
+
+#endif
@@ -568,6 +568,9 @@ sgLoad3DModel_internal(const SGPath& path,
     if (!needTransform && group->getNumChildren() < 2) {
         model = group->getChild(0);
         group->removeChild(model.get());
+        // Keep the animation updates installed on the group
+        if (group->getUpdateCallback())
+            model->addUpdateCallback(group->getUpdateCallback());
         if (data.valid())
             data->modelLoaded(modelpath.utf8Str(), props, model.get());
         return std::make_tuple(animationcount, model.release());
@@ -19,11 +19,13 @@
 
 #include <osg/AlphaFunc>
 #include <osg/Drawable>
+#include <osg/FrameStamp>
 #include <osg/Geode>
 #include <osg/Geometry>
 #include <osg/LOD>
 #include <osg/Math>
 #include <osg/Object>
+#include <osg/observer_ptr>
 #include <osg/StateSet>
 #include <osg/Switch>
 #include <osg/TexMat>
@@ -42,8 +44,10 @@
 #include <simgear/math/interpolater.hxx>
 #include <simgear/props/condition.hxx>
 #include <simgear/props/props.hxx>
+#include <simgear/props/PropertyChangeTracker.hxx>
 #include <simgear/scene/material/EffectGeode.hxx>
 #include <simgear/scene/material/EffectCullVisitor.hxx>
+#include <simgear/scene/tgdb/userdata.hxx>
 #include <simgear/scene/util/DeletionManager.hxx>
 #include <simgear/scene/util/OsgMath.hxx>
 #include <simgear/scene/util/SGNodeMasks.hxx>
@@ -226,6 +230,8 @@ public:
   }
 
   virtual bool isConst() const { return false; }
+  // shuffled on every evaluation
+  virtual bool hasExternalDependencies() const { return true; }
 
 private:
   mutable SGPersonalityParameter<double> _scale;
@@ -428,7 +434,8 @@ SGAnimation::SGAnimation(simgear::SGTransientModelData &modelData) :
   osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ALL_CHILDREN),
   _found(false),
   _configNode(modelData.getConfigNode()),
-  _modelRoot(modelData.getModelRoot())
+  _modelRoot(modelData.getModelRoot()),
+  _modelNode(modelData.getNode())
 {
   _name = modelData.getConfigNode()->getStringValue("name", "");
   _enableHOT = modelData.getConfigNode()->getBoolValue("enable-hot", true);
@@ -893,6 +900,160 @@ SGAnimation::getCondition() const
   return sgReadCondition(_modelRoot, conditionNode);
 }
 
+////////////////////////////////////////////////////////////////////////
+// Dirty tracked animation updates
+////////////////////////////////////////////////////////////////////////
+
+// The update of one animation node. It is dirty when one of the
+// properties it reads changed since it last ran.
+class SGAnimation::Update : public simgear::PropertyChangeTracker,
+                            public SGReferenced {
+public:
+  Update() : _batch(0)
+  { }
+  virtual void update() = 0;
+protected:
+  virtual void dirtied();
+private:
+  friend class SGAnimation::UpdateBatch;
+  UpdateBatch* _batch;
+};
+
+namespace
+{
+// Counts the animation updates of all models and publishes the share
+// that was skipped because nothing changed, once per frame.
+class UpdateStatistics {
+public:
+  UpdateStatistics() :
+    _frameNumber(~0u), _updated(0), _total(0)
+  { }
+  void count(const osg::FrameStamp* frameStamp, std::size_t updated,
+             std::size_t total)
+  {
+    if (!frameStamp)
+      return;
+    unsigned frameNumber = frameStamp->getFrameNumber();
+    if (frameNumber != _frameNumber) {
+      publish();
+      _frameNumber = frameNumber;
+      _updated = 0;
+      _total = 0;
+    }
+    _updated += updated;
+    _total += total;
+  }
+private:
+  void publish()
+  {
+    if (!_node) {
+      SGPropertyNode* root = simgear::getPropertyRoot();
+      if (!root)
+        return;
+      _node = root->getNode("sim/rendering/animation-updates", true);
+    }
+    _node->setIntValue("total", int(_total));
+    _node->setIntValue("updated", int(_updated));
+    _node->setDoubleValue("skipped-ratio",
+                          _total ? 1 - double(_updated)/_total : 0);
+  }
+  unsigned _frameNumber;
+  std::size_t _updated;
+  std::size_t _total;
+  SGPropertyNode_ptr _node;
+};
+
+UpdateStatistics updateStatistics;
+}
+
+// Runs the dirty animation updates of a model from one update callback
+// on the model node. Clean animations cost nothing per frame, and their
+// nodes do not need an update traversal.
+class SGAnimation::UpdateBatch : public osg::NodeCallback {
+public:
+  UpdateBatch() : _frames(0)
+  {
+    setName("SGAnimation::UpdateBatch");
+  }
+  ~UpdateBatch()
+  {
+    for (std::size_t i = 0; i < _updates.size(); ++i)
+      _updates[i]->_batch = 0;
+  }
+  void add(Update* update)
+  {
+    update->_batch = this;
+    _updates.push_back(update);
+    if (update->isVolatile())
+      _volatile.push_back(update);
+    else
+      _pending.push_back(update);
+  }
+  void schedule(Update* update)
+  {
+    if (!update->isVolatile())
+      _pending.push_back(update);
+  }
+  virtual void operator()(osg::Node* node, osg::NodeVisitor* nv)
+  {
+    // Properties tied after the model was loaded do not fire listeners
+    if (_frames++ % CheckTiedFrames == 0)
+      checkTied();
+    std::size_t updated = _volatile.size() + _pending.size();
+    for (std::size_t i = 0; i < _volatile.size(); ++i) {
+      _volatile[i]->clearDirty();
+      _volatile[i]->update();
+    }
+    _running.swap(_pending);
+    for (std::size_t i = 0; i < _running.size(); ++i) {
+      _running[i]->clearDirty();
+      _running[i]->update();
+    }
+    _running.clear();
+    updateStatistics.count(nv->getFrameStamp(), updated, _updates.size());
+    traverse(node, nv);
+  }
+private:
+  enum { CheckTiedFrames = 64 };
+  void checkTied()
+  {
+    for (std::size_t i = 0; i < _updates.size(); ++i) {
+      if (!_updates[i]->isVolatile() && _updates[i]->checkTied())
+        _volatile.push_back(_updates[i]);
+    }
+  }
+  std::vector<SGSharedPtr<Update> > _updates;
+  std::vector<Update*> _volatile;
+  std::vector<Update*> _pending;
+  std::vector<Update*> _running;
+  unsigned _frames;
+};
+
+void
+SGAnimation::Update::dirtied()
+{
+  if (_batch)
+    _batch->schedule(this);
+}
+
+void
+SGAnimation::addUpdate(osg::Node& node, Update* update)
+{
+  osg::Node* batchNode = _modelNode ? _modelNode : &node;
+  UpdateBatch* batch = 0;
+  for (auto callback = batchNode->getUpdateCallback(); callback && !batch;
+       callback = callback->getNestedCallback())
+    batch = dynamic_cast<UpdateBatch*>(callback);
+  if (!batch) {
+    batch = new UpdateBatch;
+    batchNode->addUpdateCallback(batch);
+  }
+  // Personality values are shuffled on every evaluation
+  if (_configNode->getBoolValue("use-personality", false))
+    update->setVolatile(true);
+  batch->add(update);
+}
+
 
 
 ////////////////////////////////////////////////////////////////////////
@@ -920,25 +1081,28 @@ SGGroupAnimation::createAnimationGroup(osg::Group& parent)
 // Implementation of translate animation
 ////////////////////////////////////////////////////////////////////////
 
-class SGTranslateAnimation::UpdateCallback : public osg::NodeCallback {
+class SGTranslateAnimation::UpdateCallback : public SGAnimation::Update {
 public:
-  UpdateCallback(SGCondition const* condition,
+  UpdateCallback(SGTranslateTransform* transform,
+                 SGCondition const* condition,
                  SGExpressiond const* animationValue) :
+    _transform(transform),
     _condition(condition),
     _animationValue(animationValue)
   {
-      setName("SGTranslateAnimation::UpdateCallback");
+    addDependencies(condition);
+    addDependencies(animationValue);
   }
-  virtual void operator()(osg::Node* node, osg::NodeVisitor* nv)
+  virtual void update()
   {
-    if (!_condition || _condition->test()) {
-      SGTranslateTransform* transform;
-      transform = static_cast<SGTranslateTransform*>(node);
+    osg::ref_ptr<SGTranslateTransform> transform;
+    if (!_transform.lock(transform))
+      return;
+    if (!_condition || _condition->test())
       transform->setValue(_animationValue->getValue());
-    }
-    traverse(node, nv);
   }
 public:
+  osg::observer_ptr<SGTranslateTransform> _transform;
   SGSharedPtr<SGCondition const> _condition;
   SGSharedPtr<SGExpressiond const> _animationValue;
 };
@@ -966,10 +1130,9 @@ SGTranslateAnimation::createAnimationGroup(osg::Group& parent)
 {
   SGTranslateTransform* transform = new SGTranslateTransform;
   transform->setName("translate animation");
-  if (_animationValue && !_animationValue->isConst()) {
-    UpdateCallback* uc = new UpdateCallback(_condition, _animationValue);
-    transform->setUpdateCallback(uc);
-  }
+  if (_animationValue && !_animationValue->isConst())
+    addUpdate(*transform, new UpdateCallback(transform, _condition,
+                                             _animationValue));
   transform->setAxis(_axis);
   transform->setValue(_initialValue);
   parent.addChild(transform);
@@ -981,84 +1144,34 @@ SGTranslateAnimation::createAnimationGroup(osg::Group& parent)
 // Implementation of rotate/spin animation
 ////////////////////////////////////////////////////////////////////////
 
-class SGRotAnimTransform : public SGRotateTransform
-{
+class SGRotateAnimation::UpdateCallback : public SGAnimation::Update {
 public:
-    SGRotAnimTransform();
-    SGRotAnimTransform(const SGRotAnimTransform&,
-                       const osg::CopyOp& copyop = osg::CopyOp::SHALLOW_COPY);
-    META_Node(simgear, SGRotAnimTransform);
-    virtual bool computeLocalToWorldMatrix(osg::Matrix& matrix,
-                                           osg::NodeVisitor* nv) const;
-    virtual bool computeWorldToLocalMatrix(osg::Matrix& matrix,
-                                           osg::NodeVisitor* nv) const;
-    SGSharedPtr<SGCondition const> _condition;
-    SGSharedPtr<SGExpressiond const> _animationValue;
-    // used when condition is false
-    mutable double _lastAngle;
+  UpdateCallback(SGRotateTransform* transform,
+                 SGCondition const* condition,
+                 SGExpressiond const* animationValue) :
+    _transform(transform),
+    _condition(condition),
+    _animationValue(animationValue)
+  {
+    addDependencies(condition);
+    addDependencies(animationValue);
+  }
+  virtual void update()
+  {
+    osg::ref_ptr<SGRotateTransform> transform;
+    if (!_transform.lock(transform))
+      return;
+    // keeps the last angle when the condition is false
+    if (!_condition || _condition->test())
+      transform->setAngleDeg(_animationValue->getValue());
+  }
+private:
+  osg::observer_ptr<SGRotateTransform> _transform;
+  SGSharedPtr<SGCondition const> _condition;
+  SGSharedPtr<SGExpressiond const> _animationValue;
 };
 
-SGRotAnimTransform::SGRotAnimTransform()
-    : _lastAngle(0.0)
-{
-}
-
-SGRotAnimTransform::SGRotAnimTransform(const SGRotAnimTransform& rhs,
-                                       const osg::CopyOp& copyop)
-    : SGRotateTransform(rhs, copyop), _condition(rhs._condition),
-      _animationValue(rhs._animationValue), _lastAngle(rhs._lastAngle)
-{
-}
-
-bool SGRotAnimTransform::computeLocalToWorldMatrix(osg::Matrix& matrix,
-                                                   osg::NodeVisitor* nv) const
-{
-    double angle = 0.0;
-    if (!_condition || _condition->test()) {
-        angle = _animationValue->getValue();
-        _lastAngle = angle;
-    } else {
-        angle = _lastAngle;
-    }
-    double angleRad = SGMiscd::deg2rad(angle);
-    if (_referenceFrame == RELATIVE_RF) {
-        // FIXME optimize
-        osg::Matrix tmp;
-        set_rotation(tmp, angleRad, getCenter(), getAxis());
-        matrix.preMult(tmp);
-    } else {
-        osg::Matrix tmp;
-        SGRotateTransform::set_rotation(tmp, angleRad, getCenter(), getAxis());
-        matrix = tmp;
-    }
-    return true;
-}
-
-bool SGRotAnimTransform::computeWorldToLocalMatrix(osg::Matrix& matrix,
-                                                   osg::NodeVisitor* nv) const
-{
-    double angle = 0.0;
-    if (!_condition || _condition->test()) {
-        angle = _animationValue->getValue();
-        _lastAngle = angle;
-    } else {
-        angle = _lastAngle;
-    }
-    double angleRad = SGMiscd::deg2rad(angle);
-    if (_referenceFrame == RELATIVE_RF) {
-        // FIXME optimize
-        osg::Matrix tmp;
-        set_rotation(tmp, -angleRad, getCenter(), getAxis());
-        matrix.postMult(tmp);
-    } else {
-        osg::Matrix tmp;
-        set_rotation(tmp, -angleRad, getCenter(), getAxis());
-        matrix = tmp;
-    }
-    return true;
-}
-
-// Cull callback
+// Cull callback for spin animations
 class SpinAnimCallback : public osg::NodeCallback {
 public:
     SpinAnimCallback(SGCondition const* condition,
@@ -1205,13 +1318,14 @@ SGRotateAnimation::createAnimationGroup(osg::Group& parent)
         parent.addChild(transform);
         return transform;
     } else {
-        SGRotAnimTransform* transform = new SGRotAnimTransform;
+        SGRotateTransform* transform = new SGRotateTransform;
         transform->setName("rotate animation");
-        transform->_condition = _condition;
-        transform->_animationValue = _animationValue;
-        transform->_lastAngle = _initialValue;
         transform->setCenter(_center);
         transform->setAxis(_axis);
+        transform->setAngleDeg(_initialValue);
+        if (_animationValue && !_animationValue->isConst())
+            addUpdate(*transform, new UpdateCallback(transform, _condition,
+                                                     _animationValue));
         parent.addChild(transform);
         return transform;
     }
@@ -1222,30 +1336,34 @@ SGRotateAnimation::createAnimationGroup(osg::Group& parent)
 // Implementation of scale animation
 ////////////////////////////////////////////////////////////////////////
 
-class SGScaleAnimation::UpdateCallback : public osg::NodeCallback {
+class SGScaleAnimation::UpdateCallback : public SGAnimation::Update {
 public:
-  UpdateCallback(const SGCondition* condition,
+  UpdateCallback(SGScaleTransform* transform,
+                 const SGCondition* condition,
                  SGSharedPtr<const SGExpressiond> animationValue[3]) :
+    _transform(transform),
     _condition(condition)
   {
-    _animationValue[0] = animationValue[0];
-    _animationValue[1] = animationValue[1];
-    _animationValue[2] = animationValue[2];
-    setName("SGScaleAnimation::UpdateCallback");
+    addDependencies(condition);
+    for (int i = 0; i < 3; ++i) {
+      _animationValue[i] = animationValue[i];
+      addDependencies(animationValue[i].get());
+    }
   }
-  virtual void operator()(osg::Node* node, osg::NodeVisitor* nv)
+  virtual void update()
   {
+    osg::ref_ptr<SGScaleTransform> transform;
+    if (!_transform.lock(transform))
+      return;
     if (!_condition || _condition->test()) {
-      SGScaleTransform* transform;
-      transform = static_cast<SGScaleTransform*>(node);
       SGVec3d scale(_animationValue[0]->getValue(),
                     _animationValue[1]->getValue(),
                     _animationValue[2]->getValue());
       transform->setScaleFactor(scale);
     }
-    traverse(node, nv);
   }
 public:
+  osg::observer_ptr<SGScaleTransform> _transform;
   SGSharedPtr<SGCondition const> _condition;
   SGSharedPtr<SGExpressiond const> _animationValue[3];
 };
@@ -1344,8 +1462,8 @@ SGScaleAnimation::createAnimationGroup(osg::Group& parent)
   transform->setName("scale animation");
   transform->setCenter(_center);
   transform->setScaleFactor(_initialValue);
-  UpdateCallback* uc = new UpdateCallback(_condition, _animationValue);
-  transform->setUpdateCallback(uc);
+  addUpdate(*transform, new UpdateCallback(transform, _condition,
+                                           _animationValue));
   parent.addChild(transform);
   return transform;
 }
@@ -1739,23 +1857,29 @@ namespace
 // Implementation of a range animation
 ////////////////////////////////////////////////////////////////////////
 
-class SGRangeAnimation::UpdateCallback : public osg::NodeCallback {
+class SGRangeAnimation::UpdateCallback : public SGAnimation::Update {
 public:
-  UpdateCallback(const SGCondition* condition,
+  UpdateCallback(osg::LOD* lod,
+                 const SGCondition* condition,
                  const SGExpressiond* minAnimationValue,
                  const SGExpressiond* maxAnimationValue,
                  double minValue, double maxValue) :
+    _lod(lod),
     _condition(condition),
     _minAnimationValue(minAnimationValue),
     _maxAnimationValue(maxAnimationValue),
     _minStaticValue(minValue),
     _maxStaticValue(maxValue)
   {
-      setName("SGRangeAnimation::UpdateCallback");
+    addDependencies(condition);
+    addDependencies(minAnimationValue);
+    addDependencies(maxAnimationValue);
   }
-  virtual void operator()(osg::Node* node, osg::NodeVisitor* nv)
+  virtual void update()
   {
-    osg::LOD* lod = static_cast<osg::LOD*>(node);
+    osg::ref_ptr<osg::LOD> lod;
+    if (!_lod.lock(lod))
+      return;
     if (!_condition || _condition->test()) {
       double minRange;
       if (_minAnimationValue)
@@ -1771,10 +1895,10 @@ public:
     } else {
       lod->setRange(0, 0, SGLimitsf::max());
     }
-    traverse(node, nv);
   }
 
 private:
+  osg::observer_ptr<osg::LOD> _lod;
   SGSharedPtr<const SGCondition> _condition;
   SGSharedPtr<const SGExpressiond> _minAnimationValue;
   SGSharedPtr<const SGExpressiond> _maxAnimationValue;
@@ -1831,9 +1955,10 @@ SGRangeAnimation::createAnimationGroup(osg::Group& parent)
   lod->setRangeMode(osg::LOD::DISTANCE_FROM_EYE_POINT);
   if (_minAnimationValue || _maxAnimationValue || _condition) {
     UpdateCallback* uc;
-    uc = new UpdateCallback(_condition, _minAnimationValue, _maxAnimationValue,
-                            _initialValue[0], _initialValue[1]);
-    lod->setUpdateCallback(uc);
+    uc = new UpdateCallback(lod, _condition, _minAnimationValue,
+                            _maxAnimationValue, _initialValue[0],
+                            _initialValue[1]);
+    addUpdate(*lod, uc);
   }
   return group;
 }
@@ -2318,22 +2443,24 @@ protected:
 };
 
 class SGTexTransformAnimation::UpdateCallback :
-  public osg::StateAttribute::Callback {
+  public SGAnimation::Update {
 public:
-  UpdateCallback(const SGCondition* condition) :
+  UpdateCallback(osg::TexMat* texMat, const SGCondition* condition) :
+    _texMat(texMat),
     _condition(condition)
   {
-      setName("SGTexTransformAnimation::UpdateCallback");
+    addDependencies(condition);
   }
-  virtual void operator () (osg::StateAttribute* sa, osg::NodeVisitor*)
+  virtual void update()
   {
+    osg::ref_ptr<osg::TexMat> texMat;
+    if (!_texMat.lock(texMat))
+      return;
     if (!_condition || _condition->test()) {
       TransformList::const_iterator i;
       for (i = _transforms.begin(); i != _transforms.end(); ++i)
         i->transform->setValue(i->value->getValue());
     }
-    assert(dynamic_cast<osg::TexMat*>(sa));
-    osg::TexMat* texMat = static_cast<osg::TexMat*>(sa);
     texMat->getMatrix().makeIdentity();
     TransformList::const_iterator i;
     for (i = _transforms.begin(); i != _transforms.end(); ++i)
@@ -2344,6 +2471,7 @@ public:
     Entry entry = { transform, value };
     transform->transform(_matrix);
     _transforms.push_back(entry);
+    addDependencies(value);
   }
 
 private:
@@ -2353,6 +2481,7 @@ private:
   };
   typedef std::vector<Entry> TransformList;
   TransformList _transforms;
+  osg::observer_ptr<osg::TexMat> _texMat;
   SGSharedPtr<const SGCondition> _condition;
   osg::Matrix _matrix;
 };
@@ -2370,7 +2499,7 @@ SGTexTransformAnimation::createAnimationGroup(osg::Group& parent)
   osg::StateSet* stateSet = group->getOrCreateStateSet();
   stateSet->setDataVariance(osg::Object::STATIC/*osg::Object::DYNAMIC*/);  
   osg::TexMat* texMat = new osg::TexMat;
-  UpdateCallback* updateCallback = new UpdateCallback(getCondition());
+  UpdateCallback* updateCallback = new UpdateCallback(texMat, getCondition());
   // interpret the configs ...
   std::string type = getType();
 
@@ -2399,7 +2528,7 @@ SGTexTransformAnimation::createAnimationGroup(osg::Group& parent)
     SG_LOG(SG_INPUT, SG_ALERT, "Ignoring unknown texture transform type");
   }
 
-  texMat->setUpdateCallback(updateCallback);
+  addUpdate(*group, updateCallback);
   stateSet->setTextureAttribute(0, texMat);
   parent.addChild(group);
   return group;
@@ -100,8 +100,19 @@ protected:
 
   const SGCondition* getCondition() const;
 
+  class Update;
+  /**
+   * Hand the update of an animation node to the update batch of the
+   * model, which only runs it when the properties it depends on changed.
+   * Updates depending on tied properties or personality values run every
+   * frame. Without a model node the batch goes on the animation node.
+   */
+  void addUpdate(osg::Node& node, Update* update);
+
   std::list<std::string> _objectNames;
 private:
+  class UpdateBatch;
+
   void installInGroup(const std::string& name, osg::Group& group,
                       osg::ref_ptr<osg::Group>& animationGroup);
 
@@ -116,6 +127,7 @@ private:
   std::string _name;
   SGSharedPtr<SGPropertyNode const> _configNode;
   SGPropertyNode* _modelRoot;
+  osg::Node* _modelNode;
   
   std::list<osg::ref_ptr<osg::Node> > _installedAnimations;
   bool _enableHOT;
@@ -159,6 +171,7 @@ public:
   SGRotateAnimation(simgear::SGTransientModelData &modelData);
   virtual osg::Group* createAnimationGroup(osg::Group& parent);
 private:
+  class UpdateCallback;
   SGSharedPtr<const SGCondition> _condition;
   SGSharedPtr<const SGExpressiond> _animationValue;
   SGVec3d _axis;
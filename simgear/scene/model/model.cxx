@@ -372,9 +372,8 @@ ref_ptr<Node> instantiateMaterialEffects(osg::Node* modelGroup,
 
     if (options->getMaterialLib()) {
       const SGGeod loc = SGGeod(options->getLocation());
-      SGMaterialCache* matcache = options->getMaterialLib()->generateMatCache(loc);
+      osg::ref_ptr<SGMaterialCache> matcache = options->getMaterialLib()->generateMatCache(loc);
       SGMaterial* mat = matcache->find(options->getMaterialName());
-      delete matcache;
 
       if (mat) {
         effect = new SGPropertyNode();
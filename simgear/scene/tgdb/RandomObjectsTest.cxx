@@ -0,0 +1,384 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <simgear/misc/test_macros.hxx>
+#include <simgear/scene/util/SGImageKernels.hxx>
+
+#include "SGRandomObjects.hxx"
+
+using namespace simgear;
+
+namespace
+{
+const unsigned GridSize = 120;
+const unsigned MaskWidth = 37;
+const unsigned MaskHeight = 29;
+// Padded rows, like an image with 4 byte row alignment would have
+const unsigned MaskRowBytes = 3*MaskWidth + 1;
+
+std::vector<SGRandomTriangle> makeTriangles()
+{
+    std::vector<SGRandomTriangle> triangles;
+    for (unsigned y = 0; y < GridSize; ++y) {
+        for (unsigned x = 0; x < GridSize; ++x) {
+            SGVec3f corners[4];
+            SGVec2f texCoords[4];
+            for (unsigned i = 0; i < 4; ++i) {
+                float px = 25.0f*(x + (i & 1));
+                float py = 25.0f*(y + (i >> 1));
+                // Hills steep enough to thin out the trees
+                float pz = 40.0f*std::sin(px*0.01f)*std::cos(py*0.013f);
+                corners[i] = SGVec3f(px, py, pz);
+                texCoords[i] = SGVec2f(px*0.003f, py*0.002f);
+            }
+            static const unsigned indices[2][3] = { { 0, 1, 2 }, { 1, 3, 2 } };
+            for (unsigned t = 0; t < 2; ++t) {
+                SGRandomTriangle triangle;
+                for (unsigned j = 0; j < 3; ++j) {
+                    triangle._vertices[j] = corners[indices[t][j]];
+                    triangle._texCoords[j] = texCoords[indices[t][j]];
+                }
+                triangles.push_back(triangle);
+            }
+        }
+    }
+    // A degenerate triangle produces nothing
+    triangles.push_back(triangles.front());
+    triangles.back()._vertices[2] = triangles.back()._vertices[1];
+    return triangles;
+}
+
+std::vector<unsigned char> makeMask()
+{
+    std::vector<unsigned char> data(MaskRowBytes*MaskHeight, 0xee);
+    for (unsigned y = 0; y < MaskHeight; ++y) {
+        for (unsigned x = 0; x < MaskWidth; ++x) {
+            unsigned char* pixel = &data[y*MaskRowBytes + 3*x];
+            pixel[0] = (x*7 + y*13) & 0xff;
+            pixel[1] = (x*x + y*3) & 0xff;
+            pixel[2] = (255 - x*5 - y) & 0xff;
+        }
+    }
+    return data;
+}
+
+// The mask lookup as the loops used to do it, with osg::Image::getColor
+float referenceSample(const std::vector<unsigned char>& data, unsigned channel,
+                      const SGVec2f& texCoord)
+{
+    unsigned int x = (int) (MaskWidth * texCoord.x()) % MaskWidth;
+    unsigned int y = (int) (MaskHeight * texCoord.y()) % MaskHeight;
+    return data[y*MaskRowBytes + 3*x + channel]*(1.0f/255.0f);
+}
+
+void referenceBarycentric(SGTriangleRandom& random, float& a, float& b, float& c)
+{
+    a = random();
+    b = random();
+    if ( a + b > 1 ) {
+        a = 1 - a;
+        b = 1 - b;
+    }
+    c = 1 - a - b;
+}
+
+// The serial loops of SGTexturedTriangleBin, one random sequence per
+// triangle
+void referenceSurfacePoints(const std::vector<SGRandomTriangle>& triangles,
+                            float coverage, float offset,
+                            const std::vector<unsigned char>* mask,
+                            std::vector<SGVec3f>& points)
+{
+    for (unsigned i = 0; i < triangles.size(); ++i) {
+        const SGRandomTriangle& tri = triangles[i];
+        SGVec3f v0 = tri._vertices[0], v1 = tri._vertices[1], v2 = tri._vertices[2];
+        SGVec3f normal = cross(v1 - v0, v2 - v0);
+        float area = 0.5f*length(normal);
+        if (area <= SGLimitsf::min())
+            continue;
+        SGTriangleRandom random(123, SGRandomObjectGenerator::SurfaceStream, i);
+        float unit = area + random()*coverage;
+        SGVec3f offsetVector = offset*normalize(normal);
+        while ( coverage < unit ) {
+            float a, b, c;
+            referenceBarycentric(random, a, b, c);
+            SGVec3f randomPoint = offsetVector + a*v0 + b*v1 + c*v2;
+            if (mask) {
+                SGVec2f texCoord = a*tri._texCoords[0] + b*tri._texCoords[1] + c*tri._texCoords[2];
+                if (random() < referenceSample(*mask, 0, texCoord))
+                    points.push_back(randomPoint);
+            } else {
+                points.push_back(randomPoint);
+            }
+            unit -= coverage;
+        }
+    }
+}
+
+void referenceTreePoints(const std::vector<SGRandomTriangle>& triangles,
+                         float wood_coverage,
+                         const std::vector<unsigned char>* mask,
+                         float vegetation_density,
+                         float cos_max_density_angle,
+                         float cos_zero_density_angle,
+                         std::vector<SGVec3f>& points,
+                         std::vector<SGVec3f>& normals)
+{
+    for (unsigned i = 0; i < triangles.size(); ++i) {
+        const SGRandomTriangle& tri = triangles[i];
+        SGVec3f v0 = tri._vertices[0], v1 = tri._vertices[1], v2 = tri._vertices[2];
+        SGVec3f normal = cross(v1 - v0, v2 - v0);
+        float alpha = normalize(normal).z();
+        float slope_density = 1.0;
+        if (alpha < cos_zero_density_angle)
+            continue;
+        if (alpha < cos_max_density_angle) {
+            slope_density =
+              (alpha - cos_zero_density_angle) / (cos_max_density_angle - cos_zero_density_angle);
+        }
+        float area = 0.5f*length(normal);
+        if (area <= SGLimitsf::min())
+            continue;
+        SGTriangleRandom random(123, SGRandomObjectGenerator::TreeStream, i);
+        int woodcount = (int) (vegetation_density * vegetation_density *
+                               slope_density *
+                               area / wood_coverage + random());
+        for (int j = 0; j < woodcount; j++) {
+            float a, b, c;
+            referenceBarycentric(random, a, b, c);
+            SGVec3f randomPoint = a*v0 + b*v1 + c*v2;
+            if (mask) {
+                SGVec2f texCoord = a*tri._texCoords[0] + b*tri._texCoords[1] + c*tri._texCoords[2];
+                if (random() < referenceSample(*mask, 1, texCoord)) {
+                    points.push_back(randomPoint);
+                    normals.push_back(normalize(normal));
+                }
+            } else {
+                points.push_back(randomPoint);
+                normals.push_back(normalize(normal));
+            }
+        }
+    }
+}
+
+void referencePoints(const std::vector<SGRandomTriangle>& triangles,
+                     double coverage, double spacing,
+                     const std::vector<unsigned char>* mask,
+                     std::vector<std::pair<SGVec3f, float> >& points)
+{
+    for (unsigned i = 0; i < triangles.size(); ++i) {
+        const SGRandomTriangle& tri = triangles[i];
+        SGVec3f v0 = tri._vertices[0], v1 = tri._vertices[1], v2 = tri._vertices[2];
+        SGVec3f normal = cross(v1 - v0, v2 - v0);
+        float area = 0.5f*length(normal);
+        if (area <= SGLimitsf::min())
+            continue;
+        SGTriangleRandom random(123, SGRandomObjectGenerator::PointStream, i);
+        double num = area / coverage + random();
+        if (num > 100.0)
+            num = 100.0;
+        while ( num > 1.0 ) {
+            float a, b, c;
+            referenceBarycentric(random, a, b, c);
+            SGVec3f randomPoint = a*v0 + b*v1 + c*v2;
+            if (((length(cross(randomPoint - v0, randomPoint - v1)) / length(v1 - v0)) > spacing) &&
+                ((length(cross(randomPoint - v1, randomPoint - v2)) / length(v2 - v1)) > spacing) &&
+                ((length(cross(randomPoint - v2, randomPoint - v0)) / length(v0 - v2)) > spacing)   )
+            {
+                if (mask) {
+                    SGVec2f texCoord = a*tri._texCoords[0] + b*tri._texCoords[1] + c*tri._texCoords[2];
+                    if (random() < referenceSample(*mask, 2, texCoord))
+                        points.push_back(std::make_pair(randomPoint, referenceSample(*mask, 0, texCoord)));
+                } else {
+                    points.push_back(std::make_pair(randomPoint, random()));
+                }
+            }
+            num -= 1.0;
+        }
+    }
+}
+
+template<typename T>
+void checkEqual(const std::vector<T>& a, const std::vector<T>& b)
+{
+    SG_CHECK_EQUAL(a.size(), b.size());
+    for (std::size_t i = 0; i < a.size(); ++i)
+        SG_VERIFY(a[i] == b[i]);
+}
+
+struct Results {
+    std::vector<SGVec3f> _lights;
+    std::vector<SGVec3f> _maskedLights;
+    std::vector<SGVec3f> _trees;
+    std::vector<SGVec3f> _treeNormals;
+    std::vector<std::pair<SGVec3f, float> > _buildings;
+    std::vector<std::pair<SGVec3f, float> > _maskedBuildings;
+};
+
+Results generate(const std::vector<SGRandomTriangle>& triangles,
+                 const SGObjectMask& mask, unsigned maxThreads)
+{
+    ImageKernels::setMaxThreads(maxThreads);
+    SGRandomObjectGenerator generator(unsigned(triangles.size()),
+        [&triangles](unsigned i, SGRandomTriangle& triangle) {
+            triangle = triangles[i];
+        });
+    Results results;
+    generator.addSurfacePoints(20, 3, SGObjectMask(), results._lights);
+    generator.addSurfacePoints(20, 3, mask, results._maskedLights);
+    generator.addTreePoints(30, mask, 1, 0.95f, 0.8f,
+                            results._trees, results._treeNormals);
+    generator.addPoints(200, 2, SGObjectMask(), results._buildings);
+    generator.addPoints(200, 2, mask, results._maskedBuildings);
+    ImageKernels::setMaxThreads(0);
+    return results;
+}
+}
+
+void testTriangleRandom()
+{
+    SGTriangleRandom a(123, 1, 7);
+    SGTriangleRandom b(123, 1, 7);
+    SGTriangleRandom c(123, 1, 8);
+    SGTriangleRandom d(123, 2, 7);
+    bool differsC = false, differsD = false;
+    for (unsigned i = 0; i < 100; ++i) {
+        float value = a();
+        SG_VERIFY(0 <= value && value < 1);
+        SG_CHECK_EQUAL(value, b());
+        differsC |= value != c();
+        differsD |= value != d();
+    }
+    SG_VERIFY(differsC);
+    SG_VERIFY(differsD);
+}
+
+void testMaskSampling()
+{
+    std::vector<unsigned char> data = makeMask();
+    SGObjectMask mask(&data[0], MaskWidth, MaskHeight, 3, MaskRowBytes, 0, 1, 2);
+
+    std::vector<float> u, v;
+    for (unsigned i = 0; i < 1000; ++i) {
+        u.push_back(i*0.00731f);
+        v.push_back(i*0.00297f + 0.1f);
+    }
+    for (unsigned channel = 0; channel < 3; ++channel) {
+        std::vector<float> values(u.size());
+        mask.sample(SGObjectMask::Channel(channel), &u[0], &v[0],
+                    unsigned(u.size()), &values[0]);
+        for (unsigned i = 0; i < u.size(); ++i) {
+            float expected = referenceSample(data, channel, SGVec2f(u[i], v[i]));
+            SG_CHECK_EQUAL(values[i], expected);
+            SG_CHECK_EQUAL(mask.sample(SGObjectMask::Channel(channel),
+                                       SGVec2f(u[i], v[i])), expected);
+        }
+    }
+
+    // Negative texture coordinates repeat too
+    SG_CHECK_EQUAL(mask.sample(SGObjectMask::Green, SGVec2f(-0.5f/MaskWidth, 0)),
+                   data[3*(MaskWidth - 1) + 1]*(1.0f/255.0f));
+    SG_CHECK_EQUAL(mask.sample(SGObjectMask::Blue, SGVec2f(0, -1.5f/MaskHeight)),
+                   data[(MaskHeight - 2)*MaskRowBytes + 2]*(1.0f/255.0f));
+
+    // BGR data with the channels swapped gives the same values
+    std::vector<unsigned char> bgr(data);
+    for (unsigned y = 0; y < MaskHeight; ++y)
+        for (unsigned x = 0; x < MaskWidth; ++x)
+            std::swap(bgr[y*MaskRowBytes + 3*x], bgr[y*MaskRowBytes + 3*x + 2]);
+    SGObjectMask bgrMask(&bgr[0], MaskWidth, MaskHeight, 3, MaskRowBytes, 2, 1, 0);
+    for (unsigned i = 0; i < u.size(); ++i) {
+        SG_CHECK_EQUAL(bgrMask.sample(SGObjectMask::Red, SGVec2f(u[i], v[i])),
+                       mask.sample(SGObjectMask::Red, SGVec2f(u[i], v[i])));
+    }
+
+    SGObjectMask none;
+    SG_VERIFY(!none.valid());
+    SG_CHECK_EQUAL(none.sample(SGObjectMask::Red, SGVec2f(0.3f, 0.4f)), 1.0f);
+}
+
+void testSerialEquivalence()
+{
+    std::vector<SGRandomTriangle> triangles = makeTriangles();
+    std::vector<unsigned char> data = makeMask();
+    SGObjectMask mask(&data[0], MaskWidth, MaskHeight, 3, MaskRowBytes, 0, 1, 2);
+
+    Results results = generate(triangles, mask, 1);
+    SG_VERIFY(!results._lights.empty());
+    SG_VERIFY(!results._maskedLights.empty());
+    SG_VERIFY(results._maskedLights.size() < results._lights.size());
+    SG_VERIFY(!results._trees.empty());
+    SG_VERIFY(!results._maskedBuildings.empty());
+
+    std::vector<SGVec3f> points, normals;
+    referenceSurfacePoints(triangles, 20, 3, 0, points);
+    checkEqual(results._lights, points);
+
+    points.clear();
+    referenceSurfacePoints(triangles, 20, 3, &data, points);
+    checkEqual(results._maskedLights, points);
+
+    points.clear();
+    referenceTreePoints(triangles, 30, &data, 1, 0.95f, 0.8f, points, normals);
+    checkEqual(results._trees, points);
+    checkEqual(results._treeNormals, normals);
+
+    std::vector<std::pair<SGVec3f, float> > pairs;
+    referencePoints(triangles, 200, 2, 0, pairs);
+    checkEqual(results._buildings, pairs);
+
+    pairs.clear();
+    referencePoints(triangles, 200, 2, &data, pairs);
+    checkEqual(results._maskedBuildings, pairs);
+}
+
+void testParallelDeterminism()
+{
+    std::vector<SGRandomTriangle> triangles = makeTriangles();
+    std::vector<unsigned char> data = makeMask();
+    SGObjectMask mask(&data[0], MaskWidth, MaskHeight, 3, MaskRowBytes, 0, 1, 2);
+
+    Results serial = generate(triangles, mask, 1);
+    for (unsigned threads = 2; threads <= 8; threads *= 2) {
+        Results parallel = generate(triangles, mask, threads);
+        checkEqual(parallel._lights, serial._lights);
+        checkEqual(parallel._maskedLights, serial._maskedLights);
+        checkEqual(parallel._trees, serial._trees);
+        checkEqual(parallel._treeNormals, serial._treeNormals);
+        checkEqual(parallel._buildings, serial._buildings);
+        checkEqual(parallel._maskedBuildings, serial._maskedBuildings);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    testTriangleRandom();
+    testMaskSampling();
+    testSerialEquivalence();
+    testParallelDeterminism();
+
+    std::cout << "all tests passed successfully!" << std::endl;
+    return EXIT_SUCCESS;
+}
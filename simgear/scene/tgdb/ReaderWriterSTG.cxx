@@ -25,6 +25,9 @@
 
 #include "ReaderWriterSTG.hxx"
 
+#include <map>
+#include <vector>
+
 #include <osg/LOD>
 #include <osg/MatrixTransform>
 #include <osg/PagedLOD>
@@ -51,6 +54,7 @@
 #include <simgear/scene/tgdb/apt_signs.hxx>
 #include <simgear/scene/tgdb/obj.hxx>
 #include <simgear/scene/material/matlib.hxx>
+#include <simgear/scene/model/SGInstancedModel.hxx>
 #include <simgear/scene/tgdb/SGBuildingBin.hxx>
 
 #include "SGOceanTile.hxx"
@@ -205,6 +209,78 @@ struct ReaderWriterSTG::_ModelBin {
       };
       typedef QuadTreeBuilder<osg::LOD*, _ObjectStatic, MakeQuadLeaf, AddModelLOD,
                               GetModelLODCoord>  STGObjectsQuadtree;
+
+      // Below this many placements of the same model in one leaf the
+      // instanced copy of the model costs more than it saves.
+      static const std::size_t MinInstances = 4;
+
+      // Replaces the placements of shared models within each leaf by an
+      // SGInstancedModel per model and range.
+      static void instanceModels(osg::Node* node)
+      {
+          osg::LOD* leaf = dynamic_cast<osg::LOD*>(node);
+          if (!leaf) {
+              osg::Group* group = node->asGroup();
+              for (unsigned i = 0; group && i < group->getNumChildren(); ++i)
+                  instanceModels(group->getChild(i));
+              return;
+          }
+
+          typedef std::pair<float, float> Range;
+          typedef std::pair<osg::Node*, Range> Key;
+          std::vector<Key> keys;
+          std::map<Key, SGInstancedModel::PlacementList> placements;
+          std::map<osg::Node*, bool> instanceable;
+          std::vector<std::pair<osg::ref_ptr<osg::Node>, Range> > others;
+          for (unsigned i = 0; i < leaf->getNumChildren(); ++i) {
+              Range range(leaf->getMinRange(i), leaf->getMaxRange(i));
+              osg::MatrixTransform* transform;
+              transform = dynamic_cast<osg::MatrixTransform*>(leaf->getChild(i));
+              osg::Node* model = 0;
+              if (transform && transform->getName() == "rotateStaticObject"
+                  && transform->getNumChildren() == 1)
+                  model = transform->getChild(0);
+              if (model) {
+                  std::map<osg::Node*, bool>::iterator j = instanceable.find(model);
+                  if (j == instanceable.end())
+                      j = instanceable.insert(std::make_pair(model, SGInstancedModel::isInstanceable(model))).first;
+                  if (!j->second)
+                      model = 0;
+              }
+              if (!model) {
+                  others.push_back(std::make_pair(leaf->getChild(i), range));
+                  continue;
+              }
+              Key key(model, range);
+              SGInstancedModel::PlacementList& list = placements[key];
+              if (list.empty())
+                  keys.push_back(key);
+              list.push_back(transform);
+          }
+
+          bool changed = false;
+          for (std::vector<Key>::const_iterator i = keys.begin(); i != keys.end(); ++i)
+              changed |= MinInstances <= placements[*i].size();
+          if (!changed)
+              return;
+
+          leaf->removeChildren(0, leaf->getNumChildren());
+          for (unsigned i = 0; i < others.size(); ++i)
+              leaf->addChild(others[i].first.get(), others[i].second.first, others[i].second.second);
+          for (std::vector<Key>::const_iterator i = keys.begin(); i != keys.end(); ++i) {
+              const SGInstancedModel::PlacementList& list = placements[*i];
+              const Range& range = i->second;
+              if (list.size() < MinInstances) {
+                  for (unsigned j = 0; j < list.size(); ++j)
+                      leaf->addChild(list[j].get(), range.first, range.second);
+              } else {
+                  osg::ref_ptr<SGInstancedModel> model = new SGInstancedModel(i->first, list);
+                  model->setName("instancedStaticObject");
+                  model->setDataVariance(osg::Object::STATIC);
+                  leaf->addChild(model.get(), range.first, range.second);
+              }
+          }
+      }
     public:
         virtual osgDB::ReaderWriter::ReadResult
         readNode(const std::string&, const osgDB::Options*)
@@ -215,6 +291,9 @@ struct ReaderWriterSTG::_ModelBin {
             group->setName("STG-group-A");
             group->setDataVariance(osg::Object::STATIC);
 
+            if (_options->getPluginStringData("SimGear::INSTANCE_SHARED_MODELS") != "OFF")
+                instanceModels(group.get());
+
             simgear::AirportSignBuilder signBuilder(_options->getMaterialLib(), _bucket.get_center());
             for (std::list<_Sign>::iterator i = _signList.begin(); i != _signList.end(); ++i)
                 signBuilder.addSign(SGGeod::fromDegM(i->_lon, i->_lat, i->_elev), i->_hdg, i->_name, i->_size);
@@ -20,7 +20,6 @@ class SGTriangleInfo
 public:
     SGTriangleInfo( const SGVec3d& center ) {
         gbs_center = center;
-        mt_init(&seed, 123);
     }
 
     // API used to build the Info by the visitor
@@ -219,71 +218,9 @@ public:
                                 osg::Texture2D* object_mask,
                                 std::vector<SGVec3f>& points)
     {
-        if ( !geometries.empty() ) {
-            const osg::Vec3Array* vertices  = dynamic_cast<osg::Vec3Array*>(geometries[0]->getVertexArray());
-            const osg::Vec2Array* texcoords = dynamic_cast<osg::Vec2Array*>(geometries[0]->getTexCoordArray(0));
-            
-            int numPrimitiveSets = geometries[0]->getNumPrimitiveSets();
-            if ( numPrimitiveSets > 0 ) {
-                const osg::PrimitiveSet* ps = geometries[0]->getPrimitiveSet(0);
-                unsigned int numIndices = ps->getNumIndices();
-                
-                for ( unsigned int i=2; i<numIndices; i+= 3 ) {                    
-                    SGVec3f v0 = toSG(vertices->operator[](ps->index(i-2)));
-                    SGVec3f v1 = toSG(vertices->operator[](ps->index(i-1)));
-                    SGVec3f v2 = toSG(vertices->operator[](ps->index(i-0)));
-                    
-                    SGVec2f t0 = toSG(texcoords->operator[](ps->index(i-2)));
-                    SGVec2f t1 = toSG(texcoords->operator[](ps->index(i-1)));
-                    SGVec2f t2 = toSG(texcoords->operator[](ps->index(i-0)));
-                    
-                    SGVec3f normal = cross(v1 - v0, v2 - v0);
-            
-                    // Compute the area
-                    float area = 0.5f*length(normal);
-                    if (area <= SGLimitsf::min())
-                        continue;
-            
-                    // For partial units of area, use a zombie door method to
-                    // create the proper random chance of a light being created
-                    // for this triangle
-                    float unit = area + mt_rand(&seed)*coverage;
-            
-                    SGVec3f offsetVector = offset*normalize(normal);
-                    // generate a light point for each unit of area
-            
-                    while ( coverage < unit ) {
-                        float a = mt_rand(&seed);
-                        float b = mt_rand(&seed);
-                
-                        if ( a + b > 1 ) {
-                            a = 1 - a;
-                            b = 1 - b;
-                        }
-                        float c = 1 - a - b;
-                        SGVec3f randomPoint = offsetVector + a*v0 + b*v1 + c*v2;
-                
-                        if (object_mask != NULL) {
-                            SGVec2f texCoord = a*t0 + b*t1 + c*t2;
-                    
-                            // Check this random point against the object mask
-                            // red channel.
-                            osg::Image* img = object_mask->getImage();            
-                            unsigned int x = (int) (img->s() * texCoord.x()) % img->s();
-                            unsigned int y = (int) (img->t() * texCoord.y()) % img->t();
-                    
-                            if (mt_rand(&seed) < img->getColor(x, y).r()) {                
-                                points.push_back(randomPoint);        
-                            }                    
-                        } else {      
-                            // No object mask, so simply place the object  
-                            points.push_back(randomPoint);        
-                        }
-                        unit -= coverage;        
-                    }
-                }
-            }
-        }
+        getRandomObjectGenerator().addSurfacePoints(coverage, offset,
+                                                    simgear::SGObjectMask(object_mask),
+                                                    points);
     }
     
     void addRandomTreePoints(float wood_coverage, 
@@ -294,89 +231,12 @@ public:
                              std::vector<SGVec3f>& points,
 			     std::vector<SGVec3f>& normals)
     {
-        if ( !geometries.empty() ) {
-            const osg::Vec3Array* vertices  = dynamic_cast<osg::Vec3Array*>(geometries[0]->getVertexArray());
-            const osg::Vec2Array* texcoords = dynamic_cast<osg::Vec2Array*>(geometries[0]->getTexCoordArray(0));
-            
-            int numPrimitiveSets = geometries[0]->getNumPrimitiveSets();
-            if ( numPrimitiveSets > 0 ) {
-                const osg::PrimitiveSet* ps = geometries[0]->getPrimitiveSet(0);
-                unsigned int numIndices = ps->getNumIndices();
-                
-                for ( unsigned int i=2; i<numIndices; i+= 3 ) {                    
-                    SGVec3f v0 = toSG(vertices->operator[](ps->index(i-2)));
-                    SGVec3f v1 = toSG(vertices->operator[](ps->index(i-1)));
-                    SGVec3f v2 = toSG(vertices->operator[](ps->index(i-0)));
-                    
-                    SGVec2f t0 = toSG(texcoords->operator[](ps->index(i-2)));
-                    SGVec2f t1 = toSG(texcoords->operator[](ps->index(i-1)));
-                    SGVec2f t2 = toSG(texcoords->operator[](ps->index(i-0)));
-                    
-                    SGVec3f normal = cross(v1 - v0, v2 - v0);
-            
-                    // Ensure the slope isn't too steep by checking the
-                    // cos of the angle between the slope normal and the
-                    // vertical (conveniently the z-component of the normalized
-                    // normal) and values passed in.                   
-                    float alpha = normalize(normal).z();
-                    float slope_density = 1.0;
-            
-                    if (alpha < cos_zero_density_angle) 
-                        continue; // Too steep for any vegetation      
-                        
-                    if (alpha < cos_max_density_angle) {
-                        slope_density = 
-                        (alpha - cos_zero_density_angle) / (cos_max_density_angle - cos_zero_density_angle);
-                    }
-                    
-                    // Compute the area
-                    float area = 0.5f*length(normal);
-                    if (area <= SGLimitsf::min())
-                        continue;
-                
-                    // Determine the number of trees, taking into account vegetation
-                    // density (which is linear) and the slope density factor.
-                    // Use a zombie door method to create the proper random chance 
-                    // of a tree being created for partial values.
-                    int woodcount = (int) (vegetation_density * vegetation_density * 
-                    slope_density *
-                    area / wood_coverage + mt_rand(&seed));
-                    
-                    for (int j = 0; j < woodcount; j++) {
-                        float a = mt_rand(&seed);
-                        float b = mt_rand(&seed);
-                        
-                        if ( a + b > 1.0f ) {
-                            a = 1.0f - a;
-                            b = 1.0f - b;
-                        }
-                        
-                        float c = 1.0f - a - b;
-                        
-                        SGVec3f randomPoint = a*v0 + b*v1 + c*v2;
-                        
-                        if (object_mask != NULL) {
-                            SGVec2f texCoord = a*t0 + b*t1 + c*t2;
-                            
-                            // Check this random point against the object mask
-                            // green (for trees) channel. 
-                            osg::Image* img = object_mask->getImage();            
-                            unsigned int x = (int) (img->s() * texCoord.x()) % img->s();
-                            unsigned int y = (int) (img->t() * texCoord.y()) % img->t();
-                            
-                            if (mt_rand(&seed) < img->getColor(x, y).g()) {  
-                                // The red channel contains the rotation for this object                                  
-                                points.push_back(randomPoint);
-	    			normals.push_back(normalize(normal));
-                            }
-                        } else {
-                            points.push_back(randomPoint);
-	          	    normals.push_back(normalize(normal));
-                        }                
-                    }
-                }
-            }
-        }
+        getRandomObjectGenerator().addTreePoints(wood_coverage,
+                                                 simgear::SGObjectMask(object_mask),
+                                                 vegetation_density,
+                                                 cos_max_density_angle,
+                                                 cos_zero_density_angle,
+                                                 points, normals);
     }
     
 #if 0    
@@ -438,7 +298,31 @@ public:
 #endif    
     
 private:
-    mt seed;
+    // The triangles of the first geometry for the random objects
+    simgear::SGRandomObjectGenerator getRandomObjectGenerator() const
+    {
+        const osg::Vec3Array* vertices = 0;
+        const osg::Vec2Array* texcoords = 0;
+        const osg::PrimitiveSet* ps = 0;
+        if ( !geometries.empty() && geometries[0]->getNumPrimitiveSets() > 0 ) {
+            vertices  = dynamic_cast<osg::Vec3Array*>(geometries[0]->getVertexArray());
+            texcoords = dynamic_cast<osg::Vec2Array*>(geometries[0]->getTexCoordArray(0));
+            ps = geometries[0]->getPrimitiveSet(0);
+        }
+        unsigned int numTriangles = 0;
+        if ( vertices && texcoords && ps )
+            numTriangles = ps->getNumIndices()/3;
+
+        return simgear::SGRandomObjectGenerator(numTriangles,
+            [vertices, texcoords, ps](unsigned i, simgear::SGRandomTriangle& triangle) {
+                for ( unsigned int j=0; j<3; j++ ) {
+                    unsigned int index = ps->index(3*i + j);
+                    triangle._vertices[j]  = toSG(vertices->operator[](index));
+                    triangle._texCoords[j] = toSG(texcoords->operator[](index));
+                }
+            });
+    }
+
     SGMaterial* mat;
     SGVec3d gbs_center;
     std::vector<osg::Geometry*> geometries;
@@ -279,9 +279,8 @@ osg::Node* SGOceanTile(const SGBucket& b, SGMaterialLib *matlib, int latPoints,
     double tex_width = 1000.0;
   
     // find Ocean material in the properties list
-    SGMaterialCache* matcache = matlib->generateMatCache(b.get_center());
+    osg::ref_ptr<SGMaterialCache> matcache = matlib->generateMatCache(b.get_center());
     SGMaterial* mat = matcache->find( "Ocean" );
-    delete matcache;
 
     if ( mat != NULL ) {
         // set the texture width and height values for this
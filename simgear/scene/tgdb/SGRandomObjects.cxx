@@ -0,0 +1,463 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include "SGRandomObjects.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+
+#include <osg/Image>
+#include <osg/Texture2D>
+
+#include <simgear/debug/logstream.hxx>
+#include <simgear/scene/util/SGImageKernels.hxx>
+
+namespace simgear
+{
+
+namespace
+{
+// Objects placed per triangle by addPoints at most
+const double MaxRandomObjects = 100.0;
+
+inline void randomBarycentric(SGTriangleRandom& random,
+                              float& a, float& b, float& c)
+{
+    a = random();
+    b = random();
+    if (a + b > 1) {
+        a = 1 - a;
+        b = 1 - b;
+    }
+    c = 1 - a - b;
+}
+
+inline SGVec2f interpolate(const SGRandomTriangle& triangle,
+                           float a, float b, float c)
+{
+    return a*triangle._texCoords[0] + b*triangle._texCoords[1]
+        + c*triangle._texCoords[2];
+}
+
+// Points waiting for their object mask lookup, in generation order
+struct MaskCandidates {
+    std::vector<float> _u;
+    std::vector<float> _v;
+    std::vector<float> _thresholds;
+
+    void push_back(const SGVec2f& texCoord, float threshold)
+    {
+        _u.push_back(texCoord.x());
+        _v.push_back(texCoord.y());
+        _thresholds.push_back(threshold);
+    }
+
+    std::size_t size() const { return _thresholds.size(); }
+
+    // Which candidates pass the mask channel
+    void select(const SGObjectMask& mask, SGObjectMask::Channel channel,
+                std::vector<char>& keep) const
+    {
+        std::vector<float> values(size());
+        if (!values.empty())
+            mask.sample(channel, &_u[0], &_v[0], unsigned(size()), &values[0]);
+        keep.resize(size());
+        for (std::size_t i = 0; i < size(); ++i)
+            keep[i] = _thresholds[i] < values[i];
+    }
+};
+
+template<typename T>
+void appendSelected(const std::vector<T>& from, const std::vector<char>& keep,
+                    std::vector<T>& to)
+{
+    for (std::size_t i = 0; i < from.size(); ++i) {
+        if (keep[i])
+            to.push_back(from[i]);
+    }
+}
+
+template<typename T>
+void append(const std::vector<T>& from, std::vector<T>& to)
+{
+    to.insert(to.end(), from.begin(), from.end());
+}
+}
+
+SGObjectMask::SGObjectMask() :
+    _data(0),
+    _s(0),
+    _t(0),
+    _pixelBytes(0),
+    _rowBytes(0)
+{
+    _offsets[0] = _offsets[1] = _offsets[2] = 0;
+}
+
+SGObjectMask::SGObjectMask(const osg::Texture2D* texture) :
+    _data(0),
+    _s(0),
+    _t(0),
+    _pixelBytes(0),
+    _rowBytes(0)
+{
+    _offsets[0] = _offsets[1] = _offsets[2] = 0;
+    const osg::Image* image = texture ? texture->getImage() : 0;
+    if (!image || !image->data() || image->s() <= 0 || image->t() <= 0)
+        return;
+
+    unsigned s = image->s();
+    unsigned t = image->t();
+    unsigned pixelBytes = image->getPixelSizeInBits()/8;
+    unsigned rowBytes = t > 1 ? unsigned(image->data(0, 1) - image->data(0, 0))
+        : s*pixelBytes;
+    if (image->getDataType() == GL_UNSIGNED_BYTE) {
+        switch (image->getPixelFormat()) {
+        case GL_RGB:
+        case GL_RGBA:
+            init(image->data(), s, t, pixelBytes, rowBytes, 0, 1, 2);
+            return;
+        case GL_BGR:
+        case GL_BGRA:
+            init(image->data(), s, t, pixelBytes, rowBytes, 2, 1, 0);
+            return;
+        case GL_LUMINANCE:
+        case GL_LUMINANCE_ALPHA:
+            init(image->data(), s, t, pixelBytes, rowBytes, 0, 0, 0);
+            return;
+        default:
+            break;
+        }
+    }
+
+    _converted = std::make_shared<std::vector<unsigned char> >(3*s*t);
+    unsigned char* rgb = &(*_converted)[0];
+    for (unsigned y = 0; y < t; ++y) {
+        for (unsigned x = 0; x < s; ++x, rgb += 3) {
+            osg::Vec4 color = image->getColor(x, y);
+            for (unsigned i = 0; i < 3; ++i)
+                rgb[i] = static_cast<unsigned char>(color[i]*255.0f + 0.5f);
+        }
+    }
+    init(&(*_converted)[0], s, t, 3, 3*s, 0, 1, 2);
+}
+
+SGObjectMask::SGObjectMask(const unsigned char* data, unsigned s, unsigned t,
+                           unsigned pixelBytes, unsigned rowBytes,
+                           unsigned red, unsigned green, unsigned blue)
+{
+    init(data, s, t, pixelBytes, rowBytes, red, green, blue);
+}
+
+void SGObjectMask::init(const unsigned char* data, unsigned s, unsigned t,
+                        unsigned pixelBytes, unsigned rowBytes,
+                        unsigned red, unsigned green, unsigned blue)
+{
+    _data = data;
+    _s = int(s);
+    _t = int(t);
+    _pixelBytes = pixelBytes;
+    _rowBytes = rowBytes;
+    _offsets[Red] = red;
+    _offsets[Green] = green;
+    _offsets[Blue] = blue;
+}
+
+float SGObjectMask::sample(Channel channel, const SGVec2f& texCoord) const
+{
+    float value;
+    sample(channel, &texCoord.x(), &texCoord.y(), 1, &value);
+    return value;
+}
+
+void SGObjectMask::sample(Channel channel, const float* u, const float* v,
+                          unsigned n, float* values) const
+{
+    if (!_data) {
+        for (unsigned i = 0; i < n; ++i)
+            values[i] = 1;
+        return;
+    }
+
+    const unsigned char* data = _data + _offsets[channel];
+    const float s = float(_s);
+    const float t = float(_t);
+    // The texel coordinates of a block first, which vectorises, then
+    // the lookups.
+    const unsigned BlockSize = 64;
+    int xs[BlockSize];
+    int ys[BlockSize];
+    for (unsigned begin = 0; begin < n; begin += BlockSize) {
+        unsigned count = std::min(n - begin, BlockSize);
+        for (unsigned i = 0; i < count; ++i) {
+            xs[i] = int(std::floor(s*u[begin + i]));
+            ys[i] = int(std::floor(t*v[begin + i]));
+        }
+        for (unsigned i = 0; i < count; ++i) {
+            int x = xs[i];
+            int y = ys[i];
+            if (unsigned(x) >= unsigned(_s)) {
+                x %= _s;
+                if (x < 0)
+                    x += _s;
+            }
+            if (unsigned(y) >= unsigned(_t)) {
+                y %= _t;
+                if (y < 0)
+                    y += _t;
+            }
+            values[begin + i] = data[y*_rowBytes + x*_pixelBytes]*(1.0f/255.0f);
+        }
+    }
+}
+
+struct SGRandomObjectGenerator::Band {
+    std::vector<SGVec3f> _points;
+    std::vector<SGVec3f> _normals;
+    std::vector<float> _values;
+};
+
+SGRandomObjectGenerator::SGRandomObjectGenerator(unsigned numTriangles,
+                                                 const TriangleFunc& getTriangle,
+                                                 unsigned seed) :
+    _numTriangles(numTriangles),
+    _getTriangle(getTriangle),
+    _seed(seed)
+{
+}
+
+void SGRandomObjectGenerator::forEachBand(const std::function<void(unsigned, unsigned, Band&)>& func,
+                                          Band& result) const
+{
+    std::mutex mutex;
+    std::map<unsigned, Band> bands;
+    ImageKernels::forEachBand(_numTriangles, sizeof(SGRandomTriangle),
+                              [&](unsigned begin, unsigned end) {
+        Band band;
+        func(begin, end, band);
+        std::lock_guard<std::mutex> lock(mutex);
+        std::swap(bands[begin], band);
+    });
+
+    // Concatenated in triangle order, as a single thread would have
+    std::map<unsigned, Band>::const_iterator i;
+    for (i = bands.begin(); i != bands.end(); ++i) {
+        append(i->second._points, result._points);
+        append(i->second._normals, result._normals);
+        append(i->second._values, result._values);
+    }
+}
+
+void SGRandomObjectGenerator::addSurfacePoints(float coverage, float offset,
+                                               const SGObjectMask& mask,
+                                               std::vector<SGVec3f>& points) const
+{
+    Band result;
+    forEachBand([&](unsigned begin, unsigned end, Band& band) {
+        std::vector<SGVec3f> candidates;
+        MaskCandidates maskCandidates;
+        std::vector<SGVec3f>& out = mask.valid() ? candidates : band._points;
+        SGRandomTriangle triangle;
+        for (unsigned i = begin; i < end; ++i) {
+            _getTriangle(i, triangle);
+            const SGVec3f& v0 = triangle._vertices[0];
+            const SGVec3f& v1 = triangle._vertices[1];
+            const SGVec3f& v2 = triangle._vertices[2];
+            SGVec3f normal = cross(v1 - v0, v2 - v0);
+
+            // Compute the area
+            float area = 0.5f*length(normal);
+            if (area <= SGLimitsf::min())
+                continue;
+
+            // For partial units of area, use a zombie door method to
+            // create the proper random chance of a light being created
+            // for this triangle
+            SGTriangleRandom random(_seed, SurfaceStream, i);
+            float unit = area + random()*coverage;
+
+            SGVec3f offsetVector = offset*normalize(normal);
+            // generate a light point for each unit of area
+            while (coverage < unit) {
+                float a, b, c;
+                randomBarycentric(random, a, b, c);
+                out.push_back(offsetVector + a*v0 + b*v1 + c*v2);
+                if (mask.valid())
+                    maskCandidates.push_back(interpolate(triangle, a, b, c), random());
+                unit -= coverage;
+            }
+        }
+
+        if (mask.valid()) {
+            std::vector<char> keep;
+            maskCandidates.select(mask, SGObjectMask::Red, keep);
+            appendSelected(candidates, keep, band._points);
+        }
+    }, result);
+    append(result._points, points);
+}
+
+void SGRandomObjectGenerator::addTreePoints(float woodCoverage,
+                                            const SGObjectMask& mask,
+                                            float vegetationDensity,
+                                            float cosMaxDensityAngle,
+                                            float cosZeroDensityAngle,
+                                            std::vector<SGVec3f>& points,
+                                            std::vector<SGVec3f>& normals) const
+{
+    Band result;
+    forEachBand([&](unsigned begin, unsigned end, Band& band) {
+        Band candidates;
+        MaskCandidates maskCandidates;
+        Band& out = mask.valid() ? candidates : band;
+        SGRandomTriangle triangle;
+        for (unsigned i = begin; i < end; ++i) {
+            _getTriangle(i, triangle);
+            const SGVec3f& v0 = triangle._vertices[0];
+            const SGVec3f& v1 = triangle._vertices[1];
+            const SGVec3f& v2 = triangle._vertices[2];
+            SGVec3f normal = cross(v1 - v0, v2 - v0);
+
+            // Ensure the slope isn't too steep by checking the
+            // cos of the angle between the slope normal and the
+            // vertical (conveniently the z-component of the normalized
+            // normal) and values passed in.
+            float alpha = normalize(normal).z();
+            float slopeDensity = 1.0;
+
+            if (alpha < cosZeroDensityAngle)
+                continue; // Too steep for any vegetation
+
+            if (alpha < cosMaxDensityAngle) {
+                slopeDensity = (alpha - cosZeroDensityAngle)
+                    / (cosMaxDensityAngle - cosZeroDensityAngle);
+            }
+
+            // Compute the area
+            float area = 0.5f*length(normal);
+            if (area <= SGLimitsf::min())
+                continue;
+
+            // Determine the number of trees, taking into account vegetation
+            // density (which is linear) and the slope density factor.
+            // Use a zombie door method to create the proper random chance
+            // of a tree being created for partial values.
+            SGTriangleRandom random(_seed, TreeStream, i);
+            int woodcount = (int) (vegetationDensity*vegetationDensity
+                                   *slopeDensity*area/woodCoverage + random());
+
+            for (int j = 0; j < woodcount; j++) {
+                float a, b, c;
+                randomBarycentric(random, a, b, c);
+                out._points.push_back(a*v0 + b*v1 + c*v2);
+                out._normals.push_back(normalize(normal));
+                if (mask.valid())
+                    maskCandidates.push_back(interpolate(triangle, a, b, c), random());
+            }
+        }
+
+        if (mask.valid()) {
+            std::vector<char> keep;
+            maskCandidates.select(mask, SGObjectMask::Green, keep);
+            appendSelected(candidates._points, keep, band._points);
+            appendSelected(candidates._normals, keep, band._normals);
+        }
+    }, result);
+    append(result._points, points);
+    append(result._normals, normals);
+}
+
+void SGRandomObjectGenerator::addPoints(double coverage, double spacing,
+                                        const SGObjectMask& mask,
+                                        std::vector<std::pair<SGVec3f, float> >& points) const
+{
+    Band result;
+    forEachBand([&](unsigned begin, unsigned end, Band& band) {
+        Band candidates;
+        MaskCandidates maskCandidates;
+        Band& out = mask.valid() ? candidates : band;
+        SGRandomTriangle triangle;
+        for (unsigned i = begin; i < end; ++i) {
+            _getTriangle(i, triangle);
+            const SGVec3f& v0 = triangle._vertices[0];
+            const SGVec3f& v1 = triangle._vertices[1];
+            const SGVec3f& v2 = triangle._vertices[2];
+            SGVec3f normal = cross(v1 - v0, v2 - v0);
+
+            // Compute the area
+            float area = 0.5f*length(normal);
+            if (area <= SGLimitsf::min())
+                continue;
+
+            // for partial units of area, use a zombie door method to
+            // create the proper random chance of an object being created
+            // for this triangle.
+            SGTriangleRandom random(_seed, PointStream, i);
+            double num = area/coverage + random();
+
+            if (num > MaxRandomObjects) {
+                SG_LOG(SG_TERRAIN, SG_ALERT,
+                       "Per-triangle random object count exceeded limits ("
+                       << MaxRandomObjects << ") " << num);
+                num = MaxRandomObjects;
+            }
+
+            // place an object each unit of area
+            while (num > 1.0) {
+                float a, b, c;
+                randomBarycentric(random, a, b, c);
+                SGVec3f point = a*v0 + b*v1 + c*v2;
+
+                // Check that the point is sufficiently far from
+                // the edge of the triangle by measuring the distance
+                // from the three lines that make up the triangle.
+                if (((length(cross(point - v0, point - v1))/length(v1 - v0)) > spacing) &&
+                    ((length(cross(point - v1, point - v2))/length(v2 - v1)) > spacing) &&
+                    ((length(cross(point - v2, point - v0))/length(v0 - v2)) > spacing)) {
+                    out._points.push_back(point);
+                    if (mask.valid())
+                        maskCandidates.push_back(interpolate(triangle, a, b, c), random());
+                    else
+                        out._values.push_back(random());
+                }
+                num -= 1.0;
+            }
+        }
+
+        if (mask.valid()) {
+            std::vector<char> keep;
+            maskCandidates.select(mask, SGObjectMask::Blue, keep);
+            // The red channel contains the rotation of the objects
+            std::vector<float> rotations(maskCandidates.size());
+            if (!rotations.empty())
+                mask.sample(SGObjectMask::Red, &maskCandidates._u[0],
+                            &maskCandidates._v[0], unsigned(rotations.size()),
+                            &rotations[0]);
+            appendSelected(candidates._points, keep, band._points);
+            appendSelected(rotations, keep, band._values);
+        }
+    }, result);
+    for (std::size_t i = 0; i < result._points.size(); ++i)
+        points.push_back(std::make_pair(result._points[i], result._values[i]));
+}
+
+}
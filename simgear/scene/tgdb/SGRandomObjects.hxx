@@ -0,0 +1,190 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA
+
+#ifndef SIMGEAR_SGRANDOMOBJECTS_HXX
+#define SIMGEAR_SGRANDOMOBJECTS_HXX 1
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <simgear/math/SGMath.hxx>
+
+namespace osg { class Texture2D; }
+
+namespace simgear
+{
+
+/// One triangle of a tile, as the random object generation sees it
+struct SGRandomTriangle {
+    SGVec3f _vertices[3];
+    SGVec2f _texCoords[3];
+};
+
+/**
+ * Random numbers for the objects of one triangle.
+ *
+ * Every triangle gets its own sequence, derived from the seed, the kind
+ * of objects generated and the index of the triangle. The objects thus
+ * do not depend on the order the triangles are processed in, or on the
+ * threads doing it.
+ */
+class SGTriangleRandom {
+public:
+    SGTriangleRandom(unsigned seed, unsigned stream, unsigned triangle) :
+        _state((uint64_t(seed) << 32 | stream) * 0x9e3779b97f4a7c15ULL
+               ^ uint64_t(triangle) * 0xd1b54a32d192ed03ULL)
+    {
+        next();
+    }
+
+    /// Uniformly distributed in [0, 1)
+    float operator()()
+    {
+        return float(next() >> 40)*(1.0f/16777216.0f);
+    }
+
+private:
+    // splitmix64
+    uint64_t next()
+    {
+        uint64_t z = (_state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30))*0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27))*0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t _state;
+};
+
+/**
+ * The object mask of a material texture: red gives the density of
+ * lights and the rotation of buildings, green the density of trees and
+ * blue the density of buildings.
+ *
+ * 8 bit images are sampled in place, anything else is converted once.
+ * Texture coordinates repeat.
+ */
+class SGObjectMask {
+public:
+    enum Channel { Red = 0, Green = 1, Blue = 2 };
+
+    /// No mask, every object is placed
+    SGObjectMask();
+    SGObjectMask(const osg::Texture2D* texture);
+    /**
+     * Samples 8 bit data of s times t pixels, pixelBytes apart within a
+     * row and rows rowBytes apart. red, green and blue are the byte
+     * offsets of the channels within a pixel.
+     */
+    SGObjectMask(const unsigned char* data, unsigned s, unsigned t,
+                 unsigned pixelBytes, unsigned rowBytes,
+                 unsigned red, unsigned green, unsigned blue);
+
+    bool valid() const { return _data != 0; }
+
+    float sample(Channel channel, const SGVec2f& texCoord) const;
+    /// Samples n texture coordinates at once into values
+    void sample(Channel channel, const float* u, const float* v, unsigned n,
+                float* values) const;
+
+private:
+    void init(const unsigned char* data, unsigned s, unsigned t,
+              unsigned pixelBytes, unsigned rowBytes,
+              unsigned red, unsigned green, unsigned blue);
+
+    const unsigned char* _data;
+    int _s;
+    int _t;
+    unsigned _pixelBytes;
+    unsigned _rowBytes;
+    unsigned _offsets[3];
+    std::shared_ptr<std::vector<unsigned char> > _converted;
+};
+
+/**
+ * Places the random lights, trees and buildings on the triangles of a
+ * tile.
+ *
+ * The triangles are split into bands that run on several threads, see
+ * ImageKernels::forEachBand. The results are the same for any number of
+ * threads, see SGTriangleRandom. Object mask lookups are batched per
+ * band.
+ */
+class SGRandomObjectGenerator {
+public:
+    /**
+     * The SGTriangleRandom streams of the object kinds, which keep
+     * lights, trees and buildings from ending up on the same spots.
+     */
+    enum Stream {
+        SurfaceStream = 1,
+        TreeStream,
+        PointStream
+    };
+
+    typedef std::function<void(unsigned, SGRandomTriangle&)> TriangleFunc;
+
+    /**
+     * getTriangle(i, triangle) fills in triangle i and is called
+     * concurrently.
+     */
+    SGRandomObjectGenerator(unsigned numTriangles,
+                            const TriangleFunc& getTriangle,
+                            unsigned seed = 123);
+
+    /**
+     * One point per coverage units of area, offset along the triangle
+     * normal. The mask's red channel gives the chance to keep a point.
+     */
+    void addSurfacePoints(float coverage, float offset,
+                          const SGObjectMask& mask,
+                          std::vector<SGVec3f>& points) const;
+
+    /**
+     * Trees, with their density reduced on steep slopes. The mask's
+     * green channel gives the chance to keep a tree.
+     */
+    void addTreePoints(float woodCoverage, const SGObjectMask& mask,
+                       float vegetationDensity, float cosMaxDensityAngle,
+                       float cosZeroDensityAngle,
+                       std::vector<SGVec3f>& points,
+                       std::vector<SGVec3f>& normals) const;
+
+    /**
+     * Objects at least spacing away from the triangle edges, paired with
+     * a rotation in [0, 1]. The mask's blue channel gives the chance to
+     * keep an object and its red channel the rotation.
+     */
+    void addPoints(double coverage, double spacing, const SGObjectMask& mask,
+                   std::vector<std::pair<SGVec3f, float> >& points) const;
+
+private:
+    struct Band;
+
+    void forEachBand(const std::function<void(unsigned, unsigned, Band&)>& func,
+                     Band& result) const;
+
+    unsigned _numTriangles;
+    TriangleFunc _getTriangle;
+    unsigned _seed;
+};
+
+}
+
+#endif
@@ -33,6 +33,7 @@
 
 #include <simgear/math/sg_random.h>
 #include <simgear/scene/util/OsgMath.hxx>
+#include "SGRandomObjects.hxx"
 #include "SGTriangleBin.hxx"
 
 
@@ -140,7 +141,6 @@ class SGTexturedTriangleBin : public SGTriangleBin<SGVertNormTex> {
 public:
   SGTexturedTriangleBin()
   {
-    mt_init(&seed, 123);
     has_sec_tcs = false;
   }
 
@@ -152,61 +152,9 @@ public:
                               osg::Texture2D* object_mask,
                               std::vector<SGVec3f>& points)
   {
-    unsigned num = getNumTriangles();
-    for (unsigned i = 0; i < num; ++i) {
-      triangle_ref triangleRef = getTriangleRef(i);
-      SGVec3f v0 = getVertex(triangleRef[0]).GetVertex();
-      SGVec3f v1 = getVertex(triangleRef[1]).GetVertex();
-      SGVec3f v2 = getVertex(triangleRef[2]).GetVertex();
-      SGVec2f t0 = getVertex(triangleRef[0]).GetTexCoord(0);
-      SGVec2f t1 = getVertex(triangleRef[1]).GetTexCoord(0);
-      SGVec2f t2 = getVertex(triangleRef[2]).GetTexCoord(0);
-      SGVec3f normal = cross(v1 - v0, v2 - v0);
-      
-      // Compute the area
-      float area = 0.5f*length(normal);
-      if (area <= SGLimitsf::min())
-        continue;
-      
-      // For partial units of area, use a zombie door method to
-      // create the proper random chance of a light being created
-      // for this triangle
-      float unit = area + mt_rand(&seed)*coverage;
-      
-      SGVec3f offsetVector = offset*normalize(normal);
-      // generate a light point for each unit of area
-
-      while ( coverage < unit ) {
-
-        float a = mt_rand(&seed);
-        float b = mt_rand(&seed);
-
-        if ( a + b > 1 ) {
-          a = 1 - a;
-          b = 1 - b;
-        }
-        float c = 1 - a - b;
-        SGVec3f randomPoint = offsetVector + a*v0 + b*v1 + c*v2;
-        
-        if (object_mask != NULL) {
-          SGVec2f texCoord = a*t0 + b*t1 + c*t2;
-          
-          // Check this random point against the object mask
-          // red channel.
-          osg::Image* img = object_mask->getImage();            
-          unsigned int x = (int) (img->s() * texCoord.x()) % img->s();
-          unsigned int y = (int) (img->t() * texCoord.y()) % img->t();
-          
-          if (mt_rand(&seed) < img->getColor(x, y).r()) {                
-            points.push_back(randomPoint);        
-          }                    
-        } else {      
-          // No object mask, so simply place the object  
-          points.push_back(randomPoint);        
-        }
-        unit -= coverage;        
-      }
-    }
+    getRandomObjectGenerator().addSurfacePoints(coverage, offset,
+                                                simgear::SGObjectMask(object_mask),
+                                                points);
   }
 
   // Computes and adds random surface points to the points list for tree
@@ -219,78 +167,12 @@ public:
                            std::vector<SGVec3f>& points,
 			   std::vector<SGVec3f>& normals)
   {
-    unsigned num = getNumTriangles();
-    for (unsigned i = 0; i < num; ++i) {
-      triangle_ref triangleRef = getTriangleRef(i);
-      SGVec3f v0 = getVertex(triangleRef[0]).GetVertex();
-      SGVec3f v1 = getVertex(triangleRef[1]).GetVertex();
-      SGVec3f v2 = getVertex(triangleRef[2]).GetVertex();
-      SGVec2f t0 = getVertex(triangleRef[0]).GetTexCoord(0);
-      SGVec2f t1 = getVertex(triangleRef[1]).GetTexCoord(0);
-      SGVec2f t2 = getVertex(triangleRef[2]).GetTexCoord(0);
-      SGVec3f normal = cross(v1 - v0, v2 - v0);
-      
-      // Ensure the slope isn't too steep by checking the
-      // cos of the angle between the slope normal and the
-      // vertical (conveniently the z-component of the normalized
-      // normal) and values passed in.                   
-      float alpha = normalize(normal).z();
-      float slope_density = 1.0;
-      
-      if (alpha < cos_zero_density_angle) 
-        continue; // Too steep for any vegetation      
-      
-      if (alpha < cos_max_density_angle) {
-        slope_density = 
-          (alpha - cos_zero_density_angle) / (cos_max_density_angle - cos_zero_density_angle);
-      }
-      
-      // Compute the area
-      float area = 0.5f*length(normal);
-      if (area <= SGLimitsf::min())
-        continue;
-        
-      // Determine the number of trees, taking into account vegetation
-      // density (which is linear) and the slope density factor.
-      // Use a zombie door method to create the proper random chance 
-      // of a tree being created for partial values.
-      int woodcount = (int) (vegetation_density * vegetation_density * 
-                             slope_density *
-                             area / wood_coverage + mt_rand(&seed));
-      
-      for (int j = 0; j < woodcount; j++) {
-        float a = mt_rand(&seed);
-        float b = mt_rand(&seed);
-
-        if ( a + b > 1.0f ) {
-          a = 1.0f - a;
-          b = 1.0f - b;
-        }
-
-        float c = 1.0f - a - b;
-
-        SGVec3f randomPoint = a*v0 + b*v1 + c*v2;
-        
-        if (object_mask != NULL) {
-          SGVec2f texCoord = a*t0 + b*t1 + c*t2;
-          
-          // Check this random point against the object mask
-          // green (for trees) channel. 
-          osg::Image* img = object_mask->getImage();            
-          unsigned int x = (int) (img->s() * texCoord.x()) % img->s();
-          unsigned int y = (int) (img->t() * texCoord.y()) % img->t();
-          
-          if (mt_rand(&seed) < img->getColor(x, y).g()) {  
-            // The red channel contains the rotation for this object                                  
-            points.push_back(randomPoint);
-	    normals.push_back(normalize(normal));
-          }
-        } else {
-          points.push_back(randomPoint);
-          normals.push_back(normalize(normal));
-        }                
-      }
-    }
+    getRandomObjectGenerator().addTreePoints(wood_coverage,
+                                             simgear::SGObjectMask(object_mask),
+                                             vegetation_density,
+                                             cos_max_density_angle,
+                                             cos_zero_density_angle,
+                                             points, normals);
   }
   
    void addRandomPoints(double coverage, 
@@ -298,71 +180,18 @@ public:
                         osg::Texture2D* object_mask,
                         std::vector<std::pair<SGVec3f, float> >& points)
   {
-    unsigned numtriangles = getNumTriangles();
-    for (unsigned i = 0; i < numtriangles; ++i) {
-      triangle_ref triangleRef = getTriangleRef(i);
-      SGVec3f v0 = getVertex(triangleRef[0]).GetVertex();
-      SGVec3f v1 = getVertex(triangleRef[1]).GetVertex();
-      SGVec3f v2 = getVertex(triangleRef[2]).GetVertex();
-      SGVec2f t0 = getVertex(triangleRef[0]).GetTexCoord(0);
-      SGVec2f t1 = getVertex(triangleRef[1]).GetTexCoord(0);
-      SGVec2f t2 = getVertex(triangleRef[2]).GetTexCoord(0);
-      SGVec3f normal = cross(v1 - v0, v2 - v0);
-      
-      // Compute the area
-      float area = 0.5f*length(normal);
-      if (area <= SGLimitsf::min())
-        continue;
-      
-      // for partial units of area, use a zombie door method to
-      // create the proper random chance of an object being created
-      // for this triangle.
-      double num = area / coverage + mt_rand(&seed);
-
-      if (num > MAX_RANDOM_OBJECTS) {
-          SG_LOG(SG_TERRAIN, SG_ALERT,
-                 "Per-triangle random object count exceeded limits ("
-        		  << MAX_RANDOM_OBJECTS << ") " << num);
-          num = MAX_RANDOM_OBJECTS;
-      }
+    getRandomObjectGenerator().addPoints(coverage, spacing,
+                                         simgear::SGObjectMask(object_mask),
+                                         points);
+  }
 
-      // place an object each unit of area
-      while ( num > 1.0 ) {
-        float a = mt_rand(&seed);
-        float b = mt_rand(&seed);
-        if ( a + b > 1 ) {
-          a = 1 - a;
-          b = 1 - b;
-        }
-        float c = 1 - a - b;
-        SGVec3f randomPoint = a*v0 + b*v1 + c*v2;
-        
-        // Check that the point is sufficiently far from
-        // the edge of the triangle by measuring the distance
-        // from the three lines that make up the triangle.        
-        if (((length(cross(randomPoint - v0, randomPoint - v1)) / length(v1 - v0)) > spacing) &&
-            ((length(cross(randomPoint - v1, randomPoint - v2)) / length(v2 - v1)) > spacing) &&
-            ((length(cross(randomPoint - v2, randomPoint - v0)) / length(v0 - v2)) > spacing)   )
-        {
-          if (object_mask != NULL) {
-            SGVec2f texCoord = a*t0 + b*t1 + c*t2;
-            
-            // Check this random point against the object mask
-            // blue (for buildings) channel. 
-            osg::Image* img = object_mask->getImage();            
-            unsigned int x = (int) (img->s() * texCoord.x()) % img->s();
-            unsigned int y = (int) (img->t() * texCoord.y()) % img->t();
-            
-            if (mt_rand(&seed) < img->getColor(x, y).b()) {  
-              // The red channel contains the rotation for this object                                  
-              points.push_back(std::make_pair(randomPoint, img->getColor(x,y).r()));
-            }
-          } else {
-            points.push_back(std::make_pair(randomPoint, static_cast<float>(mt_rand(&seed))));
-          }        
-        }
-        num -= 1.0;
-      }
+  void getRandomTriangle(unsigned i, simgear::SGRandomTriangle& triangle) const
+  {
+    triangle_ref triangleRef = getTriangleRef(i);
+    for (unsigned j = 0; j < 3; ++j) {
+      const SGVertNormTex& vertex = getVertex(triangleRef[j]);
+      triangle._vertices[j] = vertex.GetVertex();
+      triangle._texCoords[j] = vertex.GetTexCoord(0);
     }
   }
 
@@ -461,9 +290,14 @@ public:
   void hasSecondaryTexCoord( bool sec_tc ) { has_sec_tcs = sec_tc; }
 
 private:
-  // Random seed for the triangle.
-  mt seed;
-  
+  simgear::SGRandomObjectGenerator getRandomObjectGenerator() const
+  {
+    return simgear::SGRandomObjectGenerator(getNumTriangles(),
+      [this](unsigned i, simgear::SGRandomTriangle& triangle) {
+        getRandomTriangle(i, triangle);
+      });
+  }
+
   // does the triangle array have secondary texture coordinates
   bool has_sec_tcs;
 };
@@ -38,6 +38,7 @@
 #include <simgear/scene/util/OptionsReadFileCallback.hxx>
 #include <simgear/scene/util/SGNodeMasks.hxx>
 
+#include "SGRandomObjects.hxx"
 #include "SGNodeTriangles.hxx"
 #include "GroundLightManager.hxx"
 #include "SGLightBin.hxx"
@@ -256,7 +257,7 @@ public:
         return NULL;
 
       SGMaterialLibPtr matlib;
-      SGMaterialCache* matcache = 0;
+      osg::ref_ptr<SGMaterialCache> matcache;
       bool useVBOs = false;
       bool simplifyNear    = false;
       double ratio       = SG_SIMPLIFIER_RATIO;
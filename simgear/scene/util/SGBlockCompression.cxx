@@ -0,0 +1,647 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include "SGBlockCompression.hxx"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#include <simgear/math/simd.hxx>
+
+#include "SGImageKernels.hxx"
+
+namespace simgear
+{
+namespace BlockCompression
+{
+namespace
+{
+    typedef simd4_t<float,4> Vec;
+
+    // Encoding a block costs about as much as a kernel pass over this
+    // many times its bytes, used to size the bands
+    const std::size_t EncodeCost = 16;
+
+    inline Vec clamp255(const Vec& v)
+    {
+        return simd4::min(simd4::max(v, Vec(0.0f)), Vec(255.0f));
+    }
+
+    void loadBlock(const unsigned char rgba[64], bool withAlpha, Vec pixels[16])
+    {
+        for (int i = 0; i < 16; ++i) {
+            const unsigned char* p = rgba + 4*i;
+            pixels[i] = Vec(p[0], p[1], p[2], withAlpha ? p[3] : 0);
+        }
+    }
+
+    // Endpoints at the ends of the principal axis of the pixels
+    void fitPrincipalAxis(const Vec* pixels, Vec& e0, Vec& e1)
+    {
+        Vec mean(0.0f);
+        Vec lo = pixels[0];
+        Vec hi = pixels[0];
+        for (int i = 0; i < 16; ++i) {
+            mean += pixels[i];
+            lo = simd4::min(lo, pixels[i]);
+            hi = simd4::max(hi, pixels[i]);
+        }
+        mean *= 1.0f/16.0f;
+
+        Vec covariance[4];
+        for (int i = 0; i < 16; ++i) {
+            Vec d = pixels[i] - mean;
+            for (int c = 0; c < 4; ++c)
+                covariance[c] += d*d[c];
+        }
+
+        // Power iteration, starting from the diagonal of the bounding box
+        Vec axis = hi - lo;
+        for (int iteration = 0; iteration < 8; ++iteration) {
+            Vec v = covariance[0]*axis[0] + covariance[1]*axis[1]
+                + covariance[2]*axis[2] + covariance[3]*axis[3];
+            float length2 = simd4::dot(v, v);
+            if (length2 < 1e-12f)
+                break;
+            axis = v*(1.0f/std::sqrt(length2));
+        }
+        float length2 = simd4::dot(axis, axis);
+        if (length2 < 1e-12f) {
+            e0 = e1 = mean;
+            return;
+        }
+        axis *= 1.0f/std::sqrt(length2);
+
+        float tmin = FLT_MAX;
+        float tmax = -FLT_MAX;
+        for (int i = 0; i < 16; ++i) {
+            float t = simd4::dot(pixels[i] - mean, axis);
+            tmin = std::min(tmin, t);
+            tmax = std::max(tmax, t);
+        }
+        e0 = clamp255(mean + axis*tmin);
+        e1 = clamp255(mean + axis*tmax);
+    }
+
+    // Least squares endpoints for the chosen palette weights
+    bool refineEndpoints(const Vec* pixels, const unsigned char* indices,
+                         const float* weights, Vec& e0, Vec& e1)
+    {
+        float aa = 0, bb = 0, ab = 0;
+        Vec ax(0.0f), bx(0.0f);
+        for (int i = 0; i < 16; ++i) {
+            float b = weights[indices[i]];
+            float a = 1 - b;
+            aa += a*a;
+            bb += b*b;
+            ab += a*b;
+            ax += pixels[i]*a;
+            bx += pixels[i]*b;
+        }
+        float det = aa*bb - ab*ab;
+        if (std::fabs(det) < 1e-6f)
+            return false;
+        float scale = 1/det;
+        e0 = clamp255((ax*bb - bx*ab)*scale);
+        e1 = clamp255((bx*aa - ax*ab)*scale);
+        return true;
+    }
+
+    // The nearest palette entry of each pixel and the summed squared
+    // error. The palette is transposed so that one simd4_t holds a
+    // channel of four entries.
+    float selectIndices(const Vec* pixels, const Vec* palette,
+                        unsigned numEntries, unsigned char* indices)
+    {
+        Vec channels[4][4];
+        unsigned numGroups = (numEntries + 3)/4;
+        for (unsigned g = 0; g < numGroups; ++g) {
+            for (unsigned l = 0; l < 4; ++l) {
+                // Padding repeats the last entry, which never wins a tie
+                const Vec& entry = palette[std::min(4*g + l, numEntries - 1)];
+                for (int c = 0; c < 4; ++c)
+                    channels[g][c][l] = entry[c];
+            }
+        }
+
+        float error = 0;
+        for (int i = 0; i < 16; ++i) {
+            const Vec& p = pixels[i];
+            float best = FLT_MAX;
+            unsigned bestIndex = 0;
+            for (unsigned g = 0; g < numGroups; ++g) {
+                Vec d = channels[g][0] - Vec(p[0]);
+                Vec distance = d*d;
+                d = channels[g][1] - Vec(p[1]);
+                distance += d*d;
+                d = channels[g][2] - Vec(p[2]);
+                distance += d*d;
+                d = channels[g][3] - Vec(p[3]);
+                distance += d*d;
+                for (unsigned l = 0; l < 4; ++l) {
+                    if (distance[l] < best) {
+                        best = distance[l];
+                        bestIndex = 4*g + l;
+                    }
+                }
+            }
+            indices[i] = (unsigned char)bestIndex;
+            error += best;
+        }
+        return error;
+    }
+
+    class BitWriter {
+    public:
+        BitWriter(unsigned char* data) : _data(data), _pos(0)
+        { std::memset(_data, 0, 16); }
+        void write(unsigned value, unsigned bits)
+        {
+            for (unsigned i = 0; i < bits; ++i, ++_pos) {
+                if (value & (1u << i))
+                    _data[_pos >> 3] |= (unsigned char)(1u << (_pos & 7));
+            }
+        }
+    private:
+        unsigned char* _data;
+        unsigned _pos;
+    };
+
+    class BitReader {
+    public:
+        BitReader(const unsigned char* data) : _data(data), _pos(0) {}
+        unsigned read(unsigned bits)
+        {
+            unsigned value = 0;
+            for (unsigned i = 0; i < bits; ++i, ++_pos) {
+                if (_data[_pos >> 3] & (1u << (_pos & 7)))
+                    value |= 1u << i;
+            }
+            return value;
+        }
+    private:
+        const unsigned char* _data;
+        unsigned _pos;
+    };
+
+    // BC1 color block
+
+    unsigned short to565(const Vec& c)
+    {
+        unsigned r = unsigned(c[0]*(31.0f/255.0f) + 0.5f);
+        unsigned g = unsigned(c[1]*(63.0f/255.0f) + 0.5f);
+        unsigned b = unsigned(c[2]*(31.0f/255.0f) + 0.5f);
+        return (unsigned short)((r << 11) | (g << 5) | b);
+    }
+
+    void from565(unsigned short c, int rgb[3])
+    {
+        int r = (c >> 11) & 0x1f;
+        int g = (c >> 5) & 0x3f;
+        int b = c & 0x1f;
+        rgb[0] = (r << 3) | (r >> 2);
+        rgb[1] = (g << 2) | (g >> 4);
+        rgb[2] = (b << 3) | (b >> 2);
+    }
+
+    // The palette as the decoder computes it
+    void colorPalette(unsigned short c0, unsigned short c1, bool fourColors,
+                      int palette[4][4])
+    {
+        from565(c0, palette[0]);
+        from565(c1, palette[1]);
+        for (int c = 0; c < 3; ++c) {
+            if (fourColors) {
+                palette[2][c] = (2*palette[0][c] + palette[1][c])/3;
+                palette[3][c] = (palette[0][c] + 2*palette[1][c])/3;
+            } else {
+                palette[2][c] = (palette[0][c] + palette[1][c])/2;
+                palette[3][c] = 0;
+            }
+        }
+        palette[0][3] = palette[1][3] = palette[2][3] = 255;
+        palette[3][3] = fourColors ? 255 : 0;
+    }
+
+    float encodeColor(const Vec* pixels, Vec& e0, Vec& e1,
+                      unsigned char* block, unsigned char indices[16])
+    {
+        unsigned short c0 = to565(e0);
+        unsigned short c1 = to565(e1);
+        if (c0 < c1) {
+            std::swap(c0, c1);
+            std::swap(e0, e1);
+        }
+
+        float error;
+        if (c0 == c1) {
+            // A single color, in the three color mode that index 0 means
+            int rgb[3];
+            from565(c0, rgb);
+            Vec color(rgb[0], rgb[1], rgb[2], 0);
+            error = 0;
+            for (int i = 0; i < 16; ++i) {
+                Vec d = pixels[i] - color;
+                error += simd4::dot(d, d);
+                indices[i] = 0;
+            }
+        } else {
+            int entries[4][4];
+            colorPalette(c0, c1, true, entries);
+            Vec palette[4];
+            for (int k = 0; k < 4; ++k)
+                palette[k] = Vec(entries[k][0], entries[k][1], entries[k][2], 0);
+            error = selectIndices(pixels, palette, 4, indices);
+        }
+
+        unsigned bits = 0;
+        for (int i = 0; i < 16; ++i)
+            bits |= unsigned(indices[i]) << (2*i);
+        block[0] = (unsigned char)(c0 & 0xff);
+        block[1] = (unsigned char)(c0 >> 8);
+        block[2] = (unsigned char)(c1 & 0xff);
+        block[3] = (unsigned char)(c1 >> 8);
+        block[4] = (unsigned char)(bits & 0xff);
+        block[5] = (unsigned char)((bits >> 8) & 0xff);
+        block[6] = (unsigned char)((bits >> 16) & 0xff);
+        block[7] = (unsigned char)(bits >> 24);
+        return error;
+    }
+
+    void compressColorBlock(const Vec* pixels, unsigned char* block)
+    {
+        static const float weights[4] = { 0.0f, 1.0f, 1.0f/3.0f, 2.0f/3.0f };
+
+        Vec e0, e1;
+        fitPrincipalAxis(pixels, e0, e1);
+        unsigned char indices[16];
+        float bestError = encodeColor(pixels, e0, e1, block, indices);
+        for (int iteration = 0; iteration < 2 && 0 < bestError; ++iteration) {
+            if (!refineEndpoints(pixels, indices, weights, e0, e1))
+                break;
+            unsigned char candidate[8];
+            float error = encodeColor(pixels, e0, e1, candidate, indices);
+            if (bestError <= error)
+                break;
+            std::memcpy(block, candidate, 8);
+            bestError = error;
+        }
+    }
+
+    void decompressColorBlock(const unsigned char* block, bool alwaysFourColors,
+                              unsigned char rgba[64])
+    {
+        unsigned short c0 = (unsigned short)(block[0] | (block[1] << 8));
+        unsigned short c1 = (unsigned short)(block[2] | (block[3] << 8));
+        unsigned bits = block[4] | (block[5] << 8) | (block[6] << 16)
+            | (unsigned(block[7]) << 24);
+        int palette[4][4];
+        colorPalette(c0, c1, alwaysFourColors || c1 < c0, palette);
+        for (int i = 0; i < 16; ++i) {
+            const int* entry = palette[(bits >> (2*i)) & 3];
+            for (int c = 0; c < 4; ++c)
+                rgba[4*i + c] = (unsigned char)entry[c];
+        }
+    }
+
+    // BC2 and BC3 alpha blocks
+
+    void compressExplicitAlpha(const unsigned char rgba[64], unsigned char* block)
+    {
+        std::memset(block, 0, 8);
+        for (int i = 0; i < 16; ++i) {
+            unsigned a = (rgba[4*i + 3]*15 + 127)/255;
+            block[i/2] |= (unsigned char)(a << (4*(i & 1)));
+        }
+    }
+
+    void decompressExplicitAlpha(const unsigned char* block, unsigned char rgba[64])
+    {
+        for (int i = 0; i < 16; ++i) {
+            unsigned a = (block[i/2] >> (4*(i & 1))) & 0xf;
+            rgba[4*i + 3] = (unsigned char)(a*17);
+        }
+    }
+
+    void alphaPalette(int a0, int a1, int palette[8])
+    {
+        palette[0] = a0;
+        palette[1] = a1;
+        if (a0 > a1) {
+            for (int j = 0; j < 6; ++j)
+                palette[2 + j] = ((6 - j)*a0 + (j + 1)*a1)/7;
+        } else {
+            for (int j = 0; j < 4; ++j)
+                palette[2 + j] = ((4 - j)*a0 + (j + 1)*a1)/5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    void compressInterpolatedAlpha(const unsigned char rgba[64], unsigned char* block)
+    {
+        int amin = 255, amax = 0;
+        for (int i = 0; i < 16; ++i) {
+            amin = std::min(amin, int(rgba[4*i + 3]));
+            amax = std::max(amax, int(rgba[4*i + 3]));
+        }
+        std::memset(block, 0, 8);
+        block[0] = (unsigned char)amax;
+        block[1] = (unsigned char)amin;
+        if (amin == amax)
+            return;
+
+        int palette[8];
+        alphaPalette(amax, amin, palette);
+        unsigned long long bits = 0;
+        for (int i = 0; i < 16; ++i) {
+            int a = rgba[4*i + 3];
+            int best = 256;
+            unsigned bestIndex = 0;
+            for (unsigned k = 0; k < 8; ++k) {
+                int d = std::abs(palette[k] - a);
+                if (d < best) {
+                    best = d;
+                    bestIndex = k;
+                }
+            }
+            bits |= (unsigned long long)bestIndex << (3*i);
+        }
+        for (int i = 0; i < 6; ++i)
+            block[2 + i] = (unsigned char)((bits >> (8*i)) & 0xff);
+    }
+
+    void decompressInterpolatedAlpha(const unsigned char* block, unsigned char rgba[64])
+    {
+        int palette[8];
+        alphaPalette(block[0], block[1], palette);
+        unsigned long long bits = 0;
+        for (int i = 0; i < 6; ++i)
+            bits |= (unsigned long long)block[2 + i] << (8*i);
+        for (int i = 0; i < 16; ++i)
+            rgba[4*i + 3] = (unsigned char)palette[(bits >> (3*i)) & 7];
+    }
+
+    // BC7 mode 6: one subset, RGBA endpoints of 7 bits plus a p-bit each
+    // and 4 bit indices
+
+    const int Mode6Weights[16] = {
+        0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64
+    };
+
+    // The 7 bit endpoint and p-bit closest to e
+    void quantizeMode6(const Vec& e, int q[4], int& pbit)
+    {
+        float bestError = FLT_MAX;
+        for (int p = 0; p < 2; ++p) {
+            int candidate[4];
+            float error = 0;
+            for (int c = 0; c < 4; ++c) {
+                int v = int(std::floor((e[c] - p)*0.5f + 0.5f));
+                candidate[c] = std::min(std::max(v, 0), 127);
+                float d = float(2*candidate[c] + p) - e[c];
+                error += d*d;
+            }
+            if (error < bestError) {
+                bestError = error;
+                pbit = p;
+                std::copy(candidate, candidate + 4, q);
+            }
+        }
+    }
+
+    void mode6Palette(const int v0[4], const int v1[4], int palette[16][4])
+    {
+        for (int k = 0; k < 16; ++k) {
+            int w = Mode6Weights[k];
+            for (int c = 0; c < 4; ++c)
+                palette[k][c] = ((64 - w)*v0[c] + w*v1[c] + 32) >> 6;
+        }
+    }
+
+    float encodeMode6(const Vec* pixels, const Vec& e0, const Vec& e1,
+                      unsigned char* block, unsigned char indices[16])
+    {
+        int q0[4], q1[4], p0, p1;
+        quantizeMode6(e0, q0, p0);
+        quantizeMode6(e1, q1, p1);
+
+        int v0[4], v1[4];
+        for (int c = 0; c < 4; ++c) {
+            v0[c] = 2*q0[c] + p0;
+            v1[c] = 2*q1[c] + p1;
+        }
+        int entries[16][4];
+        mode6Palette(v0, v1, entries);
+        Vec palette[16];
+        for (int k = 0; k < 16; ++k)
+            palette[k] = Vec(entries[k][0], entries[k][1], entries[k][2], entries[k][3]);
+        float error = selectIndices(pixels, palette, 16, indices);
+
+        // The first index is stored without its top bit
+        if (indices[0] & 8) {
+            std::swap(q0, q1);
+            std::swap(p0, p1);
+            for (int i = 0; i < 16; ++i)
+                indices[i] = (unsigned char)(15 - indices[i]);
+        }
+
+        BitWriter writer(block);
+        writer.write(1 << 6, 7);
+        for (int c = 0; c < 4; ++c) {
+            writer.write(q0[c], 7);
+            writer.write(q1[c], 7);
+        }
+        writer.write(p0, 1);
+        writer.write(p1, 1);
+        writer.write(indices[0], 3);
+        for (int i = 1; i < 16; ++i)
+            writer.write(indices[i], 4);
+        return error;
+    }
+
+    void compressBC7Block(const Vec* pixels, unsigned char* block)
+    {
+        static const float weights[16] = {
+            0/64.0f, 4/64.0f, 9/64.0f, 13/64.0f, 17/64.0f, 21/64.0f, 26/64.0f, 30/64.0f,
+            34/64.0f, 38/64.0f, 43/64.0f, 47/64.0f, 51/64.0f, 55/64.0f, 60/64.0f, 64/64.0f
+        };
+
+        Vec e0, e1;
+        fitPrincipalAxis(pixels, e0, e1);
+        unsigned char indices[16];
+        float bestError = encodeMode6(pixels, e0, e1, block, indices);
+        for (int iteration = 0; iteration < 2 && 0 < bestError; ++iteration) {
+            // The indices may have been flipped to the swapped endpoints
+            if (!refineEndpoints(pixels, indices, weights, e0, e1))
+                break;
+            unsigned char candidate[16];
+            float error = encodeMode6(pixels, e0, e1, candidate, indices);
+            if (bestError <= error)
+                break;
+            std::memcpy(block, candidate, 16);
+            bestError = error;
+        }
+    }
+
+    bool decompressBC7Block(const unsigned char* block, unsigned char rgba[64])
+    {
+        BitReader reader(block);
+        if (reader.read(7) != (1 << 6))
+            return false;
+        int v0[4], v1[4];
+        for (int c = 0; c < 4; ++c) {
+            v0[c] = reader.read(7) << 1;
+            v1[c] = reader.read(7) << 1;
+        }
+        int p0 = reader.read(1);
+        int p1 = reader.read(1);
+        for (int c = 0; c < 4; ++c) {
+            v0[c] |= p0;
+            v1[c] |= p1;
+        }
+        int palette[16][4];
+        mode6Palette(v0, v1, palette);
+        for (int i = 0; i < 16; ++i) {
+            const int* entry = palette[reader.read(i == 0 ? 3 : 4)];
+            for (int c = 0; c < 4; ++c)
+                rgba[4*i + c] = (unsigned char)entry[c];
+        }
+        return true;
+    }
+}
+
+unsigned
+getBlockSize(Format format)
+{
+    return format == BC1 ? 8 : 16;
+}
+
+std::size_t
+getCompressedSize(Format format, unsigned width, unsigned height)
+{
+    return std::size_t((width + 3)/4)*((height + 3)/4)*getBlockSize(format);
+}
+
+void
+compressBlock(Format format, const unsigned char rgba[64], unsigned char* block)
+{
+    Vec pixels[16];
+    switch (format) {
+    case BC1:
+        loadBlock(rgba, false, pixels);
+        compressColorBlock(pixels, block);
+        break;
+    case BC2:
+        compressExplicitAlpha(rgba, block);
+        loadBlock(rgba, false, pixels);
+        compressColorBlock(pixels, block + 8);
+        break;
+    case BC3:
+        compressInterpolatedAlpha(rgba, block);
+        loadBlock(rgba, false, pixels);
+        compressColorBlock(pixels, block + 8);
+        break;
+    case BC7:
+        loadBlock(rgba, true, pixels);
+        compressBC7Block(pixels, block);
+        break;
+    }
+}
+
+bool
+decompressBlock(Format format, const unsigned char* block, unsigned char rgba[64])
+{
+    switch (format) {
+    case BC1:
+        decompressColorBlock(block, false, rgba);
+        return true;
+    case BC2:
+        decompressColorBlock(block + 8, true, rgba);
+        decompressExplicitAlpha(block, rgba);
+        return true;
+    case BC3:
+        decompressColorBlock(block + 8, true, rgba);
+        decompressInterpolatedAlpha(block, rgba);
+        return true;
+    case BC7:
+        return decompressBC7Block(block, rgba);
+    }
+    return false;
+}
+
+void
+compressImage(Format format, const unsigned char* rgba, unsigned width,
+              unsigned height, std::size_t rowStep, unsigned char* blocks)
+{
+    if (!width || !height)
+        return;
+
+    unsigned blocksWide = (width + 3)/4;
+    unsigned blocksHigh = (height + 3)/4;
+    unsigned blockSize = getBlockSize(format);
+    ImageKernels::forEachBand(blocksHigh, 4*rowStep*EncodeCost, [&](unsigned begin, unsigned end) {
+        unsigned char pixels[64];
+        for (unsigned by = begin; by < end; ++by) {
+            unsigned char* block = blocks + std::size_t(by)*blocksWide*blockSize;
+            for (unsigned bx = 0; bx < blocksWide; ++bx, block += blockSize) {
+                // Partial blocks repeat the last row and column
+                for (unsigned y = 0; y < 4; ++y) {
+                    unsigned sy = std::min(4*by + y, height - 1);
+                    const unsigned char* row = rgba + sy*rowStep;
+                    for (unsigned x = 0; x < 4; ++x) {
+                        unsigned sx = std::min(4*bx + x, width - 1);
+                        std::memcpy(pixels + 16*y + 4*x, row + 4*sx, 4);
+                    }
+                }
+                compressBlock(format, pixels, block);
+            }
+        }
+    });
+}
+
+bool
+decompressImage(Format format, const unsigned char* blocks, unsigned width,
+                unsigned height, unsigned char* rgba)
+{
+    unsigned blocksWide = (width + 3)/4;
+    unsigned blocksHigh = (height + 3)/4;
+    unsigned blockSize = getBlockSize(format);
+    unsigned char pixels[64];
+    for (unsigned by = 0; by < blocksHigh; ++by) {
+        for (unsigned bx = 0; bx < blocksWide; ++bx) {
+            const unsigned char* block = blocks + (std::size_t(by)*blocksWide + bx)*blockSize;
+            if (!decompressBlock(format, block, pixels))
+                return false;
+            for (unsigned y = 0; y < 4 && 4*by + y < height; ++y) {
+                for (unsigned x = 0; x < 4 && 4*bx + x < width; ++x) {
+                    std::memcpy(rgba + 4*(std::size_t(4*by + y)*width + 4*bx + x),
+                                pixels + 16*y + 4*x, 4);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+}
+}
@@ -0,0 +1,80 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef SIMGEAR_BLOCKCOMPRESSION_HXX
+#define SIMGEAR_BLOCKCOMPRESSION_HXX 1
+
+#include <cstddef>
+
+namespace simgear
+{
+/**
+ * CPU encoders for the block compressed texture formats, so textures can
+ * be compressed in the loader threads and stored in the texture cache
+ * instead of being compressed by the driver at upload time.
+ *
+ * The encoders fit the endpoints along the principal axis of the block
+ * colors and refine them with a least squares step. The palette search
+ * compares a pixel against four palette entries at once with simd4_t.
+ * BC7 only uses mode 6, one RGBA subset with 4 bit indices, which is
+ * fast to encode and still better than BC3 for most textures.
+ *
+ * Images are 8 bit RGBA, rows rowStep bytes apart. Sizes that are not a
+ * multiple of four repeat the last row and column in the partial blocks.
+ */
+namespace BlockCompression
+{
+    enum Format {
+        BC1,    ///< DXT1, opaque RGB, 8 bytes per block
+        BC2,    ///< DXT3, explicit 4 bit alpha, 16 bytes per block
+        BC3,    ///< DXT5, interpolated alpha, 16 bytes per block
+        BC7     ///< BPTC, mode 6 blocks, 16 bytes per block
+    };
+
+    /** Bytes per 4x4 block. */
+    unsigned getBlockSize(Format format);
+
+    /** Bytes of an image of width times height pixels. */
+    std::size_t getCompressedSize(Format format, unsigned width,
+                                  unsigned height);
+
+    /** Encode one block of 16 RGBA pixels, row by row. */
+    void compressBlock(Format format, const unsigned char rgba[64],
+                       unsigned char* block);
+
+    /**
+     * Decode one block into 16 RGBA pixels. BC7 blocks in other modes
+     * than mode 6 are not decoded, this returns false for them.
+     */
+    bool decompressBlock(Format format, const unsigned char* block,
+                         unsigned char rgba[64]);
+
+    /**
+     * Encode an image. The rows of blocks are spread over threads the way
+     * ImageKernels::forEachBand does, the result does not depend on that.
+     */
+    void compressImage(Format format, const unsigned char* rgba,
+                       unsigned width, unsigned height, std::size_t rowStep,
+                       unsigned char* blocks);
+
+    /** Decode an image into tightly packed RGBA rows. */
+    bool decompressImage(Format format, const unsigned char* blocks,
+                         unsigned width, unsigned height,
+                         unsigned char* rgba);
+}
+}
+
+#endif
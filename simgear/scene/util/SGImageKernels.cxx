@@ -0,0 +1,604 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include "SGImageKernels.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+#include <simgear/math/simd.hxx>
+
+namespace simgear
+{
+namespace ImageKernels
+{
+namespace
+{
+    typedef simd4_t<float,4> Color;
+
+    std::atomic<bool> s_enabled(true);
+    std::atomic<unsigned> s_maxThreads(0);
+
+    // Below this many bytes per band handing it to another thread costs
+    // more than it saves
+    const std::size_t MinBandBytes = 256*1024;
+
+    // The bands of one forEachBand call
+    struct BandJob {
+        BandJob() : _next(0), _pending(0) {}
+
+        const std::function<void(unsigned, unsigned)>* _func;
+        unsigned _count;
+        unsigned _numBands;
+        unsigned _next;         // first band nobody claimed yet
+        unsigned _pending;      // bands claimed and not finished
+        std::exception_ptr _error;
+    };
+
+    // Threads running bands for all callers of forEachBand, started on the
+    // first use. A caller runs bands of its own job too, until none is
+    // left, so nested calls and a pool without threads work as well.
+    class BandPool {
+    public:
+        static BandPool& instance()
+        {
+            static BandPool pool;
+            return pool;
+        }
+
+        // Runs all bands of job, rethrows the first exception of any band
+        void run(BandJob& job)
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _jobs.push_back(&job);
+            _wake.notify_all();
+            while (runBand(lock, job))
+                ;
+            _done.wait(lock, [&job] { return job._pending == 0; });
+            lock.unlock();
+            if (job._error)
+                std::rethrow_exception(job._error);
+        }
+
+    private:
+        BandPool() :
+            _quit(false)
+        {
+            unsigned numThreads = std::thread::hardware_concurrency();
+            for (unsigned i = 1; i < numThreads; ++i) {
+                try {
+                    _threads.emplace_back(&BandPool::workerFunc, this);
+                } catch (const std::system_error&) {
+                    break;
+                }
+            }
+        }
+
+        ~BandPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _quit = true;
+            }
+            _wake.notify_all();
+            for (auto& t : _threads)
+                t.join();
+        }
+
+        void workerFunc()
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            for (;;) {
+                _wake.wait(lock, [this] { return _quit || !_jobs.empty(); });
+                if (_quit)
+                    return;
+                runBand(lock, *_jobs.front());
+            }
+        }
+
+        // Claims and runs the next band of job with the lock released.
+        // Returns false if all bands are claimed. After an exception the
+        // bands nobody started yet are skipped.
+        bool runBand(std::unique_lock<std::mutex>& lock, BandJob& job)
+        {
+            if (job._next == job._numBands)
+                return false;
+            unsigned band = job._next++;
+            ++job._pending;
+            if (job._next == job._numBands)
+                _jobs.erase(std::find(_jobs.begin(), _jobs.end(), &job));
+            lock.unlock();
+
+            std::exception_ptr error;
+            try {
+                (*job._func)(unsigned(std::size_t(band)*job._count/job._numBands),
+                             unsigned(std::size_t(band + 1)*job._count/job._numBands));
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            lock.lock();
+            if (error) {
+                if (!job._error)
+                    job._error = error;
+                if (job._next != job._numBands) {
+                    job._next = job._numBands;
+                    _jobs.erase(std::find(_jobs.begin(), _jobs.end(), &job));
+                }
+            }
+            // The caller may return as soon as it sees no pending band,
+            // job must not be used after this
+            if (--job._pending == 0)
+                _done.notify_all();
+            return true;
+        }
+
+        std::vector<std::thread> _threads;
+        std::mutex _mutex;
+        std::condition_variable _wake;
+        std::condition_variable _done;
+        std::deque<BandJob*> _jobs;
+        bool _quit;
+    };
+
+    inline Color lerp(const Color& c0, const Color& c1, float weight)
+    {
+        return c0*(1.0f - weight) + c1*weight;
+    }
+
+    // The alpha is computed like PixelReader does, so the threshold
+    // comparisons of featherLine give the same answers
+    struct PixelRGBA8 {
+        enum { Size = 4 };
+
+        static Color load(const unsigned char* p)
+        {
+            return Color(float(p[0]), float(p[1]), float(p[2]), float(p[3]))*(1.0f/255.0f);
+        }
+        static float alpha(const unsigned char* p)
+        {
+            return float(p[3]*(1.0/255.0));
+        }
+        static void store(unsigned char* p, Color c)
+        {
+            c *= 255.0f;
+            c += 0.5f;
+            c = simd4::min(simd4::max(c, Color(0.0f)), Color(255.0f));
+            p[0] = (unsigned char)c[0];
+            p[1] = (unsigned char)c[1];
+            p[2] = (unsigned char)c[2];
+            p[3] = (unsigned char)c[3];
+        }
+    };
+
+    struct PixelRGB8 {
+        enum { Size = 3 };
+
+        static Color load(const unsigned char* p)
+        {
+            const float scale = 1.0f/255.0f;
+            return Color(p[0]*scale, p[1]*scale, p[2]*scale, 1.0f);
+        }
+        static float alpha(const unsigned char*)
+        {
+            return 1.0f;
+        }
+        static void store(unsigned char* p, Color c)
+        {
+            c *= 255.0f;
+            c += 0.5f;
+            c = simd4::min(simd4::max(c, Color(0.0f)), Color(255.0f));
+            p[0] = (unsigned char)c[0];
+            p[1] = (unsigned char)c[1];
+            p[2] = (unsigned char)c[2];
+        }
+    };
+
+    struct PixelRGBA32F {
+        enum { Size = 16 };
+
+        static Color load(const unsigned char* p)
+        {
+            float v[4];
+            std::memcpy(v, p, sizeof(v));
+            return Color(v);
+        }
+        static float alpha(const unsigned char* p)
+        {
+            float a;
+            std::memcpy(&a, p + 3*sizeof(float), sizeof(a));
+            return a;
+        }
+        static void store(unsigned char* p, const Color& c)
+        {
+            std::memcpy(p, c.ptr(), 4*sizeof(float));
+        }
+    };
+
+    template<typename P>
+    void resizeRowT(unsigned char* dest, const unsigned char* row0,
+                    const unsigned char* row1, float weight,
+                    const ResizeColumns& columns)
+    {
+        for (std::size_t i = 0; i < columns.size(); ++i, dest += P::Size) {
+            const ResizeColumn& column = columns[i];
+            const unsigned char* p0 = row0 + column._col0*P::Size;
+            const unsigned char* p1 = row0 + column._col1*P::Size;
+            Color color = lerp(P::load(p0), P::load(p1), column._weight);
+            if (weight != 0.0f) {
+                p0 = row1 + column._col0*P::Size;
+                p1 = row1 + column._col1*P::Size;
+                Color color1 = lerp(P::load(p0), P::load(p1), column._weight);
+                color = lerp(color, color1, weight);
+            }
+            P::store(dest, color);
+        }
+    }
+
+    template<typename P>
+    void mixRowT(unsigned char* dest, const unsigned char* src,
+                 unsigned width, float a, bool srcHasAlpha, bool destHasAlpha)
+    {
+        for (unsigned i = 0; i < width; ++i, dest += P::Size, src += P::Size) {
+            Color s = P::load(src);
+            Color d = P::load(dest);
+            float sa = srcHasAlpha ? a*s[3] : a;
+            float da = destHasAlpha ? d[3] : 1.0f;
+            Color color = lerp(d, s, sa);
+            color[3] = std::max(sa, da);
+            P::store(dest, color);
+        }
+    }
+
+    template<typename P>
+    void premultiplyRowT(unsigned char* row, unsigned width)
+    {
+        for (unsigned i = 0; i < width; ++i, row += P::Size) {
+            Color color = P::load(row);
+            float a = color[3];
+            color *= a;
+            color[3] = a;
+            P::store(row, color);
+        }
+    }
+
+    template<typename P>
+    void bumpMapRowT(unsigned char* dest, const unsigned char* above,
+                     const unsigned char* row, const unsigned char* below,
+                     unsigned width)
+    {
+        const Color mid(0.5f);
+        if (!above || !below || width < 3) {
+            for (unsigned s = 0; s < width; ++s)
+                P::store(dest + s*P::Size, mid);
+            return;
+        }
+
+        // The emboss kernel
+        //   -1 -1  0
+        //   -1  0  1
+        //    0  1  1
+        // biased for bump mapping and weighted to grey
+        const Color grey(0.2989f, 0.5870f, 0.1140f, 1.0f);
+        P::store(dest, mid);
+        for (unsigned s = 1; s < width - 1; ++s) {
+            unsigned left = (s - 1)*P::Size;
+            unsigned center = s*P::Size;
+            unsigned right = (s + 1)*P::Size;
+            Color sum = P::load(below + center) + P::load(below + right)
+                + P::load(row + right) - P::load(above + left)
+                - P::load(above + center) - P::load(row + left);
+            sum *= 1.0f/9.0f;
+            sum += 0.5f;
+            sum *= grey;
+            sum[3] = P::load(row + center)[3];
+            P::store(dest + center, sum);
+        }
+        P::store(dest + (width - 1)*P::Size, mid);
+    }
+
+    template<typename P>
+    void featherLineT(unsigned char* first, unsigned count,
+                      std::ptrdiff_t step, float maxAlpha)
+    {
+        unsigned char* pixel = first;
+        for (unsigned i = 0; i < count; ++i, pixel += step) {
+            if (maxAlpha < P::alpha(pixel))
+                continue;
+            if (i + 1 < count && maxAlpha < P::alpha(pixel + step)) {
+                std::memcpy(pixel, pixel + step, P::Size);
+                continue;
+            }
+            if (0 < i && maxAlpha < P::alpha(pixel - step)) {
+                std::memcpy(pixel, pixel - step, P::Size);
+                return;
+            }
+        }
+    }
+
+    template<typename P>
+    void mipmapRowT(unsigned char* dest, const unsigned char* row0,
+                    const unsigned char* row1, unsigned srcWidth,
+                    const int functions[4])
+    {
+        unsigned width = std::max(srcWidth >> 1, 1u);
+        for (unsigned i = 0; i < width; ++i, dest += P::Size) {
+            unsigned s = 2*i;
+            Color reductions[MAX + 1];
+            Color& sum = reductions[SUM];
+            Color& product = reductions[PRODUCT];
+            Color& minimum = reductions[MIN];
+            Color& maximum = reductions[MAX];
+
+            sum = product = minimum = maximum = P::load(row0 + s*P::Size);
+            unsigned count = 1;
+            const unsigned char* others[3];
+            unsigned numOthers = 0;
+            if (s + 1 < srcWidth)
+                others[numOthers++] = row0 + (s + 1)*P::Size;
+            if (row1) {
+                others[numOthers++] = row1 + s*P::Size;
+                if (s + 1 < srcWidth)
+                    others[numOthers++] = row1 + (s + 1)*P::Size;
+            }
+            for (unsigned j = 0; j < numOthers; ++j, ++count) {
+                Color color = P::load(others[j]);
+                sum += color;
+                product *= color;
+                minimum = simd4::min(minimum, color);
+                maximum = simd4::max(maximum, color);
+            }
+            reductions[AVERAGE] = sum;
+            reductions[AVERAGE] /= float(count);
+
+            Color result;
+            for (int c = 0; c < 4; ++c) {
+                int function = functions[c];
+                if (AVERAGE <= function && function <= MAX)
+                    result[c] = reductions[function][c];
+            }
+            P::store(dest, result);
+        }
+    }
+}
+
+void
+setEnabled(bool enabled)
+{
+    s_enabled = enabled;
+}
+
+bool
+isEnabled()
+{
+    return s_enabled;
+}
+
+void
+setMaxThreads(unsigned maxThreads)
+{
+    s_maxThreads = maxThreads;
+}
+
+unsigned
+getMaxThreads()
+{
+    return s_maxThreads;
+}
+
+void
+forEachBand(unsigned count, std::size_t bytesPerItem,
+            const std::function<void(unsigned, unsigned)>& func)
+{
+    unsigned numThreads = s_maxThreads;
+    if (!numThreads)
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::size_t numBands = count*bytesPerItem/MinBandBytes;
+    numBands = std::min(numBands, std::size_t(numThreads));
+    numBands = std::min(numBands, std::size_t(count));
+    if (numBands <= 1) {
+        func(0, count);
+        return;
+    }
+
+    BandJob job;
+    job._func = &func;
+    job._count = count;
+    job._numBands = unsigned(numBands);
+    BandPool::instance().run(job);
+}
+
+void
+computeResizeColumns(unsigned inSize, unsigned outSize, bool bilinear,
+                     ResizeColumns& columns)
+{
+    columns.resize(outSize);
+    for (unsigned i = 0; i < outSize; ++i) {
+        float input = float(i)/float(outSize)*float(inSize);
+        if (input >= float(inSize))
+            input = float(inSize - 1);
+        else if (input < 0)
+            input = 0;
+
+        ResizeColumn& column = columns[i];
+        if (bilinear) {
+            int colMin = std::max(int(std::floor(input)), 0);
+            int colMax = std::max(std::min(int(std::ceil(input)), int(inSize) - 1), 0);
+            if (colMin > colMax)
+                colMin = colMax;
+            column._col0 = unsigned(colMin);
+            column._col1 = unsigned(colMax);
+            column._weight = colMin == colMax ? 0.0f : input - float(colMin);
+        } else {
+            int col = int(input);
+            if (std::ceil(input) - input < input - float(col))
+                col = std::min(col + 1, int(inSize) - 1);
+            column._col0 = column._col1 = unsigned(col);
+            column._weight = 0.0f;
+        }
+    }
+}
+
+bool
+resizeRow(PixelLayout layout, unsigned char* dest, const unsigned char* row0,
+          const unsigned char* row1, float weight,
+          const ResizeColumns& columns)
+{
+    switch (layout) {
+    case RGBA8:
+        resizeRowT<PixelRGBA8>(dest, row0, row1, weight, columns);
+        return true;
+    case RGB8:
+        resizeRowT<PixelRGB8>(dest, row0, row1, weight, columns);
+        return true;
+    case RGBA32F:
+        resizeRowT<PixelRGBA32F>(dest, row0, row1, weight, columns);
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool
+mixRow(PixelLayout layout, unsigned char* dest, const unsigned char* src,
+       unsigned width, float a, bool srcHasAlpha, bool destHasAlpha)
+{
+    switch (layout) {
+    case RGBA8:
+        mixRowT<PixelRGBA8>(dest, src, width, a, srcHasAlpha, destHasAlpha);
+        return true;
+    case RGB8:
+        mixRowT<PixelRGB8>(dest, src, width, a, srcHasAlpha, destHasAlpha);
+        return true;
+    case RGBA32F:
+        mixRowT<PixelRGBA32F>(dest, src, width, a, srcHasAlpha, destHasAlpha);
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool
+premultiplyRow(PixelLayout layout, unsigned char* row, unsigned width)
+{
+    switch (layout) {
+    case RGBA8:
+        premultiplyRowT<PixelRGBA8>(row, width);
+        return true;
+    case RGB8:
+        // Opaque, nothing to do
+        return true;
+    case RGBA32F:
+        premultiplyRowT<PixelRGBA32F>(row, width);
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool
+bumpMapRow(PixelLayout layout, unsigned char* dest, const unsigned char* above,
+           const unsigned char* row, const unsigned char* below,
+           unsigned width)
+{
+    switch (layout) {
+    case RGBA8:
+        bumpMapRowT<PixelRGBA8>(dest, above, row, below, width);
+        return true;
+    case RGB8:
+        bumpMapRowT<PixelRGB8>(dest, above, row, below, width);
+        return true;
+    case RGBA32F:
+        bumpMapRowT<PixelRGBA32F>(dest, above, row, below, width);
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool
+sharpenRow(PixelLayout layout, unsigned char* dest, const unsigned char* above,
+           const unsigned char* row, const unsigned char* below,
+           unsigned width)
+{
+    // The filter works on the bytes of four byte pixels, which is all
+    // the generic path can do as well
+    if (layout != RGBA8)
+        return false;
+    if (width < 3)
+        return true;
+
+    // Plain integer arithmetic on the bytes of the row, which the
+    // compiler vectorizes
+    for (unsigned i = 4; i < (width - 1)*4; ++i) {
+        int sum = 5*row[i] - row[i - 4] - row[i + 4] - above[i] - below[i];
+        dest[i] = (unsigned char)std::min(std::max(sum, 0), 255);
+    }
+    return true;
+}
+
+bool
+featherLine(PixelLayout layout, unsigned char* first, unsigned count,
+            std::ptrdiff_t step, float maxAlpha)
+{
+    switch (layout) {
+    case RGBA8:
+        featherLineT<PixelRGBA8>(first, count, step, maxAlpha);
+        return true;
+    case RGB8:
+        featherLineT<PixelRGB8>(first, count, step, maxAlpha);
+        return true;
+    case RGBA32F:
+        featherLineT<PixelRGBA32F>(first, count, step, maxAlpha);
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool
+mipmapRow(PixelLayout layout, unsigned char* dest, const unsigned char* row0,
+          const unsigned char* row1, unsigned srcWidth, const int functions[4])
+{
+    switch (layout) {
+    case RGBA8:
+        mipmapRowT<PixelRGBA8>(dest, row0, row1, srcWidth, functions);
+        return true;
+    case RGB8:
+        mipmapRowT<PixelRGB8>(dest, row0, row1, srcWidth, functions);
+        return true;
+    case RGBA32F:
+        mipmapRowT<PixelRGBA32F>(dest, row0, row1, srcWidth, functions);
+        return true;
+    default:
+        return false;
+    }
+}
+
+}
+}
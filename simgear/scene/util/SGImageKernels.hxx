@@ -0,0 +1,144 @@
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef SIMGEAR_IMAGEKERNELS_HXX
+#define SIMGEAR_IMAGEKERNELS_HXX 1
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace simgear
+{
+/**
+ * Row kernels for the pixel formats textures are loaded in.
+ *
+ * The image operations of ImageUtils and the mipmap generation go through
+ * PixelReader/PixelWriter, which costs a function pointer call and an
+ * osg::Vec4 per pixel. For the common formats the operations work on
+ * whole rows here instead: a pixel is loaded into one simd4_t<float,4>
+ * and all channels are computed at once.
+ *
+ * 8 bit values are rounded to the nearest value when written back, the
+ * generic path truncates. Results may thus differ by one step.
+ *
+ * All kernels return false for GENERIC, the caller then uses the
+ * PixelReader/PixelWriter path.
+ */
+namespace ImageKernels
+{
+    enum PixelLayout {
+        GENERIC,
+        RGBA8,      ///< GL_RGBA, GL_UNSIGNED_BYTE, normalized
+        RGB8,       ///< GL_RGB, GL_UNSIGNED_BYTE, normalized
+        RGBA32F     ///< GL_RGBA, GL_FLOAT
+    };
+
+    /** Enable or disable the kernels, mainly to compare against the generic path. */
+    void setEnabled(bool enabled);
+    bool isEnabled();
+
+    /** Limit the threads used by forEachBand, 0 uses all cores. */
+    void setMaxThreads(unsigned maxThreads);
+    unsigned getMaxThreads();
+
+    /**
+     * Split the range [0, count) into contiguous bands and call
+     * func(begin, end) for each of them. The bands run on a set of threads
+     * kept for all calls if the whole work, count times bytesPerItem, is
+     * large enough to pay for that, otherwise on the calling thread.
+     * Returns when all bands are done. An exception thrown by func is
+     * rethrown here, bands not started by then are skipped.
+     */
+    void forEachBand(unsigned count, std::size_t bytesPerItem,
+                     const std::function<void(unsigned, unsigned)>& func);
+
+    /** Source columns and weight of one output pixel of resizeRow. */
+    struct ResizeColumn {
+        unsigned _col0;
+        unsigned _col1;
+        float _weight;
+    };
+    typedef std::vector<ResizeColumn> ResizeColumns;
+
+    /**
+     * Columns of resizeRow, in the way ImageUtils::resizeImage samples:
+     * blended between the two neighbouring columns or the nearest one.
+     */
+    void computeResizeColumns(unsigned inSize, unsigned outSize,
+                              bool bilinear, ResizeColumns& columns);
+
+    /** dest = row0*(1 - weight) + row1*weight sampled at the columns. */
+    bool resizeRow(PixelLayout layout, unsigned char* dest,
+                   const unsigned char* row0, const unsigned char* row1,
+                   float weight, const ResizeColumns& columns);
+
+    /** Blend src over dest with opacity a, like ImageUtils::mix. */
+    bool mixRow(PixelLayout layout, unsigned char* dest,
+                const unsigned char* src, unsigned width, float a,
+                bool srcHasAlpha, bool destHasAlpha);
+
+    /** Multiply the colors with the alpha. */
+    bool premultiplyRow(PixelLayout layout, unsigned char* row,
+                        unsigned width);
+
+    /**
+     * The emboss filter of ImageUtils::createBumpMap for the inner pixels
+     * of row, with above and below being the neighbouring rows. The first
+     * and the last pixel are set to the neutral value.
+     */
+    bool bumpMapRow(PixelLayout layout, unsigned char* dest,
+                    const unsigned char* above, const unsigned char* row,
+                    const unsigned char* below, unsigned width);
+
+    /**
+     * The sharpening filter of ImageUtils::createSharpenedImage for the
+     * inner pixels of row. The first and the last pixel are not written.
+     */
+    bool sharpenRow(PixelLayout layout, unsigned char* dest,
+                    const unsigned char* above, const unsigned char* row,
+                    const unsigned char* below, unsigned width);
+
+    /**
+     * One line of ImageUtils::featherAlphaRegions. The line starts at
+     * first and has count pixels, step bytes apart, so this does rows as
+     * well as columns.
+     */
+    bool featherLine(PixelLayout layout, unsigned char* first,
+                     unsigned count, std::ptrdiff_t step, float maxAlpha);
+
+    /** The reductions of the mipmap functions, in the order of MipMapFunction. */
+    enum Reduction {
+        AVERAGE = 1,
+        SUM,
+        PRODUCT,
+        MIN,
+        MAX
+    };
+
+    /**
+     * One row of the next mipmap level from the rows row0 and row1 of
+     * srcWidth pixels. row1 is null if the level has a single row. Each
+     * channel is reduced with its own function, any other value than a
+     * Reduction writes a zero.
+     */
+    bool mipmapRow(PixelLayout layout, unsigned char* dest,
+                   const unsigned char* row0, const unsigned char* row1,
+                   unsigned srcWidth, const int functions[4]);
+}
+}
+
+#endif
@@ -151,6 +151,22 @@ ImageUtils::createBumpMap(const osg::Image* input)
 
     osg::Image* output = osg::clone(input, osg::CopyOp::DEEP_COPY_ALL);
 
+    ImageKernels::PixelLayout layout = getPixelLayout(input);
+    if (layout != ImageKernels::GENERIC)
+    {
+        unsigned int nt = input->t();
+        ImageKernels::forEachBand(nt, input->getRowStepInBytes(), [&](unsigned begin, unsigned end) {
+            for (unsigned t = begin; t < end; ++t)
+            {
+                bool border = t == 0 || t == nt - 1;
+                ImageKernels::bumpMapRow(layout, output->data(0, t),
+                    border ? 0L : input->data(0, t - 1), input->data(0, t),
+                    border ? 0L : input->data(0, t + 1), input->s());
+            }
+        });
+        return output;
+    }
+
     static const float kernel[] = {
         -1.0, -1.0, 0.0,
         -1.0,  0.0, 1.0,
@@ -248,6 +264,28 @@ ImageUtils::resizeImage(const osg::Image* input,
     {
         memcpy(output->data(), input->data(), input->getTotalSizeInBytes());
     }
+    else if (mipmapLevel == 0 &&
+        getPixelLayout(input) != ImageKernels::GENERIC &&
+        getPixelLayout(input) == getPixelLayout(output.get()))
+    {
+        ImageKernels::PixelLayout layout = getPixelLayout(input);
+        ImageKernels::ResizeColumns columns, rows;
+        ImageKernels::computeResizeColumns(in_s, out_s, bilinear, columns);
+        ImageKernels::computeResizeColumns(in_t, out_t, bilinear, rows);
+
+        for (int layer = 0; layer < input->r(); ++layer)
+        {
+            ImageKernels::forEachBand(out_t, output->getRowStepInBytes(), [&](unsigned begin, unsigned end) {
+                for (unsigned output_row = begin; output_row < end; ++output_row)
+                {
+                    const ImageKernels::ResizeColumn& row = rows[output_row];
+                    ImageKernels::resizeRow(layout, output->data(0, output_row, layer),
+                        input->data(0, row._col0, layer), input->data(0, row._col1, layer),
+                        row._weight, columns);
+                }
+            });
+        }
+    }
     else
     {
         PixelReader read(input);
@@ -705,6 +743,23 @@ ImageUtils::mix(osg::Image* dest, const osg::Image* src, float a)
         return false;
     }
 
+    ImageKernels::PixelLayout layout = getPixelLayout(dest);
+    if (layout != ImageKernels::GENERIC && layout == getPixelLayout(src))
+    {
+        a = osg::clampBetween(a, 0.0f, 1.0f);
+        bool srcHasAlpha = hasAlphaChannel(src);
+        bool destHasAlpha = hasAlphaChannel(dest);
+        for (int r = 0; r < dest->r(); ++r)
+        {
+            ImageKernels::forEachBand(dest->t(), dest->getRowStepInBytes(), [&](unsigned begin, unsigned end) {
+                for (unsigned t = begin; t < end; ++t)
+                    ImageKernels::mixRow(layout, dest->data(0, t, r), src->data(0, t, r),
+                        dest->s(), a, srcHasAlpha, destHasAlpha);
+            });
+        }
+        return true;
+    }
+
     PixelVisitor<MixImage> mixer;
     mixer._a = osg::clampBetween(a, 0.0f, 1.0f);
     mixer._srcHasAlpha = hasAlphaChannel(src); //src->getPixelSizeInBits() == 32;
@@ -787,6 +842,22 @@ ImageUtils::createSharpenedImage(const osg::Image* input)
 {
     int filter[9] = { 0, -1, 0, -1, 5, -1, 0, -1, 0 };
     osg::Image* output = ImageUtils::cloneImage(input);
+
+    if (getPixelLayout(input) == ImageKernels::RGBA8)
+    {
+        for (int r = 0; r < input->r(); ++r)
+        {
+            unsigned int inner = input->t() > 2 ? input->t() - 2 : 0;
+            ImageKernels::forEachBand(inner, input->getRowStepInBytes(), [&](unsigned begin, unsigned end) {
+                for (unsigned t = begin + 1; t < end + 1; ++t)
+                    ImageKernels::sharpenRow(ImageKernels::RGBA8, output->data(0, t, r),
+                        input->data(0, t - 1, r), input->data(0, t, r),
+                        input->data(0, t + 1, r), input->s());
+            });
+        }
+        return output;
+    }
+
     for (int r = 0; r<input->r(); ++r)
     {
         for (int t = 1; t<input->t() - 1; t++)
@@ -798,7 +869,7 @@ ImageUtils::createSharpenedImage(const osg::Image* input)
                     *(int*)input->data(s - 1,t  ,r), *(int*)input->data(s,t  ,r), *(int*)input->data(s + 1,t  ,r),
                     *(int*)input->data(s - 1,t + 1,r), *(int*)input->data(s,t + 1,r), *(int*)input->data(s + 1,t + 1,r) };
 
-                int shifts[4] = { 0, 8, 16, 32 };
+                int shifts[4] = { 0, 8, 16, 24 };
 
                 for (int c = 0; c<4; c++) // components
                 {
@@ -1141,6 +1212,85 @@ ImageUtils::computeTextureCompressionMode(const osg::Image*                 imag
 //    return true;
 //}
 
+osg::Image*
+ImageUtils::compressImage(const osg::Image* image, BlockCompression::Format format)
+{
+    if (!image || !image->data() || isCompressed(image) || image->r() != 1)
+        return 0L;
+
+    GLenum compressedFormat;
+    switch (format)
+    {
+    case BlockCompression::BC1: compressedFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT; break;
+    case BlockCompression::BC2: compressedFormat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; break;
+    case BlockCompression::BC3: compressedFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+    default:                    compressedFormat = GL_COMPRESSED_RGBA_BPTC_UNORM_ARB; break;
+    }
+
+    unsigned int numLevels = image->getNumMipmapLevels();
+    osg::Image::MipmapDataType offsets;
+    std::size_t total = 0;
+    for (unsigned int m = 0; m < numLevels; ++m)
+    {
+        if (m > 0)
+            offsets.push_back((unsigned int)total);
+        total += BlockCompression::getCompressedSize(format,
+            osg::maximum(image->s() >> m, 1), osg::maximum(image->t() >> m, 1));
+    }
+
+    unsigned char* data = new unsigned char[total];
+    for (unsigned int m = 0; m < numLevels; ++m)
+    {
+        int s = osg::maximum(image->s() >> m, 1);
+        int t = osg::maximum(image->t() >> m, 1);
+
+        // each level on its own, since convert() only does the first one
+        osg::ref_ptr<const osg::Image> level = image;
+        if (m > 0)
+        {
+            osg::Image* view = new osg::Image;
+            view->setImage(s, t, 1, image->getInternalTextureFormat(), image->getPixelFormat(),
+                image->getDataType(), const_cast<unsigned char*>(image->getMipmapData(m)),
+                osg::Image::NO_DELETE, image->getPacking());
+            markAsNormalized(view, isNormalized(image));
+            level = view;
+        }
+        if (level->getPixelFormat() != GL_RGBA || level->getDataType() != GL_UNSIGNED_BYTE)
+        {
+            level = convertToRGBA8(level.get());
+            if (!level.valid())
+            {
+                delete [] data;
+                return 0L;
+            }
+        }
+
+        BlockCompression::compressImage(format, level->data(), s, t,
+            level->getRowStepInBytes(), data + (m > 0 ? offsets[m - 1] : 0));
+    }
+
+    osg::Image* result = new osg::Image;
+    result->setImage(image->s(), image->t(), 1, compressedFormat, compressedFormat,
+        GL_UNSIGNED_BYTE, data, osg::Image::USE_NEW_DELETE);
+    if (!offsets.empty())
+        result->setMipmapLevels(offsets);
+    result->setName(image->getName());
+    result->setFileName(image->getFileName());
+    return result;
+}
+
+osg::Image*
+ImageUtils::compressImage(const osg::Image* image, osg::Texture::InternalFormatMode mode)
+{
+    switch (mode)
+    {
+    case osg::Texture::USE_S3TC_DXT1_COMPRESSION: return compressImage(image, BlockCompression::BC1);
+    case osg::Texture::USE_S3TC_DXT3_COMPRESSION: return compressImage(image, BlockCompression::BC2);
+    case osg::Texture::USE_S3TC_DXT5_COMPRESSION: return compressImage(image, BlockCompression::BC3);
+    default:                                      return 0L;
+    }
+}
+
 bool
 ImageUtils::canConvert(const osg::Image* image, GLenum pixelFormat, GLenum dataType)
 {
@@ -1329,13 +1479,33 @@ ImageUtils::featherAlphaRegions(osg::Image* image, float maxAlpha)
     if (!PixelReader::supports(image) || !PixelWriter::supports(image))
         return false;
 
-    PixelReader read(image);
-    PixelWriter write(image);
-
     int ns = image->s();
     int nt = image->t();
     int nr = image->r();
 
+    ImageKernels::PixelLayout layout = getPixelLayout(image);
+    if (layout != ImageKernels::GENERIC)
+    {
+        unsigned int pixelSize = image->getPixelSizeInBits() / 8;
+        unsigned int rowStep = image->getRowStepInBytes();
+        for (int r = 0; r < nr; ++r)
+        {
+            // all rows first, then all columns
+            ImageKernels::forEachBand(nt, rowStep, [&](unsigned begin, unsigned end) {
+                for (unsigned t = begin; t < end; ++t)
+                    ImageKernels::featherLine(layout, image->data(0, t, r), ns, pixelSize, maxAlpha);
+            });
+            ImageKernels::forEachBand(ns, nt * pixelSize, [&](unsigned begin, unsigned end) {
+                for (unsigned s = begin; s < end; ++s)
+                    ImageKernels::featherLine(layout, image->data(s, 0, r), nt, rowStep, maxAlpha);
+            });
+        }
+        return true;
+    }
+
+    PixelReader read(image);
+    PixelWriter write(image);
+
     osg::Vec4 n;
 
     for (int r = 0; r < nr; ++r)
@@ -1405,6 +1575,19 @@ ImageUtils::convertToPremultipliedAlpha(osg::Image* image)
     if (!PixelReader::supports(image) || !PixelWriter::supports(image))
         return false;
 
+    ImageKernels::PixelLayout layout = getPixelLayout(image);
+    if (layout != ImageKernels::GENERIC)
+    {
+        for (int r = 0; r < image->r(); ++r)
+        {
+            ImageKernels::forEachBand(image->t(), image->getRowStepInBytes(), [&](unsigned begin, unsigned end) {
+                for (unsigned t = begin; t < end; ++t)
+                    ImageKernels::premultiplyRow(layout, image->data(0, t, r), image->s());
+            });
+        }
+        return true;
+    }
+
     PixelReader read(image);
     PixelWriter write(image);
     for (int r = 0; r < image->r(); ++r) {
@@ -1419,6 +1602,27 @@ ImageUtils::convertToPremultipliedAlpha(osg::Image* image)
 }
 
 
+ImageKernels::PixelLayout
+ImageUtils::getPixelLayout(const osg::Image* image)
+{
+    if (!image || !image->data() || !ImageKernels::isEnabled())
+        return ImageKernels::GENERIC;
+
+    if (image->getDataType() == GL_FLOAT)
+        return image->getPixelFormat() == GL_RGBA ? ImageKernels::RGBA32F : ImageKernels::GENERIC;
+
+    if (image->getDataType() != GL_UNSIGNED_BYTE || !isNormalized(image))
+        return ImageKernels::GENERIC;
+
+    switch (image->getPixelFormat())
+    {
+    case GL_RGBA: return ImageKernels::RGBA8;
+    case GL_RGB:  return ImageKernels::RGB8;
+    default:      return ImageKernels::GENERIC;
+    }
+}
+
+
 bool
 ImageUtils::isCompressed(const osg::Image *image)
 {
@@ -1436,6 +1640,7 @@ ImageUtils::isCompressed(const osg::Image *image)
     case(GL_COMPRESSED_RGBA_S3TC_DXT1_EXT):
     case(GL_COMPRESSED_RGBA_S3TC_DXT3_EXT):
     case(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT):
+    case(GL_COMPRESSED_RGBA_BPTC_UNORM_ARB):
     case(GL_COMPRESSED_SIGNED_RED_RGTC1_EXT):
     case(GL_COMPRESSED_RED_RGTC1_EXT):
     case(GL_COMPRESSED_SIGNED_RED_GREEN_RGTC2_EXT):
@@ -27,6 +27,9 @@
 #include <osgDB/ReaderWriter>
 #include <vector>
 
+#include <simgear/scene/util/SGBlockCompression.hxx>
+#include <simgear/scene/util/SGImageKernels.hxx>
+
   //These formats were not added to OSG until after 2.8.3 so we need to define them to use them.
 #ifndef GL_EXT_texture_compression_rgtc
 #define GL_COMPRESSED_RED_RGTC1_EXT                0x8DBB
@@ -35,6 +38,10 @@
 #define GL_COMPRESSED_SIGNED_RED_GREEN_RGTC2_EXT   0x8DBE
 #endif
 
+#ifndef GL_ARB_texture_compression_bptc
+#define GL_COMPRESSED_RGBA_BPTC_UNORM_ARB       0x8E8C
+#endif
+
 #ifndef GL_IMG_texture_compression_pvrtc
 #define GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG      0x8C00
 #define GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG      0x8C01
@@ -294,6 +301,12 @@ namespace simgear
         */
         static bool isCompressed(const osg::Image* image);
 
+        /**
+        * The layout of the ImageKernels row kernels for the image, or GENERIC
+        * if there is no kernel for its format or the kernels are disabled.
+        */
+        static ImageKernels::PixelLayout getPixelLayout(const osg::Image* image);
+
         /**
         * Generated a bump map image for the input image
         */
@@ -312,6 +325,24 @@ namespace simgear
             osg::Texture::InternalFormatMode& out_mode);
 
 
+        /**
+        * Compresses an image and its mipmaps on the CPU, so that it does not
+        * have to be compressed by the driver on upload. Returns a new image
+        * or NULL if the image is already compressed, is 3D or cannot be
+        * converted to RGBA8. BC1 drops the alpha channel.
+        */
+        static osg::Image* compressImage(
+            const osg::Image* image,
+            BlockCompression::Format format);
+
+        /**
+        * Same for the S3TC modes: DXT1 is BC1, DXT3 is BC2 and DXT5 is BC3.
+        * Returns NULL for other modes.
+        */
+        static osg::Image* compressImage(
+            const osg::Image* image,
+            osg::Texture::InternalFormatMode mode);
+
         /**
         * Bicubic upsampling in a quadrant. Target image is already allocated.
         */
@@ -45,6 +45,10 @@ public:
     SGPath getTextureCompressionPath() const { return _TextureCompressionPath; }
     void setTextureCompressionPath(const SGPath path) { _TextureCompressionPath = path; }
 
+    /// Where named effects are kept merged across runs, empty for nowhere
+    SGPath getEffectCachePath() const { return _EffectCachePath; }
+    void setEffectCachePath(const SGPath path) { _EffectCachePath = path; }
+
     bool getTextureCacheActive() const { return _TextureCacheActive; }
     void setTextureCacheActive(const bool val) { _TextureCacheActive = val; }
 
@@ -121,6 +125,7 @@ private:
     TextureCompression _textureCompression;
     int _MaxTextureSize;
     SGPath _TextureCompressionPath;
+    SGPath _EffectCachePath;
     bool _TextureCacheCompressionActive;
     bool _TextureCacheCompressionActiveTransparent;
     bool _TextureCacheActive;
@@ -0,0 +1,183 @@
+#include <simgear_config.h>
+#include <simgear/compiler.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <simgear/math/sg_random.h>
+#include <simgear/misc/test_macros.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include "SGBlockCompression.hxx"
+#include "SGImageKernels.hxx"
+
+using namespace simgear;
+using namespace simgear::BlockCompression;
+
+typedef std::vector<unsigned char> Pixels;
+
+const char* formatNames[] = { "BC1", "BC2", "BC3", "BC7" };
+
+// Smooth color gradients with some detail and noise, and a soft alpha
+// mask, roughly like a terrain texture with a cut out
+Pixels createTexture(unsigned width, unsigned height)
+{
+    Pixels pixels(4*width*height);
+    for (unsigned y = 0; y < height; ++y) {
+        for (unsigned x = 0; x < width; ++x) {
+            float u = float(x)/width;
+            float v = float(y)/height;
+            float detail = 20*std::sin(40*u)*std::cos(30*v);
+            float noise = float(16*sg_random()) - 8;
+            float color[4] = {
+                60 + 120*u + detail + noise,
+                90 + 80*v - detail + noise,
+                40 + 60*u*v + noise,
+                255*(0.5f + 0.5f*std::sin(6*u + 4*v))
+            };
+            for (int c = 0; c < 4; ++c) {
+                float value = std::min(std::max(color[c], 0.0f), 255.0f);
+                pixels[4*(y*width + x) + c] = (unsigned char)value;
+            }
+        }
+    }
+    return pixels;
+}
+
+double psnr(const Pixels& lhs, const Pixels& rhs, bool withAlpha)
+{
+    double error = 0;
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+        if (!withAlpha && i % 4 == 3)
+            continue;
+        double d = double(lhs[i]) - double(rhs[i]);
+        error += d*d;
+        ++count;
+    }
+    if (error == 0)
+        return 99;
+    return 10*std::log10(255.0*255.0/(error/count));
+}
+
+Pixels roundTrip(Format format, const Pixels& pixels, unsigned width, unsigned height)
+{
+    std::vector<unsigned char> blocks(getCompressedSize(format, width, height));
+    compressImage(format, pixels.data(), width, height, 4*width, blocks.data());
+    Pixels decoded(pixels.size());
+    SG_VERIFY(decompressImage(format, blocks.data(), width, height, decoded.data()));
+    return decoded;
+}
+
+void testSizes()
+{
+    SG_CHECK_EQUAL(getCompressedSize(BC1, 256, 256), 32768u);
+    SG_CHECK_EQUAL(getCompressedSize(BC3, 256, 256), 65536u);
+    SG_CHECK_EQUAL(getCompressedSize(BC7, 1, 1), 16u);
+    SG_CHECK_EQUAL(getCompressedSize(BC1, 13, 7), 4u*2u*8u);
+}
+
+void testSolidBlocks()
+{
+    for (int i = 0; i < 100; ++i) {
+        unsigned char color[4];
+        for (int c = 0; c < 4; ++c)
+            color[c] = (unsigned char)(256*sg_random());
+        unsigned char rgba[64];
+        for (int j = 0; j < 16; ++j)
+            std::memcpy(rgba + 4*j, color, 4);
+
+        for (int format = BC1; format <= BC7; ++format) {
+            unsigned char block[16];
+            unsigned char decoded[64];
+            compressBlock(Format(format), rgba, block);
+            SG_VERIFY(decompressBlock(Format(format), block, decoded));
+            // 565 colors are off by up to half a step, BC7 by the p-bit,
+            // explicit alpha by half a step of 17
+            int colorError = format == BC7 ? 1 : 5;
+            int alphaError = format == BC1 ? 255 : format == BC2 ? 8 : format == BC3 ? 0 : 1;
+            for (int j = 0; j < 16; ++j) {
+                for (int c = 0; c < 3; ++c)
+                    SG_VERIFY(std::abs(decoded[4*j + c] - color[c]) <= colorError);
+                SG_VERIFY(std::abs(decoded[4*j + 3] - color[3]) <= alphaError);
+            }
+        }
+    }
+}
+
+void testQuality()
+{
+    const unsigned width = 256, height = 256;
+    Pixels pixels = createTexture(width, height);
+    double results[4];
+    for (int format = BC1; format <= BC7; ++format) {
+        Pixels decoded = roundTrip(Format(format), pixels, width, height);
+        results[format] = psnr(pixels, decoded, format != BC1);
+        std::cout << formatNames[format] << " PSNR " << results[format] << " dB" << std::endl;
+    }
+    SG_VERIFY(results[BC1] > 32);
+    SG_VERIFY(results[BC2] > 30);
+    SG_VERIFY(results[BC3] > 32);
+    SG_VERIFY(results[BC7] > 38);
+    SG_VERIFY(results[BC7] > results[BC3]);
+
+    // Partial blocks at the edges
+    Pixels small = createTexture(13, 7);
+    for (int format = BC1; format <= BC7; ++format) {
+        Pixels decoded = roundTrip(Format(format), small, 13, 7);
+        SG_VERIFY(psnr(small, decoded, format != BC1) > 28);
+    }
+}
+
+void testThreads()
+{
+    const unsigned width = 1024, height = 512;
+    Pixels pixels = createTexture(width, height);
+    for (int format = BC1; format <= BC7; ++format) {
+        std::vector<unsigned char> single(getCompressedSize(Format(format), width, height));
+        std::vector<unsigned char> multi(single.size());
+        ImageKernels::setMaxThreads(1);
+        compressImage(Format(format), pixels.data(), width, height, 4*width, single.data());
+        ImageKernels::setMaxThreads(4);
+        compressImage(Format(format), pixels.data(), width, height, 4*width, multi.data());
+        ImageKernels::setMaxThreads(0);
+        SG_VERIFY(single == multi);
+    }
+}
+
+void benchmark()
+{
+    const unsigned size = 2048;
+    Pixels pixels = createTexture(size, size);
+    std::cout << size << "x" << size << " MPixel/s on one thread / all cores" << std::endl;
+    for (int format = BC1; format <= BC7; ++format) {
+        std::vector<unsigned char> blocks(getCompressedSize(Format(format), size, size));
+        double rate[2];
+        for (int i = 0; i < 2; ++i) {
+            ImageKernels::setMaxThreads(i == 0 ? 1 : 0);
+            SGTimeStamp timeStamp = SGTimeStamp::now();
+            compressImage(Format(format), pixels.data(), size, size, 4*size, blocks.data());
+            rate[i] = double(size)*size/timeStamp.elapsedUSec();
+        }
+        ImageKernels::setMaxThreads(0);
+        std::cout << "  " << formatNames[format] << ": " << rate[0] << " / "
+                  << rate[1] << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    sg_srandom(3);
+
+    testSizes();
+    testSolidBlocks();
+    testQuality();
+    testThreads();
+    benchmark();
+
+    std::cout << "all tests passed OK" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,268 @@
+#include <simgear_config.h>
+#include <simgear/compiler.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <osg/Image>
+
+#include <simgear/math/sg_random.h>
+#include <simgear/misc/test_macros.hxx>
+#include <simgear/scene/material/mipmap.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include "SGImageKernels.hxx"
+#include "SGImageUtils.hxx"
+
+using namespace simgear;
+using simgear::effect::MipMapTuple;
+
+typedef std::function<osg::Image*(const osg::Image*)> ImageOperation;
+
+osg::Image* createImage(int s, int t, GLenum pixelFormat, GLenum dataType)
+{
+    osg::Image* image = new osg::Image;
+    image->allocateImage(s, t, 1, pixelFormat, dataType);
+    if (dataType == GL_FLOAT) {
+        float* data = reinterpret_cast<float*>(image->data());
+        unsigned size = image->getTotalSizeInBytes()/sizeof(float);
+        for (unsigned i = 0; i < size; ++i)
+            data[i] = float(sg_random());
+    } else {
+        unsigned char* data = image->data();
+        for (unsigned i = 0; i < image->getTotalSizeInBytes(); ++i)
+            data[i] = (unsigned char)(sg_random()*256);
+    }
+    return image;
+}
+
+// Transparent holes for featherAlphaRegions
+void punchHoles(osg::Image* image)
+{
+    ImageUtils::PixelReader read(image);
+    ImageUtils::PixelWriter write(image);
+    for (int t = 0; t < image->t(); ++t) {
+        for (int s = 0; s < image->s(); ++s) {
+            if (sg_random() < 0.7) {
+                osg::Vec4 color = read(s, t);
+                color.a() = 0;
+                write(color, s, t);
+            }
+        }
+    }
+}
+
+// The 8 bit kernels round where the generic path truncates
+bool equivalent(const osg::Image* lhs, const osg::Image* rhs)
+{
+    if (lhs->getTotalSizeInBytesIncludingMipmaps() != rhs->getTotalSizeInBytesIncludingMipmaps())
+        return false;
+    if (lhs->getDataType() == GL_FLOAT) {
+        const float* l = reinterpret_cast<const float*>(lhs->data());
+        const float* r = reinterpret_cast<const float*>(rhs->data());
+        unsigned size = lhs->getTotalSizeInBytesIncludingMipmaps()/sizeof(float);
+        for (unsigned i = 0; i < size; ++i) {
+            if (1e-4f < std::fabs(l[i] - r[i]))
+                return false;
+        }
+    } else {
+        const unsigned char* l = lhs->data();
+        const unsigned char* r = rhs->data();
+        for (unsigned i = 0; i < lhs->getTotalSizeInBytesIncludingMipmaps(); ++i) {
+            if (1 < std::abs(int(l[i]) - int(r[i])))
+                return false;
+        }
+    }
+    return true;
+}
+
+bool identical(const osg::Image* lhs, const osg::Image* rhs)
+{
+    unsigned size = lhs->getTotalSizeInBytesIncludingMipmaps();
+    return size == rhs->getTotalSizeInBytesIncludingMipmaps()
+        && std::memcmp(lhs->data(), rhs->data(), size) == 0;
+}
+
+osg::ref_ptr<osg::Image> run(const osg::Image* input, const ImageOperation& op,
+                             bool kernels, unsigned threads = 1)
+{
+    ImageKernels::setEnabled(kernels);
+    ImageKernels::setMaxThreads(threads);
+    osg::ref_ptr<osg::Image> output = op(input);
+    ImageKernels::setEnabled(true);
+    ImageKernels::setMaxThreads(0);
+    return output;
+}
+
+struct Operation {
+    const char* _name;
+    ImageOperation _op;
+    bool _rgba8Only;
+};
+
+std::vector<Operation> createOperations(int s, int t)
+{
+    std::vector<Operation> ops;
+    ops.push_back(Operation{"resize bilinear", [s, t](const osg::Image* input) {
+        osg::ref_ptr<osg::Image> output;
+        SG_VERIFY(ImageUtils::resizeImage(input, s/2 + 3, t*3/2, output));
+        return output.release();
+    }, false});
+    ops.push_back(Operation{"resize nearest", [s, t](const osg::Image* input) {
+        osg::ref_ptr<osg::Image> output;
+        SG_VERIFY(ImageUtils::resizeImage(input, s*2, t/2, output, 0, false));
+        return output.release();
+    }, false});
+    ops.push_back(Operation{"mix", [](const osg::Image* input) {
+        osg::Image* output = ImageUtils::cloneImage(input);
+        osg::ref_ptr<osg::Image> other = ImageUtils::cloneImage(input);
+        other->flipVertical();
+        SG_VERIFY(ImageUtils::mix(output, other, 0.3f));
+        return output;
+    }, false});
+    ops.push_back(Operation{"premultiply", [](const osg::Image* input) {
+        osg::Image* output = ImageUtils::cloneImage(input);
+        SG_VERIFY(ImageUtils::convertToPremultipliedAlpha(output));
+        return output;
+    }, false});
+    ops.push_back(Operation{"bump map", [](const osg::Image* input) {
+        return ImageUtils::createBumpMap(input);
+    }, false});
+    ops.push_back(Operation{"sharpen", [](const osg::Image* input) {
+        return ImageUtils::createSharpenedImage(input);
+    }, true});
+    ops.push_back(Operation{"feather", [](const osg::Image* input) {
+        osg::Image* output = ImageUtils::cloneImage(input);
+        punchHoles(output);
+        SG_VERIFY(ImageUtils::featherAlphaRegions(output));
+        return output;
+    }, false});
+    ops.push_back(Operation{"mipmap", [](const osg::Image* input) {
+        osg::ref_ptr<osg::Image> image = ImageUtils::cloneImage(input);
+        MipMapTuple attrs(effect::AVERAGE, effect::PRODUCT, effect::MIN, effect::MAX);
+        return effect::computeMipmap(image.get(), attrs);
+    }, false});
+    return ops;
+}
+
+void testAgainstGeneric()
+{
+    GLenum formats[][2] = {
+        { GL_RGBA, GL_UNSIGNED_BYTE },
+        { GL_RGB, GL_UNSIGNED_BYTE },
+        { GL_RGBA, GL_FLOAT }
+    };
+    for (auto& format : formats) {
+        // Feathering copies between pixels, it starts from the same holes
+        sg_srandom(5);
+        osg::ref_ptr<osg::Image> input = createImage(64, 32, format[0], format[1]);
+        SG_VERIFY(ImageUtils::getPixelLayout(input) != ImageKernels::GENERIC);
+
+        std::vector<Operation> ops = createOperations(64, 32);
+        for (const Operation& op : ops) {
+            if (op._rgba8Only && (format[0] != GL_RGBA || format[1] != GL_UNSIGNED_BYTE))
+                continue;
+            sg_srandom(7);
+            osg::ref_ptr<osg::Image> generic = run(input, op._op, false);
+            sg_srandom(7);
+            osg::ref_ptr<osg::Image> kernels = run(input, op._op, true);
+            if (!equivalent(generic, kernels)) {
+                std::cerr << op._name << " differs for format " << format[0] << std::endl;
+                SG_VERIFY(false);
+            }
+        }
+    }
+
+    // Sharpening is integer arithmetic either way
+    osg::ref_ptr<osg::Image> input = createImage(64, 32, GL_RGBA, GL_UNSIGNED_BYTE);
+    std::vector<Operation> ops = createOperations(64, 32);
+    SG_VERIFY(identical(run(input, ops[5]._op, false), run(input, ops[5]._op, true)));
+
+    // Unnormalized 8 bit images stay on the generic path
+    ImageUtils::markAsNormalized(input, false);
+    SG_CHECK_EQUAL(ImageUtils::getPixelLayout(input), ImageKernels::GENERIC);
+}
+
+void testBands()
+{
+    osg::ref_ptr<osg::Image> input = createImage(1024, 1024, GL_RGBA, GL_UNSIGNED_BYTE);
+    std::vector<Operation> ops = createOperations(1024, 1024);
+    for (const Operation& op : ops) {
+        sg_srandom(7);
+        osg::ref_ptr<osg::Image> single = run(input, op._op, true, 1);
+        sg_srandom(7);
+        osg::ref_ptr<osg::Image> multi = run(input, op._op, true, 4);
+        if (!identical(single, multi)) {
+            std::cerr << op._name << " depends on the bands" << std::endl;
+            SG_VERIFY(false);
+        }
+    }
+}
+
+void testBandPool()
+{
+    ImageKernels::setMaxThreads(4);
+    std::vector<int> hits(100000, 0);
+    ImageKernels::forEachBand(100000, 1024, [&hits](unsigned begin, unsigned end) {
+        for (unsigned i = begin; i < end; ++i)
+            ++hits[i];
+        // Nested calls must not wait for each other
+        std::vector<int> nested(64, 0);
+        ImageKernels::forEachBand(64, 1024*1024, [&nested](unsigned b, unsigned e) {
+            for (unsigned i = b; i < e; ++i)
+                ++nested[i];
+        });
+        SG_CHECK_EQUAL(std::count(nested.begin(), nested.end(), 1), 64);
+    });
+    SG_CHECK_EQUAL(std::count(hits.begin(), hits.end(), 1), 100000);
+
+    // Exceptions of other threads reach the caller
+    bool caught = false;
+    try {
+        ImageKernels::forEachBand(1000, 1024*1024, [](unsigned begin, unsigned) {
+            if (begin >= 500)
+                throw std::runtime_error("band failed");
+        });
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    SG_VERIFY(caught);
+    ImageKernels::setMaxThreads(0);
+}
+
+void benchmark()
+{
+    const int size = 4096;
+    osg::ref_ptr<osg::Image> input = createImage(size, size, GL_RGBA, GL_UNSIGNED_BYTE);
+    std::vector<Operation> ops = createOperations(size, size);
+    std::cout << size << "x" << size << " RGBA8, ms for generic / kernels / kernels on all cores"
+              << std::endl;
+    for (const Operation& op : ops) {
+        double ms[3];
+        for (int i = 0; i < 3; ++i) {
+            sg_srandom(7);
+            SGTimeStamp timeStamp = SGTimeStamp::now();
+            run(input, op._op, i != 0, i == 2 ? 0 : 1);
+            ms[i] = timeStamp.elapsedMSec();
+        }
+        std::cout << "  " << op._name << ": " << ms[0] << " / " << ms[1]
+                  << " / " << ms[2] << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    testAgainstGeneric();
+    testBands();
+    testBandPool();
+    benchmark();
+
+    std::cout << "all tests passed OK" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -16,6 +16,10 @@
 
 #include "ClusteredShading.hxx"
 
+#include <algorithm>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
 #include <thread>
 
 #include <osg/BufferIndexBinding>
@@ -27,6 +31,7 @@
 
 #include <osg/io_utils>
 
+#include <simgear/math/simd.hxx>
 #include <simgear/structure/exception.hxx>
 
 namespace simgear {
@@ -42,20 +47,97 @@ const int MAX_SPOTLIGHTS = 256;
 const int POINTLIGHT_BLOCK_SIZE = 20;
 const int SPOTLIGHT_BLOCK_SIZE = 8;
 
+// Threads that stay around for the lifetime of the ClusteredShading and are
+// woken once per frame. The calling thread does its share of the slices too,
+// so there is one worker less than configured threads.
+class ClusteredShading::WorkerPool {
+public:
+    WorkerPool(ClusteredShading *owner, int num_workers) :
+        _owner(owner),
+        _frame(0),
+        _busy(0),
+        _quit(false)
+    {
+        _threads.reserve(num_workers);
+        for (int i = 0; i < num_workers; ++i)
+            _threads.emplace_back(&WorkerPool::workerFunc, this, i + 1);
+    }
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _quit = true;
+        }
+        _wake.notify_all();
+        for (auto &t : _threads) t.join();
+    }
+
+    // Assign the lights of one frame, returns when all slices are done
+    void run()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            ++_frame;
+            _busy = _threads.size();
+        }
+        _wake.notify_all();
+
+        _owner->assignLightsOnThread(0);
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done.wait(lock, [this] { return _busy == 0; });
+    }
+
+private:
+    void workerFunc(int thread_id)
+    {
+        unsigned frame = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _wake.wait(lock, [this, frame] {
+                        return _quit || _frame != frame; });
+                if (_quit)
+                    return;
+                frame = _frame;
+            }
+
+            _owner->assignLightsOnThread(thread_id);
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (--_busy == 0)
+                _done.notify_one();
+        }
+    }
+
+    ClusteredShading *_owner;
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    unsigned _frame;
+    size_t _busy;
+    bool _quit;
+};
+
 ClusteredShading::ClusteredShading(osg::Camera *camera,
                                    const SGPropertyNode *config) :
-    _camera(camera)
+    _camera(camera),
+    _width(0),
+    _height(0)
 {
     _tile_size = config->getIntValue("tile-size", 128);
-    _depth_slices = config->getIntValue("depth-slices", 1);
-    _num_threads = config->getIntValue("num-threads", 1);
-    _slices_per_thread = _depth_slices / _num_threads;
-    if (_slices_per_thread == 0) {
+    _depth_slices = std::max(config->getIntValue("depth-slices", 1), 1);
+    _num_threads = std::max(config->getIntValue("num-threads", 1), 1);
+    if (_num_threads > _depth_slices) {
         SG_LOG(SG_INPUT, SG_INFO, "ClusteredShading::ClusteredShading(): "
                "More threads than depth slices");
         _num_threads = _depth_slices;
     }
-    _slices_remainder = _depth_slices % _num_threads;
+    _scratch.resize(_num_threads);
+    if (_num_threads > 1)
+        _worker_pool.reset(new WorkerPool(this, _num_threads - 1));
 
     osg::StateSet *ss = _camera->getOrCreateStateSet();
 
@@ -170,6 +252,26 @@ ClusteredShading::~ClusteredShading()
 
 void
 ClusteredShading::update(const SGLightList &light_list)
+{
+    collectLights(light_list);
+    if (_point_bounds.size() > MAX_POINTLIGHTS ||
+        _spot_bounds.size()  > MAX_SPOTLIGHTS) {
+        throw sg_range_exception("Maximum amount of visible lights surpassed");
+    }
+
+    setupClusters();
+    assignLights();
+
+    // Force upload of the image data
+    _light_grid->dirty();
+    _light_indices->dirty();
+
+    // Upload pointlight data
+    writePointlightData();
+}
+
+void
+ClusteredShading::collectLights(const SGLightList &light_list)
 {
     // Transform every light to a more comfortable data structure for collision
     // testing, separating point and spot lights in the process
@@ -188,21 +290,20 @@ ClusteredShading::update(const SGLightList &light_list)
 
         }
     }
-    if (_point_bounds.size() > MAX_POINTLIGHTS ||
-        _spot_bounds.size()  > MAX_SPOTLIGHTS) {
-        throw sg_range_exception("Maximum amount of visible lights surpassed");
-    }
+}
 
+void
+ClusteredShading::setupClusters()
+{
     float l, r, b, t;
     _camera->getProjectionMatrix().getFrustum(l, r, b, t, _zNear, _zFar);
     _slice_scale->set(_depth_slices / log2(_zFar / _zNear));
     _slice_bias->set(-_depth_slices * log2(_zNear) / log2(_zFar / _zNear));
 
     const osg::Viewport *vp = _camera->getViewport();
-    static int old_width = 0, old_height = 0;
     int width = vp->width(); int height = vp->height();
-    if (width != old_width || height != old_height) {
-        old_width = width; old_height = height;
+    if (width != _width || height != _height) {
+        _width = width; _height = height;
 
         _n_htiles = (width  + _tile_size - 1) / _tile_size;
         _n_vtiles = (height + _tile_size - 1) / _tile_size;
@@ -223,8 +324,6 @@ ClusteredShading::update(const SGLightList &light_list)
             float xmax = xmin + _x_step;
 
             // Create the subfrustum in clip space
-            // The near and far planes will be filled later as they change from
-            // slice to slice
             Subfrustum &subfrustum = _subfrusta[y*_n_htiles + x];
             subfrustum.plane[0].set(1.0f,0.0f,0.0f,-xmin); // left plane.
             subfrustum.plane[1].set(-1.0f,0.0f,0.0f,xmax); // right plane.
@@ -242,111 +341,138 @@ ClusteredShading::update(const SGLightList &light_list)
             }
         }
     }
+}
 
+void
+ClusteredShading::assignLights()
+{
     _global_light_count = 0;
-
-    if (_depth_slices == 1) {
-        // Just run the light assignment on the main thread to avoid the
-        // unnecessary threading overhead
-        assignLightsToSlice(0);
-    } else if (_num_threads == 1) {
-        // Again, avoid the unnecessary threading overhead
-        threadFunc(0);
-    } else {
-        std::vector<std::thread> threads;
-        threads.reserve(_num_threads);
-        for (int i = 0; i < _num_threads; ++i)
-            threads.emplace_back(&ClusteredShading::threadFunc, this, i);
-
-        for (auto &t : threads) t.join();
+    _light_index_overflow = false;
+
+    // Hand out the slices with the most lights first, so the threads run
+    // out of work at about the same time
+    _slice_order.resize(_depth_slices);
+    for (int i = 0; i < _depth_slices; ++i)
+        _slice_order[i] = i;
+    if (_worker_pool) {
+        std::vector<int> counts(_depth_slices + 1, 0);
+        for (const auto &point : _point_bounds) {
+            float depth = -point.position.z();
+            if (depth + point.range <= _zNear || depth - point.range >= _zFar)
+                continue;
+            ++counts[getSliceForDepth(depth - point.range)];
+            --counts[getSliceForDepth(depth + point.range) + 1];
+        }
+        for (int i = 1; i < _depth_slices; ++i)
+            counts[i] += counts[i - 1];
+        std::stable_sort(_slice_order.begin(), _slice_order.end(),
+                         [&counts](int a, int b) { return counts[a] > counts[b]; });
     }
+    _next_slice = 0;
 
-    // Force upload of the image data
-    _light_grid->dirty();
-    _light_indices->dirty();
+    if (_worker_pool)
+        _worker_pool->run();
+    else
+        assignLightsOnThread(0);
 
-    // Upload pointlight data
-    writePointlightData();
+    if (_light_index_overflow) {
+        throw sg_range_exception(
+            "Clustered shading light index count is over the hardcoded limit ("
+            + std::to_string(MAX_LIGHT_INDICES) + ")");
+    }
 }
 
 void
-ClusteredShading::threadFunc(int thread_id)
+ClusteredShading::assignLightsOnThread(int thread_id)
 {
-    for (int i = 0; i < _slices_per_thread; ++i)
-        assignLightsToSlice(thread_id * _slices_per_thread + i);
-
-    if (_slices_remainder > thread_id)
-        assignLightsToSlice(_slices_per_thread * _num_threads + thread_id);
+    SliceScratch &scratch = _scratch[thread_id];
+    for (;;) {
+        int next = _next_slice++;
+        if (next >= _depth_slices)
+            break;
+        assignLightsToSlice(_slice_order[next], scratch);
+    }
 }
 
 void
-ClusteredShading::assignLightsToSlice(int slice)
+ClusteredShading::assignLightsToSlice(int slice, SliceScratch &scratch)
 {
+    typedef simd4_t<float,4> Vec4;
+
     size_t z_offset = slice * _n_htiles * _n_vtiles;
 
     float near = getDepthForSlice(slice);
     float far  = getDepthForSlice(slice + 1);
-    osg::Vec4f near_plane(0.0f, 0.0f, -1.0f, -near);
-    osg::Vec4f far_plane (0.0f, 0.0f,  1.0f,  far);
+
+    // The near and far planes are the same for every tile of the slice, so
+    // only the lights passing them are tested against the tiles
+    scratch.x.clear();
+    scratch.y.clear();
+    scratch.z.clear();
+    scratch.range.clear();
+    scratch.lights.clear();
+    for (size_t i = 0; i < _point_bounds.size(); ++i) {
+        const PointlightBound &point = _point_bounds[i];
+        float z = point.position.z();
+        if (-z - near + point.range <= 0.0f || z + far + point.range <= 0.0f)
+            continue;
+        scratch.x.push_back(point.position.x());
+        scratch.y.push_back(point.position.y());
+        scratch.z.push_back(z);
+        scratch.range.push_back(point.range);
+        scratch.lights.push_back(GLushort(i));
+    }
+    // Pad with lights that are outside of any plane
+    while (scratch.x.size() % 4) {
+        scratch.x.push_back(0.0f);
+        scratch.y.push_back(0.0f);
+        scratch.z.push_back(0.0f);
+        scratch.range.push_back(-std::numeric_limits<float>::max());
+    }
 
     GLuint *grid = reinterpret_cast<GLuint *>(_light_grid->data());
     GLushort *indices = reinterpret_cast<GLushort *>(_light_indices->data());
 
+    const Vec4 zero(0.0f);
     for (int i = 0; i < (_n_htiles * _n_vtiles); ++i) {
-        Subfrustum subfrustum = _subfrusta[i];
-        subfrustum.plane[4] = near_plane;
-        subfrustum.plane[5] = far_plane;
-
-        GLuint start_offset = _global_light_count;
-        GLuint local_point_count = 0;
-        GLuint local_spot_count = 0;
-
-        for (GLushort point_iterator = 0;
-             point_iterator < _point_bounds.size();
-             ++point_iterator) {
-            PointlightBound point = _point_bounds[point_iterator];
-
-            // Perform frustum-sphere collision tests
-            float distance = 0.0f;
-            for (int j = 0; j < 6; j++) {
-                distance = subfrustum.plane[j] * point.position + point.range;
-                if (distance <= 0.0f)
-                    break;
+        const Subfrustum &subfrustum = _subfrusta[i];
+
+        // Perform frustum-sphere collision tests on four lights at once
+        scratch.tile_lights.clear();
+        for (size_t j = 0; j < scratch.x.size(); j += 4) {
+            Vec4 x(&scratch.x[j]);
+            Vec4 y(&scratch.y[j]);
+            Vec4 z(&scratch.z[j]);
+            Vec4 range(&scratch.range[j]);
+
+            int outside = 0;
+            for (int k = 0; k < 4 && outside != 0xf; ++k) {
+                const osg::Vec4f &p = subfrustum.plane[k];
+                Vec4 distance = p[0]*x + p[1]*y + p[2]*z + Vec4(p[3]) + range;
+                outside |= simd4::le_mask(distance, zero);
             }
-
-            if (distance > 0.0f) {
-                // Update light index list
-                indices[_global_light_count] = point_iterator;
-                ++local_point_count;
-                ++_global_light_count; // Atomic increment
+            for (int lane = 0; lane < 4; ++lane) {
+                if (!(outside & (1 << lane)))
+                    scratch.tile_lights.push_back(scratch.lights[j + lane]);
             }
+        }
 
-            if (_global_light_count >= MAX_LIGHT_INDICES) {
-                throw sg_range_exception(
-                    "Clustered shading light index count is over the hardcoded limit ("
-                    + std::to_string(MAX_LIGHT_INDICES) + ")");
-            }
+        // Reserve a contiguous range of the light index list for this tile
+        GLuint local_point_count = scratch.tile_lights.size();
+        GLuint local_spot_count = 0;
+        GLuint start_offset = _global_light_count.fetch_add(local_point_count);
+        if (start_offset + local_point_count > GLuint(MAX_LIGHT_INDICES)) {
+            _light_index_overflow = true;
+            return;
         }
+        std::copy(scratch.tile_lights.begin(), scratch.tile_lights.end(),
+                  indices + start_offset);
 
         // Update light grid
         grid[(z_offset + i) * 3 + 0] = start_offset;
         grid[(z_offset + i) * 3 + 1] = local_point_count;
         grid[(z_offset + i) * 3 + 2] = local_spot_count;
     }
-
-    // for (int y = 0; y < _n_vtiles; ++y) {
-    //     for (int x = 0; x < _n_htiles; ++x) {
-    //         std::cout << grid[(y * _n_htiles + x) * 3 + 0] << ","
-    //                   << grid[(y * _n_htiles + x) * 3 + 1] << " ";
-    //     }
-    //     std::cout << std::endl;
-    // }
-    // std::cout << "\n\n";
-
-    // for (int i = 0; i < n_vtiles * n_htiles; ++i) {
-    //     std::cout << indices[i] << " ";
-    // }
-    // std::cout << "\n";
 }
 
 void
@@ -391,5 +517,14 @@ ClusteredShading::getDepthForSlice(int slice) const
     return _zNear * pow(_zFar / _zNear, float(slice) / _depth_slices);
 }
 
+int
+ClusteredShading::getSliceForDepth(float depth) const
+{
+    if (depth <= _zNear)
+        return 0;
+    int slice = int(_depth_slices * log(depth / _zNear) / log(_zFar / _zNear));
+    return std::min(slice, _depth_slices - 1);
+}
+
 } // namespace compositor
 } // namespace simgear
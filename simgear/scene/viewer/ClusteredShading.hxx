@@ -18,6 +18,8 @@
 #define SG_CLUSTERED_SHADING_HXX
 
 #include <atomic>
+#include <memory>
+#include <vector>
 
 #include <osg/Camera>
 #include <osg/Uniform>
@@ -37,8 +39,10 @@ protected:
     // We could make use of osg::Polytope, but it does a lot of std::vector
     // push_back() calls, so we make our own frustum structure for huge
     // performance gains.
+    // Only the four side planes are stored, the near and far planes change
+    // from slice to slice and are tested once per slice.
     struct Subfrustum {
-        osg::Vec4f plane[6];
+        osg::Vec4f plane[4];
     };
 
     struct PointlightBound {
@@ -52,10 +56,25 @@ protected:
         float range;
     };
 
-    void threadFunc(int thread_id);
-    void assignLightsToSlice(int slice);
+    // Scratch space of one thread. The lights touching the current depth
+    // slice are kept as structure of arrays, padded to a multiple of four,
+    // so the plane tests can run on four lights at once.
+    struct SliceScratch {
+        std::vector<float>    x, y, z, range;
+        std::vector<GLushort> lights;
+        std::vector<GLushort> tile_lights;
+    };
+
+    class WorkerPool;
+
+    void collectLights(const SGLightList &light_list);
+    void setupClusters();
+    void assignLights();
+    void assignLightsOnThread(int thread_id);
+    void assignLightsToSlice(int slice, SliceScratch &scratch);
     void writePointlightData();
     float getDepthForSlice(int slice) const;
+    int getSliceForDepth(float depth) const;
 
     osg::observer_ptr<osg::Camera>  _camera;
 
@@ -65,12 +84,12 @@ protected:
     int                             _tile_size;
     int                             _depth_slices;
     int                             _num_threads;
-    int                             _slices_per_thread;
-    int                             _slices_remainder;
 
     float                           _zNear;
     float                           _zFar;
 
+    int                             _width;
+    int                             _height;
     int                             _n_htiles;
     int                             _n_vtiles;
 
@@ -87,7 +106,15 @@ protected:
     std::vector<PointlightBound>    _point_bounds;
     std::vector<SpotlightBound>     _spot_bounds;
 
+    // Persistent threads, only created for more than one thread
+    std::unique_ptr<WorkerPool>     _worker_pool;
+    std::vector<SliceScratch>       _scratch;
+    // Slices with the most lights first, handed out in this order
+    std::vector<int>                _slice_order;
+    std::atomic<int>                _next_slice;
+
     std::atomic<GLuint>             _global_light_count;
+    std::atomic<bool>               _light_index_overflow;
 };
 
 } // namespace compositor
@@ -25,6 +25,7 @@
 
 #include <simgear/math/SGRect.hxx>
 #include <simgear/props/props_io.hxx>
+#include <simgear/scene/material/Effect.hxx>
 #include <simgear/scene/material/EffectCullVisitor.hxx>
 #include <simgear/scene/util/SGReaderWriterOptions.hxx>
 #include <simgear/scene/util/RenderConstants.hxx>
@@ -127,6 +128,9 @@ void
 Compositor::update(const osg::Matrix &view_matrix,
                    const osg::Matrix &proj_matrix)
 {
+    // Effect uniforms bound to properties changed this frame
+    UniformFactory::instance()->updateUniforms();
+
     for (auto &pass : _passes) {
         if (pass->inherit_cull_mask) {
             osg::Camera *camera = pass->camera;
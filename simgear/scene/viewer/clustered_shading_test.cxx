@@ -0,0 +1,166 @@
+#include <simgear_config.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <osg/Camera>
+#include <osg/Group>
+#include <osg/MatrixTransform>
+
+#include <simgear/math/sg_random.h>
+#include <simgear/misc/test_macros.hxx>
+#include <simgear/props/props.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include "ClusteredShading.hxx"
+
+using namespace simgear::compositor;
+
+// Runs the light binning without a graphics context and without the limits
+// of the GPU side light data buffers
+class TestClusteredShading : public ClusteredShading {
+public:
+    TestClusteredShading(osg::Camera *camera, const SGPropertyNode *config) :
+        ClusteredShading(camera, config)
+    {
+    }
+
+    void bin(const SGLightList &light_list)
+    {
+        collectLights(light_list);
+        setupClusters();
+        assignLights();
+    }
+
+    // Compare against the plain six plane test of every light in every
+    // cluster
+    bool check() const
+    {
+        const GLuint *grid = reinterpret_cast<const GLuint *>(_light_grid->data());
+        const GLushort *indices =
+            reinterpret_cast<const GLushort *>(_light_indices->data());
+        int num_tiles = _n_htiles * _n_vtiles;
+        for (int slice = 0; slice < _depth_slices; ++slice) {
+            osg::Vec4f near_plane(0.0f, 0.0f, -1.0f, -getDepthForSlice(slice));
+            osg::Vec4f far_plane(0.0f, 0.0f, 1.0f, getDepthForSlice(slice + 1));
+            for (int i = 0; i < num_tiles; ++i) {
+                osg::Vec4f planes[6] = {
+                    _subfrusta[i].plane[0], _subfrusta[i].plane[1],
+                    _subfrusta[i].plane[2], _subfrusta[i].plane[3],
+                    near_plane, far_plane
+                };
+                std::vector<GLushort> expected;
+                for (size_t j = 0; j < _point_bounds.size(); ++j) {
+                    const PointlightBound &point = _point_bounds[j];
+                    float distance = 0.0f;
+                    for (int k = 0; k < 6; ++k) {
+                        distance = planes[k] * point.position + point.range;
+                        if (distance <= 0.0f)
+                            break;
+                    }
+                    if (distance > 0.0f)
+                        expected.push_back(GLushort(j));
+                }
+
+                const GLuint *cluster = grid + (slice*num_tiles + i)*3;
+                if (cluster[1] != expected.size())
+                    return false;
+                for (size_t j = 0; j < expected.size(); ++j) {
+                    if (indices[cluster[0] + j] != expected[j])
+                        return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+
+osg::Camera *createCamera()
+{
+    osg::Camera *camera = new osg::Camera;
+    camera->setViewport(0, 0, 1920, 1080);
+    camera->setProjectionMatrixAsPerspective(60.0, 1920.0/1080.0, 1.0, 2000.0);
+    camera->setViewMatrix(osg::Matrix::identity());
+    return camera;
+}
+
+// Small lights like the ones along a runway, spread over the view frustum
+void createLights(osg::Group *root, unsigned count, SGLightList &lights)
+{
+    for (unsigned i = 0; i < count; ++i) {
+        double depth = 50 + 1450*sg_random();
+        double x = (2*sg_random() - 1)*depth*0.577*1920/1080;
+        double y = (2*sg_random() - 1)*depth*0.577;
+        osg::MatrixTransform *transform = new osg::MatrixTransform;
+        transform->setMatrix(osg::Matrix::translate(x, y, -depth));
+        SGLight *light = new SGLight;
+        light->setType(SGLight::POINT);
+        light->setRange(0.5 + 2.5*sg_random());
+        transform->addChild(light);
+        root->addChild(transform);
+        lights.push_back(light);
+    }
+}
+
+osg::ref_ptr<TestClusteredShading> createClusteredShading(osg::Camera *camera,
+                                                          int num_threads)
+{
+    SGPropertyNode_ptr config = new SGPropertyNode;
+    config->setIntValue("tile-size", 64);
+    config->setIntValue("depth-slices", 16);
+    config->setIntValue("num-threads", num_threads);
+    return new TestClusteredShading(camera, config);
+}
+
+void testAssignment()
+{
+    osg::ref_ptr<osg::Camera> camera = createCamera();
+    osg::ref_ptr<osg::Group> root = new osg::Group;
+    SGLightList lights;
+    createLights(root, 1000, lights);
+
+    for (int num_threads = 1; num_threads <= 4; num_threads *= 2) {
+        osg::ref_ptr<TestClusteredShading> shading =
+            createClusteredShading(camera, num_threads);
+        // Twice to also run through the woken up workers
+        for (int frame = 0; frame < 2; ++frame) {
+            shading->bin(lights);
+            SG_VERIFY(shading->check());
+        }
+    }
+}
+
+void benchmarkAssignment()
+{
+    osg::ref_ptr<osg::Camera> camera = createCamera();
+    unsigned counts[] = { 1000, 10000, 50000 };
+    for (unsigned count : counts) {
+        osg::ref_ptr<osg::Group> root = new osg::Group;
+        SGLightList lights;
+        createLights(root, count, lights);
+
+        for (int num_threads = 1; num_threads <= 4; num_threads *= 4) {
+            osg::ref_ptr<TestClusteredShading> shading =
+                createClusteredShading(camera, num_threads);
+            const int frames = 10;
+            SGTimeStamp timeStamp = SGTimeStamp::now();
+            for (int frame = 0; frame < frames; ++frame)
+                shading->bin(lights);
+            std::cout << count << " lights, " << num_threads << " threads: "
+                      << timeStamp.elapsedUSec()/frames << "us per frame"
+                      << std::endl;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    sg_srandom(17);
+
+    testAssignment();
+    benchmarkAssignment();
+
+    std::cout << "all tests passed OK" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,192 @@
+// codecs.cxx -- decoders for compressed audio samples
+//
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include <simgear_config.h>
+
+#include "codecs.hxx"
+
+#include <simgear/misc/stdint.hxx>
+
+#if defined(ENABLE_SIMD_CODE) && defined(__SSE2__)
+# include <emmintrin.h>
+# define SG_ULAW_SSE2 1
+#endif
+
+namespace
+{
+  const int16_t ima4_index_table[16] =
+  {
+     -1, -1, -1, -1, 2, 4, 6, 8,
+     -1, -1, -1, -1, 2, 4, 6, 8
+  };
+
+  const int16_t ima4_step_table[89] =
+  {
+       7,     8,     9,    10,    11,    12,    13,    14,    16,    17,
+      19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+      50,    55,    60,    66,    73,    80,    88,    97,   107,   118,
+     130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+     337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+     876,   963,  1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+    2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+    5894,  6484,  7132,  7845,  8630,  9493, 10442, 11487, 12635, 13899,
+   15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+  };
+
+  inline int clampIndex(int index)
+  {
+    return (index < 0) ? 0 : ((index > 88) ? 88 : index);
+  }
+
+  inline int16_t ima2linear(uint8_t nibble, int& predictor, int& index)
+  {
+    int step = ima4_step_table[index];
+
+    int diff = step >> 3;
+    if (nibble & 4) diff += step;
+    if (nibble & 2) diff += step >> 1;
+    if (nibble & 1) diff += step >> 2;
+
+    predictor += (nibble & 8) ? -diff : diff;
+    if (predictor < -32768) predictor = -32768;
+    else if (predictor > 32767) predictor = 32767;
+
+    index = clampIndex(index + ima4_index_table[nibble]);
+    return predictor;
+  }
+
+  // all 256 µ-law bytes, for the scalar path
+  struct ULawTable
+  {
+    int16_t value[256];
+
+    ULawTable()
+    {
+      for (int i = 0; i < 256; i++) {
+        value[i] = simgear::mulaw2linear(i);
+      }
+    }
+  };
+
+#ifdef SG_ULAW_SSE2
+  // expands 8 µ-law bytes, zero extended to 16 bits
+  inline __m128i ulaw2linear8(__m128i b)
+  {
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i two = _mm_set1_epi16(2);
+    const __m128i four = _mm_set1_epi16(4);
+
+    b = _mm_xor_si128(b, _mm_set1_epi16(0xFF));
+    __m128i negative = _mm_cmpeq_epi16(_mm_and_si128(b, _mm_set1_epi16(0x80)),
+                                       _mm_set1_epi16(0x80));
+    __m128i exponent = _mm_and_si128(_mm_srli_epi16(b, 4), _mm_set1_epi16(7));
+    __m128i mantissa = _mm_and_si128(b, _mm_set1_epi16(0x0F));
+
+    // exp_lut[e] + (m << (e + 3)) == (((m << 3) + 132) << e) - 132,
+    // shifted by e one exponent bit at a time
+    __m128i v = _mm_add_epi16(_mm_slli_epi16(mantissa, 3), _mm_set1_epi16(132));
+    __m128i bit = _mm_cmpeq_epi16(_mm_and_si128(exponent, one), one);
+    v = _mm_add_epi16(v, _mm_and_si128(v, bit));
+    bit = _mm_cmpeq_epi16(_mm_and_si128(exponent, two), two);
+    v = _mm_or_si128(_mm_andnot_si128(bit, v),
+                     _mm_and_si128(bit, _mm_slli_epi16(v, 2)));
+    bit = _mm_cmpeq_epi16(_mm_and_si128(exponent, four), four);
+    v = _mm_or_si128(_mm_andnot_si128(bit, v),
+                     _mm_and_si128(bit, _mm_slli_epi16(v, 4)));
+    v = _mm_sub_epi16(v, _mm_set1_epi16(132));
+
+    // negate where the sign bit was set
+    return _mm_sub_epi16(_mm_xor_si128(v, negative), negative);
+  }
+#endif
+}
+
+namespace simgear
+{
+
+/*
+ * From: http://www.multimedia.cx/simpleaudio.html#tth_sEc6.1
+ */
+int16_t mulaw2linear(uint8_t mulawbyte)
+{
+  static const int16_t exp_lut[8] = {
+    0, 132, 396, 924, 1980, 4092, 8316, 16764
+  };
+  int16_t sign, exponent, mantissa, sample;
+  mulawbyte = ~mulawbyte;
+  sign = (mulawbyte & 0x80);
+  exponent = (mulawbyte >> 4) & 0x07;
+  mantissa = mulawbyte & 0x0F;
+  sample = exp_lut[exponent] + (mantissa << (exponent + 3));
+  return sign ? -sample : sample;
+}
+
+void decodeULaw(const uint8_t* in, size_t count, int16_t* out)
+{
+  size_t i = 0;
+#ifdef SG_ULAW_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= count; i += 16) {
+    __m128i b = _mm_loadu_si128((const __m128i*)(in + i));
+    _mm_storeu_si128((__m128i*)(out + i),
+                     ulaw2linear8(_mm_unpacklo_epi8(b, zero)));
+    _mm_storeu_si128((__m128i*)(out + i + 8),
+                     ulaw2linear8(_mm_unpackhi_epi8(b, zero)));
+  }
+#endif
+  static const ULawTable table;
+  for (; i < count; i++) {
+    out[i] = table.value[in[i]];
+  }
+}
+
+size_t decodeIMA4(const uint8_t* in, size_t length,
+                  unsigned int block_align, int16_t* out)
+{
+  size_t samples = ima4BlockSamples(block_align);
+  if (samples == 0) {
+    return 0;
+  }
+
+  size_t blocks = length / block_align;
+  for (size_t i = 0; i < blocks; i++)
+  {
+    const uint8_t* d = in + i * block_align;
+    const uint8_t* end = d + block_align;
+
+    int predictor = int16_t(d[0] | (d[1] << 8));
+    int index = clampIndex(d[2]);
+    d += 4;
+
+    *out++ = predictor;
+    for (; d < end; d++) {
+      *out++ = ima2linear(*d & 0xF, predictor, index);
+      *out++ = ima2linear(*d >> 4, predictor, index);
+    }
+  }
+  return blocks * samples;
+}
+
+void swapPCM16(uint16_t* data, size_t count)
+{
+  for (size_t i = 0; i < count; i++) {
+    data[i] = sg_bswap_16(data[i]);
+  }
+}
+
+} // of namespace simgear
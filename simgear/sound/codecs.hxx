@@ -0,0 +1,66 @@
+// codecs.hxx -- decoders for compressed audio samples
+//
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef SG_SOUND_CODECS_HXX
+#define SG_SOUND_CODECS_HXX
+
+#include <cstddef>
+#include <cstdint>
+
+// The decoders only touch memory, so they run on any thread and
+// without an audio device.
+
+namespace simgear
+{
+  /**
+   * Expand one µ-law (G.711) byte to a 16 bit linear sample.
+   */
+  int16_t mulaw2linear(uint8_t mulawbyte);
+
+  /**
+   * Expand count µ-law bytes to 16 bit linear samples, 16 at a time
+   * with SSE2 where available.
+   */
+  void decodeULaw(const uint8_t* in, size_t count, int16_t* out);
+
+  /**
+   * The samples in a block of mono IMA4 ADPCM of block_align bytes: the
+   * one in the block header and two per following byte.
+   */
+  inline size_t ima4BlockSamples(unsigned int block_align)
+  {
+    return (block_align > 4) ? (block_align - 4) * 2 + 1 : 0;
+  }
+
+  /**
+   * Decode the complete blocks of mono IMA4 ADPCM in the length bytes
+   * of in to 16 bit linear samples.
+   *
+   * @return The number of samples written to out, which must have room
+   *         for ima4BlockSamples() per block.
+   */
+  size_t decodeIMA4(const uint8_t* in, size_t length,
+                    unsigned int block_align, int16_t* out);
+
+  /**
+   * Swap the bytes of count 16 bit samples in place.
+   */
+  void swapPCM16(uint16_t* data, size_t count);
+}
+
+#endif // of SG_SOUND_CODECS_HXX
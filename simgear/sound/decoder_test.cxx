@@ -0,0 +1,191 @@
+#include <simgear_config.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <simgear/misc/sg_path.hxx>
+#include <simgear/misc/test_macros.hxx>
+
+#include "codecs.hxx"
+#include "readwav.hxx"
+#include "sample.hxx"
+#include "sample_decoder.hxx"
+
+using std::cout;
+using std::endl;
+
+// the (unsigned) 8 bit samples of jet.wav
+std::vector<int> reference()
+{
+    unsigned int format, block_align;
+    ALsizei size;
+    ALfloat freq;
+    SGPath path(SRC_DIR);
+    path.append("jet.wav");
+    ALvoid* data = simgear::loadWAVFromFile(path, 0, format, size, freq,
+                                            block_align);
+    SG_VERIFY(data);
+    SG_CHECK_EQUAL(format, SG_SAMPLE_MONO8);
+
+    std::vector<int> samples(size);
+    for (ALsizei i = 0; i < size; i++) {
+        samples[i] = (((uint8_t*)data)[i] - 128) << 8;
+    }
+    free(data);
+    return samples;
+}
+
+// the RMS difference of the samples of a decoded file to the reference
+double compare(const std::vector<int>& ref, const int16_t* data, size_t count)
+{
+    SG_VERIFY(count > 0);
+    size_t n = std::min(ref.size(), count);
+    double sum = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double d = data[i] - ref[i];
+        sum += d * d;
+    }
+    return std::sqrt(sum / n);
+}
+
+void testULaw()
+{
+    // every byte, and a tail the vector code does not handle
+    uint8_t in[256 + 7];
+    for (int i = 0; i < 256 + 7; i++) {
+        in[i] = i;
+    }
+    int16_t out[256 + 7];
+    simgear::decodeULaw(in, 256 + 7, out);
+    for (int i = 0; i < 256 + 7; i++) {
+        SG_CHECK_EQUAL(out[i], simgear::mulaw2linear(in[i]));
+    }
+
+    SG_CHECK_EQUAL(simgear::mulaw2linear(0xFF), 0);
+    SG_CHECK_EQUAL(simgear::mulaw2linear(0x80), 32124);
+    SG_CHECK_EQUAL(simgear::mulaw2linear(0x00), -32124);
+}
+
+void testIMA4()
+{
+    // a block of zero nibbles decays towards the header sample
+    uint8_t block[36];
+    memset(block, 0, sizeof(block));
+    block[0] = 0x10;
+    block[1] = 0x00;
+    int16_t out[2 * 36];
+    SG_CHECK_EQUAL(simgear::ima4BlockSamples(36), 65);
+    SG_CHECK_EQUAL(simgear::decodeIMA4(block, 36 + 10, 36, out), 65);
+    SG_CHECK_EQUAL(out[0], 16);
+    for (int i = 1; i < 65; i++) {
+        SG_VERIFY(out[i] >= out[i - 1]);
+    }
+}
+
+void testFiles()
+{
+    std::vector<int> ref = reference();
+    unsigned int format, block_align;
+    ALsizei size;
+    ALfloat freq;
+
+    SGPath path(SRC_DIR);
+    path.append("jet_ulaw.wav");
+    ALvoid* data = simgear::loadWAVFromFile(path, 0, format, size, freq,
+                                            block_align);
+    SG_VERIFY(data);
+    SG_CHECK_EQUAL(format, SG_SAMPLE_MONO16);
+    SG_CHECK_EQUAL(size_t(size / 2), ref.size());
+    SG_VERIFY(compare(ref, (int16_t*)data, size / 2) < 1024.0);
+    free(data);
+
+    // kept as it is where the audio library plays µ-law
+    data = simgear::loadWAVFromFile(path, simgear::WAV_NATIVE_MULAW, format,
+                                    size, freq, block_align);
+    SG_VERIFY(data);
+    SG_CHECK_EQUAL(format, SG_SAMPLE_MULAW);
+    SG_CHECK_EQUAL(size_t(size), ref.size());
+    free(data);
+
+    path = SGPath(SRC_DIR);
+    path.append("jet_ima4.wav");
+    data = simgear::loadWAVFromFile(path, 0, format, size, freq, block_align);
+    SG_VERIFY(data);
+    SG_CHECK_EQUAL(format, SG_SAMPLE_MONO16);
+    SG_CHECK_EQUAL(size_t(size / 2),
+                   (17920 / block_align) * simgear::ima4BlockSamples(block_align));
+    SG_VERIFY(compare(ref, (int16_t*)data, size / 2) < 2048.0);
+    free(data);
+}
+
+void testDecoder()
+{
+    SGPath dir(SRC_DIR);
+    const std::string ulaw = SGPath(dir, "jet_ulaw.wav").utf8Str();
+    const std::string ima4 = SGPath(dir, "jet_ima4.wav").utf8Str();
+    const std::string missing = SGPath(dir, "missing.wav").utf8Str();
+
+    SGSampleDecoder decoder(0);
+    SG_VERIFY(!decoder.take(ulaw));
+
+    decoder.request(ulaw);
+    decoder.request(ima4);
+    decoder.request(missing);
+    decoder.request(ulaw);
+    decoder.wait();
+
+    SG_VERIFY(!decoder.is_pending(ulaw));
+    SGSampleDecoder::Sample_ptr sample = decoder.take(ulaw);
+    SG_VERIFY(sample);
+    SG_VERIFY(!sample->failed);
+    SG_VERIFY(sample->data);
+    SG_CHECK_EQUAL(sample->format, SG_SAMPLE_MONO16);
+    SG_CHECK_EQUAL(sample->frequency, 11025.0f);
+    SG_VERIFY(!decoder.take(ulaw));
+
+    sample = decoder.take(ima4);
+    SG_VERIFY(sample);
+    SG_VERIFY(!sample->failed);
+    SG_CHECK_EQUAL(sample->format, SG_SAMPLE_MONO16);
+
+    sample = decoder.take(missing);
+    SG_VERIFY(sample);
+    SG_VERIFY(sample->failed);
+    SG_VERIFY(!sample->data);
+    SG_VERIFY(!sample->error.empty());
+
+    // Discarded samples are not kept, whether decoded or pending
+    decoder.request(ulaw);
+    decoder.wait();
+    decoder.discard(ulaw);
+    SG_VERIFY(!decoder.take(ulaw));
+
+    decoder.request(ulaw);
+    decoder.request(ima4);
+    decoder.discard(ulaw);
+    decoder.discard(ima4);
+    decoder.wait();
+    SG_VERIFY(!decoder.take(ulaw));
+    SG_VERIFY(!decoder.take(ima4));
+
+    // unless they are requested again
+    decoder.request(ima4);
+    decoder.discard(ima4);
+    decoder.request(ima4);
+    decoder.wait();
+    SG_VERIFY(decoder.take(ima4));
+}
+
+int main(int argc, char* argv[])
+{
+    testULaw();
+    testIMA4();
+    testFiles();
+    testDecoder();
+
+    cout << "all tests passed" << endl;
+    return EXIT_SUCCESS;
+}
@@ -34,6 +34,7 @@
 #include <simgear/structure/exception.hxx>
 
 #include "sample.hxx"
+#include "codecs.hxx"
 
 namespace 
 {
@@ -90,133 +91,33 @@ namespace
   
   void codecPCM16BE (Buffer* buf)
   {
-    uint16_t *d = (uint16_t *) buf->data;
-    size_t i, l = buf->length / 2;
-    for (i = 0; i < l; i++) {
-      *d = sg_bswap_16(*d); ++d;
-    }
-  }
-  
- /*
-  * From: http://www.multimedia.cx/simpleaudio.html#tth_sEc6.1
-  */
-  int16_t mulaw2linear (uint8_t mulawbyte)
-  {
-    static const int16_t exp_lut[8] = {
-      0, 132, 396, 924, 1980, 4092, 8316, 16764
-    };
-    int16_t sign, exponent, mantissa, sample;
-    mulawbyte = ~mulawbyte;
-    sign = (mulawbyte & 0x80);
-    exponent = (mulawbyte >> 4) & 0x07;
-    mantissa = mulawbyte & 0x0F;
-    sample = exp_lut[exponent] + (mantissa << (exponent + 3));
-    return sign ? -sample : sample;
+    simgear::swapPCM16((uint16_t *) buf->data, buf->length / 2);
   }
 
   void codecULaw (Buffer* b)
   {
-    uint8_t *d = (uint8_t *) b->data;
     size_t newLength = b->length * 2;
     int16_t *buf = (int16_t *) malloc(newLength);
     if (buf == NULL)
       throw sg_exception("malloc failed decoing ULaw WAV file");
-   
-    for (ALsizei i = 0; i < b->length; i++) {
-      buf[i] = mulaw2linear(d[i]);
-    }
-    
+
+    simgear::decodeULaw((const uint8_t *) b->data, b->length, buf);
+
     free(b->data);
     b->data = buf;
     b->length = newLength;
   }
 
-  int16_t ima2linear (uint8_t nibble, int16_t *val, uint8_t *idx)
-  {
-    const int16_t _ima4_index_table[16] =
-    {
-       -1, -1, -1, -1, 2, 4, 6, 8,
-       -1, -1, -1, -1, 2, 4, 6, 8
-    };
-    const int16_t _ima4_step_table[89] =
-    {
-         7,     8,     9,    10,    11,    12,    13,    14,    16,    17,
-        19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
-        50,    55,    60,    66,    73,    80,    88,    97,   107,   118,
-       130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
-       337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
-       876,   963,  1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
-      2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
-      5894,  6484,  7132,  7845,  8630,  9493, 10442, 11487, 12635, 13899,
-     15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
-    };
-    int32_t predictor;
-    int16_t diff, step;
-    int8_t delta, sign;
-    int8_t index;
-
-    index = *idx;
-    if (index > 88) index = 88;
-    else if (index < 0) index = 0;
-
-    predictor = *val;
-    step = _ima4_step_table[index];
-
-    sign = nibble & 0x8;
-    delta = nibble & 0x7;
-
-    diff = 0;
-    if (delta & 4) diff += step;
-    if (delta & 2) diff += (step >> 1);
-    if (delta & 1) diff += (step >> 2);
-    diff += (step >> 3);
-
-    if (sign) predictor -= diff;
-    else predictor += diff;
-
-    index += _ima4_index_table[nibble];
-    if (index > 88) index = 88;
-    else if (index < 0) index = 0;
-    *idx = index;
-
-    if (predictor < -32768) predictor = -32768;
-    else if (predictor > 32767) predictor = 32767;
-    *val = predictor;
-
-    return *val;
-  }
-
   void codecIMA4 (Buffer* b)
   {
-    uint8_t *d = (uint8_t *) b->data;
     unsigned int block_align = b->block_align;
     size_t blocks = b->length/block_align;
-    size_t newLength = block_align * blocks * 4;
+    size_t newLength = blocks * simgear::ima4BlockSamples(block_align) * 2;
     int16_t *buf = (int16_t *) malloc ( newLength );
     if (buf == NULL)
       throw sg_exception("malloc failed decoing IMA4 WAV file");
 
-    int16_t *ptr = buf;
-    for (size_t i = 0; i < blocks; i++)
-    {
-      int16_t predictor;
-      uint8_t index;
-
-      predictor = *d++;
-      predictor |= *d++ << 8;
-      index = *d++;
-      d++;
-
-      for (size_t j = 0; j < block_align; j += 4)
-      {
-        for (unsigned int q=0; q<4; q++)
-        {
-          uint8_t nibble = *d++;
-          *ptr++ = ima2linear(nibble & 0xF, &predictor, &index);
-          *ptr++ = ima2linear(nibble >> 4, &predictor, &index);
-        }
-      }
-    }
+    simgear::decodeIMA4((const uint8_t *) b->data, b->length, block_align, buf);
 
     free(b->data);
     b->data = buf;
@@ -258,7 +159,7 @@ namespace
     return true;
   }
   
-  void loadWavFile(gzFile fd, Buffer* b)
+  void loadWavFile(gzFile fd, Buffer* b, unsigned int native)
   {
     assert(b->data == NULL);
     
@@ -319,7 +220,7 @@ namespace
                 codec = (bitsPerSample == 8 || sgIsLittleEndian()) ? codecLinear : codecPCM16BE;
                 break;
               case 7:            /* uLaw */
-                if (alIsExtensionPresent((ALchar *)"AL_EXT_mulaw")) {
+                if (native & simgear::WAV_NATIVE_MULAW) {
                   compressed = true;
                   codec = codecLinear;
                 } else {
@@ -328,8 +229,8 @@ namespace
                }
                 break;
               case 17:		/* IMA4 ADPCM */
-                if (alIsExtensionPresent((ALchar *)"AL_EXT_ima4") &&
-                    (alIsExtensionPresent((ALchar *)"AL_SOFT_block_alignment")
+                if ((native & simgear::WAV_NATIVE_IMA4) &&
+                    ((native & simgear::WAV_NATIVE_IMA4_BLOCKS)
                      || blockAlign == 65)) {
                   compressed = true;
                   codec = codecLinear;
@@ -377,7 +278,24 @@ namespace
 namespace simgear
 {
 
+unsigned int nativeWAVFormats()
+{
+  unsigned int native = 0;
+  if (alIsExtensionPresent((ALchar *)"AL_EXT_mulaw"))
+    native |= WAV_NATIVE_MULAW;
+  if (alIsExtensionPresent((ALchar *)"AL_EXT_ima4"))
+    native |= WAV_NATIVE_IMA4;
+  if (alIsExtensionPresent((ALchar *)"AL_SOFT_block_alignment"))
+    native |= WAV_NATIVE_IMA4_BLOCKS;
+  return native;
+}
+
 ALvoid* loadWAVFromFile(const SGPath& path, unsigned int& format, ALsizei& size, ALfloat& freqf, unsigned int& block_align)
+{
+  return loadWAVFromFile(path, nativeWAVFormats(), format, size, freqf, block_align);
+}
+
+ALvoid* loadWAVFromFile(const SGPath& path, unsigned int native, unsigned int& format, ALsizei& size, ALfloat& freqf, unsigned int& block_align)
 {
   if (!path.exists()) {
     throw sg_io_exception("loadWAVFromFile: file not found", path);
@@ -399,7 +317,7 @@ ALvoid* loadWAVFromFile(const SGPath& path, unsigned int& format, ALsizei& size,
   }
 
   try {
-      loadWavFile(fd, &b);
+      loadWavFile(fd, &b, native);
   } catch (sg_exception& e) {
       throw sg_io_exception(e.getFormattedMessage() + "\nfor: " + path.str());
   }
@@ -19,7 +19,30 @@ class SGPath;
 
 namespace simgear
 {
+  /**
+   * Compressed formats the audio library plays without decoding them first
+   */
+  enum {
+    WAV_NATIVE_MULAW = 1,
+    WAV_NATIVE_IMA4 = 2,
+    WAV_NATIVE_IMA4_BLOCKS = 4 // any IMA4 block alignment
+  };
+
+  /**
+   * The compressed formats the current OpenAL context plays, call on the
+   * thread which owns the context.
+   */
+  unsigned int nativeWAVFormats();
+
   ALvoid* loadWAVFromFile(const SGPath& path, unsigned int& format, ALsizei& size, ALfloat& freqf, unsigned int& block_align);
+
+  /**
+   * Load a WAV file without asking the audio library which compressed
+   * formats it plays, so it runs on any thread and without a device.
+   *
+   * @param native The WAV_NATIVE_ formats to keep compressed
+   */
+  ALvoid* loadWAVFromFile(const SGPath& path, unsigned int native, unsigned int& format, ALsizei& size, ALfloat& freqf, unsigned int& block_align);
 }
 
 #endif // of SG_SOUND_READWAV_HXX
@@ -164,13 +164,18 @@ SGSoundSample::~SGSoundSample() {
     if ( _data != NULL ) free(_data);
 }
 
-void SGSoundSample::update_pos_and_orientation() {
+void SGSoundSample::update_relative_position() {
 
     if (_use_pos_props) {
         if (_pos_prop[0]) _relative_pos[0] = -_pos_prop[0]->getDoubleValue();
         if (_pos_prop[1]) _relative_pos[1] = -_pos_prop[1]->getDoubleValue();
         if (_pos_prop[2]) _relative_pos[2] = -_pos_prop[2]->getDoubleValue();
     }
+}
+
+void SGSoundSample::update_pos_and_orientation() {
+
+    update_relative_position();
     _absolute_pos = _base_pos;
     if (_relative_pos[0] || _relative_pos[1] || _relative_pos[2] ) {
        _absolute_pos += _rotation.rotate( _relative_pos );
@@ -129,6 +129,14 @@ public:
      */
     inline SGVec3f& get_orientation() { return _orivec; }
 
+    /**
+     * Get the position of this sound relative to the base position and
+     * the direction it is emitted to, both before they are rotated by the
+     * base orientation.
+     */
+    inline const SGVec3d& get_relative_position() const { return _relative_pos; }
+    inline const SGVec3d& get_direction() const { return _direction; }
+
     /**
      * Get the inner angle of the audio cone.
      * @return Inner angle in degrees
@@ -560,6 +568,11 @@ public:
 
     inline virtual bool is_queue() const { return false; }
 
+    /**
+     * Read the relative position from the position properties, if set.
+     */
+    void update_relative_position();
+
     void update_pos_and_orientation();
 
 protected:
@@ -0,0 +1,196 @@
+// sample_decoder.cxx -- decodes sound files on worker threads
+//
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include "sample_decoder.hxx"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include <simgear/misc/sg_path.hxx>
+#include <simgear/structure/exception.hxx>
+#include <simgear/threads/SGGuard.hxx>
+
+#include "readwav.hxx"
+
+class SGSampleDecoder::Worker : public SGThread
+{
+public:
+    Worker(SGSampleDecoder* decoder) : _decoder(decoder) {}
+
+    virtual void run()
+    {
+        std::string path;
+        while (_decoder->next(path)) {
+            Sample_ptr sample = new Sample;
+            sample->path = path;
+            try {
+                ALsizei size;
+                ALfloat frequency;
+                sample->data = simgear::loadWAVFromFile(SGPath::fromUtf8(path),
+                                                        _decoder->_native,
+                                                        sample->format, size,
+                                                        frequency,
+                                                        sample->block_align);
+                sample->size = size;
+                sample->frequency = frequency;
+                if (!sample->data) {
+                    sample->failed = true;
+                    sample->error = "Failed to load wav file: " + path;
+                }
+            } catch (sg_exception& e) {
+                sample->failed = true;
+                sample->error = e.getFormattedMessage();
+            }
+            _decoder->finished(sample);
+        }
+    }
+
+private:
+    SGSampleDecoder* _decoder;
+};
+
+SGSampleDecoder::Sample::Sample() :
+    data(NULL),
+    format(0),
+    size(0),
+    frequency(0.0f),
+    block_align(0),
+    failed(false)
+{
+}
+
+SGSampleDecoder::Sample::~Sample()
+{
+    if (data) {
+        free(data);
+    }
+}
+
+SGSampleDecoder::SGSampleDecoder(unsigned int native, unsigned int threads) :
+    _native(native),
+    _stop(false)
+{
+    if (threads < 1) {
+        threads = 1;
+    }
+    for (unsigned int i = 0; i < threads; ++i) {
+        Worker* worker = new Worker(this);
+        worker->start();
+        _workers.push_back(worker);
+    }
+}
+
+SGSampleDecoder::~SGSampleDecoder()
+{
+    {
+        SGGuard<SGMutex> g(_lock);
+        _stop = true;
+        _queue.clear();
+        _queued.broadcast();
+    }
+    for (Worker* worker : _workers) {
+        worker->join();
+        delete worker;
+    }
+}
+
+void SGSampleDecoder::request(const std::string& path)
+{
+    SGGuard<SGMutex> g(_lock);
+    if (_pending.count(path) || _done.count(path)) {
+        _discarded.erase(path);
+        return;
+    }
+    _pending.insert(path);
+    _queue.push_back(path);
+    _queued.signal();
+}
+
+bool SGSampleDecoder::is_pending(const std::string& path)
+{
+    SGGuard<SGMutex> g(_lock);
+    return _pending.count(path) != 0;
+}
+
+SGSampleDecoder::Sample_ptr SGSampleDecoder::take(const std::string& path)
+{
+    SGGuard<SGMutex> g(_lock);
+    auto it = _done.find(path);
+    if (it == _done.end()) {
+        return Sample_ptr();
+    }
+    Sample_ptr sample = it->second;
+    _done.erase(it);
+    return sample;
+}
+
+void SGSampleDecoder::discard(const std::string& path)
+{
+    SGGuard<SGMutex> g(_lock);
+    auto queued = std::find(_queue.begin(), _queue.end(), path);
+    if (queued != _queue.end()) {
+        // not picked up by a worker yet
+        _queue.erase(queued);
+        _pending.erase(path);
+        if (_pending.empty()) {
+            _idle.broadcast();
+        }
+    } else if (_pending.count(path)) {
+        _discarded.insert(path);
+    } else {
+        _done.erase(path);
+    }
+}
+
+void SGSampleDecoder::wait()
+{
+    SGGuard<SGMutex> g(_lock);
+    while (!_pending.empty()) {
+        _idle.wait(_lock);
+    }
+}
+
+bool SGSampleDecoder::next(std::string& path)
+{
+    SGGuard<SGMutex> g(_lock);
+    while (_queue.empty() && !_stop) {
+        _queued.wait(_lock);
+    }
+    if (_stop) {
+        return false;
+    }
+    path = _queue.front();
+    _queue.pop_front();
+    return true;
+}
+
+void SGSampleDecoder::finished(Sample* sample)
+{
+    SGGuard<SGMutex> g(_lock);
+    _pending.erase(sample->path);
+    if (!_discarded.erase(sample->path)) {
+        _done[sample->path] = sample;
+    }
+    if (_pending.empty()) {
+        _idle.broadcast();
+    }
+}
@@ -0,0 +1,116 @@
+// sample_decoder.hxx -- decodes sound files on worker threads
+//
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef SG_SOUND_SAMPLE_DECODER_HXX
+#define SG_SOUND_SAMPLE_DECODER_HXX
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <simgear/structure/SGReferenced.hxx>
+#include <simgear/structure/SGSharedPtr.hxx>
+#include <simgear/threads/SGThread.hxx>
+
+/**
+ * Reads and decodes sound files on worker threads, so that the first
+ * playback of a sample does not stall the thread driving the sound
+ * manager. That thread queues files with request() and picks up the
+ * decoded data with take() once it is ready; only the upload to the
+ * audio library is left to it.
+ */
+class SGSampleDecoder
+{
+public:
+    /**
+     * A decoded file, see simgear::loadWAVFromFile() for the fields.
+     */
+    class Sample : public SGReferenced
+    {
+    public:
+        Sample();
+        ~Sample();
+
+        std::string path;
+        void* data;             ///< malloc'ed, or NULL once taken over
+        unsigned int format;
+        int size;
+        float frequency;
+        unsigned int block_align;
+        bool failed;
+        std::string error;
+    };
+    typedef SGSharedPtr<Sample> Sample_ptr;
+
+    /**
+     * @param native Compressed formats to keep, see nativeWAVFormats()
+     * @param threads Number of worker threads
+     */
+    SGSampleDecoder(unsigned int native, unsigned int threads = 2);
+    ~SGSampleDecoder();
+
+    /**
+     * Queue path for decoding, unless it is queued or decoded already.
+     */
+    void request(const std::string& path);
+
+    /**
+     * Check if path is queued or being decoded.
+     */
+    bool is_pending(const std::string& path);
+
+    /**
+     * Remove and return the decoded sample of path.
+     * @return NULL if path was not requested or is still pending
+     */
+    Sample_ptr take(const std::string& path);
+
+    /**
+     * Drop the decoded sample of path, or drop it once decoded if it is
+     * still pending, for when nothing is going to take() it anymore.
+     */
+    void discard(const std::string& path);
+
+    /**
+     * Wait until all queued files are decoded.
+     */
+    void wait();
+
+private:
+    class Worker;
+    friend class Worker;
+
+    bool next(std::string& path);
+    void finished(Sample* sample);
+
+    unsigned int _native;
+    std::vector<Worker*> _workers;
+
+    SGMutex _lock;
+    SGWaitCondition _queued;
+    SGWaitCondition _idle;
+    std::deque<std::string> _queue;
+    std::set<std::string> _pending;
+    std::set<std::string> _discarded;   ///< pending, but not wanted anymore
+    std::map<std::string, Sample_ptr> _done;
+    bool _stop;
+};
+
+#endif // of SG_SOUND_SAMPLE_DECODER_HXX
@@ -28,9 +28,90 @@
 #include <simgear/sg_inlines.h>
 #include <simgear/debug/logstream.hxx>
 
+#include <algorithm>
+
 #include "soundmgr.hxx"
 #include "sample_group.hxx"
 
+#if defined(ENABLE_SIMD_CODE) && defined(__SSE__)
+# include <xmmintrin.h>
+# define SG_SAMPLE_GROUP_SSE 1
+#endif
+
+namespace
+{
+    template<class T>
+    void removeIndex( std::vector<T>& v, size_t index )
+    {
+        v[index] = v.back();
+        v.pop_back();
+    }
+
+    // out = offset + m * in for count vectors stored as separate x, y and z
+    // arrays, m is a row major 3x3 matrix
+    void transform( const float m[9], const float offset[3],
+                    const float *x, const float *y, const float *z,
+                    float *out_x, float *out_y, float *out_z, size_t count )
+    {
+        size_t i = 0;
+#ifdef SG_SAMPLE_GROUP_SSE
+        const __m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2 = _mm_set1_ps(m[2]);
+        const __m128 m3 = _mm_set1_ps(m[3]), m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]);
+        const __m128 m6 = _mm_set1_ps(m[6]), m7 = _mm_set1_ps(m[7]), m8 = _mm_set1_ps(m[8]);
+        const __m128 c0 = _mm_set1_ps(offset[0]);
+        const __m128 c1 = _mm_set1_ps(offset[1]);
+        const __m128 c2 = _mm_set1_ps(offset[2]);
+        for (; i + 4 <= count; i += 4) {
+            __m128 vx = _mm_loadu_ps(x + i);
+            __m128 vy = _mm_loadu_ps(y + i);
+            __m128 vz = _mm_loadu_ps(z + i);
+            _mm_storeu_ps(out_x + i, _mm_add_ps(c0, _mm_add_ps(_mm_mul_ps(m0, vx),
+                          _mm_add_ps(_mm_mul_ps(m1, vy), _mm_mul_ps(m2, vz)))));
+            _mm_storeu_ps(out_y + i, _mm_add_ps(c1, _mm_add_ps(_mm_mul_ps(m3, vx),
+                          _mm_add_ps(_mm_mul_ps(m4, vy), _mm_mul_ps(m5, vz)))));
+            _mm_storeu_ps(out_z + i, _mm_add_ps(c2, _mm_add_ps(_mm_mul_ps(m6, vx),
+                          _mm_add_ps(_mm_mul_ps(m7, vy), _mm_mul_ps(m8, vz)))));
+        }
+#endif
+        for (; i < count; ++i) {
+            out_x[i] = offset[0] + (m[0]*x[i] + (m[1]*y[i] + m[2]*z[i]));
+            out_y[i] = offset[1] + (m[3]*x[i] + (m[4]*y[i] + m[5]*z[i]));
+            out_z[i] = offset[2] + (m[6]*x[i] + (m[7]*y[i] + m[8]*z[i]));
+        }
+    }
+}
+
+void SGSampleGroup::SampleArrays::add( SGSoundSample *sound,
+                                       const std::string& refname )
+{
+    sample.push_back( sound );
+    name.push_back( refname );
+    rel_x.push_back( 0.0f ); rel_y.push_back( 0.0f ); rel_z.push_back( 0.0f );
+    dir_x.push_back( 0.0f ); dir_y.push_back( 0.0f ); dir_z.push_back( 0.0f );
+    pos_x.push_back( 0.0f ); pos_y.push_back( 0.0f ); pos_z.push_back( 0.0f );
+    ori_x.push_back( 0.0f ); ori_y.push_back( 0.0f ); ori_z.push_back( 0.0f );
+    sent_pos.push_back( SGVec3f::zeros() );
+    sent_ori.push_back( SGVec3f::zeros() );
+    sent_gain.push_back( 0.0f );
+    sent_pitch.push_back( 0.0f );
+    sent_vel.push_back( false );
+}
+
+void SGSampleGroup::SampleArrays::remove( size_t index )
+{
+    removeIndex( sample, index );
+    removeIndex( name, index );
+    removeIndex( rel_x, index ); removeIndex( rel_y, index ); removeIndex( rel_z, index );
+    removeIndex( dir_x, index ); removeIndex( dir_y, index ); removeIndex( dir_z, index );
+    removeIndex( pos_x, index ); removeIndex( pos_y, index ); removeIndex( pos_z, index );
+    removeIndex( ori_x, index ); removeIndex( ori_y, index ); removeIndex( ori_z, index );
+    removeIndex( sent_pos, index );
+    removeIndex( sent_ori, index );
+    removeIndex( sent_gain, index );
+    removeIndex( sent_pitch, index );
+    removeIndex( sent_vel, index );
+}
+
 SGSampleGroup::SGSampleGroup () :
     _smgr(NULL),
     _refname(""),
@@ -40,9 +121,12 @@ SGSampleGroup::SGSampleGroup () :
     _volume(1.0),
     _tied_to_listener(false),
     _velocity(SGVec3d::zeros()),
-    _orientation(SGQuatd::zeros())
+    _orientation(SGQuatd::zeros()),
+    _sample_velocity(SGVec3f::zeros())
 {
     _samples.clear();
+    for (int i = 0; i < 9; i++) _rotation[i] = (i % 4) ? 0.0f : 1.0f;
+    _offset[0] = _offset[1] = _offset[2] = 0.0f;
 }
 
 SGSampleGroup::SGSampleGroup ( SGSoundMgr *smgr,
@@ -55,10 +139,13 @@ SGSampleGroup::SGSampleGroup ( SGSoundMgr *smgr,
     _volume(1.0),
     _tied_to_listener(false),
     _velocity(SGVec3d::zeros()),
-    _orientation(SGQuatd::zeros())
+    _orientation(SGQuatd::zeros()),
+    _sample_velocity(SGVec3f::zeros())
 {
     _smgr->add(this, refname);
     _samples.clear();
+    for (int i = 0; i < 9; i++) _rotation[i] = (i % 4) ? 0.0f : 1.0f;
+    _offset[0] = _offset[1] = _offset[2] = 0.0f;
 }
 
 SGSampleGroup::~SGSampleGroup ()
@@ -81,11 +168,8 @@ void SGSampleGroup::cleanup_removed_samples()
 
         if ( stopped ) {
             sample->stop();
-            if (( !sample->is_queue() )&&
-                (sample->is_valid_buffer()))
-            {
-                _smgr->release_buffer(sample);
-            }
+            // releases the buffer, or what was decoded in advance
+            _smgr->sample_destroy(sample);
             _removed_samples.erase( _removed_samples.begin()+i );
             size--;
             continue;
@@ -94,15 +178,18 @@ void SGSampleGroup::cleanup_removed_samples()
     }
 }
 
-void SGSampleGroup::start_playing_sample(SGSoundSample *sample)
+void SGSampleGroup::start_playing_sample(size_t index)
 {
+    SGSoundSample *sample = _arrays.sample[index];
     _smgr->sample_init( sample );
-    update_sample_config( sample );
+    update_sample_config( index, SGSoundMgr::SAMPLE_DYNAMIC );
     _smgr->sample_play( sample );
 }
 
-void SGSampleGroup::check_playing_sample(SGSoundSample *sample)
+void SGSampleGroup::check_playing_sample(size_t index)
 {
+    SGSoundSample *sample = _arrays.sample[index];
+
     // check if the sound has stopped by itself
     if (_smgr->is_sample_stopped(sample)) {
         // sample is stopped because it wasn't looping
@@ -111,15 +198,13 @@ void SGSampleGroup::check_playing_sample(SGSoundSample *sample)
         _smgr->release_source( sample->get_source() );
         _smgr->release_buffer( sample );
         remove( sample->get_sample_name() );
-    } else if ( sample->has_changed() ) {
-        if ( !sample->is_playing() ) {
-            // a request to stop playing the sound has been filed.
-            sample->stop();
-            sample->no_valid_source();
-            _smgr->release_source( sample->get_source() );
-        } else if ( _smgr->has_changed() ) {
-            update_sample_config( sample );
-        }
+    } else if ( sample->has_changed() && !sample->is_playing() ) {
+        // a request to stop playing the sound has been filed.
+        sample->stop();
+        sample->no_valid_source();
+        _smgr->release_source( sample->get_source() );
+    } else {
+        update_sample_config( index, 0 );
     }
 }
 
@@ -136,17 +221,27 @@ void SGSampleGroup::update( double dt ) {
         update_pos_and_orientation();
         _changed = false;
     }
+    update_positions();
 
-    for (auto current =_samples.begin(); current !=_samples.end(); ++current) {
-        SGSoundSample *sample = current->second;
+    for (size_t i = 0; i < _arrays.size(); ) {
+        SGSoundSample *sample = _arrays.sample[i];
 
         if ( !sample->is_valid_source() && sample->is_playing() && !sample->test_out_of_range()) {
-            start_playing_sample(sample);
+            // stays silent until its file is decoded
+            if ( _smgr->prefetch_buffer(sample) ) {
+                start_playing_sample(i);
+            }
 
         } else if ( sample->is_valid_source() ) {
-            check_playing_sample(sample);
+            _smgr->update_stream(sample);
+            check_playing_sample(i);
         }
         testForMgrError("update");
+
+        // a sample which removed itself was replaced by the last one
+        if ( i < _arrays.size() && _arrays.sample[i] == sample ) {
+            ++i;
+        }
     }
 }
 
@@ -160,10 +255,19 @@ bool SGSampleGroup::add( SGSharedPtr<SGSoundSample> sound,
         return false;
     }
 
-    _samples[refname] = sound;
+    _samples[refname] = _arrays.size();
+    _arrays.add( sound, refname );
+    _smgr->prefetch_buffer(sound);
     return true;
 }
 
+void SGSampleGroup::prefetch()
+{
+    for (size_t i = 0; i < _arrays.size(); ++i) {
+        _smgr->prefetch_buffer(_arrays.sample[i]);
+    }
+}
+
 
 // remove a sound effect, return true if successful
 bool SGSampleGroup::remove( const std::string &refname ) {
@@ -174,10 +278,18 @@ bool SGSampleGroup::remove( const std::string &refname ) {
         return false;
     }
 
-    if ( sample_it->second->is_valid_buffer() )
-        _removed_samples.push_back( sample_it->second );
+    size_t index = sample_it->second;
+    if ( _arrays.sample[index]->is_valid_buffer() )
+        _removed_samples.push_back( _arrays.sample[index] );
+    else
+        // drops what was decoded in advance
+        _smgr->sample_destroy( _arrays.sample[index] );
 
     _samples.erase( sample_it );
+    _arrays.remove( index );
+    if ( index < _arrays.size() ) {
+        _samples[_arrays.name[index]] = index;
+    }
 
     return true;
 }
@@ -204,7 +316,7 @@ SGSoundSample *SGSampleGroup::find( const std::string &refname ) {
         return NULL;
     }
 
-    return sample_it->second;
+    return _arrays.sample[sample_it->second];
 }
 
 
@@ -212,9 +324,8 @@ void
 SGSampleGroup::stop ()
 {
     _pause = true;
-    for (auto current =_samples.begin(); current !=_samples.end(); ++current) {
-        SGSoundSample *sample = current->second;
-        _smgr->sample_destroy( sample );
+    for (size_t i = 0; i < _arrays.size(); ++i) {
+        _smgr->sample_destroy( _arrays.sample[i] );
     }
 }
 
@@ -224,10 +335,9 @@ SGSampleGroup::suspend ()
 {
     if (_active && _pause == false) {
         _pause = true;
-        for (auto current =_samples.begin(); current !=_samples.end(); ++current) {
+        for (size_t i = 0; i < _arrays.size(); ++i) {
 #ifdef ENABLE_SOUND
-            SGSoundSample *sample = current->second;
-            _smgr->sample_suspend( sample );
+            _smgr->sample_suspend( _arrays.sample[i] );
 #endif
         }
         testForMgrError("suspend");
@@ -240,9 +350,8 @@ SGSampleGroup::resume ()
 {
     if (_active && _pause == true) {
 #ifdef ENABLE_SOUND
-        for (auto current =_samples.begin(); current !=_samples.end(); ++current) {
-            SGSoundSample *sample = current->second;
-            _smgr->sample_resume( sample );
+        for (size_t i = 0; i < _arrays.size(); ++i) {
+            _smgr->sample_resume( _arrays.sample[i] );
         }
         testForMgrError("resume");
 #endif
@@ -298,7 +407,7 @@ void SGSampleGroup::set_volume( float vol )
     }
 }
 
-// set the source position and orientation of all managed sounds
+// set the base position and orientation of all managed sounds
 void SGSampleGroup::update_pos_and_orientation() {
 
     SGVec3d base_position = SGVec3d::fromGeod(_base_pos);
@@ -310,63 +419,137 @@ void SGSampleGroup::update_pos_and_orientation() {
     if ( _velocity[0] || _velocity[1] || _velocity[2] ) {
        velocity = toVec3f( hlOr.backTransform(_velocity*SG_FEET_TO_METER) );
     }
+    bool velocity_changed = _tied_to_listener || (velocity != _sample_velocity);
+    _sample_velocity = velocity;
+
+    // ec2body.rotate() as a matrix, applied to all samples at once
+    for (int c = 0; c < 3; c++) {
+        SGVec3d axis = SGVec3d::zeros();
+        axis[c] = 1.0;
+        SGVec3d column = ec2body.rotate(axis);
+        for (int r = 0; r < 3; r++) {
+            _rotation[r*3 + c] = column[r];
+        }
+    }
+
+    // the difference of two large ECEF positions stays in double
+    SGVec3d offset = base_position - smgr_position;
+    _offset[0] = offset[0];
+    _offset[1] = offset[1];
+    _offset[2] = offset[2];
 
-    for (auto current =_samples.begin(); current !=_samples.end(); ++current ) {
-        SGSoundSample *sample = current->second;
+    for (size_t i = 0; i < _arrays.size(); ++i) {
+        SGSoundSample *sample = _arrays.sample[i];
         sample->set_master_volume( _volume );
         sample->set_orientation( _orientation );
         sample->set_rotation( ec2body );
         sample->set_position(base_position);
         sample->set_velocity( velocity );
+        if ( velocity_changed ) {
+            _arrays.sent_vel[i] = false;
+        }
+    }
+}
 
-        // Test if a sample is farther away than max distance, if so
-        // stop the sound playback and free it's source.
-        if (!_tied_to_listener) {
-            sample->update_pos_and_orientation();
-            SGVec3d position = sample->get_position() - smgr_position;
-            float max2 = sample->get_max_dist() * sample->get_max_dist();
-            float dist2 = position[0]*position[0]
-                          + position[1]*position[1] + position[2]*position[2];
-            if ((dist2 > max2) && !sample->test_out_of_range()) {
-                sample->set_out_of_range(true);
-            } else if ((dist2 < max2) && sample->test_out_of_range()) {
-                sample->set_out_of_range(false);
-            }
+// the positions and orientations of all samples relative to the listener
+void SGSampleGroup::update_positions()
+{
+    size_t count = _arrays.size();
+    if ( _tied_to_listener ) {
+        SGVec3f orientation = _smgr->get_direction();
+        std::fill( _arrays.pos_x.begin(), _arrays.pos_x.end(), 0.0f );
+        std::fill( _arrays.pos_y.begin(), _arrays.pos_y.end(), 0.0f );
+        std::fill( _arrays.pos_z.begin(), _arrays.pos_z.end(), 0.0f );
+        std::fill( _arrays.ori_x.begin(), _arrays.ori_x.end(), orientation[0] );
+        std::fill( _arrays.ori_y.begin(), _arrays.ori_y.end(), orientation[1] );
+        std::fill( _arrays.ori_z.begin(), _arrays.ori_z.end(), orientation[2] );
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        SGSoundSample *sample = _arrays.sample[i];
+        sample->update_relative_position();
+        const SGVec3d& rel = sample->get_relative_position();
+        const SGVec3d& dir = sample->get_direction();
+        _arrays.rel_x[i] = rel[0];
+        _arrays.rel_y[i] = rel[1];
+        _arrays.rel_z[i] = rel[2];
+        _arrays.dir_x[i] = dir[0];
+        _arrays.dir_y[i] = dir[1];
+        _arrays.dir_z[i] = dir[2];
+    }
+
+    if ( count ) {
+        static const float none[3] = { 0.0f, 0.0f, 0.0f };
+        transform( _rotation, _offset,
+                   &_arrays.rel_x[0], &_arrays.rel_y[0], &_arrays.rel_z[0],
+                   &_arrays.pos_x[0], &_arrays.pos_y[0], &_arrays.pos_z[0],
+                   count );
+        transform( _rotation, none,
+                   &_arrays.dir_x[0], &_arrays.dir_y[0], &_arrays.dir_z[0],
+                   &_arrays.ori_x[0], &_arrays.ori_y[0], &_arrays.ori_z[0],
+                   count );
+    }
+
+    // Test if a sample is farther away than max distance, if so
+    // stop the sound playback and free it's source.
+    for (size_t i = 0; i < count; ++i) {
+        SGSoundSample *sample = _arrays.sample[i];
+        float max2 = sample->get_max_dist() * sample->get_max_dist();
+        float dist2 = _arrays.pos_x[i]*_arrays.pos_x[i]
+                      + _arrays.pos_y[i]*_arrays.pos_y[i]
+                      + _arrays.pos_z[i]*_arrays.pos_z[i];
+        if ((dist2 > max2) && !sample->test_out_of_range()) {
+            sample->set_out_of_range(true);
+        } else if ((dist2 < max2) && sample->test_out_of_range()) {
+            sample->set_out_of_range(false);
         }
     }
 }
 
-void SGSampleGroup::update_sample_config( SGSoundSample *sample )
+// pass the fields which changed since the last call on to the sound manager
+void SGSampleGroup::update_sample_config( size_t index, unsigned int fields )
 {
 #ifdef ENABLE_SOUND
-    SGVec3f orientation, velocity;
-    SGVec3d position;
-
-    if ( _tied_to_listener ) {
-        orientation = _smgr->get_direction();
-        position = SGVec3d::zeros();
-        velocity = _smgr->get_velocity();
-    } else {
-        sample->update_pos_and_orientation();
-        orientation = sample->get_orientation();
-        position = sample->get_position() - _smgr->get_position();
-        velocity = sample->get_velocity();
+    SGSoundSample *sample = _arrays.sample[index];
+    SGVec3f position( _arrays.pos_x[index], _arrays.pos_y[index],
+                      _arrays.pos_z[index] );
+    SGVec3f orientation( _arrays.ori_x[index], _arrays.ori_y[index],
+                         _arrays.ori_z[index] );
+    float gain = sample->get_volume();
+    float pitch = sample->get_pitch();
+
+    if ( position != _arrays.sent_pos[index] )
+        fields |= SGSoundMgr::SAMPLE_POSITION;
+    if ( orientation != _arrays.sent_ori[index] )
+        fields |= SGSoundMgr::SAMPLE_ORIENTATION;
+    if ( gain != _arrays.sent_gain[index] )
+        fields |= SGSoundMgr::SAMPLE_GAIN;
+    if ( pitch != _arrays.sent_pitch[index] )
+        fields |= SGSoundMgr::SAMPLE_PITCH;
+    if ( !_arrays.sent_vel[index] )
+        fields |= SGSoundMgr::SAMPLE_VELOCITY;
+    if ( sample->has_static_data_changed() )
+        fields |= SGSoundMgr::SAMPLE_STATIC;
+
+    if ( !fields ) {
+        return;
     }
 
+    SGVec3f velocity = _tied_to_listener ? _smgr->get_velocity()
+                                         : _sample_velocity;
     if (_smgr->bad_doppler_effect()) {
         velocity *= 100.0f;
     }
 
-#if 0
-    if (length(position) > 20000)
-        printf("%s source and listener distance greater than 20km!\n",
-               _refname.c_str());
-    if (isNaN(toVec3f(position).data())) printf("NaN in source position\n");
-    if (isNaN(orientation.data())) printf("NaN in source orientation\n");
-    if (isNaN(velocity.data())) printf("NaN in source velocity\n");
-#endif
+    SGVec3d pos = toVec3d( position );
+    _smgr->update_sample_config( sample, pos, orientation, velocity, fields );
 
-    _smgr->update_sample_config( sample, position, orientation, velocity );
+    _arrays.sent_pos[index] = position;
+    _arrays.sent_ori[index] = orientation;
+    _arrays.sent_gain[index] = gain;
+    _arrays.sent_pitch[index] = pitch;
+    _arrays.sent_vel[index] = true;
 #endif
 }
 
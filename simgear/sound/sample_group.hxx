@@ -88,6 +88,15 @@ public:
      */
     bool add( SGSharedPtr<SGSoundSample> sound, const std::string& refname );
 
+    /**
+     * Start decoding the files of all samples in this group in the
+     * background, e.g. while the aircraft is loading. A sample which is
+     * requested to play before its file is decoded stays silent until
+     * then; add() prefetches by itself once the sound manager is
+     * initialized.
+     */
+    void prefetch();
+
     /**
      * Remove an audio sample from this group.
      * @param refname Reference name of the audio sample to remove
@@ -207,9 +216,38 @@ protected:
     bool _active;
 
 private:
+    /**
+     * The samples of the group and their runtime state in parallel
+     * arrays, so that update() can transform the positions of all
+     * samples in one pass. The name map only holds indices into these.
+     */
+    struct SampleArrays
+    {
+        std::vector< SGSharedPtr<SGSoundSample> > sample;
+        std::vector<std::string> name;
+
+        // relative to the base position and the emission direction,
+        // before the rotation by the base orientation
+        std::vector<float> rel_x, rel_y, rel_z;
+        std::vector<float> dir_x, dir_y, dir_z;
+
+        // position relative to the listener, and the rotated direction
+        std::vector<float> pos_x, pos_y, pos_z;
+        std::vector<float> ori_x, ori_y, ori_z;
+
+        // what was passed on to the sound manager last
+        std::vector<SGVec3f> sent_pos, sent_ori;
+        std::vector<float> sent_gain, sent_pitch;
+        std::vector<unsigned char> sent_vel;
+
+        size_t size() const { return sample.size(); }
+        void add( SGSoundSample *sound, const std::string& refname );
+        void remove( size_t index );    // moves the last sample to index
+    };
+
     void cleanup_removed_samples();
-    void start_playing_sample(SGSoundSample *sample);
-    void check_playing_sample(SGSoundSample *sample);
+    void start_playing_sample(size_t index);
+    void check_playing_sample(size_t index);
   
     bool _changed;
     bool _pause;
@@ -220,14 +258,22 @@ private:
     SGGeod _base_pos;
     SGQuatd _orientation;
 
-    sample_map _samples;
+    // the base orientation as a matrix (row major) and the base position
+    // relative to the listener, for all samples
+    float _rotation[9];
+    float _offset[3];
+    SGVec3f _sample_velocity;
+
+    std::map<std::string, size_t> _samples;
+    SampleArrays _arrays;
     std::vector< SGSharedPtr<SGSoundSample> > _removed_samples;
 
     bool testForMgrError(std::string s);
     bool testForError(void *p, std::string s);
 
     void update_pos_and_orientation();
-    void update_sample_config( SGSoundSample *sound );
+    void update_positions();
+    void update_sample_config( size_t index, unsigned int fields );
 };
 
 #endif // _SG_SAMPLE_GROUP_OPENAL_HXX
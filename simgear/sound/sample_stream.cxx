@@ -0,0 +1,293 @@
+// sample_stream.cxx -- sound samples played while they are being read
+//
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include "sample_stream.hxx"
+
+#include <algorithm>
+
+#include <simgear/debug/logstream.hxx>
+#include <simgear/structure/exception.hxx>
+#include <simgear/threads/SGGuard.hxx>
+
+#include "wav_stream.hxx"
+
+//
+// SGSoundSampleStream
+//
+
+SGSoundSampleStream::SGSoundSampleStream(const char *file,
+                                         const SGPath& currentDir,
+                                         unsigned int chunks,
+                                         double chunk_length) :
+    SGSoundSample(file, currentDir),
+    _failed(false),
+    _chunks(std::max(chunks, 2u)),
+    _chunk_length(chunk_length),
+    _chunk_size(0),
+    _read(0),
+    _count(0),
+    _loop(false),
+    _eof(false),
+    _played(false),
+    _streamer(NULL)
+{
+}
+
+SGSoundSampleStream::~SGSoundSampleStream()
+{
+    if (_streamer) {
+        _streamer->remove(this);
+    }
+}
+
+bool SGSoundSampleStream::open()
+{
+    if (_reader || _failed) {
+        return !_failed;
+    }
+
+    try {
+        _reader.reset(new simgear::WAVStream(file_path()));
+    } catch (sg_exception& e) {
+        SG_LOG(SG_SOUND, SG_ALERT, "failed to stream sound:\n"
+               << e.getFormattedMessage());
+        _failed = true;
+        return false;
+    }
+
+    unsigned int format = _reader->format();
+    set_frequency(_reader->frequency());
+    set_format(format);
+    set_size(_reader->size());
+
+    // whole frames (IMA4 blocks) of about _chunk_length seconds
+    size_t frame = _reader->frame_size();
+    size_t bytes_per_second = _reader->frequency() * (format & 0x3)
+                              * (format & (SG_SAMPLE_8BITS|SG_SAMPLE_16BITS)) / 8;
+    size_t frames = size_t(bytes_per_second * _chunk_length) / frame;
+    _chunk_size = std::max(frames, size_t(1)) * frame;
+
+    _ring.assign(_chunks, std::vector<unsigned char>(_chunk_size));
+    _filled.assign(_chunks, 0);
+    return true;
+}
+
+void SGSoundSampleStream::start(bool loop)
+{
+    bool played;
+    {
+        SGGuard<SGMutex> g(_lock);
+        played = _played;
+    }
+
+    if (played && _reader) {
+        // not while the streamer decodes the next chunk
+        SGSoundStreamer* streamer = _streamer;
+        if (streamer) {
+            streamer->remove(this);
+        }
+
+        _reader->rewind();
+        {
+            SGGuard<SGMutex> g(_lock);
+            _read = 0;
+            _count = 0;
+            _eof = false;
+        }
+
+        if (streamer) {
+            streamer->add(this);
+        }
+    }
+
+    {
+        SGGuard<SGMutex> g(_lock);
+        _loop = loop;
+        if (loop) {
+            _eof = false;
+        }
+        _played = false;
+    }
+
+    if (_streamer) {
+        _streamer->wake();
+    }
+}
+
+const void* SGSoundSampleStream::front(size_t& length)
+{
+    SGGuard<SGMutex> g(_lock);
+    if (_count == 0) {
+        return NULL;
+    }
+    length = _filled[_read];
+    return &_ring[_read][0];
+}
+
+void SGSoundSampleStream::pop()
+{
+    {
+        SGGuard<SGMutex> g(_lock);
+        if (_count == 0) {
+            return;
+        }
+        _read = (_read + 1) % _chunks;
+        _count--;
+        _played = true;
+    }
+
+    if (_streamer) {
+        _streamer->wake();
+    }
+}
+
+bool SGSoundSampleStream::is_finished()
+{
+    SGGuard<SGMutex> g(_lock);
+    return _eof && (_count == 0);
+}
+
+bool SGSoundSampleStream::wants_data()
+{
+    SGGuard<SGMutex> g(_lock);
+    return _reader && !_eof && (_count < _chunks);
+}
+
+void SGSoundSampleStream::fill()
+{
+    unsigned int slot;
+    bool loop;
+    {
+        SGGuard<SGMutex> g(_lock);
+        if (_eof || (_count == _chunks)) {
+            return;
+        }
+        slot = (_read + _count) % _chunks;
+        loop = _loop;
+    }
+
+    // only front() and pop() touch the ring meanwhile, and never this slot
+    size_t length = _reader->read(&_ring[slot][0], _chunk_size, loop);
+
+    SGGuard<SGMutex> g(_lock);
+    if (length > 0) {
+        _filled[slot] = length;
+        _count++;
+    }
+    if (length == 0 || (length < _chunk_size && !loop)) {
+        _eof = true;
+    }
+}
+
+//
+// SGSoundStreamer
+//
+
+SGSoundStreamer::SGSoundStreamer() :
+    _busy(NULL),
+    _next(0),
+    _stop(false)
+{
+    start();
+}
+
+SGSoundStreamer::~SGSoundStreamer()
+{
+    {
+        SGGuard<SGMutex> g(_lock);
+        _stop = true;
+        _wake.signal();
+    }
+    join();
+
+    for (SGSoundSampleStream* stream : _streams) {
+        stream->_streamer = NULL;
+    }
+}
+
+bool SGSoundStreamer::add(SGSoundSampleStream* stream)
+{
+    if (!stream->open()) {
+        return false;
+    }
+
+    SGGuard<SGMutex> g(_lock);
+    if (stream->_streamer != this) {
+        _streams.push_back(stream);
+        stream->_streamer = this;
+    }
+    _wake.signal();
+    return true;
+}
+
+void SGSoundStreamer::remove(SGSoundSampleStream* stream)
+{
+    SGGuard<SGMutex> g(_lock);
+    auto it = std::find(_streams.begin(), _streams.end(), stream);
+    if (it != _streams.end()) {
+        _streams.erase(it);
+    }
+    while (_busy == stream) {
+        _idle.wait(_lock);
+    }
+    stream->_streamer = NULL;
+}
+
+void SGSoundStreamer::wake()
+{
+    SGGuard<SGMutex> g(_lock);
+    _wake.signal();
+}
+
+SGSoundSampleStream* SGSoundStreamer::next()
+{
+    // round robin, so that one stream can not starve the others
+    size_t count = _streams.size();
+    for (size_t i = 0; i < count; ++i) {
+        size_t index = (_next + i) % count;
+        if (_streams[index]->wants_data()) {
+            _next = index + 1;
+            return _streams[index];
+        }
+    }
+    return NULL;
+}
+
+void SGSoundStreamer::run()
+{
+    _lock.lock();
+    while (!_stop) {
+        SGSoundSampleStream* stream = next();
+        if (!stream) {
+            _wake.wait(_lock);
+            continue;
+        }
+
+        _busy = stream;
+        _lock.unlock();
+        stream->fill();
+        _lock.lock();
+        _busy = NULL;
+        _idle.broadcast();
+    }
+    _lock.unlock();
+}
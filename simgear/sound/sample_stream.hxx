@@ -0,0 +1,169 @@
+// sample_stream.hxx -- sound samples played while they are being read
+//
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef SG_SOUND_SAMPLE_STREAM_HXX
+#define SG_SOUND_SAMPLE_STREAM_HXX
+
+#include <memory>
+#include <vector>
+
+#include <simgear/threads/SGThread.hxx>
+
+#include "sample.hxx"
+
+namespace simgear { class WAVStream; }
+class SGSoundStreamer;
+
+/**
+ * A sound file which is decoded while it plays instead of being loaded
+ * as a whole, for long recordings and ambient loops. A background thread
+ * (SGSoundStreamer) keeps a small ring of decoded chunks filled, which
+ * the sound manager queues on the source as earlier chunks are played.
+ * Memory use depends on the length and number of the chunks, not on the
+ * length of the file.
+ */
+class SGSoundSampleStream : public SGSoundSample
+{
+public:
+    /**
+     * @param file File name of sound, an uncompressed (not gzipped) WAV
+     * @param currentDir Directory to resolve file against
+     * @param chunks Number of decoded chunks kept ahead
+     * @param chunk_length Length of a chunk in seconds
+     */
+    SGSoundSampleStream(const char *file, const SGPath& currentDir,
+                        unsigned int chunks = 4, double chunk_length = 0.25);
+    virtual ~SGSoundSampleStream();
+
+    virtual bool is_queue() const { return true; }
+
+    /**
+     * Map the file and read its format, once.
+     * @return false if the file can not be streamed.
+     */
+    bool open();
+
+    /**
+     * Check if open() failed.
+     */
+    bool is_failed() const { return _failed; }
+
+    /**
+     * Prepare to play from the beginning of the file. The chunks decoded
+     * in advance are kept, unless some were played already.
+     * @param loop Whether to continue at the start at the end of the file
+     */
+    void start(bool loop);
+
+    /**
+     * Get the oldest decoded chunk.
+     * @return NULL if there is none, otherwise valid until pop().
+     */
+    const void* front(size_t& length);
+
+    /**
+     * Release the chunk returned by front() to be filled again.
+     */
+    void pop();
+
+    /**
+     * Check if every chunk of a stream that does not loop has been
+     * popped.
+     */
+    bool is_finished();
+
+    /**
+     * The size of a chunk in bytes.
+     */
+    size_t chunk_size() const { return _chunk_size; }
+
+    /**
+     * The buffer-ids the sound manager queues the chunks with, and those
+     * of them which are not queued at the moment.
+     */
+    std::vector<unsigned int>& queue_buffers() { return _queue_buffers; }
+    std::vector<unsigned int>& free_buffers() { return _free_buffers; }
+
+private:
+    friend class SGSoundStreamer;
+
+    // called by the SGSoundStreamer thread
+    bool wants_data();
+    void fill();
+
+    std::unique_ptr<simgear::WAVStream> _reader;
+    bool _failed;
+    unsigned int _chunks;
+    double _chunk_length;
+    size_t _chunk_size;
+
+    SGMutex _lock;
+    std::vector< std::vector<unsigned char> > _ring;
+    std::vector<size_t> _filled;
+    unsigned int _read;
+    unsigned int _count;
+    bool _loop;
+    bool _eof;
+    bool _played;
+
+    SGSoundStreamer* _streamer;
+    std::vector<unsigned int> _queue_buffers;
+    std::vector<unsigned int> _free_buffers;
+};
+
+/**
+ * The thread which decodes the chunks of all attached streams.
+ */
+class SGSoundStreamer : public SGThread
+{
+public:
+    SGSoundStreamer();
+    ~SGSoundStreamer();
+
+    /**
+     * Open stream and start filling it.
+     * @return false if the stream can not be opened.
+     */
+    bool add(SGSoundSampleStream* stream);
+
+    /**
+     * Stop filling stream, waits while it is being filled.
+     */
+    void remove(SGSoundSampleStream* stream);
+
+    /**
+     * Notify the thread that a stream has room for another chunk.
+     */
+    void wake();
+
+protected:
+    virtual void run();
+
+private:
+    SGSoundSampleStream* next();
+
+    SGMutex _lock;
+    SGWaitCondition _wake;
+    SGWaitCondition _idle;
+    std::vector<SGSoundSampleStream*> _streams;
+    SGSoundSampleStream* _busy;
+    size_t _next;
+    bool _stop;
+};
+
+#endif // of SG_SOUND_SAMPLE_STREAM_HXX
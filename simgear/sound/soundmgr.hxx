@@ -216,6 +216,23 @@ public:
      */
     unsigned int request_buffer(SGSoundSample *sample);
 
+    /**
+     * Start decoding the file of a sample in the background, so that a
+     * later request_buffer() only has to upload it.
+     *
+     * @param sample Pointer to an audio sample to prepare
+     * @return true if request_buffer() will not have to wait for the file.
+     */
+    bool prefetch_buffer(SGSoundSample *sample);
+
+    /**
+     * Queue the chunks a streamed sample decoded since the last call on
+     * its source. Call this periodically while the sample plays.
+     *
+     * @param sample Pointer to an audio sample, ignored unless it streams
+     */
+    void update_stream( SGSoundSample *sample );
+
     /**
      * Free an OpenAL buffer-id for this sample
      *
@@ -273,12 +290,28 @@ public:
      */
     bool is_sample_stopped( SGSoundSample *sample );
 
+    /**
+     * Parameters of a sample for update_sample_config()
+     */
+    enum {
+        SAMPLE_POSITION = 1,
+        SAMPLE_ORIENTATION = 2,
+        SAMPLE_VELOCITY = 4,
+        SAMPLE_GAIN = 8,
+        SAMPLE_PITCH = 16,
+        SAMPLE_DYNAMIC = 31,    ///< all of the above
+        SAMPLE_STATIC = 32      ///< audio cone and distances
+    };
+
     /**
      * Update all status and 3d parameters of a sample.
      *
      * @param sample Pointer to an audio sample to update.
+     * @param fields The SAMPLE_ parameters to pass on to the audio
+     *        library. The static ones are passed on when they changed in
+     *        any case.
      */
-    void update_sample_config( SGSoundSample *sample, SGVec3d& position, SGVec3f& orientation, SGVec3f& velocity );
+    void update_sample_config( SGSoundSample *sample, SGVec3d& position, SGVec3f& orientation, SGVec3f& velocity, unsigned int fields = SAMPLE_DYNAMIC );
 
     /**
      * Test if the position of the sound manager has changed.
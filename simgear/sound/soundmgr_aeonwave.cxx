@@ -503,9 +503,20 @@ unsigned int  SGSoundMgr::request_buffer(SGSoundSample *sample)
     return bufid;
 }
 
+// AeonWave reads and decodes the files itself
+bool SGSoundMgr::prefetch_buffer(SGSoundSample *sample)
+{
+    return true;
+}
+
+// AeonWave plays the file of a streamed sample as a whole
+void SGSoundMgr::update_stream( SGSoundSample *sample )
+{
+}
+
 void SGSoundMgr::release_buffer(SGSoundSample *sample)
 {
-    if ( !sample->is_queue() )
+    if ( !sample->is_queue() || sample->is_file() )
     {
         unsigned int buffer = sample->get_buffer();
         auto buffer_it = d->_buffers.find(buffer);
@@ -550,7 +561,7 @@ void SGSoundMgr::sample_play( SGSoundSample *sample )
 #ifdef ENABLE_SOUND
     aax::Emitter& emitter = d->get_emitter(sample->get_source());
 
-    if ( !sample->is_queue() ) {
+    if ( !sample->is_queue() || sample->is_file() ) {
         unsigned int bufid = request_buffer(sample);
         if (bufid == SGSoundMgr::FAILED_BUFFER ||
             bufid == SGSoundMgr::NO_BUFFER)
@@ -633,30 +644,39 @@ bool SGSoundMgr::is_sample_stopped(SGSoundSample *sample)
 #endif
 }
 
-void SGSoundMgr::update_sample_config( SGSoundSample *sample, SGVec3d& position, SGVec3f& orientation, SGVec3f& velocity )
+void SGSoundMgr::update_sample_config( SGSoundSample *sample, SGVec3d& position, SGVec3f& orientation, SGVec3f& velocity, unsigned int fields )
 {
     aax::Emitter& emitter = d->get_emitter(sample->get_source());
     aax::dsp dsp;
 
     if (emitter != d->nullEmitter)
     {
-        aax::Vector64 pos = position.data();
-        aax::Vector ori = orientation.data();
-        aax::Vector vel = velocity.data();
+        // position and orientation share the emitter matrix
+        if ( fields & (SAMPLE_POSITION|SAMPLE_ORIENTATION) ) {
+            aax::Vector64 pos = position.data();
+            aax::Vector ori = orientation.data();
+            aax::Matrix64 mtx(pos, ori);
+            TRY( emitter.matrix(mtx) );
+        }
 
-        aax::Matrix64 mtx(pos, ori);
-        TRY( emitter.matrix(mtx) );
-        TRY( emitter.velocity(vel) );
+        if ( fields & SAMPLE_VELOCITY ) {
+            aax::Vector vel = velocity.data();
+            TRY( emitter.velocity(vel) );
+        }
 
-        dsp = emitter.get(AAX_VOLUME_FILTER);
-        TRY( dsp.set(AAX_GAIN, sample->get_volume()) );
-        TRY( emitter.set(dsp) );
+        if ( fields & SAMPLE_GAIN ) {
+            dsp = emitter.get(AAX_VOLUME_FILTER);
+            TRY( dsp.set(AAX_GAIN, sample->get_volume()) );
+            TRY( emitter.set(dsp) );
+        }
 
-        dsp = emitter.get(AAX_PITCH_EFFECT);
-        TRY( dsp.set(AAX_PITCH, sample->get_pitch()) );
-        TRY( emitter.set(dsp) );
+        if ( fields & SAMPLE_PITCH ) {
+            dsp = emitter.get(AAX_PITCH_EFFECT);
+            TRY( dsp.set(AAX_PITCH, sample->get_pitch()) );
+            TRY( emitter.set(dsp) );
+        }
 
-        if ( sample->has_static_data_changed() ) {
+        if ( (fields & SAMPLE_STATIC) || sample->has_static_data_changed() ) {
             dsp = emitter.get(AAX_ANGULAR_FILTER);
             TRY( dsp.set(AAX_INNER_ANGLE, sample->get_innerangle()) );
             TRY( dsp.set(AAX_OUTER_ANGLE, sample->get_outerangle()) );
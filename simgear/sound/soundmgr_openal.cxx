@@ -35,9 +35,13 @@
 #include <algorithm>
 #include <cstring>
 #include <cassert>
+#include <map>
+#include <set>
 
 #include "soundmgr.hxx"
 #include "readwav.hxx"
+#include "sample_decoder.hxx"
+#include "sample_stream.hxx"
 #include "soundmgr_openal_private.hxx"
 #include "sample_group.hxx"
 
@@ -64,6 +68,9 @@ using std::vector;
 # define AL_UNPACK_BLOCK_ALIGNMENT_SOFT	0x200C
 #endif
 
+// buffers queued on the source of a streamed sample
+#define STREAM_BUFFERS			3
+
 class SGSoundMgr::SoundManagerPrivate
 {
 public:
@@ -108,6 +115,56 @@ public:
 
         _absolute_pos = _base_pos;
     }
+
+    ALenum stream_format(SGSoundSampleStream *stream)
+    {
+        switch( stream->get_format() )
+        {
+        case SG_SAMPLE_MONO8:
+            return AL_FORMAT_MONO8;
+        case SG_SAMPLE_STEREO16:
+            return AL_FORMAT_STEREO16;
+        case SG_SAMPLE_STEREO8:
+            return AL_FORMAT_STEREO8;
+        default:
+            return AL_FORMAT_MONO16;
+        }
+    }
+
+    // fill the free buffers of stream with its decoded chunks and queue
+    // them on source
+    void queue_chunks(SGSoundSampleStream *stream, ALuint source)
+    {
+        ALenum format = stream_format(stream);
+        std::vector<unsigned int>& free_buffers = stream->free_buffers();
+        const void *data;
+        size_t length;
+        while ( !free_buffers.empty() && (data = stream->front(length)) ) {
+            ALuint buffer = free_buffers.back();
+            alBufferData( buffer, format, data, length, stream->get_frequency() );
+            alSourceQueueBuffers( source, 1, &buffer );
+            free_buffers.pop_back();
+            stream->pop();
+        }
+    }
+
+    // keep source alive while the streamer catches up
+    void queue_silence(SGSoundSampleStream *stream, ALuint source)
+    {
+        std::vector<unsigned int>& free_buffers = stream->free_buffers();
+        if ( free_buffers.empty() ) {
+            return;
+        }
+
+        ALenum format = stream_format(stream);
+        bool pcm8 = (format == AL_FORMAT_MONO8 || format == AL_FORMAT_STEREO8);
+        std::vector<unsigned char> silence( stream->chunk_size(), pcm8 ? 0x80 : 0 );
+        ALuint buffer = free_buffers.back();
+        alBufferData( buffer, format, &silence[0], silence.size(),
+                      stream->get_frequency() );
+        alSourceQueueBuffers( source, 1, &buffer );
+        free_buffers.pop_back();
+    }
         
     ALCdevice *_device;
     ALCcontext *_context;
@@ -124,6 +181,14 @@ public:
     
     sample_group_map _sample_groups;
     buffer_map _buffers;
+
+    // decodes sample files ahead of their first use
+    std::unique_ptr<SGSampleDecoder> _decoder;
+    // the samples waiting for each file prefetched by the decoder
+    std::map<std::string, std::set<const SGSoundSample*> > _prefetching;
+
+    // decodes the chunks of streamed samples
+    std::unique_ptr<SGSoundStreamer> _streamer;
 };
 
 
@@ -256,6 +321,9 @@ void SGSoundMgr::init()
     if (d->_free_sources.empty()) {
         SG_LOG(SG_SOUND, SG_ALERT, "Unable to grab any OpenAL sources!");
     }
+
+    d->_decoder.reset(new SGSampleDecoder(simgear::nativeWAVFormats()));
+    d->_streamer.reset(new SGSoundStreamer);
 #endif
 }
 
@@ -319,6 +387,9 @@ void SGSoundMgr::stop()
     
     d->_buffers.clear();
     d->_sources_in_use.clear();
+    d->_decoder.reset();
+    d->_prefetching.clear();
+    d->_streamer.reset();
 
     if (is_working()) {
         _active = false;
@@ -537,10 +608,39 @@ unsigned int SGSoundMgr::request_buffer(SGSoundSample *sample)
         }
 
         // sample name was not found in the buffer cache.
-        if ( sample->is_file() ) {
+        SGSampleDecoder::Sample_ptr decoded;
+        if ( sample->is_file() && d->_decoder ) {
+            decoded = d->_decoder->take( sample_name );
+            // the other samples of the file find the buffer cached
+            d->_prefetching.erase( sample_name );
+        }
+
+        if ( decoded ) {
+            // decoded in the background by prefetch_buffer()
+            if ( decoded->failed ) {
+              SG_LOG(SG_SOUND, SG_ALERT,
+                    "failed to load sound buffer:\n" << decoded->error);
+              sample->set_buffer( SGSoundMgr::FAILED_BUFFER );
+              return FAILED_BUFFER;
+            }
+
+            sample_data = decoded->data;
+            decoded->data = NULL;
+
+            sample->set_block_align( decoded->block_align );
+            sample->set_frequency( (int)decoded->frequency );
+            sample->set_format( decoded->format );
+            sample->set_size( decoded->size );
+
+        } else if ( sample->is_file() ) {
             int freq, format, block;
             size_t size;
 
+            // a background decode still running is not needed anymore
+            if ( d->_decoder ) {
+                d->_decoder->discard( sample_name );
+            }
+
             try {
               bool res = load(sample_name, &sample_data, &format, &size, &freq, &block);
               if (res == false) return NO_BUFFER;
@@ -617,6 +717,40 @@ unsigned int SGSoundMgr::request_buffer(SGSoundSample *sample)
     return buffer;
 }
 
+bool SGSoundMgr::prefetch_buffer(SGSoundSample *sample)
+{
+#ifdef ENABLE_SOUND
+    if ( sample->is_queue() ) {
+        SGSoundSampleStream *stream = dynamic_cast<SGSoundSampleStream*>(sample);
+        if ( !stream || sample->is_valid_source() || !d->_streamer ||
+             !d->_streamer->add(stream) ) {
+            return true;
+        }
+
+        // keeps the chunks decoded in advance unless they were played
+        stream->start( sample->is_looping() );
+        size_t length;
+        return stream->front(length) || stream->is_finished();
+    }
+
+    if ( sample->is_valid_buffer() || !sample->is_file() || !d->_decoder ) {
+        return true;
+    }
+
+    std::string sample_name = sample->get_sample_name();
+    if ( d->_buffers.find( sample_name ) != d->_buffers.end() ) {
+        return true;
+    }
+
+    // a no-op if the file is decoded or being decoded already
+    d->_prefetching[sample_name].insert( sample );
+    d->_decoder->request( sample_name );
+    return !d->_decoder->is_pending( sample_name );
+#else
+    return true;
+#endif
+}
+
 void SGSoundMgr::release_buffer(SGSoundSample *sample)
 {
     if ( !sample->is_queue() )
@@ -639,6 +773,59 @@ void SGSoundMgr::release_buffer(SGSoundSample *sample)
             testForError("release buffer");
         }
     }
+    else
+    {
+        // the buffers of a stream are its own
+        SGSoundSampleStream *stream = dynamic_cast<SGSoundSampleStream*>(sample);
+        if ( stream && !stream->queue_buffers().empty() ) {
+#ifdef ENABLE_SOUND
+            std::vector<unsigned int>& buffers = stream->queue_buffers();
+            alDeleteBuffers( buffers.size(), &buffers[0] );
+#endif
+            stream->queue_buffers().clear();
+            stream->free_buffers().clear();
+            testForError("release stream buffers");
+        }
+        sample->no_valid_buffer();
+    }
+}
+
+void SGSoundMgr::update_stream( SGSoundSample *sample )
+{
+#ifdef ENABLE_SOUND
+    if ( !sample->is_queue() || !sample->is_valid_source() ) {
+        return;
+    }
+
+    SGSoundSampleStream *stream = dynamic_cast<SGSoundSampleStream*>(sample);
+    if ( !stream ) {
+        return;
+    }
+
+    ALuint source = sample->get_source();
+    ALint processed = 0;
+    alGetSourcei( source, AL_BUFFERS_PROCESSED, &processed );
+    while ( processed-- > 0 ) {
+        ALuint buffer;
+        alSourceUnqueueBuffers( source, 1, &buffer );
+        stream->free_buffers().push_back( buffer );
+    }
+
+    d->queue_chunks( stream, source );
+
+    // restart a source which ran dry before the streamer caught up
+    ALint state;
+    alGetSourcei( source, AL_SOURCE_STATE, &state );
+    if ( state == AL_STOPPED && sample->is_playing() && !stream->is_finished() ) {
+        ALint queued = 0;
+        alGetSourcei( source, AL_BUFFERS_QUEUED, &queued );
+        if ( queued == 0 ) {
+            d->queue_silence( stream, source );
+        }
+        alSourcePlay( source );
+    }
+    testForError("update stream");
+#endif
 }
 
 void SGSoundMgr::sample_suspend( SGSoundSample *sample )
@@ -695,6 +882,36 @@ void SGSoundMgr::sample_play( SGSoundSample *sample )
         } else
             SG_LOG( SG_SOUND, SG_ALERT, "No such buffer!");
     }
+    else
+    {
+        SGSoundSampleStream *stream = dynamic_cast<SGSoundSampleStream*>(sample);
+        if ( !stream || !d->_streamer || !d->_streamer->add(stream) ) {
+            release_source(source);
+            return;
+        }
+
+        if ( stream->queue_buffers().empty() ) {
+            ALuint buffers[STREAM_BUFFERS];
+            alGenBuffers( STREAM_BUFFERS, buffers );
+            if ( testForError("generate stream buffers") ) {
+                release_source(source);
+                return;
+            }
+            stream->queue_buffers().assign( buffers, buffers + STREAM_BUFFERS );
+            sample->set_buffer( buffers[0] );
+        }
+
+        // the source may still hold the queue of an earlier sample
+        alSourcei( source, AL_BUFFER, 0 );
+        stream->free_buffers() = stream->queue_buffers();
+
+        stream->start( sample->is_looping() );
+        d->queue_chunks( stream, source );
+        testForError("queue stream buffers");
+
+        // the stream loops by itself
+        looping = AL_FALSE;
+    }
 
     alSourcef( source, AL_ROLLOFF_FACTOR, 0.3 );
     alSourcei( source, AL_LOOPING, looping );
@@ -741,6 +958,17 @@ void SGSoundMgr::sample_destroy( SGSoundSample *sample )
     if ( sample->is_valid_buffer() ) {
         release_buffer( sample );
         sample->no_valid_buffer();
+    } else if ( sample->is_file() && d->_decoder ) {
+        // prefetched, but never played: drop the decoded file unless
+        // another sample still waits for it
+        auto it = d->_prefetching.find( sample->get_sample_name() );
+        if ( it != d->_prefetching.end() ) {
+            it->second.erase( sample );
+            if ( it->second.empty() ) {
+                d->_decoder->discard( it->first );
+                d->_prefetching.erase( it );
+            }
+        }
     }
 }
 
@@ -757,19 +985,27 @@ bool SGSoundMgr::is_sample_stopped(SGSoundSample *sample)
     return true;
 }
 
-void SGSoundMgr::update_sample_config( SGSoundSample *sample, SGVec3d& position, SGVec3f& orientation, SGVec3f& velocity )
+void SGSoundMgr::update_sample_config( SGSoundSample *sample, SGVec3d& position, SGVec3f& orientation, SGVec3f& velocity, unsigned int fields )
 {
     unsigned int source = sample->get_source();
-    alSourcefv( source, AL_POSITION, toVec3f(position).data() );
-    alSourcefv( source, AL_VELOCITY, velocity.data() );
-    alSourcefv( source, AL_DIRECTION, orientation.data() );
-    testForError("position and orientation");
-
-    alSourcef( source, AL_PITCH, sample->get_pitch() );
-    alSourcef( source, AL_GAIN, sample->get_volume() );
-    testForError("pitch and gain");
+    if ( fields & SAMPLE_POSITION ) {
+        alSourcefv( source, AL_POSITION, toVec3f(position).data() );
+    }
+    if ( fields & SAMPLE_VELOCITY ) {
+        alSourcefv( source, AL_VELOCITY, velocity.data() );
+    }
+    if ( fields & SAMPLE_ORIENTATION ) {
+        alSourcefv( source, AL_DIRECTION, orientation.data() );
+    }
+    if ( fields & SAMPLE_PITCH ) {
+        alSourcef( source, AL_PITCH, sample->get_pitch() );
+    }
+    if ( fields & SAMPLE_GAIN ) {
+        alSourcef( source, AL_GAIN, sample->get_volume() );
+    }
+    testForError("position, orientation, pitch and gain");
 
-    if ( sample->has_static_data_changed() ) {
+    if ( (fields & SAMPLE_STATIC) || sample->has_static_data_changed() ) {
         alSourcef( source, AL_CONE_INNER_ANGLE, sample->get_innerangle() );
         alSourcef( source, AL_CONE_OUTER_ANGLE, sample->get_outerangle() );
         alSourcef( source, AL_CONE_OUTER_GAIN, sample->get_outergain() );
@@ -101,6 +101,28 @@ int main( int argc, char *argv[] ) {
     smgr->update(1);
     sleep(1);
 
+    // a moving group with many samples of which only some play
+    SGSampleGroup *bench = smgr->find("bench", true);
+    for (int i=0; i<1000; i++) {
+        SGSoundSample *sample = new SGSoundSample("jet.wav", srcDir);
+        sample->set_relative_position(SGVec3f(i % 10, (i / 10) % 10, i / 100));
+        sample->set_volume(0.01);
+        if (i % 32 == 0) sample->play_looped();
+        char name[16];
+        snprintf(name, sizeof(name), "bench%i", i);
+        bench->add(sample, name);
+    }
+    smgr->update(1);
+
+    SGTimeStamp start = SGTimeStamp::now();
+    for (int i=0; i<100; i++) {
+        bench->set_position_geod(SGGeod::fromDegM(4.0 + i*1e-5, 52.0, 100.0));
+        smgr->update(0.01);
+    }
+    printf("update with 1000 samples: %i usec\n",
+           int(start.elapsedUSec() / 100));
+    smgr->remove("bench");
+
     smgr->unbind();
     sleep(2);
     delete smgr;
@@ -0,0 +1,140 @@
+#include <simgear_config.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <simgear/misc/sg_path.hxx>
+#include <simgear/misc/test_macros.hxx>
+#include <simgear/structure/SGSharedPtr.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include "readwav.hxx"
+#include "sample_stream.hxx"
+#include "wav_stream.hxx"
+
+using std::cout;
+using std::endl;
+using std::string;
+
+// the file as loadWAVFromFile() decodes it
+string load(const string& file)
+{
+    unsigned int format, block_align;
+    ALsizei size;
+    ALfloat freq;
+    SGPath path(SRC_DIR);
+    path.append(file);
+    ALvoid* data = simgear::loadWAVFromFile(path, 0, format, size, freq,
+                                            block_align);
+    SG_VERIFY(data);
+    string result((const char*)data, size);
+    free(data);
+    return result;
+}
+
+void testReader(const string& file)
+{
+    string expected = load(file);
+
+    SGPath path(SRC_DIR);
+    path.append(file);
+    simgear::WAVStream reader(path);
+    SG_CHECK_EQUAL(reader.size(), expected.size());
+    SG_CHECK_EQUAL(reader.frequency(), 11025);
+
+    // in pieces which are no multiple of an IMA4 block
+    string decoded;
+    std::vector<char> buffer(reader.frame_size() * 3);
+    while (!reader.at_end()) {
+        size_t length = reader.read(&buffer[0], buffer.size(), false);
+        SG_VERIFY(length > 0);
+        SG_CHECK_EQUAL(length % reader.frame_size(), 0);
+        decoded.append(&buffer[0], length);
+    }
+    SG_CHECK_EQUAL(reader.read(&buffer[0], buffer.size(), false), 0);
+    SG_CHECK_EQUAL(decoded.size(), expected.size());
+    SG_VERIFY(decoded == expected);
+
+    // looping wraps around to the start
+    reader.rewind();
+    std::vector<char> twice(expected.size() * 2);
+    SG_CHECK_EQUAL(reader.read(&twice[0], twice.size(), true), twice.size());
+    SG_VERIFY(memcmp(&twice[0], expected.data(), expected.size()) == 0);
+    SG_VERIFY(memcmp(&twice[expected.size()], expected.data(), expected.size()) == 0);
+}
+
+// take chunks off stream until it has delivered length bytes or finished
+string consume(SGSoundSampleStream* stream, size_t length)
+{
+    string result;
+    SGTimeStamp start = SGTimeStamp::now();
+    while (result.size() < length && !stream->is_finished()) {
+        size_t size;
+        const void* data = stream->front(size);
+        if (!data) {
+            SG_VERIFY(start.elapsedMSec() < 10000);
+            SGTimeStamp::sleepForMSec(1);
+            continue;
+        }
+        SG_VERIFY(size <= stream->chunk_size());
+        result.append((const char*)data, size);
+        stream->pop();
+    }
+    return result;
+}
+
+void testStream()
+{
+    string expected = load("jet_ima4.wav");
+    SGSoundStreamer streamer;
+
+    SGSharedPtr<SGSoundSampleStream> stream =
+        new SGSoundSampleStream("jet_ima4.wav", SGPath(SRC_DIR), 3, 0.1);
+    SG_VERIFY(streamer.add(stream));
+    SG_CHECK_EQUAL(stream->get_size(), expected.size());
+    // the ring holds a fraction of the file
+    SG_VERIFY(stream->chunk_size() * 3 < expected.size());
+
+    stream->start(false);
+    string played = consume(stream, expected.size() * 2);
+    SG_VERIFY(stream->is_finished());
+    SG_VERIFY(played == expected);
+
+    // again, looping
+    stream->start(true);
+    played = consume(stream, expected.size() * 3);
+    SG_VERIFY(!stream->is_finished());
+    SG_VERIFY(played.size() >= expected.size() * 3);
+    SG_VERIFY(played.compare(0, expected.size(), expected) == 0);
+    SG_VERIFY(played.compare(expected.size() * 2, expected.size(), expected) == 0);
+
+    // a second stream shares the thread
+    SGSharedPtr<SGSoundSampleStream> other =
+        new SGSoundSampleStream("jet_ulaw.wav", SGPath(SRC_DIR));
+    SG_VERIFY(streamer.add(other));
+    other->start(false);
+    SG_VERIFY(consume(other, ~size_t(0)) == load("jet_ulaw.wav"));
+
+    // removed while the streamer may be filling it
+    streamer.remove(stream);
+    stream = NULL;
+
+    SGSharedPtr<SGSoundSampleStream> missing =
+        new SGSoundSampleStream("missing.wav", SGPath(SRC_DIR));
+    SG_VERIFY(!streamer.add(missing));
+    SG_VERIFY(missing->is_failed());
+}
+
+int main(int argc, char* argv[])
+{
+    testReader("jet.wav");
+    testReader("jet_ulaw.wav");
+    testReader("jet_ima4.wav");
+    testStream();
+
+    cout << "all tests passed" << endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,299 @@
+// wav_stream.cxx -- reads a WAV file piecewise from a memory mapping
+//
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifdef HAVE_CONFIG_H
+#  include <simgear_config.h>
+#endif
+
+#include "wav_stream.hxx"
+
+#include <cstring>
+#include <string>
+
+#if defined(SG_WINDOWS)
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+#include <simgear/misc/stdint.hxx>
+#include <simgear/structure/exception.hxx>
+
+#include "codecs.hxx"
+#include "sample.hxx"
+
+namespace
+{
+  inline uint16_t readLE16(const uint8_t* p)
+  {
+    return p[0] | (p[1] << 8);
+  }
+
+  inline uint32_t readLE32(const uint8_t* p)
+  {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24);
+  }
+
+  inline bool isChunk(const uint8_t* p, const char* id)
+  {
+    return memcmp(p, id, 4) == 0;
+  }
+}
+
+namespace simgear
+{
+
+WAVStream::WAVStream(const SGPath& path) :
+    _map(NULL),
+    _map_size(0),
+#if defined(SG_WINDOWS)
+    _file(INVALID_HANDLE_VALUE),
+    _mapping(NULL),
+#endif
+    _data(NULL),
+    _length(0),
+    _pos(0),
+    _encoding(PCM),
+    _format(0),
+    _frequency(0),
+    _block_align(0),
+    _in_unit(1),
+    _out_unit(1)
+{
+    map(path);
+    try {
+        parse(path);
+    } catch (...) {
+        unmap();
+        throw;
+    }
+}
+
+WAVStream::~WAVStream()
+{
+    unmap();
+}
+
+void WAVStream::map(const SGPath& path)
+{
+#if defined(SG_WINDOWS)
+    std::wstring ws = path.wstr();
+    _file = CreateFileW(ws.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                        OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (_file == INVALID_HANDLE_VALUE) {
+        throw sg_io_exception("WAVStream: unable to open file", path);
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(_file, &size) || size.QuadPart == 0) {
+        unmap();
+        throw sg_io_exception("WAVStream: empty file", path);
+    }
+    _map_size = size.QuadPart;
+
+    _mapping = CreateFileMappingW(_file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (_mapping) {
+        _map = (const uint8_t*) MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+#else
+    std::string ps = path.utf8Str();
+    int fd = open(ps.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw sg_io_exception("WAVStream: unable to open file", path);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        throw sg_io_exception("WAVStream: empty file", path);
+    }
+    _map_size = st.st_size;
+
+    void* p = mmap(NULL, _map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps the file open
+    if (p != MAP_FAILED) {
+        _map = (const uint8_t*) p;
+# ifdef POSIX_MADV_SEQUENTIAL
+        posix_madvise(p, _map_size, POSIX_MADV_SEQUENTIAL);
+# endif
+    }
+#endif
+
+    if (!_map) {
+        unmap();
+        throw sg_io_exception("WAVStream: unable to map file", path);
+    }
+}
+
+void WAVStream::unmap()
+{
+#if defined(SG_WINDOWS)
+    if (_map) {
+        UnmapViewOfFile(_map);
+    }
+    if (_mapping) {
+        CloseHandle(_mapping);
+        _mapping = NULL;
+    }
+    if (_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(_file);
+        _file = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (_map) {
+        munmap((void*) _map, _map_size);
+    }
+#endif
+    _map = NULL;
+    _data = NULL;
+}
+
+void WAVStream::parse(const SGPath& path)
+{
+    if (_map_size < 12 || !isChunk(_map, "RIFF") || !isChunk(_map + 8, "WAVE")) {
+        // gzipped files can only be loaded as a whole
+        throw sg_io_exception("WAVStream: not an uncompressed .wav file", path);
+    }
+
+    bool found_header = false;
+    uint16_t audioFormat = 0;
+    uint16_t numChannels = 0;
+    uint16_t bitsPerSample = 0;
+
+    size_t pos = 12;
+    while (pos + 8 <= _map_size) {
+        const uint8_t* chunk = _map + pos;
+        size_t chunkLength = readLE32(chunk + 4);
+        size_t available = _map_size - (pos + 8);
+
+        if (isChunk(chunk, "fmt ")) {
+            if (chunkLength < 16 || chunkLength > available) {
+                throw sg_io_exception("corrupt or truncated WAV data", path);
+            }
+            found_header = true;
+            audioFormat = readLE16(chunk + 8);
+            numChannels = readLE16(chunk + 10);
+            _frequency = readLE32(chunk + 12);
+            _block_align = readLE16(chunk + 20);
+            bitsPerSample = readLE16(chunk + 22);
+        } else if (isChunk(chunk, "data")) {
+            // play what there is of a truncated file
+            _data = chunk + 8;
+            _length = (chunkLength < available) ? chunkLength : available;
+        }
+
+        if (found_header && _data) {
+            break;
+        }
+        pos += 8 + chunkLength + (chunkLength & 1);
+    }
+
+    if (!found_header || !_data) {
+        throw sg_io_exception("corrupt or truncated WAV data", path);
+    }
+
+    if (numChannels < 1 || numChannels > 2) {
+        throw sg_io_exception("WAVStream: unsupported number of channels", path);
+    }
+    unsigned int tracks = (numChannels == 1) ? SG_SAMPLE_MONO : SG_SAMPLE_STEREO;
+
+    switch (audioFormat)
+    {
+    case 1:            /* PCM */
+        if (bitsPerSample != 8 && bitsPerSample != 16) {
+            throw sg_io_exception("WAVStream: unsupported sample size", path);
+        }
+        _encoding = (bitsPerSample == 8 || sgIsLittleEndian()) ? PCM : PCM16_SWAP;
+        _format = tracks | bitsPerSample;
+        _in_unit = _out_unit = numChannels * bitsPerSample / 8;
+        break;
+    case 7:            /* uLaw */
+        _encoding = ULAW;
+        _format = tracks | SG_SAMPLE_16BITS;
+        _in_unit = numChannels;
+        _out_unit = numChannels * 2;
+        break;
+    case 17:           /* IMA4 ADPCM */
+        if (numChannels != 1 || ima4BlockSamples(_block_align) == 0) {
+            throw sg_io_exception("WAVStream: unsupported IMA4 layout", path);
+        }
+        _encoding = IMA4;
+        _format = SG_SAMPLE_MONO16;
+        _in_unit = _block_align;
+        _out_unit = ima4BlockSamples(_block_align) * 2;
+        break;
+    default:
+        throw sg_io_exception("unsupported WAV encoding", path);
+    }
+}
+
+size_t WAVStream::size() const
+{
+    return (_length / _in_unit) * _out_unit;
+}
+
+void WAVStream::decode(const uint8_t* in, size_t units, uint8_t* out)
+{
+    switch (_encoding)
+    {
+    case PCM:
+        memcpy(out, in, units * _in_unit);
+        break;
+    case PCM16_SWAP:
+        memcpy(out, in, units * _in_unit);
+        swapPCM16((uint16_t*) out, units * _in_unit / 2);
+        break;
+    case ULAW:
+        decodeULaw(in, units * _in_unit, (int16_t*) out);
+        break;
+    case IMA4:
+        decodeIMA4(in, units * _in_unit, _block_align, (int16_t*) out);
+        break;
+    }
+}
+
+size_t WAVStream::read(void* out, size_t length, bool loop)
+{
+    uint8_t* dest = (uint8_t*) out;
+    size_t done = 0;
+
+    while (length - done >= _out_unit) {
+        if (at_end()) {
+            if (!loop || _length < _in_unit) {
+                break;
+            }
+            _pos = 0;
+        }
+
+        size_t units = (length - done) / _out_unit;
+        size_t left = (_length - _pos) / _in_unit;
+        if (units > left) {
+            units = left;
+        }
+
+        decode(_data + _pos, units, dest + done);
+        _pos += units * _in_unit;
+        done += units * _out_unit;
+    }
+    return done;
+}
+
+} // of namespace simgear
@@ -0,0 +1,118 @@
+// wav_stream.hxx -- reads a WAV file piecewise from a memory mapping
+//
+// Copyright (C) 2026  The FlightGear Project
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef SG_SOUND_WAV_STREAM_HXX
+#define SG_SOUND_WAV_STREAM_HXX
+
+#include <cstddef>
+#include <cstdint>
+
+#include <simgear/compiler.h>
+#include <simgear/misc/sg_path.hxx>
+
+namespace simgear
+{
+
+/**
+ * Decodes a WAV file to linear PCM a piece at a time. The file is mapped
+ * into memory rather than read, so only the pages around the current
+ * position are resident, whatever the length of the file.
+ *
+ * Unlike loadWAVFromFile() this needs an uncompressed (not gzipped)
+ * file. µ-law and IMA4 data are decoded to 16 bit samples.
+ */
+class WAVStream
+{
+public:
+    /**
+     * Map and parse the header of path.
+     * Throws sg_io_exception if that fails or the encoding is unsupported.
+     */
+    explicit WAVStream(const SGPath& path);
+    ~WAVStream();
+
+    /**
+     * The SG_SAMPLE_ format of the decoded data.
+     */
+    unsigned int format() const { return _format; }
+
+    unsigned int frequency() const { return _frequency; }
+
+    /**
+     * The number of bytes read() decodes at least, it only returns
+     * multiples of this. For IMA4 this is one decoded block.
+     */
+    size_t frame_size() const { return _out_unit; }
+
+    /**
+     * The number of decoded bytes in the complete file.
+     */
+    size_t size() const;
+
+    /**
+     * Decode up to length bytes from the current position to out.
+     *
+     * @param loop Continue at the start of the data at its end
+     * @return The number of bytes written, which is less than length
+     *         only at the end of the data if loop is false.
+     */
+    size_t read(void* out, size_t length, bool loop);
+
+    /**
+     * Continue reading at the start of the data.
+     */
+    void rewind() { _pos = 0; }
+
+    /**
+     * Check if the last complete frame has been read.
+     */
+    bool at_end() const { return _pos + _in_unit > _length; }
+
+private:
+    WAVStream(const WAVStream&);
+    WAVStream& operator=(const WAVStream&);
+
+    void map(const SGPath& path);
+    void unmap();
+    void parse(const SGPath& path);
+    void decode(const uint8_t* in, size_t units, uint8_t* out);
+
+    enum Encoding { PCM, PCM16_SWAP, ULAW, IMA4 };
+
+    const uint8_t* _map;
+    size_t _map_size;
+#if defined(SG_WINDOWS)
+    void* _file;
+    void* _mapping;
+#endif
+
+    const uint8_t* _data;       ///< the data chunk within _map
+    size_t _length;
+    size_t _pos;
+
+    Encoding _encoding;
+    unsigned int _format;
+    unsigned int _frequency;
+    unsigned int _block_align;
+    size_t _in_unit;            ///< bytes of one decodable frame
+    size_t _out_unit;           ///< bytes it decodes to
+};
+
+} // of namespace simgear
+
+#endif // of SG_SOUND_WAV_STREAM_HXX
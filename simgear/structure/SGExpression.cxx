@@ -896,3 +896,425 @@ bool BindingLayout::findBinding(const std::string& name,
 }
 }
 }
+
+namespace simgear
+{
+int Expression::compile(expression::Compiler& compiler) const
+{
+    return compiler.call(this);
+}
+
+namespace expression
+{
+namespace
+{
+// The value a tree of the type holds for a double
+double convertValue(Type type, double value)
+{
+    switch (type) {
+    case BOOL:
+        return value != 0;
+    case INT:
+        return int(value);
+    case FLOAT:
+        return float(value);
+    default:
+        return value;
+    }
+}
+
+double valueToDouble(Type type, const Value& value)
+{
+    switch (type) {
+    case BOOL:
+        return value.val.boolVal;
+    case INT:
+        return value.val.intVal;
+    case FLOAT:
+        return value.val.floatVal;
+    default:
+        return value.val.doubleVal;
+    }
+}
+
+// Number of register operands of an instruction
+int numOperands(Compiler::Opcode op)
+{
+    if (op < Compiler::CONVERT)
+        return 0;
+    if (op < Compiler::ADD)
+        return 1;
+    if (op < Compiler::CLIP)
+        return 2;
+    return 3;
+}
+}
+
+inline double Program::execute(const Instruction& i, const double* r,
+                               const Binding* binding) const
+{
+    switch (i.op) {
+    case Compiler::LOAD_PROPERTY: {
+        const SGPropertyNode* node = _properties[i.a];
+        switch (i.type) {
+        case BOOL:
+            return node->getBoolValue();
+        case INT:
+            return node->getIntValue();
+        case FLOAT:
+            return node->getFloatValue();
+        default:
+            return node->getDoubleValue();
+        }
+    }
+    case Compiler::LOAD_VARIABLE:
+        if (!binding)
+            return 0;
+        return valueToDouble(Type(i.type), binding->getBindings()[i.a]);
+    case Compiler::CALL: {
+        Value value = simgear::eval(_calls[i.a], binding);
+        return valueToDouble(value.typeTag, value);
+    }
+    case Compiler::TEST:
+        return _conditions[i.a]->test();
+    case Compiler::CONVERT:
+        return convertValue(Type(i.type), r[i.a]);
+    case Compiler::ABS:
+        return r[i.a] <= 0 ? -r[i.a] : r[i.a];
+    case Compiler::ACOS:
+        return acos(SGMiscd::clip(r[i.a], -1, 1));
+    case Compiler::ASIN:
+        return asin(SGMiscd::clip(r[i.a], -1, 1));
+    case Compiler::ATAN:
+        return atan(r[i.a]);
+    case Compiler::CEIL:
+        return ceil(r[i.a]);
+    case Compiler::COS:
+        return cos(r[i.a]);
+    case Compiler::COSH:
+        return cosh(r[i.a]);
+    case Compiler::EXP:
+        return exp(r[i.a]);
+    case Compiler::FLOOR:
+        return floor(r[i.a]);
+    case Compiler::LOG:
+        return log(r[i.a]);
+    case Compiler::LOG10:
+        return log10(r[i.a]);
+    case Compiler::SIN:
+        return sin(r[i.a]);
+    case Compiler::SINH:
+        return sinh(r[i.a]);
+    case Compiler::SQRT:
+        return sqrt(r[i.a]);
+    case Compiler::TAN:
+        return tan(r[i.a]);
+    case Compiler::TANH:
+        return tanh(r[i.a]);
+    case Compiler::NOT:
+        return r[i.a] == 0;
+    case Compiler::INTERPOLATE:
+        return _tables[i.b]->interpolate(r[i.a]);
+    case Compiler::ADD:
+        return r[i.a] + r[i.b];
+    case Compiler::SUB:
+        return r[i.a] - r[i.b];
+    case Compiler::MUL:
+        return r[i.a] * r[i.b];
+    case Compiler::DIV:
+        if (i.type == INT) {
+            int divisor = int(r[i.b]);
+            return divisor ? int(r[i.a]) / divisor : 0;
+        }
+        return r[i.a] / r[i.b];
+    case Compiler::MOD:
+        if (i.type == INT) {
+            int divisor = int(r[i.b]);
+            return divisor ? int(r[i.a]) % divisor : 0;
+        }
+        return fmod(r[i.a], r[i.b]);
+    case Compiler::POW:
+        return pow(r[i.a], r[i.b]);
+    case Compiler::ATAN2:
+        return atan2(r[i.a], r[i.b]);
+    case Compiler::MIN:
+        return SGMiscd::min(r[i.a], r[i.b]);
+    case Compiler::MAX:
+        return SGMiscd::max(r[i.a], r[i.b]);
+    case Compiler::EQUAL:
+        return r[i.a] == r[i.b];
+    case Compiler::LESS:
+        return r[i.a] < r[i.b];
+    case Compiler::LESS_EQUAL:
+        return r[i.a] <= r[i.b];
+    case Compiler::AND:
+        return r[i.a] != 0 && r[i.b] != 0;
+    case Compiler::OR:
+        return r[i.a] != 0 || r[i.b] != 0;
+    case Compiler::CLIP:
+        return SGMiscd::clip(r[i.a], r[i.b], r[i.c]);
+    case Compiler::STEP:
+        switch (i.type) {
+        case INT:
+            return SGStepExpression<int>::applyStep(int(r[i.a]), int(r[i.b]),
+                                                    int(r[i.c]));
+        case FLOAT:
+            return SGStepExpression<float>::applyStep(float(r[i.a]),
+                                                      float(r[i.b]),
+                                                      float(r[i.c]));
+        default:
+            return SGStepExpression<double>::applyStep(r[i.a], r[i.b], r[i.c]);
+        }
+    case Compiler::SELECT:
+        return r[i.a] != 0 ? r[i.b] : r[i.c];
+    default:
+        return 0;
+    }
+}
+
+void Program::run(double* registers, const Binding* binding) const
+{
+    if (_registers.empty())
+        return;
+    memcpy(registers, &_registers[0], _registers.size()*sizeof(double));
+    std::vector<Instruction>::const_iterator i = _code.begin();
+    for (; i != _code.end(); ++i)
+        registers[i->dst] = execute(*i, registers, binding);
+}
+
+Compiler::Compiler() :
+    _program(new Program)
+{
+}
+
+int Compiler::compile(const Expression* expression)
+{
+    if (!expression)
+        return constant(0);
+    return convert(expression->getType(), expression->compile(*this));
+}
+
+int Compiler::compile(const SGCondition* condition)
+{
+    // Like SGConditional, no condition is true
+    if (!condition)
+        return constant(1, BOOL);
+    return convert(BOOL, condition->compile(*this));
+}
+
+int Compiler::addRegister(double value, Type type, bool constant)
+{
+    _program->_registers.push_back(value);
+    _types.push_back(type);
+    _constant.push_back(constant);
+    return _program->_registers.size() - 1;
+}
+
+int Compiler::constant(double value, Type type)
+{
+    value = convertValue(type, value);
+    unsigned long long bits;
+    memcpy(&bits, &value, sizeof(bits));
+    std::pair<int, unsigned long long> key(type, bits);
+    std::map<std::pair<int, unsigned long long>, int>::iterator it
+        = _constants.find(key);
+    if (it != _constants.end())
+        return it->second;
+    int reg = addRegister(value, type, true);
+    _constants.insert(std::make_pair(key, reg));
+    return reg;
+}
+
+int Compiler::property(const SGPropertyNode* node, Type type)
+{
+    if (!node)
+        return constant(0, type);
+    std::pair<std::map<const void*, int>::iterator, bool> ins
+        = _references.insert(std::make_pair(node, int(_program->_properties.size())));
+    if (ins.second)
+        _program->_properties.push_back(node);
+    return emit(LOAD_PROPERTY, type, type, ins.first->second);
+}
+
+int Compiler::variable(int location, Type type)
+{
+    return emit(LOAD_VARIABLE, type, type, location);
+}
+
+int Compiler::call(const Expression* expression)
+{
+    std::pair<std::map<const void*, int>::iterator, bool> ins
+        = _references.insert(std::make_pair(expression, int(_program->_calls.size())));
+    if (ins.second)
+        _program->_calls.push_back(expression);
+    return emit(CALL, expression->getType(), expression->getType(),
+                ins.first->second);
+}
+
+int Compiler::test(const SGCondition* condition)
+{
+    std::pair<std::map<const void*, int>::iterator, bool> ins
+        = _references.insert(std::make_pair(condition, int(_program->_conditions.size())));
+    if (ins.second)
+        _program->_conditions.push_back(condition);
+    return emit(TEST, BOOL, BOOL, ins.first->second);
+}
+
+int Compiler::interpolate(const SGInterpTable* table, Type type, int operand)
+{
+    std::pair<std::map<const void*, int>::iterator, bool> ins
+        = _references.insert(std::make_pair(table, int(_program->_tables.size())));
+    if (ins.second)
+        _program->_tables.push_back(table);
+    return convert(type, emit(INTERPOLATE, type, DOUBLE, operand,
+                              ins.first->second));
+}
+
+int Compiler::convert(Type type, int operand)
+{
+    Type from = _types[operand];
+    // Every value fits a double, and bools fit everything
+    if (from == type || type == DOUBLE || from == BOOL)
+        return operand;
+    return emit(CONVERT, type, type, operand);
+}
+
+int Compiler::unary(Opcode op, Type type, int operand)
+{
+    switch (op) {
+    case NOT:
+        return emit(NOT, BOOL, BOOL, operand);
+    case ABS:
+    case CEIL:
+    case FLOOR:
+        // These don't leave the type
+        operand = convert(type, operand);
+        return emit(op, type, type, operand);
+    default:
+        return convert(type, emit(op, type, DOUBLE, operand));
+    }
+}
+
+int Compiler::binary(Opcode op, Type type, int operand0, int operand1)
+{
+    switch (op) {
+    case EQUAL:
+    case LESS:
+    case LESS_EQUAL:
+        return emit(op, BOOL, BOOL, operand0, operand1);
+    case AND:
+    case OR:
+        // A constant operand either decides or drops out
+        for (int i = 0; i < 2; ++i) {
+            int reg = i ? operand1 : operand0;
+            int other = i ? operand0 : operand1;
+            if (isConstant(reg)) {
+                if ((getConstant(reg) != 0) == (op == AND))
+                    return convert(BOOL, other);
+                return constant(op == OR, BOOL);
+            }
+        }
+        return emit(op, BOOL, BOOL, operand0, operand1);
+    case ADD:
+        if (isConstant(operand0) && getConstant(operand0) == 0)
+            return convert(type, operand1);
+        if (isConstant(operand1) && getConstant(operand1) == 0)
+            return convert(type, operand0);
+        break;
+    case SUB:
+        if (isConstant(operand1) && getConstant(operand1) == 0)
+            return convert(type, operand0);
+        break;
+    case MUL:
+        if (isConstant(operand0) && getConstant(operand0) == 1)
+            return convert(type, operand1);
+        if (isConstant(operand1) && getConstant(operand1) == 1)
+            return convert(type, operand0);
+        break;
+    case DIV:
+    case MOD:
+        if (type == INT)
+            return emit(op, INT, INT, convert(INT, operand0),
+                        convert(INT, operand1));
+        break;
+    case MIN:
+    case MAX:
+        return emit(op, type, type, convert(type, operand0),
+                    convert(type, operand1));
+    default:
+        break;
+    }
+    return convert(type, emit(op, type, DOUBLE, operand0, operand1));
+}
+
+int Compiler::ternary(Opcode op, Type type, int operand0, int operand1,
+                      int operand2)
+{
+    switch (op) {
+    case SELECT:
+        if (isConstant(operand0))
+            return convert(type, getConstant(operand0) != 0 ? operand1 : operand2);
+        return emit(SELECT, type, type, operand0, convert(type, operand1),
+                    convert(type, operand2));
+    default:
+        // Clipping picks one of the operands, stepping rounds itself
+        return emit(op, type, type, convert(type, operand0),
+                    convert(type, operand1), convert(type, operand2));
+    }
+}
+
+int Compiler::emit(Opcode op, Type type, Type resultType, int a, int b, int c)
+{
+    std::vector<int> key(5);
+    key[0] = op;
+    key[1] = type;
+    key[2] = a;
+    key[3] = b;
+    key[4] = c;
+    std::map<std::vector<int>, int>::iterator it = _instructions.find(key);
+    if (it != _instructions.end())
+        return it->second;
+
+    Program::Instruction instruction = {
+        (unsigned char)op, (unsigned char)type, -1, a, b, c
+    };
+    int operands[3] = { a, b, c };
+    int numOps = numOperands(op);
+    bool folded = numOps > 0;
+    for (int i = 0; i < numOps; ++i)
+        folded = folded && isConstant(operands[i]);
+
+    int reg;
+    if (folded) {
+        reg = constant(_program->execute(instruction, &_program->_registers[0], 0),
+                       resultType);
+    } else {
+        reg = addRegister(0, resultType, false);
+        instruction.dst = reg;
+        _program->_code.push_back(instruction);
+    }
+    _instructions.insert(std::make_pair(key, reg));
+    return reg;
+}
+
+size_t Batch::add(const Expression* expression)
+{
+    _outputs.push_back(_compiler.compile(expression));
+    return _outputs.size() - 1;
+}
+
+size_t Batch::add(const SGCondition* condition)
+{
+    _outputs.push_back(_compiler.compile(condition));
+    return _outputs.size() - 1;
+}
+
+void Batch::evaluate(const Binding* binding)
+{
+    const Program* program = _compiler.getProgram();
+    _registers.resize(program->getNumRegisters());
+    if (!_registers.empty())
+        program->run(&_registers[0], binding);
+}
+}
+}
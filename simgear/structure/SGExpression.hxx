@@ -25,6 +25,7 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <map>
 #include <set>
 #include <string>
 
@@ -99,6 +100,7 @@ namespace simgear
     };
 
     class Binding;
+    class Compiler;
   }
 
   class Expression : public SGReferenced
@@ -106,11 +108,164 @@ namespace simgear
   public:
     virtual ~Expression() {}
     virtual expression::Type getType() const = 0;
+    /**
+     * Emit the instructions computing this expression and return the
+     * register holding the result. Expressions that don't know better are
+     * evaluated through a call to eval().
+     */
+    virtual int compile(expression::Compiler& compiler) const;
   };
 
   const expression::Value eval(const Expression* exp,
                                const expression::Binding* binding = 0);
 
+  namespace expression
+  {
+  /**
+   * A compiled expression: a flat list of instructions working on a file
+   * of double registers. Values of int, float and bool expressions are
+   * rounded where the expression tree rounds them, so a program computes
+   * the same values as the tree. Constants live in the initial register
+   * file, property nodes are referenced directly.
+   *
+   * A program may compute any number of expressions; run() evaluates all
+   * of them in one loop. It is not changed by running it, so it can be
+   * shared between threads with one register file each.
+   */
+  class Program : public SGReferenced
+  {
+  public:
+    unsigned getNumRegisters() const
+    { return _registers.size(); }
+
+    /**
+     * Evaluate the program. The registers array needs getNumRegisters()
+     * entries, the results are left at the registers Compiler::compile()
+     * returned.
+     */
+    void run(double* registers, const Binding* binding = 0) const;
+
+  private:
+    friend class Compiler;
+
+    struct Instruction {
+      unsigned char op;
+      unsigned char type;
+      int dst;
+      int a;
+      int b;
+      int c;
+    };
+
+    double execute(const Instruction& instruction, const double* registers,
+                   const Binding* binding) const;
+
+    std::vector<Instruction> _code;
+    // Initial register file, holding the constants
+    std::vector<double> _registers;
+    std::vector<SGSharedPtr<const SGPropertyNode> > _properties;
+    std::vector<SGSharedPtr<const SGInterpTable> > _tables;
+    std::vector<SGSharedPtr<const Expression> > _calls;
+    std::vector<SGSharedPtr<const SGCondition> > _conditions;
+  };
+
+  /**
+   * Compiles expression and condition trees into a Program. Instructions
+   * whose operands are constant are folded, and repeated instructions,
+   * like loads of the same property, reuse the first result. Compiling
+   * several trees with one compiler builds a batch that is evaluated in
+   * one run.
+   */
+  class Compiler
+  {
+  public:
+    enum Opcode {
+      LOAD_PROPERTY,
+      LOAD_VARIABLE,
+      CALL,
+      TEST,
+      CONVERT,
+      ABS, ACOS, ASIN, ATAN, CEIL, COS, COSH, EXP, FLOOR, LOG, LOG10,
+      SIN, SINH, SQRT, TAN, TANH, NOT, INTERPOLATE,
+      ADD, SUB, MUL, DIV, MOD, POW, ATAN2, MIN, MAX,
+      EQUAL, LESS, LESS_EQUAL, AND, OR,
+      CLIP, STEP, SELECT
+    };
+
+    Compiler();
+
+    int compile(const Expression* expression);
+    int compile(const SGCondition* condition);
+
+    int constant(double value, Type type = DOUBLE);
+    int property(const SGPropertyNode* node, Type type);
+    int variable(int location, Type type);
+    /// Evaluate a tree the compiler does not know in its own instruction
+    int call(const Expression* expression);
+    int test(const SGCondition* condition);
+    int interpolate(const SGInterpTable* table, Type type, int operand);
+    /// Round a register to the type
+    int convert(Type type, int operand);
+
+    int unary(Opcode op, Type type, int operand);
+    int unary(Opcode op, Type type, const Expression* operand)
+    { return unary(op, type, compile(operand)); }
+    int binary(Opcode op, Type type, int operand0, int operand1);
+    int binary(Opcode op, Type type, const Expression* operand0,
+               const Expression* operand1)
+    { return binary(op, type, compile(operand0), compile(operand1)); }
+    int ternary(Opcode op, Type type, int operand0, int operand1,
+                int operand2);
+
+    bool isConstant(int reg) const
+    { return _constant[reg]; }
+    double getConstant(int reg) const
+    { return _program->_registers[reg]; }
+
+    Program* getProgram() const
+    { return _program; }
+
+  private:
+    int emit(Opcode op, Type type, Type resultType, int a = -1, int b = -1,
+             int c = -1);
+    int addRegister(double value, Type type, bool constant);
+
+    SGSharedPtr<Program> _program;
+    // What the registers are known to hold
+    std::vector<Type> _types;
+    std::vector<bool> _constant;
+    std::map<std::pair<int, unsigned long long>, int> _constants;
+    std::map<std::vector<int>, int> _instructions;
+    std::map<const void*, int> _references;
+  };
+
+  /**
+   * Expressions and conditions compiled into one program and evaluated
+   * together, like the inputs of all animations of a model once a frame.
+   */
+  class Batch
+  {
+  public:
+    /// Add an expression, returns its index for getValue()
+    size_t add(const Expression* expression);
+    size_t add(const SGCondition* condition);
+
+    size_t size() const
+    { return _outputs.size(); }
+
+    void evaluate(const Binding* binding = 0);
+
+    double getValue(size_t i) const
+    { return _registers[_outputs[i]]; }
+    bool getBoolValue(size_t i) const
+    { return _registers[_outputs[i]] != 0; }
+
+  private:
+    Compiler _compiler;
+    std::vector<int> _outputs;
+    std::vector<double> _registers;
+  };
+  }
 }
 
 template<typename T>
@@ -139,6 +294,19 @@ public:
   }
   virtual void collectDependentProperties(std::set<const SGPropertyNode*>& props) const
   { }
+  /**
+   * True if the value depends on more than the properties reported by
+   * collectDependentProperties(). Unknown leaves that are not constant
+   * are assumed to read some other state.
+   */
+  virtual bool hasExternalDependencies() const
+  { return !isConst(); }
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  {
+    if (isConst())
+      return compiler.constant(getValue(), getType());
+    return simgear::Expression::compile(compiler);
+  }
 };
 
 /// Constant value expression
@@ -190,6 +358,8 @@ public:
   
   virtual void collectDependentProperties(std::set<const SGPropertyNode*>& props) const
     { _expression->collectDependentProperties(props); }  
+  virtual bool hasExternalDependencies() const
+    { return _expression->hasExternalDependencies(); }
 protected:
   SGUnaryExpression(SGExpression<T>* expression = 0)
   { setOperand(expression); }
@@ -228,6 +398,11 @@ public:
     _expressions[0]->collectDependentProperties(props);
     _expressions[1]->collectDependentProperties(props); 
   } 
+  virtual bool hasExternalDependencies() const
+  {
+    return _expressions[0]->hasExternalDependencies()
+      || _expressions[1]->hasExternalDependencies();
+  }
   
 protected:
   SGBinaryExpression(SGExpression<T>* expr0, SGExpression<T>* expr1)
@@ -282,6 +457,13 @@ public:
     for (size_t i = 0; i < _expressions.size(); ++i)
       _expressions[i]->collectDependentProperties(props);
   } 
+  virtual bool hasExternalDependencies() const
+  {
+    for (size_t i = 0; i < _expressions.size(); ++i)
+      if (_expressions[i]->hasExternalDependencies())
+        return true;
+    return false;
+  }
 protected:
   SGNaryExpression()
   { }
@@ -307,6 +489,10 @@ public:
   
   virtual void collectDependentProperties(std::set<const SGPropertyNode*>& props) const
     { props.insert(_prop.get()); }
+  virtual bool hasExternalDependencies() const
+    { return false; }
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  { return compiler.property(_prop, this->getType()); }
 private:
   void doEval(float& value) const
   { if (_prop) value = _prop->getFloatValue(); }
@@ -331,6 +517,9 @@ public:
   virtual void eval(T& value, const simgear::expression::Binding* b) const
   { value = getOperand()->getValue(b); if (value <= 0) value = -value; }
 
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  { return compiler.unary(compiler.ABS, this->getType(), getOperand()); }
+
   using SGUnaryExpression<T>::getOperand;
 };
 
@@ -344,6 +533,9 @@ public:
   virtual void eval(T& value, const simgear::expression::Binding* b) const
   { value = acos((double)SGMisc<T>::clip(getOperand()->getValue(b), -1, 1)); }
 
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  { return compiler.unary(compiler.ACOS, this->getType(), getOperand()); }
+
   using SGUnaryExpression<T>::getOperand;
 };
 
@@ -357,6 +549,9 @@ public:
   virtual void eval(T& value, const simgear::expression::Binding* b) const
   { value = asin((double)SGMisc<T>::clip(getOperand()->getValue(b), -1, 1)); }
 
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  { return compiler.unary(compiler.ASIN, this->getType(), getOperand()); }
+
   using SGUnaryExpression<T>::getOperand;
 };
 
@@ -370,6 +565,9 @@ public:
   virtual void eval(T& value, const simgear::expression::Binding* b) const
   { value = atan(getOperand()->getDoubleValue(b)); }
 
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  { return compiler.unary(compiler.ATAN, this->getType(), getOperand()); }
+
   using SGUnaryExpression<T>::getOperand;
 };
 
@@ -383,6 +581,9 @@ public:
   virtual void eval(T& value, const simgear::expression::Binding* b) const
   { value = ceil(getOperand()->getDoubleValue(b)); }
 
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  { return compiler.unary(compiler.CEIL, this->getType(), getOperand()); }
+
   using SGUnaryExpression<T>::getOperand;
 };
 
@@ -396,6 +597,9 @@ public:
   virtual void eval(T& value, const simgear::expression::Binding* b) const
   { value = cos(getOperand()->getDoubleValue(b)); }
 
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  { return compiler.unary(compiler.COS, this->getType(), getOperand()); }
+
   using SGUnaryExpression<T>::getOperand;
 };
 
@@ -409,6 +613,9 @@ public:
   virtual void eval(T& value, const simgear::expression::Binding* b) const
   { value = cosh(getOperand()->getDoubleValue(b)); }
 
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  { return compiler.unary(compiler.COSH, this->getType(), getOperand()); }
+
   using SGUnaryExpression<T>::getOperand;
 };
 
@@ -422,6 +629,9 @@ public:
   virtual void eval(T& value, const simgear::expression::Binding* b) const
   { value = exp(getOperand()->getDoubleValue(b)); }
 
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  { return compiler.unary(compiler.EXP, this->getType(), getOperand()); }
+
   using SGUnaryExpression<T>::getOperand;
 };
 
@@ -435,6 +645,9 @@ public:
   virtual void eval(T& value, const simgear::expression::Binding* b) const
   { value = floor(getOperand()->getDoubleValue(b)); }
 
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  { return compiler.unary(compiler.FLOOR, this->getType(), getOperand()); }
+
   using SGUnaryExpression<T>::getOperand;
 };
 
@@ -448,6 +661,9 @@ public:
   virtual void eval(T& value, const simgear::expression::Binding* b) const
   { value = log(getOperand()->getDoubleValue(b)); }
 
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  { return compiler.unary(compiler.LOG, this->getType(), getOperand()); }
+
   using SGUnaryExpression<T>::getOperand;
 };
 
@@ -461,6 +677,9 @@ public:
   virtual void eval(T& value, const simgear::expression::Binding* b) const
   { value = log10(getOperand()->getDoubleValue(b)); }
 
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  { return compiler.unary(compiler.LOG10, this->getType(), getOperand()); }
+
   using SGUnaryExpression<T>::getOperand;
 };
 
@@ -474,6 +693,9 @@ public:
   virtual void eval(T& value, const simgear::expression::Binding* b) const
   { value = sin(getOperand()->getDoubleValue(b)); }
 
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  { return compiler.unary(compiler.SIN, this->getType(), getOperand()); }
+
   using SGUnaryExpression<T>::getOperand;
 };
 
@@ -487,6 +709,9 @@ public:
   virtual void eval(T& value, const simgear::expression::Binding* b) const
   { value = sinh(getOperand()->getDoubleValue(b)); }
 
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  { return compiler.unary(compiler.SINH, this->getType(), getOperand()); }
+
   using SGUnaryExpression<T>::getOperand;
 };
 
@@ -500,6 +725,12 @@ public:
   virtual void eval(T& value, const simgear::expression::Binding* b) const
   { value = getOperand()->getValue(b); value = value*value; }
 
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  {
+    int operand = compiler.compile(getOperand());
+    return compiler.binary(compiler.MUL, this->getType(), operand, operand);
+  }
+
   using SGUnaryExpression<T>::getOperand;
 };
 
@@ -513,6 +744,9 @@ public:
   virtual void eval(T& value, const simgear::expression::Binding* b) const
   { value = sqrt(getOperand()->getDoubleValue(b)); }
 
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  { return compiler.unary(compiler.SQRT, this->getType(), getOperand()); }
+
   using SGUnaryExpression<T>::getOperand;
 };
 
@@ -526,6 +760,9 @@ public:
   virtual void eval(T& value, const simgear::expression::Binding* b) const
   { value = tan(getOperand()->getDoubleValue(b)); }
 
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  { return compiler.unary(compiler.TAN, this->getType(), getOperand()); }
+
   using SGUnaryExpression<T>::getOperand;
 };
 
@@ -539,6 +776,9 @@ public:
   virtual void eval(T& value, const simgear::expression::Binding* b) const
   { value = tanh(getOperand()->getDoubleValue(b)); }
 
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  { return compiler.unary(compiler.TANH, this->getType(), getOperand()); }
+
   using SGUnaryExpression<T>::getOperand;
 };
 
@@ -563,6 +803,13 @@ public:
     return SGUnaryExpression<T>::simplify();
   }
 
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  {
+    return compiler.binary(compiler.MUL, this->getType(),
+                           compiler.constant(_scale, this->getType()),
+                           compiler.compile(getOperand()));
+  }
+
   using SGUnaryExpression<T>::getOperand;
 private:
   T _scale;
@@ -590,6 +837,13 @@ public:
     return SGUnaryExpression<T>::simplify();
   }
 
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  {
+    return compiler.binary(compiler.ADD, this->getType(),
+                           compiler.constant(_bias, this->getType()),
+                           compiler.compile(getOperand()));
+  }
+
   using SGUnaryExpression<T>::getOperand;
 private:
   T _bias;
@@ -610,6 +864,14 @@ public:
       value = _interpTable->interpolate(getOperand()->getValue(b));
   }
 
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  {
+    if (!_interpTable)
+      return compiler.constant(0, this->getType());
+    return compiler.interpolate(_interpTable, this->getType(),
+                                compiler.compile(getOperand()));
+  }
+
   using SGUnaryExpression<T>::getOperand;
 private:
   SGSharedPtr<SGInterpTable const> _interpTable;
@@ -653,6 +915,14 @@ public:
     return SGUnaryExpression<T>::simplify();
   }
 
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  {
+    return compiler.ternary(compiler.CLIP, this->getType(),
+                            compiler.compile(getOperand()),
+                            compiler.constant(_clipMin, this->getType()),
+                            compiler.constant(_clipMax, this->getType()));
+  }
+
   using SGUnaryExpression<T>::getOperand;
 private:
   T _clipMin;
@@ -678,26 +948,34 @@ public:
   { return _scroll; }
 
   virtual void eval(T& value, const simgear::expression::Binding* b) const
-  { value = apply_mods(getOperand()->getValue(b)); }
+  { value = applyStep(getOperand()->getValue(b), _step, _scroll); }
+
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  {
+    return compiler.ternary(compiler.STEP, this->getType(),
+                            compiler.compile(getOperand()),
+                            compiler.constant(_step, this->getType()),
+                            compiler.constant(_scroll, this->getType()));
+  }
 
   using SGUnaryExpression<T>::getOperand;
 
-private:
-  T apply_mods(T property) const
+  static T applyStep(T property, T step, T scroll)
   {
-    if( _step <= SGLimits<T>::min() ) return property;
+    if( step <= SGLimits<T>::min() ) return property;
 
     // apply stepping of input value
-    T modprop = floor(property/_step)*_step;
+    T modprop = floor(property/step)*step;
 
     // calculate scroll amount (for odometer like movement)
-    T remainder = property <= SGLimits<T>::min() ? -fmod(property,_step) : (_step - fmod(property,_step));
-    if( remainder > SGLimits<T>::min() && remainder < _scroll )
-      modprop += (_scroll - remainder) / _scroll * _step;
+    T remainder = property <= SGLimits<T>::min() ? -fmod(property,step) : (step - fmod(property,step));
+    if( remainder > SGLimits<T>::min() && remainder < scroll )
+      modprop += (scroll - remainder) / scroll * step;
 
     return modprop;
   }
 
+private:
   T _step;
   T _scroll;
 };
@@ -738,6 +1016,21 @@ public:
     SGUnaryExpression<T>::collectDependentProperties(props);
     _enable->collectDependentProperties(props);
   }
+  virtual bool hasExternalDependencies() const
+  {
+    return SGUnaryExpression<T>::hasExternalDependencies()
+      || _enable->hasExternalDependencies();
+  }
+
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  {
+    if (!_enable)
+      return compiler.compile(getOperand());
+    return compiler.ternary(compiler.SELECT, this->getType(),
+                            compiler.compile(_enable.get()),
+                            compiler.compile(getOperand()),
+                            compiler.constant(_disabledValue, this->getType()));
+  }
 
   using SGUnaryExpression<T>::getOperand;
 private:
@@ -753,6 +1046,11 @@ public:
   { }
   virtual void eval(T& value, const simgear::expression::Binding* b) const
   { value = atan2(getOperand(0)->getDoubleValue(b), getOperand(1)->getDoubleValue(b)); }
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  {
+    return compiler.binary(compiler.ATAN2, this->getType(), getOperand(0),
+                           getOperand(1));
+  }
   using SGBinaryExpression<T>::getOperand;
 };
 
@@ -764,6 +1062,11 @@ public:
   { }
   virtual void eval(T& value, const simgear::expression::Binding* b) const
   { value = getOperand(0)->getValue(b) / getOperand(1)->getValue(b); }
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  {
+    return compiler.binary(compiler.DIV, this->getType(), getOperand(0),
+                           getOperand(1));
+  }
   using SGBinaryExpression<T>::getOperand;
 };
 
@@ -775,6 +1078,11 @@ public:
   { }
   virtual void eval(T& value, const simgear::expression::Binding* b) const
   { value = mod(getOperand(0)->getValue(b), getOperand(1)->getValue(b)); }
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  {
+    return compiler.binary(compiler.MOD, this->getType(), getOperand(0),
+                           getOperand(1));
+  }
   using SGBinaryExpression<T>::getOperand;
 private:
   int mod(const int& v0, const int& v1) const
@@ -793,6 +1101,11 @@ public:
   { }
   virtual void eval(T& value, const simgear::expression::Binding* b) const
   { value = pow(getOperand(0)->getDoubleValue(b), getOperand(1)->getDoubleValue(b)); }
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  {
+    return compiler.binary(compiler.POW, this->getType(), getOperand(0),
+                           getOperand(1));
+  }
   using SGBinaryExpression<T>::getOperand;
 };
 
@@ -811,6 +1124,15 @@ public:
     for (size_t i = 0; i < sz; ++i)
       value += getOperand(i)->getValue(b);
   }
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  {
+    int value = compiler.constant(T(0), this->getType());
+    size_t sz = SGNaryExpression<T>::getNumOperands();
+    for (size_t i = 0; i < sz; ++i)
+      value = compiler.binary(compiler.ADD, this->getType(), value,
+                              compiler.compile(getOperand(i)));
+    return value;
+  }
   using SGNaryExpression<T>::getValue;
   using SGNaryExpression<T>::getOperand;
 };
@@ -830,6 +1152,17 @@ public:
     for (size_t i = 1; i < sz; ++i)
       value -= getOperand(i)->getValue(b);
   }
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  {
+    size_t sz = SGNaryExpression<T>::getNumOperands();
+    if (sz < 1)
+      return compiler.constant(0, this->getType());
+    int value = compiler.compile(getOperand(0));
+    for (size_t i = 1; i < sz; ++i)
+      value = compiler.binary(compiler.SUB, this->getType(), value,
+                              compiler.compile(getOperand(i)));
+    return value;
+  }
   using SGNaryExpression<T>::getValue;
   using SGNaryExpression<T>::getOperand;
 };
@@ -849,6 +1182,15 @@ public:
     for (size_t i = 0; i < sz; ++i)
       value *= getOperand(i)->getValue(b);
   }
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  {
+    int value = compiler.constant(T(1), this->getType());
+    size_t sz = SGNaryExpression<T>::getNumOperands();
+    for (size_t i = 0; i < sz; ++i)
+      value = compiler.binary(compiler.MUL, this->getType(), value,
+                              compiler.compile(getOperand(i)));
+    return value;
+  }
   using SGNaryExpression<T>::getValue;
   using SGNaryExpression<T>::getOperand;
 };
@@ -871,6 +1213,17 @@ public:
     for (size_t i = 1; i < sz; ++i)
       value = SGMisc<T>::min(value, getOperand(i)->getValue(b));
   }
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  {
+    size_t sz = SGNaryExpression<T>::getNumOperands();
+    if (sz < 1)
+      return compiler.constant(0, this->getType());
+    int value = compiler.compile(getOperand(0));
+    for (size_t i = 1; i < sz; ++i)
+      value = compiler.binary(compiler.MIN, this->getType(), value,
+                              compiler.compile(getOperand(i)));
+    return value;
+  }
   using SGNaryExpression<T>::getOperand;
 };
 
@@ -892,6 +1245,17 @@ public:
     for (size_t i = 1; i < sz; ++i)
       value = SGMisc<T>::max(value, getOperand(i)->getValue(b));
   }
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  {
+    size_t sz = SGNaryExpression<T>::getNumOperands();
+    if (sz < 1)
+      return compiler.constant(0, this->getType());
+    int value = compiler.compile(getOperand(0));
+    for (size_t i = 1; i < sz; ++i)
+      value = compiler.binary(compiler.MAX, this->getType(), value,
+                              compiler.compile(getOperand(i)));
+    return value;
+  }
   using SGNaryExpression<T>::getOperand;
 };
 
@@ -905,6 +1269,63 @@ typedef SGSharedPtr<SGExpressionf> SGExpressionf_ref;
 typedef SGSharedPtr<SGExpressiond> SGExpressiond_ref;
 typedef SGSharedPtr<SGExpressionb> SGExpressionb_ref;
 
+/**
+ * Evaluates an expression tree through a compiled program. The tree is
+ * kept for collectDependentProperties() and isConst().
+ */
+template<typename T>
+class SGCompiledExpression : public SGExpression<T> {
+public:
+  enum { MaxStackRegisters = 64 };
+
+  SGCompiledExpression(SGExpression<T>* expression) :
+    _expression(expression)
+  {
+    simgear::expression::Compiler compiler;
+    _result = compiler.compile(expression);
+    _program = compiler.getProgram();
+    _constant = compiler.isConstant(_result);
+    _constantValue = T(compiler.getConstant(_result));
+  }
+
+  const SGExpression<T>* getExpression() const
+  { return _expression; }
+
+  virtual void eval(T& value, const simgear::expression::Binding* b) const
+  {
+    if (_constant) {
+      value = _constantValue;
+      return;
+    }
+    unsigned numRegisters = _program->getNumRegisters();
+    if (numRegisters <= MaxStackRegisters) {
+      double registers[MaxStackRegisters];
+      _program->run(registers, b);
+      value = T(registers[_result]);
+    } else {
+      std::vector<double> registers(numRegisters);
+      _program->run(&registers[0], b);
+      value = T(registers[_result]);
+    }
+  }
+
+  virtual bool isConst() const
+  { return _constant; }
+  virtual void collectDependentProperties(std::set<const SGPropertyNode*>& props) const
+  { _expression->collectDependentProperties(props); }
+  virtual bool hasExternalDependencies() const
+  { return _expression->hasExternalDependencies(); }
+  virtual int compile(simgear::expression::Compiler& compiler) const
+  { return compiler.compile(_expression.get()); }
+
+private:
+  SGSharedPtr<SGExpression<T> > _expression;
+  SGSharedPtr<const simgear::expression::Program> _program;
+  int _result;
+  bool _constant;
+  T _constantValue;
+};
+
 /**
  * Global function to make an expression out of properties.
 
@@ -1093,6 +1514,8 @@ namespace simgear
       const expression::Value* values = b->getBindings();
       value = *reinterpret_cast<const T *>(&values[_location].val);
     }
+    virtual int compile(expression::Compiler& compiler) const
+    { return compiler.variable(_location, this->getType()); }
   protected:
     int _location;
 
@@ -1143,6 +1566,19 @@ namespace simgear
       return SGExpression<T>::simplify();
     }
 
+    virtual void collectDependentProperties(std::set<const SGPropertyNode*>& props) const
+    {
+      for (size_t i = 0; i < _expressions.size(); ++i)
+        _expressions[i]->collectDependentProperties(props);
+    }
+    virtual bool hasExternalDependencies() const
+    {
+      for (size_t i = 0; i < _expressions.size(); ++i)
+        if (_expressions[i]->hasExternalDependencies())
+          return true;
+      return false;
+    }
+
     simgear::expression::Type getOperandType() const
     {
       return simgear::expression::TypeTraits<OpType>::typeTag;
@@ -1182,6 +1618,14 @@ namespace simgear
                     this->getOperand(1)->getValue(b));
     }
   protected:
+    int compilePredicate(expression::Compiler& compiler,
+                         expression::Compiler::Opcode op) const
+    {
+      if (this->getNumOperands() != 2)
+        return compiler.constant(0, expression::BOOL);
+      return compiler.binary(op, expression::BOOL, this->getOperand(0),
+                             this->getOperand(1));
+    }
     Pred<OpType> _pred;
   };
 
@@ -1202,6 +1646,8 @@ namespace simgear
       : PredicateExpression<OpType, std::equal_to>(expr0, expr1)
     {
     }
+    virtual int compile(expression::Compiler& compiler) const
+    { return this->compilePredicate(compiler, compiler.EQUAL); }
   };
 
   template<typename OpType>
@@ -1213,6 +1659,8 @@ namespace simgear
       : PredicateExpression<OpType, std::less>(expr0, expr1)
     {
     }
+    virtual int compile(expression::Compiler& compiler) const
+    { return this->compilePredicate(compiler, compiler.LESS); }
   };
 
   template<typename OpType>
@@ -1226,6 +1674,8 @@ namespace simgear
       : PredicateExpression<OpType, std::less_equal>(expr0, expr1)
     {
     }
+    virtual int compile(expression::Compiler& compiler) const
+    { return this->compilePredicate(compiler, compiler.LESS_EQUAL); }
   };
 
   class NotExpression : public ::SGUnaryExpression<bool>
@@ -1239,6 +1689,8 @@ namespace simgear
     {
       value = !getOperand()->getValue(b);
     }
+    int compile(expression::Compiler& compiler) const
+    { return compiler.unary(compiler.NOT, expression::BOOL, getOperand()); }
   };
 
   class OrExpression : public ::SGNaryExpression<bool>
@@ -1253,6 +1705,14 @@ namespace simgear
           return;
       }
     }
+    int compile(expression::Compiler& compiler) const
+    {
+      int value = compiler.constant(false, expression::BOOL);
+      for (int i = 0; i < (int)getNumOperands(); ++i)
+        value = compiler.binary(compiler.OR, expression::BOOL, value,
+                                compiler.compile(getOperand(i)));
+      return value;
+    }
   };
 
   class AndExpression : public ::SGNaryExpression<bool>
@@ -1267,6 +1727,14 @@ namespace simgear
           return;
       }
     }
+    int compile(expression::Compiler& compiler) const
+    {
+      int value = compiler.constant(true, expression::BOOL);
+      for (int i = 0; i < (int)getNumOperands(); ++i)
+        value = compiler.binary(compiler.AND, expression::BOOL, value,
+                                compiler.compile(getOperand(i)));
+      return value;
+    }
   };
 
   /**
@@ -1287,6 +1755,11 @@ namespace simgear
       this->_expressions.at(0)->eval(result, b);
       value = result;
     }
+    virtual int compile(expression::Compiler& compiler) const
+    {
+      return compiler.convert(expression::TypeTraits<T>::typeTag,
+                              compiler.compile(this->_expressions.at(0)));
+    }
   };
 }
 #endif // _SG_EXPRESSION_HXX
@@ -22,6 +22,8 @@
 #include <simgear/props/condition.hxx>
 #include <simgear/props/props.hxx>
 #include <simgear/props/props_io.hxx>
+#include <simgear/math/sg_random.h>
+#include <simgear/timing/timestamp.hxx>
 
 using namespace std;    
 using namespace simgear;
@@ -98,12 +100,286 @@ void testParse()
     SG_VERIFY(deps.find(propertyTree->getNode("group-b/thing-1")) != deps.end());
 }
 
+// Random trees over a few properties, for comparing the compiled
+// programs against the tree evaluation
+struct RandomTrees
+{
+    RandomTrees()
+    {
+        root = new SGPropertyNode;
+        for (int i = 0; i < 4; ++i) {
+            doubles.push_back(root->getNode("doubles/value", i, true));
+            ints.push_back(root->getNode("ints/value", i, true));
+            bools.push_back(root->getNode("bools/value", i, true));
+        }
+        table = new SGInterpTable;
+        table->addEntry(-1, 5);
+        table->addEntry(0, 1);
+        table->addEntry(2, -3);
+        const char* xml = "<?xml version=\"1.0\"?>"
+            "<PropertyList><condition><or>"
+              "<property>/bools/value[1]</property>"
+              "<and>"
+                "<not><property>/bools/value[2]</property></not>"
+                "<less-than>"
+                  "<property>/doubles/value[0]</property>"
+                  "<property>/doubles/value[3]</property>"
+                "</less-than>"
+              "</and>"
+            "</or></condition></PropertyList>";
+        SGPropertyNode_ptr desc = new SGPropertyNode;
+        readProperties(xml, strlen(xml), desc.ptr());
+        condition = sgReadCondition(root, desc->getChild("condition"));
+    }
+
+    void randomize()
+    {
+        for (int i = 0; i < 4; ++i) {
+            doubles[i]->setDoubleValue(8*sg_random() - 4);
+            ints[i]->setIntValue(int(20*sg_random()) - 10);
+            bools[i]->setBoolValue(sg_random() < 0.5);
+        }
+    }
+
+    template<typename T>
+    const SGPropertyNode* randomProperty()
+    {
+        int i = int(4*sg_random());
+        return int(sg_random()*3) ? (sg_random() < 0.5 ? doubles[i] : ints[i])
+                                  : bools[i];
+    }
+
+    template<typename T>
+    SGExpression<T>* leaf()
+    {
+        if (sg_random() < 0.3)
+            return new SGConstExpression<T>(T(8*sg_random() - 4));
+        return new SGPropertyExpression<T>(randomProperty<T>());
+    }
+
+    // Integer trees stay clear of overflow and division by zero
+    template<typename T>
+    SGExpression<T>* create(int depth, bool integer)
+    {
+        if (depth == 0 || sg_random() < 0.15)
+            return leaf<T>();
+        SGExpression<T>* a = create<T>(depth - 1, integer);
+        SGExpression<T>* b = create<T>(depth - 1, integer);
+        int kind = int((integer ? 12 : 36)*sg_random());
+        switch (kind) {
+        case 0: return new SGAbsExpression<T>(a);
+        case 1: return new SGFloorExpression<T>(a);
+        case 2: return new SGCeilExpression<T>(a);
+        case 3: return new SGScaleExpression<T>(a, T(3));
+        case 4: return new SGBiasExpression<T>(a, T(-2));
+        case 5: return new SGClipExpression<T>(a, T(-3), T(5));
+        case 6: return new SGStepExpression<T>(a, T(2), T(1));
+        case 7: return new SGMinExpression<T>(a, b);
+        case 8: return new SGMaxExpression<T>(a, b);
+        case 9: return new SGSumExpression<T>(a, b);
+        case 10: return new SGDifferenceExpression<T>(a, b);
+        case 11: return new SGEnableExpression<T>(a, condition, T(7));
+        case 12: return new SGSqrExpression<T>(a);
+        case 13: return new SGProductExpression<T>(a, b);
+        case 14: return new SGDivExpression<T>(a, b);
+        case 15: return new SGModExpression<T>(a, b);
+        case 16: return new SGPowExpression<T>(a, b);
+        case 17: return new SGAtan2Expression<T>(a, b);
+        case 18: return new SGACosExpression<T>(a);
+        case 19: return new SGASinExpression<T>(a);
+        case 20: return new SGATanExpression<T>(a);
+        case 21: return new SGCosExpression<T>(a);
+        case 22: return new SGCoshExpression<T>(a);
+        case 23: return new SGExpExpression<T>(a);
+        case 24: return new SGLogExpression<T>(a);
+        case 25: return new SGLog10Expression<T>(a);
+        case 26: return new SGSinExpression<T>(a);
+        case 27: return new SGSinhExpression<T>(a);
+        case 28: return new SGSqrtExpression<T>(a);
+        case 29: return new SGTanExpression<T>(a);
+        case 30: return new SGTanhExpression<T>(a);
+        case 31: return new SGInterpTableExpression<T>(a, table);
+        case 32: return new SGScaleExpression<T>(a, T(1));
+        case 33: return new SGClipExpression<T>(a);
+        case 34: {
+            SGSumExpression<T>* sum = new SGSumExpression<T>;
+            sum->addOperand(new SGConstExpression<T>(T(1.5)));
+            sum->addOperand(new SGConstExpression<T>(T(2)));
+            sum->addOperand(a);
+            return sum;
+        }
+        default: return new SGProductExpression<T>(a, new SGConstExpression<T>(T(0.5)));
+        }
+    }
+
+    SGPropertyNode_ptr root;
+    std::vector<SGPropertyNode_ptr> doubles, ints, bools;
+    SGSharedPtr<SGInterpTable> table;
+    SGSharedPtr<SGCondition> condition;
+};
+
+template<typename T>
+bool same(T lhs, T rhs)
+{
+    return lhs == rhs || (lhs != lhs && rhs != rhs);
+}
+
+template<typename T>
+void testCompiledType(RandomTrees& trees, bool integer)
+{
+    for (int i = 0; i < 300; ++i) {
+        SGSharedPtr<SGExpression<T> > tree = trees.create<T>(5, integer);
+        SGSharedPtr<SGExpression<T> > compiled = new SGCompiledExpression<T>(tree);
+        for (int j = 0; j < 20; ++j) {
+            trees.randomize();
+            if (!same(tree->getValue(), compiled->getValue())) {
+                cerr << "compiled expression differs: " << tree->getValue()
+                     << " != " << compiled->getValue() << endl;
+                SG_VERIFY(false);
+            }
+        }
+    }
+}
+
+void testCompiled()
+{
+    sg_srandom(17);
+    RandomTrees trees;
+    testCompiledType<double>(trees, false);
+    testCompiledType<float>(trees, false);
+    testCompiledType<int>(trees, true);
+
+    // Conditions, and the batch of all of them
+    expression::Batch batch;
+    std::vector<SGSharedPtr<SGExpressiond> > exps;
+    for (size_t i = 0; i < 100; ++i) {
+        exps.push_back(trees.create<double>(4, false));
+        SG_CHECK_EQUAL(batch.add(exps.back()), 2*i);
+        SG_CHECK_EQUAL(batch.add(trees.condition), 2*i + 1);
+    }
+    for (int j = 0; j < 50; ++j) {
+        trees.randomize();
+        batch.evaluate();
+        for (size_t i = 0; i < exps.size(); ++i) {
+            SG_VERIFY(same(exps[i]->getValue(), batch.getValue(2*i)));
+            SG_CHECK_EQUAL(trees.condition->test(), batch.getBoolValue(2*i + 1));
+        }
+    }
+}
+
+void testFolding()
+{
+    RandomTrees trees;
+    SGSharedPtr<SGExpressiond> constant
+        = new SGSinExpression<double>(new SGSumExpression<double>(
+              new SGConstExpression<double>(1), new SGConstExpression<double>(2)));
+    SGSharedPtr<SGExpressiond> compiled = new SGCompiledExpression<double>(constant);
+    SG_VERIFY(compiled->isConst());
+    SG_CHECK_EQUAL(compiled->getValue(), sin(3.0));
+
+    // Shared subexpressions and property loads are emitted once
+    expression::Compiler compiler;
+    SGSharedPtr<SGExpressiond> clip
+        = new SGClipExpression<double>(new SGScaleExpression<double>(
+              new SGPropertyExpression<double>(trees.doubles[0]), 2), -1, 1);
+    int first = compiler.compile(clip);
+    unsigned registers = compiler.getProgram()->getNumRegisters();
+    SG_CHECK_EQUAL(compiler.compile(clip), first);
+    SGSharedPtr<SGExpressiond> other
+        = new SGScaleExpression<double>(new SGPropertyExpression<double>(trees.doubles[0]), 2);
+    compiler.compile(other);
+    SG_CHECK_EQUAL(compiler.getProgram()->getNumRegisters(), registers);
+
+    // Identities drop out, only the load is left
+    SGSharedPtr<SGExpressiond> identity
+        = new SGBiasExpression<double>(new SGScaleExpression<double>(
+              new SGPropertyExpression<double>(trees.doubles[1]), 1), 0);
+    expression::Compiler identityCompiler;
+    identityCompiler.compile(identity);
+    SG_CHECK_EQUAL(identityCompiler.getProgram()->getNumRegisters(), 3u);
+}
+
+void testVariables()
+{
+    expression::FixedLengthBinding<2> binding;
+    binding._bindings[0] = expression::Value(2.5);
+    binding._bindings[1] = expression::Value(4);
+    SGSharedPtr<SGExpressiond> tree
+        = new SGSumExpression<double>(new VariableExpression<double>(0),
+                                      new SGConstExpression<double>(1));
+    SGSharedPtr<SGExpressioni> itree
+        = new SGScaleExpression<int>(new VariableExpression<int>(1), 3);
+    expression::Batch batch;
+    batch.add(tree);
+    batch.add(itree);
+    batch.evaluate(&binding);
+    SG_CHECK_EQUAL(batch.getValue(0), 3.5);
+    SG_CHECK_EQUAL(batch.getValue(1), 12);
+}
+
+// Animation like inputs: scaled, offset and clipped properties and table
+// lookups, as the tree, compiled one by one and as one batch. Every one
+// has its own property, as most animations do.
+void benchmarkCompiled()
+{
+    RandomTrees trees;
+    std::vector<SGSharedPtr<SGExpressiond> > exps;
+    std::vector<SGSharedPtr<SGExpressiond> > compiled;
+    expression::Batch batch;
+    std::vector<SGPropertyNode_ptr> inputs;
+    for (int i = 0; i < 2000; ++i) {
+        inputs.push_back(trees.root->getNode("inputs/value", i, true));
+        inputs.back()->setDoubleValue(8*sg_random() - 4);
+        SGExpressiond* input = new SGPropertyExpression<double>(inputs.back());
+        SGExpressiond* exp;
+        if (i % 3 == 0)
+            exp = new SGInterpTableExpression<double>(input, trees.table);
+        else
+            exp = new SGClipExpression<double>(
+                new SGBiasExpression<double>(
+                    new SGScaleExpression<double>(input, 0.5 + i % 7), i % 5),
+                -10, 10);
+        exps.push_back(exp);
+        compiled.push_back(new SGCompiledExpression<double>(exp));
+        batch.add(exp);
+    }
+
+    const int frames = 500;
+    double sum[3] = { 0, 0, 0 };
+    double ms[3];
+    for (int k = 0; k < 3; ++k) {
+        SGTimeStamp timeStamp = SGTimeStamp::now();
+        for (int frame = 0; frame < frames; ++frame) {
+            if (k == 2)
+                batch.evaluate();
+            for (size_t i = 0; i < exps.size(); ++i) {
+                if (k == 0)
+                    sum[k] += exps[i]->getValue();
+                else if (k == 1)
+                    sum[k] += compiled[i]->getValue();
+                else
+                    sum[k] += batch.getValue(i);
+            }
+        }
+        ms[k] = timeStamp.elapsedMSec();
+    }
+    SG_CHECK_EQUAL(sum[0], sum[1]);
+    SG_CHECK_EQUAL(sum[0], sum[2]);
+    cout << exps.size() << " expressions x " << frames
+         << " frames, ms for tree / compiled / batch: " << ms[0] << " / "
+         << ms[1] << " / " << ms[2] << endl;
+}
+
 int main(int argc, char* argv[])
 {
     sglog().setLogLevels( SG_ALL, SG_INFO );
   
     testBasic();
     testParse();
+    testCompiled();
+    testFolding();
+    testVariables();
+    benchmarkCompiled();
     
     cout << __FILE__ << ": All tests passed" << endl;
     return EXIT_SUCCESS;